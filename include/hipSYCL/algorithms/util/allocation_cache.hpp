@@ -11,6 +11,8 @@
 #ifndef HIPSYCL_ALGORITHM_UTIL_ALLOCATION_CACHE_HPP
 #define HIPSYCL_ALGORITHM_UTIL_ALLOCATION_CACHE_HPP
 
+#include <array>
+#include <atomic>
 #include <vector>
 #include <mutex>
 
@@ -18,6 +20,8 @@
 #include "hipSYCL/runtime/device_id.hpp"
 #include "hipSYCL/runtime/runtime.hpp"
 #include "hipSYCL/runtime/application.hpp"
+#include "hipSYCL/runtime/settings.hpp"
+#include "hipSYCL/common/debug.hpp"
 #include "hipSYCL/sycl/device.hpp"
 
 namespace hipsycl::rt {
@@ -39,91 +43,239 @@ enum class allocation_type {
   device, shared, host
 };
 
+/// A cache for scratch allocations, e.g. for temporary data of reductions
+/// and scans.
+///
+/// Allocations are rounded up to size classes, such that returned
+/// allocations can be reused for all requests of the same size class in O(1).
+/// Size classes are powers of two up to 64 KiB. Above, there are four size
+/// classes per power of two, which limits the memory wasted by rounding up
+/// large allocations to 25%. Unused allocations are kept in multiple shards that
+/// threads are distributed across, so that concurrent algorithm invocations
+/// from different threads usually do not contend for the same lock.
+/// If the unused allocations exceed a configurable high-water mark,
+/// they are trimmed, starting with the largest size classes.
 class allocation_cache {
   friend class allocation_group;
 public:
+  struct statistics {
+    // Number of requests served from cached allocations
+    std::size_t num_hits = 0;
+    // Number of requests that required a new allocation
+    std::size_t num_misses = 0;
+    // Number of allocations that were freed due to trimming
+    std::size_t num_trimmed = 0;
+    // Bytes of allocations that are cached, but currently unused
+    std::size_t bytes_held = 0;
+    // Bytes of allocations that are currently used by allocation_groups
+    std::size_t bytes_in_use = 0;
+  };
+
   allocation_cache(allocation_type alloc_type)
-  : _alloc_type{alloc_type} {}
+      : allocation_cache{alloc_type,
+                         rt::application::get_settings()
+                             .get<rt::setting::scratch_cache_max_size>()} {}
+
+  /// \param max_held_bytes The high-water mark for unused allocations.
+  /// 0 means no limit.
+  allocation_cache(allocation_type alloc_type, std::size_t max_held_bytes)
+      : _alloc_type{alloc_type}, _max_held_bytes{max_held_bytes} {}
 
   ~allocation_cache() {
     purge();
+    statistics stats = get_statistics();
+    HIPSYCL_DEBUG_INFO << "allocation_cache: " << stats.num_hits << " hits, "
+                       << stats.num_misses << " misses, " << stats.num_trimmed
+                       << " trimmed allocations" << std::endl;
   }
 
+  /// Frees all unused allocations
   void purge() {
-    std::lock_guard<std::mutex> lock{_mutex};
-    
-    for(auto& allocation : _allocations) {
-      auto* allocator = _rt.get()->backends()
-          .get(allocation.dev.get_backend())
-          ->get_allocator(allocation.dev);
-      rt::deallocate(allocator, allocation.ptr);
+    trim(0);
+  }
+
+  /// Frees unused allocations until at most max_held_bytes remain. Each
+  /// shard is visited once, and within a shard the largest allocations are
+  /// freed first.
+  void trim(std::size_t max_held_bytes) {
+    for(auto& s : _shards) {
+      if(_bytes_held.load(std::memory_order_relaxed) <= max_held_bytes)
+        return;
+
+      std::lock_guard<std::mutex> lock{s.mutex};
+      for(std::size_t size_class = num_size_classes; size_class-- > 0;) {
+        for(auto& pool : s.pools) {
+          auto& free_list = pool.free_allocations[size_class];
+          while(!free_list.empty() &&
+                _bytes_held.load(std::memory_order_relaxed) > max_held_bytes) {
+            auto* allocator = _rt.get()->backends()
+                .get(pool.dev.get_backend())
+                ->get_allocator(pool.dev);
+            rt::deallocate(allocator, free_list.back());
+            free_list.pop_back();
+            _bytes_held.fetch_sub(get_class_size(size_class),
+                                  std::memory_order_relaxed);
+            _num_trimmed.fetch_add(1, std::memory_order_relaxed);
+          }
+        }
+      }
     }
-    _allocations.clear();
+  }
+
+  statistics get_statistics() const {
+    statistics stats;
+    stats.num_hits = _num_hits.load(std::memory_order_relaxed);
+    stats.num_misses = _num_misses.load(std::memory_order_relaxed);
+    stats.num_trimmed = _num_trimmed.load(std::memory_order_relaxed);
+    stats.bytes_held = _bytes_held.load(std::memory_order_relaxed);
+    stats.bytes_in_use = _bytes_in_use.load(std::memory_order_relaxed);
+    return stats;
   }
 private:
-  
+  // Size classes are powers of two from 2^min_size_log2 to
+  // 2^fine_size_log2 bytes, followed by four classes per power of two.
+  static constexpr std::size_t min_size_log2 = 8;
+  static constexpr std::size_t fine_size_log2 = 16;
+  static constexpr std::size_t num_coarse_size_classes =
+      fine_size_log2 - min_size_log2 + 1;
+  static constexpr std::size_t num_size_classes =
+      num_coarse_size_classes + 4 * (63 - fine_size_log2);
+  static constexpr std::size_t num_shards = 8;
+
+  struct device_pool {
+    rt::device_id dev;
+    std::array<std::vector<void *>, num_size_classes> free_allocations;
+  };
+
+  struct alignas(64) shard {
+    std::mutex mutex;
+    // Typically only contains very few devices
+    std::vector<device_pool> pools;
+
+    device_pool& get_pool(rt::device_id dev) {
+      for(auto& pool : pools)
+        if(pool.dev == dev)
+          return pool;
+      pools.emplace_back();
+      pools.back().dev = dev;
+      return pools.back();
+    }
+  };
+
+  static std::size_t get_size_class(std::size_t size) {
+    if(size <= (std::size_t{1} << fine_size_log2)) {
+      std::size_t size_class = 0;
+      while(get_class_size(size_class) < size)
+        ++size_class;
+      return size_class;
+    }
+    std::size_t base_log2 = 63 - __builtin_clzll(size - 1);
+    std::size_t base = std::size_t{1} << base_log2;
+    std::size_t step = base / 4;
+    return num_coarse_size_classes + 4 * (base_log2 - fine_size_log2) +
+           (size - base + step - 1) / step - 1;
+  }
+
+  static std::size_t get_class_size(std::size_t size_class) {
+    if(size_class < num_coarse_size_classes)
+      return std::size_t{1} << (size_class + min_size_log2);
+    std::size_t fine_class = size_class - num_coarse_size_classes;
+    std::size_t base = std::size_t{1} << (fine_size_log2 + fine_class / 4);
+    return base + (base / 4) * (fine_class % 4 + 1);
+  }
+
+  static std::size_t get_thread_shard() {
+    static std::atomic<std::size_t> num_threads = 0;
+    static thread_local std::size_t shard_index =
+        num_threads.fetch_add(1, std::memory_order_relaxed) % num_shards;
+    return shard_index;
+  }
+
   allocation find_or_alloc(std::size_t min_size, std::size_t min_alignment,
                            rt::device_id dev) {
+    std::size_t size_class = get_size_class(min_size);
+    std::size_t own_shard = get_thread_shard();
+
     allocation result;
-    if(!find_allocation(min_size, min_alignment, dev, result)){  
-      result.dev = dev;
-      result.size = min_size;
-
-      auto allocator = _rt.get()->backends()
-                       .get(dev.get_backend())
-                       ->get_allocator(dev);
-
-      if(_alloc_type == allocation_type::device)
-        result.ptr = rt::allocate_device(allocator, min_alignment, min_size);
-      else if(_alloc_type == allocation_type::shared)
-        result.ptr = rt::allocate_shared(allocator, min_size);
-      else
-        result.ptr =
-            rt::allocate_host(allocator, min_alignment, min_size);
+    result.dev = dev;
+    result.size = get_class_size(size_class);
+
+    // Look in the shard of this thread first, then in the others
+    for(std::size_t i = 0; i < num_shards; ++i) {
+      shard& s = _shards[(own_shard + i) % num_shards];
+      if (try_take(s, size_class, min_alignment, dev, result.ptr)) {
+        _num_hits.fetch_add(1, std::memory_order_relaxed);
+        _bytes_held.fetch_sub(result.size, std::memory_order_relaxed);
+        _bytes_in_use.fetch_add(result.size, std::memory_order_relaxed);
+        return result;
+      }
     }
+
+    _num_misses.fetch_add(1, std::memory_order_relaxed);
+    auto allocator = _rt.get()->backends()
+                      .get(dev.get_backend())
+                      ->get_allocator(dev);
+
+    if(_alloc_type == allocation_type::device)
+      result.ptr = rt::allocate_device(allocator, min_alignment, result.size);
+    else if(_alloc_type == allocation_type::shared)
+      result.ptr = rt::allocate_shared(allocator, result.size);
+    else
+      result.ptr =
+          rt::allocate_host(allocator, min_alignment, result.size);
+
+    if(result.ptr)
+      _bytes_in_use.fetch_add(result.size, std::memory_order_relaxed);
     return result;
   }
 
-  bool find_allocation(std::size_t min_size, std::size_t min_alignment,
-                       rt::device_id dev, allocation &out) {
-    std::lock_guard<std::mutex> lock{_mutex};
-
-    bool found = false;
-    std::size_t found_index = 0;
-    for (std::size_t i = 0; i < _allocations.size(); ++i) {
-      const auto& allocation = _allocations[i];
-      if (allocation.dev == dev) {
-        if (allocation.size >= min_size &&
-            reinterpret_cast<std::size_t>(allocation.ptr) % min_alignment ==
-                0) {
-          // If we already have found a candidate: We want the smallest
-          // allocation that has the required size so that larger allocations
-          // remain available for larger requests.
-          if (!found || allocation.size < out.size) {
-            out = allocation;
-            found_index = i;
-          }
-          found = true;
-        }
+  bool try_take(shard &s, std::size_t size_class, std::size_t min_alignment,
+                rt::device_id dev, void *&out) {
+    std::lock_guard<std::mutex> lock{s.mutex};
+    auto& free_list = s.get_pool(dev).free_allocations[size_class];
+    // Search from the back, which contains the most recently returned
+    // allocations
+    for(std::size_t i = free_list.size(); i-- > 0;) {
+      if(reinterpret_cast<std::size_t>(free_list[i]) % min_alignment == 0) {
+        out = free_list[i];
+        free_list[i] = free_list.back();
+        free_list.pop_back();
+        return true;
       }
     }
-    if(found) {
-      // The allocation is no longer available for other requests,
-      // so remove for now.
-      _allocations.erase(_allocations.begin() + found_index);
-    }
-    return found;
+    return false;
   }
 
   void return_allocation(const allocation& alloc) {
-    std::lock_guard<std::mutex> lock{_mutex};
-    _allocations.push_back(alloc);
+    if(!alloc.ptr)
+      return;
+    // Account before publishing the allocation, so that the counter
+    // cannot underflow when another thread takes it right away.
+    std::size_t held =
+        _bytes_held.fetch_add(alloc.size, std::memory_order_relaxed) +
+        alloc.size;
+    _bytes_in_use.fetch_sub(alloc.size, std::memory_order_relaxed);
+    {
+      shard& s = _shards[get_thread_shard()];
+      std::lock_guard<std::mutex> lock{s.mutex};
+      s.get_pool(alloc.dev)
+          .free_allocations[get_size_class(alloc.size)]
+          .push_back(alloc.ptr);
+    }
+    if(_max_held_bytes > 0 && held > _max_held_bytes)
+      trim(_max_held_bytes);
   }
 
   rt::runtime_keep_alive_token _rt;
-  common::auto_small_vector<allocation> _allocations;
-  std::mutex _mutex;
+  std::array<shard, num_shards> _shards;
   allocation_type _alloc_type;
+  std::size_t _max_held_bytes;
+
+  std::atomic<std::size_t> _num_hits = 0;
+  std::atomic<std::size_t> _num_misses = 0;
+  std::atomic<std::size_t> _num_trimmed = 0;
+  std::atomic<std::size_t> _bytes_held = 0;
+  std::atomic<std::size_t> _bytes_in_use = 0;
 };
 
 /// allocation_group represents allocation requests that belong together
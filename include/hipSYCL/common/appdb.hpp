@@ -11,11 +11,15 @@
 #ifndef HIPSYCL_COMMON_APP_DB_HPP
 #define HIPSYCL_COMMON_APP_DB_HPP
 
+#include <map>
 #include <unordered_map>
 #include <atomic>
 #include <vector>
 #include <string>
 #include <ostream>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 #include "msgpack/msgpack.hpp"
 
@@ -88,6 +92,49 @@ struct binary_entry {
   void dump(std::ostream& ostr, int indentation_level=0) const;
 };
 
+// Aggregated runtime measurements of a stdpar operation
+// in one problem size bucket
+struct stdpar_sample {
+  uint64_t total_problem_size = 0;
+  uint64_t total_runtime = 0; // in ns
+  uint64_t num_samples = 0;
+
+  template<class T>
+  void pack(T &pack) {
+    pack(total_problem_size);
+    pack(total_runtime);
+    pack(num_samples);
+  }
+
+  void dump(std::ostream& ostr, int indentation_level=0) const;
+};
+
+struct stdpar_op_entry {
+  // Samples by problem size bucket
+  std::map<uint64_t, stdpar_sample> host_samples;
+  std::map<uint64_t, stdpar_sample> offload_samples;
+
+  template<class T>
+  void pack(T &pack) {
+    pack(host_samples);
+    pack(offload_samples);
+  }
+
+  void dump(std::ostream& ostr, int indentation_level=0) const;
+};
+
+struct stdpar_dataset {
+  // Operations by operation hash
+  std::unordered_map<uint64_t, stdpar_op_entry> ops;
+
+  template<class T>
+  void pack(T &pack) {
+    pack(ops);
+  }
+
+  void dump(std::ostream& ostr, int indentation_level=0) const;
+};
+
 struct appdb_data {
   std::size_t content_version = 0;
 
@@ -97,12 +144,15 @@ struct appdb_data {
   std::unordered_map<rt::kernel_configuration::id_type, binary_entry,
                      rt::kernel_id_hash>
       binaries;
+  // stdpar offload heuristic measurements by dataset name
+  std::unordered_map<std::string, stdpar_dataset> stdpar_datasets;
 
   template<class T>
   void pack(T &pack) {
     pack(kernels);
     pack(binaries);
     pack(content_version);
+    pack(stdpar_datasets);
   }
 
   void dump(std::ostream& ostr, int indentation_level=0) const;
@@ -113,11 +163,19 @@ class appdb  {
 public:
   // DO NOT FORGET TO INCREMENT THIS WHEN ADDING/REMOVING
   // FIELDS OR OTHERWISE CHANGING THE DATA LAYOUT!
-  static const uint64_t format_version = 4;
+  static const uint64_t format_version = 5;
 
-  appdb(const std::string& db_path);
+  /// \param flush_interval If non-zero, modifications are additionally
+  /// flushed to disk in the background every \c flush_interval seconds.
+  /// Otherwise, they are only flushed on destruction.
+  appdb(const std::string& db_path, std::size_t flush_interval = 0);
   ~appdb();
 
+  /// Merges the modifications since the last flush into the database on disk.
+  /// Multiple processes may flush the same database concurrently;
+  /// statistics collected by all of them are retained.
+  void flush();
+
   template<class F>
   auto read_access(F&& handler) const{
     read_lock lock {_lock};
@@ -171,12 +229,28 @@ private:
    std::atomic<int>& _op_counter;
   };
 
+  void run_background_flushes(std::size_t flush_interval);
+
   mutable std::atomic<int> _lock;
   bool _was_modified;
 
   std::string _db_path;
 
   appdb_data _data;
+  // The state of _data at the last synchronization with the disk.
+  // Modifications are computed relative to this state when flushing.
+  appdb_data _last_synchronized_data;
+  // The application run that this process contributes to content_version.
+  // Remains constant during the lifetime of the process.
+  std::size_t _application_run;
+  bool _has_registered_application_run = false;
+
+  std::mutex _flush_mutex;
+
+  std::mutex _background_flush_mutex;
+  std::condition_variable _background_flush_cv;
+  bool _is_shutting_down = false;
+  std::thread _background_flush_thread;
 };
 
 
@@ -12,11 +12,13 @@
 #define HIPSYCL_COMMON_FILESYSTEM_HPP
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <atomic>
 
 #include "appdb.hpp"
+#include "jit_cache_archive.hpp"
 
 
 namespace hipsycl {
@@ -41,11 +43,26 @@ std::vector<std::string> list_regular_files(const std::string &directory,
                                             const std::string &extension);
 
 /// Writes data atomically to filename
-bool atomic_write(const std::string& filename, const std::string& data);
+bool atomic_write(const std::string& filename, std::string_view data);
 
 /// Removes a file, returns true if successful.
 bool remove(const std::string &filename);
 
+/// Advisory inter-process lock on a lock file, which is created if
+/// it does not exist. The lock is held for the lifetime of the object.
+/// If locking is unsupported (e.g. on some network file systems),
+/// no inter-process synchronization takes place.
+class file_lock {
+public:
+  file_lock(const std::string& lock_path, bool exclusive);
+  ~file_lock();
+
+  file_lock(const file_lock&) = delete;
+  file_lock& operator=(const file_lock&) = delete;
+private:
+  int _fd = -1;
+};
+
 class persistent_storage {
 public:
   static persistent_storage& get() {
@@ -72,6 +89,10 @@ public:
     return *_this_app_db;
   }
 
+  jit_cache_archive& get_jit_cache_archive() {
+    return *_jit_cache_archive;
+  }
+
   // Generates just the expected name of the file, without directories.
   std::string generate_app_db_filename() const;
 private:
@@ -83,6 +104,7 @@ private:
   std::string _jit_cache_dir;
 
   std::unique_ptr<db::appdb> _this_app_db;
+  std::unique_ptr<jit_cache_archive> _jit_cache_archive;
 };
 
 }
@@ -21,7 +21,8 @@
 #include <algorithm>
 #include <exception>
 #include <cassert>
-#include <locale>
+#include <optional>
+#include <string_view>
 
 namespace hipsycl {
 namespace common {
@@ -126,17 +127,41 @@ public:
   }
 
   hcf_container(const std::string& container) {
-    std::string appendix_id {_binary_appendix_id};
+    std::string_view appendix = init(container);
+    _binary_appendix = std::string{appendix};
+  }
 
-    std::size_t appendix_begin = container.find(appendix_id);
-    if(appendix_begin != std::string::npos) {
-      _binary_appendix = container.substr(appendix_begin + appendix_id.length());
-    }
+  /// Tag to construct a container that references the binary appendix
+  /// of the serialized data in place instead of copying it.
+  struct reference_binary_appendix_t {};
+  static constexpr reference_binary_appendix_t reference_binary_appendix{};
 
-    std::string parseable_data = container;
-    parseable_data.erase(appendix_begin);
+  /// The serialized data must outlive the container and all its copies.
+  hcf_container(std::string_view container, reference_binary_appendix_t) {
+    _binary_appendix_ref = init(container);
+  }
 
-    parse(parseable_data);
+  /// Looks up a key of the root node without parsing the container.
+  /// Only finds keys that precede the first subnode, which is where
+  /// serialize() places them.
+  static std::optional<std::string_view>
+  peek_root_value(std::string_view container, std::string_view key) {
+    container = container.substr(0, container.find(_binary_appendix_id));
+    std::size_t pos = 0;
+    while(pos < container.size()) {
+      std::size_t end = container.find('\n', pos);
+      if(end == std::string_view::npos)
+        end = container.size();
+      std::string_view line = trim(container.substr(pos, end - pos));
+      pos = end + 1;
+
+      if(starts_with(line, _node_start_id))
+        break;
+      std::size_t eq = line.find('=');
+      if(eq != std::string_view::npos && line.substr(0, eq) == key)
+        return line.substr(eq + 1);
+    }
+    return {};
   }
 
   const node* root_node() const {
@@ -148,6 +173,16 @@ public:
   }
 
   bool get_binary_attachment(const node* n, std::string& out) const {
+    std::string_view attachment;
+    if(!get_binary_attachment(n, attachment))
+      return false;
+    out = std::string{attachment};
+    return true;
+  }
+
+  /// Returns the attachment without copying it. The view remains valid
+  /// as long as the container is alive and no content is attached.
+  bool get_binary_attachment(const node* n, std::string_view& out) const {
     std::size_t start = 0;
     std::size_t size = 0;
 
@@ -183,12 +218,13 @@ public:
     start = std::stoull(*start_entry);
     size = std::stoull(*size_entry);
 
-    if(start + size > _binary_appendix.size()) {
+    std::string_view appendix = get_binary_appendix();
+    if(start + size > appendix.size()) {
       HIPSYCL_DEBUG_ERROR << "hcf: Binary content address is out-of-bounds\n";
       return false;
     }
 
-    out = _binary_appendix.substr(start, size);
+    out = appendix.substr(start, size);
 
     return true;
   }
@@ -199,6 +235,11 @@ public:
     if(!binary_node)
       return false;
 
+    if(_binary_appendix_ref.data()) {
+      _binary_appendix = std::string{_binary_appendix_ref};
+      _binary_appendix_ref = {};
+    }
+
     std::size_t start = _binary_appendix.size();
     std::size_t length = binary_content.size();
 
@@ -215,9 +256,30 @@ public:
     serialize_node(_root_node, sstr);
     sstr << _binary_appendix_id;
 
-    return sstr.str() + _binary_appendix;
+    std::string result = sstr.str();
+    result += get_binary_appendix();
+    return result;
   }
 private:
+  // Parses the part of the container preceding the binary appendix,
+  // and returns the appendix.
+  std::string_view init(std::string_view container) {
+    std::string_view appendix;
+    std::size_t appendix_begin = container.find(_binary_appendix_id);
+    if(appendix_begin != std::string_view::npos) {
+      appendix = container.substr(appendix_begin +
+                                  std::string_view{_binary_appendix_id}.size());
+      container = container.substr(0, appendix_begin);
+    }
+    parse(container);
+    return appendix;
+  }
+
+  std::string_view get_binary_appendix() const {
+    if(_binary_appendix_ref.data())
+      return _binary_appendix_ref;
+    return _binary_appendix;
+  }
 
   void serialize_node(const node& n, std::ostream& out) const {
     for(const auto& p : n.key_value_pairs){
@@ -230,118 +292,76 @@ private:
     }
   }
 
-  void trim_left(std::string& str) const
-  {
-    auto it2 = std::find_if(str.begin(), str.end(), [](char ch) {
-      return !std::isspace<char>(ch, std::locale::classic());
-    });
-    str.erase(str.begin(), it2);
+  static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' ||
+           c == '\f';
   }
 
-  void trim_right(std::string& str) const
-  {
-    auto it1 = std::find_if(str.rbegin(), str.rend(), [](char ch) {
-      return !std::isspace<char>(ch, std::locale::classic());
-    });
-    str.erase(it1.base(), str.end());
+  static std::string_view trim(std::string_view str) {
+    while(!str.empty() && is_space(str.front()))
+      str.remove_prefix(1);
+    while(!str.empty() && is_space(str.back()))
+      str.remove_suffix(1);
+    return str;
   }
 
-  bool parse_node_start(const std::string& start_line, std::string& node_id) const {
-    std::string processed_data = start_line;
-    std::string node_start_id = std::string{_node_start_id};
-
-    trim_left(processed_data);
-    
-    if(processed_data.find(node_start_id) != 0) {
-      HIPSYCL_DEBUG_ERROR << "hcf: Invalid node start: " << processed_data
-                          << "\n";
-      return false;
-    }
-
-
-    processed_data.erase(0, node_start_id.length());
-    trim_right(processed_data);
-
-    node_id = processed_data;
-
-    return true;
+  static bool starts_with(std::string_view str, std::string_view prefix) {
+    return str.substr(0, prefix.size()) == prefix;
   }
 
-  bool parse_node_interior(const std::vector<std::string>& lines, 
-                           std::size_t node_start_line,
-                           std::size_t node_end_line,
-                           node& current_node) const {
-
-    if(node_start_line == node_end_line)
-      return true;
-
-    for(int i = node_start_line; i <  node_end_line; ++i) {
-      assert(i < lines.size());
-      const std::string& current = lines[i];
-
-      if(current.find(_node_start_id) == 0) {
-        node new_node;
-
-        if(!parse_node_start(current, new_node.node_id)) {
-          return false;
-        }
+  // Single pass over the lines, keeping the currently open nodes on a stack.
+  // Only the innermost open node gains subnodes, so pointers to the
+  // open nodes remain valid.
+  bool parse(std::string_view data) {
+    _root_node.node_id = "root";
 
-        std::size_t num_node_lines = std::string::npos;
-        std::string node_end_marker = _node_end_id + new_node.node_id;
-        
-        for(int j = i + 1; j < node_end_line; ++j) {
-          if(lines[j] == node_end_marker) {
-            num_node_lines = j-i;
-            break;
-          }
-        }
-        if(num_node_lines == std::string::npos) {
-          HIPSYCL_DEBUG_ERROR
-              << "hcf: Syntax error: Did not find expected node end marker: "
-              << node_end_marker << "\n";
+    const std::string_view node_start_id{_node_start_id};
+    const std::string_view node_end_id{_node_end_id};
+
+    std::vector<node*> open_nodes{&_root_node};
+    std::size_t pos = 0;
+    while(pos < data.size()) {
+      std::size_t end = data.find('\n', pos);
+      if(end == std::string_view::npos)
+        end = data.size();
+      std::string_view current = trim(data.substr(pos, end - pos));
+      pos = end + 1;
+
+      if(current.empty())
+        continue;
+
+      node* current_node = open_nodes.back();
+      if(starts_with(current, node_start_id)) {
+        node& new_node = current_node->subnodes.emplace_back();
+        new_node.node_id =
+            std::string{trim(current.substr(node_start_id.size()))};
+        open_nodes.push_back(&new_node);
+      } else if(std::size_t eq = current.find('='); eq != std::string_view::npos) {
+        current_node->key_value_pairs.emplace_back(
+            std::string{current.substr(0, eq)},
+            std::string{current.substr(eq + 1)});
+      } else if(starts_with(current, node_end_id)) {
+        if(open_nodes.size() == 1 ||
+           current.substr(node_end_id.size()) != current_node->node_id) {
+          HIPSYCL_DEBUG_ERROR << "hcf: Syntax error: Unexpected node end: "
+                              << current << "\n";
           return false;
         }
-        if(!parse_node_interior(lines, i+1, i+num_node_lines, new_node))
-          return false;
-
-        current_node.subnodes.push_back(new_node);
-        i += num_node_lines;
-      } else if(current.find("=") != std::string::npos) {
-        std::size_t pos = current.find("=");
-        std::string key = current.substr(0, pos);
-        std::string value = current.substr(pos+1);
-        current_node.key_value_pairs.push_back(std::make_pair(key, value));
-      } else if(current.find(_node_end_id) == 0) {
-        HIPSYCL_DEBUG_ERROR << "hcf: Syntax error: Unexpected node end: " << current
-                          << "\n";
-        return false;
+        open_nodes.pop_back();
       } else {
         HIPSYCL_DEBUG_ERROR << "hcf: Syntax error: Invalid line: " << current
-                          << "\n";
+                            << "\n";
         return false;
       }
-
     }
 
-    return true;
-  }
-
-  bool parse(const std::string& data) {
-    std::stringstream ss(data);
-    std::string line;
-
-    std::vector<std::string> lines;
-    
-    while(std::getline(ss,line)){
-      trim_left(line);
-      trim_right(line);
-
-      if(!line.empty())
-        lines.push_back(line);
+    if(open_nodes.size() > 1) {
+      HIPSYCL_DEBUG_ERROR
+          << "hcf: Syntax error: Did not find expected node end marker: "
+          << _node_end_id << open_nodes.back()->node_id << "\n";
+      return false;
     }
-
-    _root_node.node_id = "root";
-    return parse_node_interior(lines, 0, lines.size(), _root_node);
+    return true;
   }
 
   static constexpr char _binary_appendix_id [] = "__acpp_hcf_binary_appendix";
@@ -351,6 +371,8 @@ private:
 
   node _root_node;
   std::string _binary_appendix;
+  // Set instead of _binary_appendix if the appendix is referenced in place
+  std::string_view _binary_appendix_ref;
 };
 
 }
@@ -0,0 +1,96 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+#ifndef HIPSYCL_COMMON_INTRUSIVE_FREE_LIST_HPP
+#define HIPSYCL_COMMON_INTRUSIVE_FREE_LIST_HPP
+
+#include <cstddef>
+
+namespace hipsycl {
+namespace common {
+
+/// Singly-linked list of free objects of slab allocators that stores
+/// the links inside the free objects themselves, so objects must be
+/// at least pointer-sized and pointer-aligned. Since it never allocates,
+/// it can be used by allocators that replace the global operator new.
+///
+/// Thread safety: None
+class intrusive_free_list {
+public:
+  void push(void* ptr) {
+    free_object* obj = static_cast<free_object*>(ptr);
+    obj->next = _head;
+    _head = obj;
+    if(!_tail)
+      _tail = obj;
+    ++_size;
+  }
+
+  /// \return The most recently pushed object, or nullptr if the list is empty
+  void* pop() {
+    free_object* obj = _head;
+    if(obj) {
+      _head = obj->next;
+      if(!_head)
+        _tail = nullptr;
+      --_size;
+    }
+    return obj;
+  }
+
+  /// Moves up to n objects from the front into a new list
+  intrusive_free_list split(std::size_t n) {
+    intrusive_free_list result;
+    while(result._size < n && _head) {
+      free_object* obj = static_cast<free_object*>(pop());
+      obj->next = nullptr;
+      if(result._tail)
+        result._tail->next = obj;
+      else
+        result._head = obj;
+      result._tail = obj;
+      ++result._size;
+    }
+    return result;
+  }
+
+  /// Moves all objects of other to the front of this list
+  void splice(intrusive_free_list& other) {
+    if(!other._head)
+      return;
+    other._tail->next = _head;
+    _head = other._head;
+    if(!_tail)
+      _tail = other._tail;
+    _size += other._size;
+    other = intrusive_free_list{};
+  }
+
+  std::size_t size() const {
+    return _size;
+  }
+
+  bool empty() const {
+    return _size == 0;
+  }
+private:
+  struct free_object {
+    free_object* next;
+  };
+
+  free_object* _head = nullptr;
+  free_object* _tail = nullptr;
+  std::size_t _size = 0;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,170 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+#ifndef HIPSYCL_COMMON_JIT_CACHE_ARCHIVE_HPP
+#define HIPSYCL_COMMON_JIT_CACHE_ARCHIVE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "hipSYCL/runtime/kernel_configuration.hpp"
+
+namespace hipsycl {
+namespace common {
+namespace filesystem {
+
+/// A read-only view of a complete file. Where supported, the file
+/// is memory-mapped; otherwise, its content is read into memory.
+class mapped_file {
+public:
+  /// Returns nullptr if the file could not be opened or mapped.
+  static std::shared_ptr<const mapped_file> open(const std::string& path);
+
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+  ~mapped_file();
+
+  const char* data() const { return _data; }
+  std::size_t size() const { return _size; }
+private:
+  mapped_file() = default;
+
+  const char* _data = nullptr;
+  std::size_t _size = 0;
+  bool _is_mapped = false;
+  std::string _fallback_storage;
+};
+
+/// Data of a binary stored in a jit_cache_archive. Keeps the
+/// underlying memory mapping alive, so the data remains valid
+/// even if the archive is compacted or remapped in the meantime.
+class archived_binary {
+public:
+  archived_binary() = default;
+  archived_binary(std::shared_ptr<const mapped_file> mapping,
+                  std::string_view data)
+      : _mapping{std::move(mapping)}, _data{data} {}
+
+  std::string_view data() const { return _data; }
+private:
+  std::shared_ptr<const mapped_file> _mapping;
+  std::string_view _data;
+};
+
+/// Persistent storage for JIT-compiled binaries in a single
+/// append-only pack file, with an index keyed by the binary id.
+///
+/// * Lookups return zero-copy views into the memory-mapped pack file.
+/// * Multiple processes may use the same archive concurrently;
+///   modifications of the pack and index files are serialized using
+///   a lock file.
+/// * When the index is flushed, least-recently-used binaries are evicted
+///   if the total size exceeds the configured limit, and the pack file
+///   is compacted if too much of it is occupied by evicted or
+///   superseded binaries.
+///
+/// This class is thread-safe.
+class jit_cache_archive {
+public:
+  using id_type = rt::kernel_configuration::id_type;
+
+  /// \param max_size Maximum total size of binaries in bytes. 0 means unlimited.
+  jit_cache_archive(const std::string &directory, std::size_t max_size);
+  ~jit_cache_archive();
+
+  jit_cache_archive(const jit_cache_archive&) = delete;
+  jit_cache_archive& operator=(const jit_cache_archive&) = delete;
+
+  /// Returns true if the binary was found. The integrity of binaries is
+  /// validated the first time they are looked up within a process.
+  bool lookup(const id_type &id, archived_binary &out);
+  /// Appends the binary to the archive. Returns true on success.
+  bool store(const id_type &id, std::string_view data);
+
+  /// Writes the index to disk, applies the eviction policy and compacts
+  /// the pack file if required. Invoked automatically on destruction.
+  void flush();
+
+  std::size_t get_num_entries() const;
+  /// Total size of all binaries that are referenced by the index.
+  std::size_t get_stored_bytes() const;
+
+  struct index_entry {
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    uint64_t hash = 0;
+    // Seconds since epoch
+    uint64_t last_used = 0;
+
+    template<class T>
+    void pack(T& pack) {
+      pack(offset);
+      pack(size);
+      pack(hash);
+      pack(last_used);
+    }
+  };
+
+  struct index_data {
+    // Must match the generation stored in the pack file header,
+    // otherwise the index refers to a different pack file.
+    uint64_t pack_generation = 0;
+    // The pack file size up to which the index is known to be complete.
+    uint64_t covered_pack_size = 0;
+    std::unordered_map<id_type, index_entry, rt::kernel_id_hash> entries;
+
+    template<class T>
+    void pack(T& pack) {
+      pack(pack_generation);
+      pack(covered_pack_size);
+      pack(entries);
+    }
+  };
+private:
+  // All functions below assume that _mutex is locked.
+
+  // Re-reads the pack file and the index from disk if they were
+  // modified by another process. Assumes that the archive lock file is held.
+  void refresh();
+  void reload();
+  void remap();
+  // Adds entries from records in the pack file in
+  // [_index.covered_pack_size, pack file end) to the index.
+  void scan_pack_tail();
+  bool write_index();
+  bool compact();
+  void evict_lru_entries();
+  std::size_t get_stored_bytes_impl() const;
+
+  uint64_t read_pack_generation() const;
+  bool initialize_pack_file();
+
+  std::string _pack_path;
+  std::string _index_path;
+  std::string _lock_path;
+  std::size_t _max_size;
+
+  index_data _index;
+  std::unordered_map<id_type, bool, rt::kernel_id_hash> _validated_entries;
+  std::shared_ptr<const mapped_file> _mapping;
+  bool _index_was_modified = false;
+
+  mutable std::mutex _mutex;
+};
+
+}
+}
+}
+
+#endif
@@ -28,22 +28,23 @@ namespace sbo{
         struct rebind{
             typedef small_buffer_vector_allocator<U, MaxSize, NonReboundT> other;
         };
-        //don't copy the small buffer for the copy/move constructors, as the copying is done through the vector
-        constexpr small_buffer_vector_allocator(const small_buffer_vector_allocator& other) noexcept : m_smallBufferUsed(other.m_smallBufferUsed) {}
-        constexpr small_buffer_vector_allocator& operator=(const small_buffer_vector_allocator& other) noexcept {  m_smallBufferUsed = other.m_smallBufferUsed; return *this; }
+        //don't copy the small buffer for the copy/move constructors, as the copying is done through the vector.
+        //The small buffer of the copy is not in use, regardless of the state of other.
+        constexpr small_buffer_vector_allocator(const small_buffer_vector_allocator&) noexcept {}
+        constexpr small_buffer_vector_allocator& operator=(const small_buffer_vector_allocator&) noexcept { return *this; }
         constexpr small_buffer_vector_allocator(small_buffer_vector_allocator&&) noexcept {}
         constexpr small_buffer_vector_allocator& operator=(const small_buffer_vector_allocator&&) noexcept { return *this; }
 
         [[nodiscard]] constexpr T* allocate(const size_t n) {
             //when the allocator was rebound we don't want to use the small buffer
             if constexpr (std::is_same_v<T, NonReboundT>) {
-                if (n <= MaxSize) {
+                //the small buffer might still hold the elements, e.g. when the vector grows from a capacity below MaxSize
+                if (n <= MaxSize && !m_smallBufferUsed) {
                     m_smallBufferUsed = true;
                     //as long as we use less memory than the small buffer, we return a pointer to it
                     return reinterpret_cast<T*>(&m_smallBuffer);
                 }
             }
-            m_smallBufferUsed = false;
             //otherwise use the default allocator
             return m_alloc.allocate(n);
         }
@@ -51,7 +52,8 @@ namespace sbo{
           // we don't deallocate anything if the memory was allocated in small buffer
           if (&m_smallBuffer != p) 
               m_alloc.deallocate(static_cast<T*>(p), n);
-          m_smallBufferUsed = false;
+          else
+              m_smallBufferUsed = false;
         }
         //according to the C++ standard when propagate_on_container_move_assignment is set to false, the comparision operators are used 
         //to check if two allocators are equal. When they are not, an element wise move is done instead of just taking over the memory. 
@@ -70,7 +72,8 @@ namespace sbo{
         using vectorT = std::vector<T, small_buffer_vector_allocator<T, N>>;
         //default initialize with the small buffer size
         constexpr small_vector() noexcept { vectorT::reserve(N); }
-        small_vector(const small_vector&) = default;
+        //reserve first, so that copies also use the small buffer
+        small_vector(const small_vector& other) : small_vector() { vectorT::operator=(other); }
         small_vector& operator=(const small_vector&) = default;
         small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
             if (other.size() <= N)
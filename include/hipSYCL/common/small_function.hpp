@@ -0,0 +1,170 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+#ifndef HIPSYCL_COMMON_SMALL_FUNCTION_HPP
+#define HIPSYCL_COMMON_SMALL_FUNCTION_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace hipsycl {
+namespace common {
+
+/// Allocates callables of small_function that cannot be stored inline
+struct default_function_allocation {
+  static void* allocate(std::size_t size) {
+    return ::operator new(size);
+  }
+
+  static void deallocate(void* ptr, std::size_t size) noexcept {
+    ::operator delete(ptr);
+  }
+};
+
+template <class Signature, std::size_t InlineSize = 48,
+          class Allocation = default_function_allocation>
+class small_function;
+
+/// A move-only replacement for std::function. Callables that fit into
+/// InlineSize bytes and are nothrow move constructible are stored
+/// without heap allocation. Other callables are allocated with
+/// Allocation, which must not be used for over-aligned callables.
+template <class R, class... Args, std::size_t InlineSize, class Allocation>
+class small_function<R(Args...), InlineSize, Allocation> {
+public:
+  small_function() noexcept = default;
+  small_function(std::nullptr_t) noexcept {}
+
+  template <class F, std::enable_if_t<
+                         !std::is_same_v<std::decay_t<F>, small_function> &&
+                             std::is_invocable_r_v<R, std::decay_t<F> &, Args...>,
+                         int> = 0>
+  small_function(F&& f) {
+    using callable = std::decay_t<F>;
+    if constexpr (is_stored_inline<callable>()) {
+      new (&_storage) callable(std::forward<F>(f));
+    } else {
+      static_assert(alignof(callable) <= alignof(std::max_align_t),
+                    "Over-aligned callables are not supported");
+      void* mem = Allocation::allocate(sizeof(callable));
+      try {
+        new (&_storage) callable*(new (mem) callable(std::forward<F>(f)));
+      } catch(...) {
+        Allocation::deallocate(mem, sizeof(callable));
+        throw;
+      }
+    }
+    _vtable = &vtable_for<callable>;
+  }
+
+  small_function(small_function&& other) noexcept {
+    move_from(other);
+  }
+
+  small_function& operator=(small_function&& other) noexcept {
+    if(this != &other) {
+      reset();
+      move_from(other);
+    }
+    return *this;
+  }
+
+  small_function(const small_function&) = delete;
+  small_function& operator=(const small_function&) = delete;
+
+  ~small_function() {
+    reset();
+  }
+
+  explicit operator bool() const noexcept {
+    return _vtable != nullptr;
+  }
+
+  R operator()(Args... args) {
+    return _vtable->invoke(&_storage, std::forward<Args>(args)...);
+  }
+
+  void reset() noexcept {
+    if(_vtable) {
+      _vtable->destroy(&_storage);
+      _vtable = nullptr;
+    }
+  }
+private:
+  using storage_type =
+      std::aligned_storage_t<(InlineSize < sizeof(void *) ? sizeof(void *)
+                                                          : InlineSize),
+                             alignof(std::max_align_t)>;
+
+  template<class F>
+  static constexpr bool is_stored_inline() {
+    return sizeof(F) <= sizeof(storage_type) &&
+           alignof(F) <= alignof(storage_type) &&
+           std::is_nothrow_move_constructible_v<F>;
+  }
+
+  template<class F>
+  static F* get(void* storage) noexcept {
+    if constexpr(is_stored_inline<F>())
+      return std::launder(reinterpret_cast<F*>(storage));
+    else
+      return *std::launder(reinterpret_cast<F**>(storage));
+  }
+
+  struct vtable {
+    R (*invoke)(void*, Args&&...);
+    // Move-constructs into dest and destroys the source
+    void (*relocate)(void* dest, void* src) noexcept;
+    void (*destroy)(void*) noexcept;
+  };
+
+  template<class F>
+  static constexpr vtable vtable_for = {
+    [](void* storage, Args&&... args) -> R {
+      return (*get<F>(storage))(std::forward<Args>(args)...);
+    },
+    [](void* dest, void* src) noexcept {
+      if constexpr(is_stored_inline<F>()) {
+        F* source = get<F>(src);
+        new (dest) F(std::move(*source));
+        source->~F();
+      } else {
+        new (dest) F*(get<F>(src));
+      }
+    },
+    [](void* storage) noexcept {
+      if constexpr(is_stored_inline<F>())
+        get<F>(storage)->~F();
+      else {
+        F* f = get<F>(storage);
+        f->~F();
+        Allocation::deallocate(f, sizeof(F));
+      }
+    }
+  };
+
+  void move_from(small_function& other) noexcept {
+    if(other._vtable) {
+      other._vtable->relocate(&_storage, &other._storage);
+      _vtable = other._vtable;
+      other._vtable = nullptr;
+    }
+  }
+
+  storage_type _storage;
+  const vtable* _vtable = nullptr;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+#ifndef HIPSYCL_WORKITEMLOOPVECTORIZER_HPP
+#define HIPSYCL_WORKITEMLOOPVECTORIZER_HPP
+
+#include "llvm/IR/PassManager.h"
+#include "llvm/Pass.h"
+
+namespace hipsycl {
+namespace compiler {
+
+// Explicitly vectorizes the innermost wi-loops across work items, driven by the
+// uniformity analysis: uniform values stay scalar, divergent control flow is
+// if-converted using block masks and memory accesses become (masked) vector loads,
+// stores, gathers or scatters depending on the vector shape of their address.
+// The original wi-loop remains as remainder loop and is used for loops that cannot
+// be vectorized. Results are reported as optimization remarks (acpp-wi-loop-vectorize).
+//
+// A VectorWidth of 0 derives the width from the target's vector register size.
+class WorkItemLoopVectorizerPassLegacy : public llvm::FunctionPass {
+  unsigned VectorWidth_;
+
+public:
+  static char ID;
+
+  explicit WorkItemLoopVectorizerPassLegacy(unsigned VectorWidth = 0)
+      : llvm::FunctionPass(ID), VectorWidth_(VectorWidth) {}
+
+  llvm::StringRef getPassName() const override { return "hipSYCL wi-loop vectorization pass"; }
+
+  void getAnalysisUsage(llvm::AnalysisUsage &AU) const override;
+
+  bool runOnFunction(llvm::Function &F) override;
+};
+
+class WorkItemLoopVectorizerPass : public llvm::PassInfoMixin<WorkItemLoopVectorizerPass> {
+  unsigned VectorWidth_;
+
+public:
+  explicit WorkItemLoopVectorizerPass(unsigned VectorWidth = 0) : VectorWidth_(VectorWidth) {}
+
+  llvm::PreservedAnalyses run(llvm::Function &F, llvm::FunctionAnalysisManager &AM);
+  static bool isRequired() { return false; }
+};
+} // namespace compiler
+} // namespace hipsycl
+
+#endif // HIPSYCL_WORKITEMLOOPVECTORIZER_HPP
@@ -0,0 +1,52 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+#ifndef HIPSYCL_HOST_OBJECT_LOADER_HPP
+#define HIPSYCL_HOST_OBJECT_LOADER_HPP
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Note: This header is included by the runtime and must not
+// depend on LLVM headers.
+
+namespace hipsycl {
+namespace compiler {
+
+/// Returns whether the given binary is a relocatable object file
+/// (as opposed to e.g. a shared library) for the host.
+bool isRelocatableHostObject(std::string_view Binary);
+
+/// Links a relocatable object file as generated by LLVMToHostTranslator
+/// into the running process in memory, without going through the
+/// file system and the dynamic loader.
+/// Symbols are unloaded when the HostObjectLoader is destroyed.
+class HostObjectLoader {
+public:
+  HostObjectLoader();
+  ~HostObjectLoader();
+
+  HostObjectLoader(const HostObjectLoader &) = delete;
+  HostObjectLoader &operator=(const HostObjectLoader &) = delete;
+
+  bool load(std::string_view Object, std::string &ErrorMessage);
+  /// Returns nullptr if the symbol cannot be found.
+  void *getSymbol(const std::string &Name) const;
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> I;
+};
+
+}
+}
+
+#endif
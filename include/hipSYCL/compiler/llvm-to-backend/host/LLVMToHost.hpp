@@ -30,12 +30,21 @@ public:
   virtual bool toBackendFlavor(llvm::Module &M, PassHandler& PH) override;
   virtual bool translateToBackendFormat(llvm::Module &FlavoredModule, std::string &out) override;
 protected:
+  virtual bool applyBuildFlag(const std::string &Flag) override;
   virtual bool applyBuildOption(const std::string &Option, const std::string &Value) override;
   virtual bool isKernelAfterFlavoring(llvm::Function& F) override;
   virtual AddressSpaceMap getAddressSpaceMap() const override;
   virtual void migrateKernelProperties(llvm::Function* From, llvm::Function* To) override;
 private:
+  // Generates a relocatable object file in-process
+  bool emitObjectFile(llvm::Module &FlavoredModule, std::string &out);
+  // Generates a shared library by invoking clang
+  bool compileWithExternalCompiler(llvm::Module &FlavoredModule, std::string &out);
+
   std::vector<std::string> KernelNames;
+  bool UseExternalCompiler = false;
+  // 0 means that the sub-group size is chosen based on the SIMD width
+  int SubGroupSize = 1;
 };
 
 }
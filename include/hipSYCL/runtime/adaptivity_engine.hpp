@@ -38,7 +38,28 @@ public:
   finalize_binary_configuration(kernel_configuration &config);
 
   std::string select_image_and_kernels(std::vector<std::string>* kernel_names_out);
+
+  int get_adaptivity_level() const;
+
+  /// Like finalize_binary_configuration(), but applies the optimizations
+  /// of the given (typically lower) adaptivity level. This can be used to
+  /// obtain less specialized fallback variants of a kernel. Unlike
+  /// finalize_binary_configuration(), this does not update kernel argument
+  /// statistics in the appdb.
+  kernel_configuration::id_type
+  finalize_fallback_binary_configuration(kernel_configuration &config,
+                                         int adaptivity_level);
+
+  /// Selects image and kernels as they would be selected at the given
+  /// adaptivity level.
+  std::string select_image_and_kernels(std::vector<std::string> *kernel_names_out,
+                                       int adaptivity_level);
 private:
+  kernel_configuration::id_type
+  finalize_binary_configuration(kernel_configuration &config,
+                                int adaptivity_level,
+                                bool update_statistics);
+
   hcf_object_id _hcf;
   std::string_view _kernel_name;
   const hcf_kernel_info* _kernel_info;
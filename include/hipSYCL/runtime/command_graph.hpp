@@ -0,0 +1,143 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+#ifndef HIPSYCL_COMMAND_GRAPH_HPP
+#define HIPSYCL_COMMAND_GRAPH_HPP
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "dag_node.hpp"
+#include "hints.hpp"
+#include "operations.hpp"
+#include "hipSYCL/common/small_vector.hpp"
+
+namespace hipsycl {
+namespace rt {
+
+class runtime;
+
+/// A sequence of operations that is recorded once and can then be
+/// submitted repeatedly. Dependencies between recorded operations are
+/// resolved at recording time and stored as indices, so replaying
+/// only needs to create and submit the nodes.
+///
+/// Recorded operations are shared between all replays. To prevent
+/// an operation from being executed concurrently with itself, every
+/// replayed node depends on its counterpart from the previous replay.
+///
+/// Thread safety: Safe
+class command_graph
+{
+public:
+  using index_list_t = common::small_vector<std::size_t, 4>;
+
+  struct entry {
+    std::shared_ptr<operation> op;
+    execution_hints hints;
+    // Indices of recorded entries that this entry depends on
+    index_list_t internal_dependencies;
+    // Nodes that were submitted outside of the graph before
+    // recording and that this entry depends on
+    node_list_t external_dependencies;
+  };
+
+  command_graph() = default;
+
+  /// Starts a new recording, discarding any previously recorded operations.
+  /// If \c is_in_order is set, every recorded operation additionally
+  /// depends on the operation recorded before it.
+  void begin_recording(bool is_in_order, std::size_t node_group);
+  /// Finishes the recording.
+  void end_recording();
+  bool is_recording() const;
+
+  /// Records an operation and returns a placeholder node representing it.
+  /// The placeholder can be used to express dependencies between recorded
+  /// operations, but it is never submitted and must not be waited on.
+  dag_node_ptr record(std::shared_ptr<operation> op,
+                      const execution_hints &hints,
+                      const node_list_t &requirements, runtime *rt);
+
+  /// Replaces the operation of the entry with the given index,
+  /// retaining its dependencies. Replays that are already in flight
+  /// keep using the previous operation.
+  void update(std::size_t index, std::shared_ptr<operation> op);
+
+  std::shared_ptr<operation> get_operation(std::size_t index) const;
+
+  std::size_t size() const;
+  std::size_t get_node_group() const;
+  bool is_in_order() const;
+
+  /// Submits all recorded entries in recording order.
+  /// \c submit is invoked as submit(op, hints, requirements) and must return
+  /// the node that was created for the operation. \c initial_requirements
+  /// are added to all entries without internal dependencies.
+  /// \return a node that completes after all submitted nodes. If multiple
+  /// entries have no dependent entries, this is a virtual node joining them.
+  template <class SubmissionHandler>
+  dag_node_ptr replay(const node_list_t &initial_requirements, runtime *rt,
+                      SubmissionHandler &&submit) {
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    std::vector<dag_node_ptr> nodes;
+    nodes.reserve(_entries.size());
+
+    for(std::size_t i = 0; i < _entries.size(); ++i) {
+      const entry& e = _entries[i];
+
+      node_list_t reqs = e.external_dependencies;
+      for(std::size_t dep : e.internal_dependencies)
+        reqs.push_back(nodes[dep]);
+      if(e.internal_dependencies.empty()) {
+        for(const auto& req : initial_requirements)
+          reqs.push_back(req);
+      }
+      // In-order graphs are already ordered with respect to
+      // the previous replay.
+      if(!_is_in_order && i < _previous_replay.size())
+        reqs.push_back(_previous_replay[i]);
+
+      nodes.push_back(submit(e.op, e.hints, reqs));
+    }
+
+    if(!_is_in_order)
+      _previous_replay = nodes;
+
+    return join_sinks(nodes, rt);
+  }
+
+private:
+  dag_node_ptr join_sinks(const std::vector<dag_node_ptr> &nodes, runtime *rt);
+
+  std::vector<entry> _entries;
+  // Only used during recording to map placeholders to entries
+  std::vector<dag_node_ptr> _placeholders;
+  std::unordered_map<const dag_node*, std::size_t> _placeholder_indices;
+
+  std::vector<dag_node_ptr> _previous_replay;
+  // Indices of entries that no entry depends on
+  index_list_t _sinks;
+
+  bool _is_recording = false;
+  bool _is_in_order = false;
+  std::size_t _node_group = 0;
+
+  mutable std::mutex _mutex;
+};
+
+}
+}
+
+#endif
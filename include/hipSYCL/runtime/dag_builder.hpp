@@ -37,7 +37,7 @@ class dag_builder
 public:
   dag_builder(runtime* rt);
 
-  dag_node_ptr add_command_group(std::unique_ptr<operation> op,
+  dag_node_ptr add_command_group(std::shared_ptr<operation> op,
                                 const requirements_list& requirements,
                                 const execution_hints& hints = {});
 
@@ -53,7 +53,7 @@ private:
   bool is_conflicting_access(const memory_requirement *mem_req,
                              const data_user &user) const;
 
-  dag_node_ptr build_node(std::unique_ptr<operation> op,
+  dag_node_ptr build_node(std::shared_ptr<operation> op,
                           const requirements_list &requirements,
                           const execution_hints &hints);
   
@@ -12,15 +12,40 @@
 #define HIPSYCL_DAG_DIRECT_SCHEDULER_HPP
 
 #include "dag_node.hpp"
+#include "data.hpp"
+#include "device_id.hpp"
 #include "operations.hpp"
+#include "hipSYCL/common/small_vector.hpp"
 
 #include <functional>
+#include <vector>
 
 namespace hipsycl {
 namespace rt {
 
 class runtime;
 
+/// An outdated region together with the devices that hold valid data
+/// for all of it.
+struct update_region {
+  range_store::rect rect;
+  common::small_vector<device_id, 4> sources;
+};
+
+/// Merges regions that are adjacent in one dimension, have the same offset
+/// and extent in the other dimensions, and share at least one update source,
+/// such that each merged region can still be updated from a single device.
+/// Regions are merged in one sweep per dimension over the regions sorted
+/// along this dimension, which merges chains of adjacent regions without
+/// repeated pairwise scans.
+void coalesce_regions(std::vector<update_region> &regions);
+
+/// Splits the region into at most num_chunks parts along its slowest
+/// dimension with more than one element, such that the parts
+/// are contiguous in memory if the region is.
+void split_region(const range_store::rect &region, std::size_t num_chunks,
+                  std::vector<range_store::rect> &out);
+
 class dag_direct_scheduler {
 public:
   dag_direct_scheduler(runtime* rt);
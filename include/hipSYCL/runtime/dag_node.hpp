@@ -13,6 +13,7 @@
 
 #include <memory>
 #include <atomic>
+#include <cstdint>
 
 #include "hints.hpp"
 #include "event.hpp"
@@ -37,9 +38,12 @@ using weak_node_list_t = common::small_vector<std::weak_ptr<dag_node>, 8>;
 class dag_node
 {
 public:
+  /// The operation may be shared with other nodes, e.g. when
+  /// a recorded command_graph is replayed. Nodes sharing an operation
+  /// must not execute concurrently.
   dag_node(const execution_hints& hints,
           const node_list_t& requirements,
-          std::unique_ptr<operation> op,
+          std::shared_ptr<operation> op,
           runtime* rt);
 
   ~dag_node();
@@ -114,6 +118,9 @@ public:
   }
 
   runtime* get_runtime() const;
+
+  /// Id of the node in runtime traces, 0 if tracing is disabled.
+  std::uint64_t get_trace_id() const;
 private:
   execution_hints _hints;
   weak_node_list_t _requirements;
@@ -124,7 +131,7 @@ private:
   std::size_t _assigned_execution_index;
 
   std::shared_ptr<dag_node_event> _event;
-  std::unique_ptr<operation> _operation;
+  std::shared_ptr<operation> _operation;
   /// This is a temporary solution to access operations
   /// executed for requirements; we should move to an
   /// API consisting of subnodes to properly handle
@@ -137,7 +144,7 @@ private:
   std::atomic<bool> _is_cancelled;
 
   runtime* _rt;
-
+  std::uint64_t _trace_id;
 };
 
 }
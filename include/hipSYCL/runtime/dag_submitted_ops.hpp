@@ -11,7 +11,10 @@
 #ifndef HIPSYCL_DAG_SUBMITTED_OPS_HPP
 #define HIPSYCL_DAG_SUBMITTED_OPS_HPP
 
+#include <deque>
+#include <limits>
 #include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #include "dag_node.hpp"
@@ -21,7 +24,13 @@
 namespace hipsycl {
 namespace rt {
 
-
+/// Tracks submitted nodes until they have completed.
+///
+/// Nodes are kept in one list per node group (i.e. typically per queue)
+/// in submission order. Since nodes of a group tend to complete
+/// in submission order, completed nodes are retired incrementally from
+/// the front of each list, and operations on one node group
+/// do not need to touch the nodes of other groups.
 class dag_submitted_ops
 {
 public:
@@ -40,10 +49,35 @@ public:
 
   ~dag_submitted_ops();
 private:
+  struct submitted_node {
+    dag_node_ptr node;
+    // Position of the node in the global submission order
+    std::size_t submission_index;
+  };
+  using node_fifo = std::deque<submitted_node>;
+
+  // Assumes that _lock is locked. Returns nullptr if the node group
+  // has no submitted nodes.
+  node_fifo *get_fifo(std::size_t node_group);
+  const node_fifo *get_fifo(std::size_t node_group) const;
+  // Assumes that _lock is locked. Retires nodes from the front of the
+  // node group's fifo as long as they are known to have completed. In addition,
+  // the completion of up to poll_limit nodes is queried from the backend.
+  void retire_completed(std::size_t node_group, std::size_t poll_limit);
+  // Waits for all nodes of the group that have been submitted so far
+  // and retires them.
+  void wait_and_retire(std::size_t node_group);
   void purge_known_completed();
-  void copy_node_list(std::vector<dag_node_ptr>& out) const;
+  void get_group_ids(std::vector<std::size_t> &out) const;
+
+  // Returns ungrouped_node_group for nodes without node_group hint
+  static std::size_t get_node_group(const dag_node_ptr &node);
+  static constexpr std::size_t ungrouped_node_group =
+      std::numeric_limits<std::size_t>::max();
 
-  std::vector<dag_node_ptr> _ops;
+  std::unordered_map<std::size_t, node_fifo> _groups;
+  std::size_t _num_nodes = 0;
+  std::size_t _num_submitted_nodes = 0;
   mutable std::mutex _lock;
   worker_thread _updater_thread;
 };
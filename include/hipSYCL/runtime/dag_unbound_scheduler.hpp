@@ -11,21 +11,66 @@
 #ifndef HIPSYCL_DAG_UNBOUND_SCHEDULER_HPP
 #define HIPSYCL_DAG_UNBOUND_SCHEDULER_HPP
 
+#include <deque>
+#include <utility>
+#include <vector>
+
 #include "dag_node.hpp"
 #include "dag_direct_scheduler.hpp"
+#include "hw_model/cost.hpp"
 
 namespace hipsycl {
 namespace rt {
 
 class runtime;
 
+/// Assigns nodes without bind_to_device hint to devices and then submits
+/// them using the direct scheduler.
+///
+/// Devices are selected with an online earliest-finish-time list scheduling
+/// heuristic: For each eligible device, the scheduler estimates when the
+/// node would complete, taking into account
+/// * the estimated remaining work of nodes previously assigned to the device,
+/// * the cost of transferring buffer data that is not yet valid on the device,
+///   based on the memcpy model of the hardware model.
+/// The node is assigned to the device with the earliest estimated
+/// completion.
 class dag_unbound_scheduler {
 public:
   dag_unbound_scheduler(runtime* rt);
 
   void submit(dag_node_ptr node);
+
+  /// Returns the device from eligible_devices on which node is estimated
+  /// to finish earliest.
+  device_id select_device(const dag_node_ptr &node,
+                          const std::vector<device_id> &eligible_devices);
 private:
+  // Estimated cost of making all buffer data that node requires
+  // available on dev
+  cost_type estimate_data_transfer_cost(const dag_node_ptr &node,
+                                        device_id dev) const;
+  // Estimated cost of executing the node's operation itself
+  cost_type estimate_execution_cost(const dag_node_ptr &node,
+                                    device_id dev) const;
+  // Estimated remaining work of nodes assigned to dev
+  cost_type get_backlog(device_id dev) const;
+  // Removes completed nodes from the front of each backlog. Since nodes
+  // assigned to a device tend to complete in assignment order, only the
+  // completion of the oldest nodes is queried.
+  void remove_completed_from_backlog();
+
+  struct device_backlog {
+    device_id dev;
+    // Assigned nodes that have not yet completed in assignment order,
+    // with their estimated cost
+    std::deque<std::pair<dag_node_ptr, cost_type>> nodes;
+    // Sum of the estimated costs of nodes
+    cost_type total_cost = 0.0;
+  };
+
   std::vector<device_id> _devices;
+  std::vector<device_backlog> _backlogs;
   rt::dag_direct_scheduler _direct_scheduler;
   runtime* _rt;
 };
@@ -39,7 +39,20 @@ public:
     available,
   };
 
-  range_store(range<3> size);
+  enum class representation
+  {
+    /// One byte per page. Operations visit each page individually.
+    dense,
+    /// One bit per page. Operations process rows of pages
+    /// (along the fastest dimension) a machine word at a time,
+    /// which is much faster for large page tables.
+    bitmap
+  };
+
+  range_store(range<3> size, representation r = representation::dense);
+
+  representation get_representation() const
+  { return _representation; }
 
   void add(const rect& r);
   
@@ -68,6 +81,17 @@ public:
   { return entire_range_equals(r, data_state::empty); }
 
 private:
+  // Implementation of the bitmap representation
+  void bitmap_fill(const rect& r, bool value);
+  bool bitmap_entire_range_equals(const rect& r, bool value) const;
+  void bitmap_intersections_with(const rect& r, bool value,
+                                 std::vector<rect>& out) const;
+
+  std::size_t get_row_offset(std::size_t x, std::size_t y) const
+  {
+    return (x * _size[1] + y) * _words_per_row;
+  }
+
   template<class Entry_selection_predicate>
   range<3> find_max_contiguous_rect_extent(
     id<3> begin,
@@ -192,7 +216,11 @@ private:
   }
 
   range<3> _size;
+  representation _representation;
   std::vector<data_state> _contained_data;
+
+  std::size_t _words_per_row;
+  std::vector<uint64_t> _bits;
 };
 
 
@@ -387,10 +415,15 @@ public:
   /// dimension must be a multiple of the page size
   /// \param page_size The size (numbers of elements) of the granularity of data
   /// management
-  data_region(
-      range<3> num_elements, std::size_t element_size, range<3> page_size)
+  /// \param page_table_representation How the page tables of allocations
+  /// are stored. The bitmap representation is faster for large page tables.
+  data_region(range<3> num_elements, std::size_t element_size,
+              range<3> page_size,
+              range_store::representation page_table_representation =
+                  range_store::representation::dense)
       : _element_size{element_size}, _page_size{page_size},
-        _num_elements{num_elements} {
+        _num_elements{num_elements},
+        _page_table_representation{page_table_representation} {
 
     for(std::size_t i = 0; i < 3; ++i){
       assert(page_size[i] > 0);
@@ -571,6 +604,21 @@ public:
               const device_id& d,
               const range_store::rect& data_range,
               std::vector<std::pair<device_id, range_store::rect>>& update_sources) const
+  {
+    find_update_source_candidates(d, data_range, update_sources);
+    if(update_sources.empty()){
+      assert(false && "Could not find valid data source for updating data buffer - "
+              "this can happen if several data transfers are required to update accessed range, "
+              "which is not yet supported.");
+    }
+  }
+
+  /// Like get_update_source_candidates(), but an empty result is
+  /// not considered an error.
+  void find_update_source_candidates(
+              const device_id& d,
+              const range_store::rect& data_range,
+              std::vector<std::pair<device_id, range_store::rect>>& update_sources) const
   {
     update_sources.clear();
 
@@ -586,11 +634,6 @@ public:
       }
       return true;
     });
-    if(update_sources.empty()){
-      assert(false && "Could not find valid data source for updating data buffer - "
-              "this can happen if several data transfers are required to update accessed range, "
-              "which is not yet supported.");
-    }
   }
 
   data_user_tracker& get_users()
@@ -603,6 +646,33 @@ public:
 
   range<3> get_num_elements() const { return _num_elements; }
 
+  range<3> get_page_size() const { return _page_size; }
+
+  /// Splits the given range of elements into the parts that
+  /// belong to different pages.
+  void split_into_pages(const range_store::rect &data_range,
+                        std::vector<range_store::rect> &out) const {
+    page_range pr = get_page_range(data_range.first, data_range.second);
+    for (std::size_t i = 0; i < pr.second[0]; ++i) {
+      for (std::size_t j = 0; j < pr.second[1]; ++j) {
+        for (std::size_t k = 0; k < pr.second[2]; ++k) {
+          id<3> page{pr.first[0] + i, pr.first[1] + j, pr.first[2] + k};
+          range_store::rect part;
+          for (int dim = 0; dim < 3; ++dim) {
+            std::size_t begin =
+                std::max(data_range.first[dim], page[dim] * _page_size[dim]);
+            std::size_t end = std::min(
+                {data_range.first[dim] + data_range.second[dim],
+                 (page[dim] + 1) * _page_size[dim], _num_elements[dim]});
+            part.first[dim] = begin;
+            part.second[dim] = end - begin;
+          }
+          out.push_back(part);
+        }
+      }
+    }
+  }
+
   Memory_descriptor get_memory(device_id dev) const
   {
     assert(has_allocation(dev));
@@ -693,7 +763,7 @@ private:
     assert(!has_allocation(d));
 
     data_allocation<Memory_descriptor> new_alloc{
-        d, memory_context, range_store{_num_pages}, takes_ownership, allocator};
+        d, memory_context, range_store{_num_pages, _page_table_representation}, takes_ownership, allocator};
 
     if constexpr(InitialState == initial_data_state::invalid) {
       new_alloc.invalid_pages.add(std::make_pair(id<3>{0, 0, 0}, _num_pages));
@@ -714,6 +784,7 @@ private:
   range<3> _page_size;
   range<3> _num_pages;
   range<3> _num_elements;
+  range_store::representation _page_table_representation;
 
   data_user_tracker _user_tracker;
 };
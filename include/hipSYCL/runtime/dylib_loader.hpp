@@ -24,6 +24,14 @@ namespace hipsycl {
 namespace rt {
 namespace detail {
 void *load_library(const std::string &filename, std::string_view loader);
+// Loads a shared library from an in-memory image without creating a file
+// in the file system. Returns nullptr if unsupported on this platform.
+// image_fd receives a descriptor that must remain open as long as the
+// library is loaded; release it with close_library_image() after
+// close_library().
+void *load_library_from_memory(std::string_view image, std::string_view loader,
+                               int &image_fd);
+void close_library_image(int image_fd);
 void *get_symbol_from_library(void *handle, const std::string &symbolName, std::string_view loader);
 void close_library(void *handle, std::string_view loader);
 
@@ -15,18 +15,35 @@
 #include <atomic>
 #include <condition_variable>
 #include <mutex>
-#include <functional>
-#include <queue>
+#include <memory>
+#include <deque>
 
+#include "hipSYCL/common/small_function.hpp"
+#include "object_pool.hpp"
 
 namespace hipsycl {
 namespace rt {
 
 /// A worker thread that processes a queue in the background.
+///
+/// Operations are enqueued into a bounded lock-free multi-producer/
+/// single-consumer ring buffer. If the ring is full, operations are
+/// enqueued into an overflow queue instead, so submission never blocks.
+/// Operations from the same submitting thread are executed in submission
+/// order. When idle, the worker thread spins for an adaptively chosen
+/// time before parking, such that fine-grained operations submitted in quick
+/// succession do not pay for wakeups.
 class worker_thread
 {
 public:
-  using async_function = std::function<void ()>;
+  /// Callables that do not fit into the ring cells are allocated
+  /// from the object pool.
+  using async_function =
+      common::small_function<void(), 48, object_pool_function_allocation>;
+
+  /// Number of operations that can be enqueued without
+  /// falling back to the overflow queue. Must be a power of two.
+  static constexpr std::size_t ring_capacity = 1024;
 
   /// Construct object
   worker_thread();
@@ -44,7 +61,8 @@ public:
   /// \param f The function to enqueue for execution
   void operator()(async_function f);
 
-  /// \return The number of enqueued operations
+  /// \return The number of enqueued operations, including
+  /// the operation that is currently executing.
   std::size_t queue_size() const;
 
   /// Stop the worker thread
@@ -56,14 +74,43 @@ private:
   /// supplied.
   void work();
 
-  std::thread _worker_thread;
+  // Producer side of the ring. Returns false if the ring is full.
+  bool try_push(async_function& f);
+  // Consumer side of the ring. Returns false if the next operation
+  // is not yet available.
+  bool try_pop(async_function& out);
+  bool has_pending_operations() const;
+  // Spins for up to max_iterations while predicate is false. Returns
+  // true if predicate became true.
+  template<class Predicate>
+  bool spin_until(Predicate p, int max_iterations) const;
+
+  struct alignas(64) cell {
+    std::atomic<std::size_t> sequence;
+    async_function operation;
+  };
+
+  std::unique_ptr<cell[]> _cells;
+  alignas(64) std::atomic<std::size_t> _enqueue_pos;
+  // Only accessed by the worker thread
+  alignas(64) std::size_t _dequeue_pos;
+  int _spin_budget;
+
+  alignas(64) std::atomic<std::size_t> _num_submitted;
+  alignas(64) std::atomic<std::size_t> _num_completed;
+
+  std::atomic<std::size_t> _num_overflow_operations;
+  std::mutex _overflow_mutex;
+  std::deque<async_function> _overflow_operations;
 
   std::atomic<bool> _continue;
+  std::atomic<bool> _is_worker_parked;
+  std::atomic<int> _num_parked_waiters;
+  mutable std::mutex _park_mutex;
+  std::condition_variable _worker_wakeup;
+  std::condition_variable _waiter_wakeup;
 
-  std::condition_variable _condition_wait;
-  mutable std::mutex _mutex;
-
-  std::queue<async_function> _enqueued_operations;
+  std::thread _worker_thread;
 };
 
 }
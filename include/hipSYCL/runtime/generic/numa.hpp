@@ -0,0 +1,57 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+#ifndef HIPSYCL_NUMA_HPP
+#define HIPSYCL_NUMA_HPP
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace hipsycl {
+namespace rt {
+namespace numa {
+
+struct cpu_info {
+  int cpu;
+  int numa_node;
+};
+
+/// \return The CPUs in the process affinity mask, sorted by NUMA node.
+/// The topology is determined on first use. Returns an empty vector if the
+/// topology cannot be determined or consists of a single NUMA node.
+const std::vector<cpu_info>& get_topology();
+
+/// \return The NUMA nodes with CPUs in the process affinity mask, in
+/// ascending order. Empty if get_topology() is empty.
+std::vector<int> get_nodes();
+
+/// \return The number of CPUs of the given node in the process affinity mask
+std::size_t get_num_cpus(int node);
+
+/// Restricts the thread to the CPUs of the given NUMA node.
+/// \return Whether the affinity could be set.
+bool bind_thread(std::thread &t, int node);
+bool bind_current_thread(int node);
+
+/// Interleaves the pages of the given memory range across the given NUMA
+/// nodes. ptr must be aligned to the page size. Only affects pages
+/// that have not been touched yet.
+/// \return Whether the memory policy could be set.
+bool interleave_memory(void *ptr, std::size_t num_bytes,
+                       const std::vector<int> &nodes);
+
+std::size_t get_page_size();
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,138 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+#ifndef HIPSYCL_OBJECT_POOL_HPP
+#define HIPSYCL_OBJECT_POOL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace hipsycl {
+namespace rt {
+
+/// Thread-caching slab allocator for the small objects that the runtime
+/// creates for each submission, such as DAG nodes, operations and events.
+///
+/// Objects are rounded up to size classes that are multiples of the cache
+/// line size. Each thread keeps a free list per size class, so allocation
+/// and deallocation usually do not synchronize with other threads. Freed
+/// objects go to the free list of the freeing thread. If it grows too large,
+/// a batch of objects is moved to a global free list, from which threads
+/// refill their free lists before carving new objects from slabs.
+/// This balances objects that are allocated in one thread and freed in
+/// another, e.g. DAG nodes that are created by the submitting thread and
+/// released once dag_submitted_ops has retired them.
+///
+/// Slabs are never returned to the system, so memory usage is bounded by
+/// the peak number of live objects. Larger objects are allocated with
+/// the global aligned operator new, so all objects are aligned to
+/// object_pool::alignment.
+class object_pool {
+public:
+  static constexpr std::size_t max_object_size = 1024;
+  static constexpr std::size_t alignment = 64;
+
+  static void *allocate(std::size_t size);
+  /// \param size Must be the size that was passed to allocate()
+  static void deallocate(void *ptr, std::size_t size) noexcept;
+};
+
+/// Allocator for standard library facilities such as std::allocate_shared
+template<class T>
+class object_pool_allocator {
+public:
+  using value_type = T;
+
+  object_pool_allocator() noexcept = default;
+  template<class U>
+  object_pool_allocator(const object_pool_allocator<U>&) noexcept {}
+
+  T* allocate(std::size_t n) {
+    if constexpr(alignof(T) > object_pool::alignment)
+      return static_cast<T *>(::operator new(n * sizeof(T),
+                                             std::align_val_t{alignof(T)}));
+    else
+      return static_cast<T *>(object_pool::allocate(n * sizeof(T)));
+  }
+
+  void deallocate(T* ptr, std::size_t n) noexcept {
+    if constexpr(alignof(T) > object_pool::alignment)
+      ::operator delete(ptr, std::align_val_t{alignof(T)});
+    else
+      object_pool::deallocate(ptr, n * sizeof(T));
+  }
+
+  template<class U>
+  bool operator==(const object_pool_allocator<U>&) const noexcept {
+    return true;
+  }
+
+  template<class U>
+  bool operator!=(const object_pool_allocator<U>&) const noexcept {
+    return false;
+  }
+};
+
+/// Like std::make_shared, but allocates the object and its control block
+/// from the object pool.
+template<class T, class... Args>
+std::shared_ptr<T> make_pooled_shared(Args&&... args) {
+  return std::allocate_shared<T>(object_pool_allocator<T>{},
+                                 std::forward<Args>(args)...);
+}
+
+/// Base class for polymorphic classes whose instances created with new
+/// should be allocated from the object pool. Relies on sized deallocation,
+/// so classes deriving from it must have a virtual destructor. Instances
+/// of classes that require an alignment larger than object_pool::alignment
+/// are allocated with the global aligned operator new instead.
+class pooled_object {
+public:
+  static void* operator new(std::size_t size) {
+    return object_pool::allocate(size);
+  }
+
+  static void* operator new(std::size_t size, std::align_val_t alignment) {
+    if(static_cast<std::size_t>(alignment) > object_pool::alignment)
+      return ::operator new(size, alignment);
+    return object_pool::allocate(size);
+  }
+
+  static void operator delete(void* ptr, std::size_t size) noexcept {
+    object_pool::deallocate(ptr, size);
+  }
+
+  static void operator delete(void *ptr, std::size_t size,
+                              std::align_val_t alignment) noexcept {
+    if(static_cast<std::size_t>(alignment) > object_pool::alignment)
+      ::operator delete(ptr, alignment);
+    else
+      object_pool::deallocate(ptr, size);
+  }
+};
+
+/// Allocation policy for common::small_function that allocates
+/// callables that are too large to be stored inline from the object pool.
+struct object_pool_function_allocation {
+  static void* allocate(std::size_t size) {
+    return object_pool::allocate(size);
+  }
+
+  static void deallocate(void* ptr, std::size_t size) noexcept {
+    object_pool::deallocate(ptr, size);
+  }
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,129 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+#ifndef HIPSYCL_WORK_STEALING_EXECUTOR_HPP
+#define HIPSYCL_WORK_STEALING_EXECUTOR_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace hipsycl {
+namespace rt {
+
+/// A persistent thread pool that executes parallel loops with work stealing.
+///
+/// Each parallel_for is split evenly among all threads of the pool. Threads
+/// take chunks of grain_size items from their own range, and steal half of
+/// the remaining range from other threads once their own range is exhausted,
+/// preferring threads on the same NUMA node. Multiple parallel_for calls
+/// (e.g. from different queues) may run concurrently. In this case, the pool
+/// threads are partitioned among them, such that e.g. two concurrent
+/// parallel_for calls each run on half of the cores instead of
+/// oversubscribing the machine.
+///
+/// On systems with multiple NUMA nodes, pool threads are bound to the
+/// NUMA node of their CPU in the process affinity mask. Since the initial
+/// distribution of a parallel_for only depends on the number of items and
+/// the requested NUMA node, a given item is initially always processed by the same pool thread,
+/// and therefore on the same NUMA node. parallel_for_static() can be used
+/// to first-touch memory with the same distribution.
+class work_stealing_executor {
+public:
+  /// \param num_threads Total number of threads that execute a parallel_for,
+  /// including the thread calling parallel_for. num_threads-1 pool threads
+  /// are created.
+  explicit work_stealing_executor(std::size_t num_threads);
+  ~work_stealing_executor();
+
+  work_stealing_executor(const work_stealing_executor&) = delete;
+  work_stealing_executor& operator=(const work_stealing_executor&) = delete;
+
+  std::size_t get_num_threads() const {
+    return _workers.size() + 1;
+  }
+
+  /// Invokes f(begin, end) for disjoint chunks [begin, end) that cover
+  /// [0, num_items), each of at most grain_size items. If grain_size is 0, it
+  /// is chosen automatically. The calling thread participates in the
+  /// execution. Returns once all chunks have been processed.
+  /// If numa_node is not -1 and there are pool threads bound to this NUMA
+  /// node, the other pool threads do not participate.
+  /// This function is thread-safe.
+  template<class F>
+  void parallel_for(std::size_t num_items, std::size_t grain_size, F&& f,
+                    int numa_node = -1) {
+    run(num_items, grain_size, numa_node, true, make_chunk_function<F>(),
+        const_cast<void*>(static_cast<const void *>(&f)));
+  }
+
+  /// Invokes f(begin, end) once for each participating thread, with
+  /// the range that this thread initially owns in a parallel_for with the
+  /// same num_items and numa_node. Ranges are not stolen, so every range is
+  /// processed by its owning thread.
+  /// This function is thread-safe.
+  template<class F>
+  void parallel_for_static(std::size_t num_items, F&& f, int numa_node = -1) {
+    run(num_items, num_items, numa_node, false, make_chunk_function<F>(),
+        const_cast<void*>(static_cast<const void *>(&f)));
+  }
+private:
+  using chunk_function = void (*)(void *, std::size_t, std::size_t);
+
+  template<class F>
+  static chunk_function make_chunk_function() {
+    using callable = std::remove_reference_t<F>;
+    return [](void *ctx, std::size_t begin, std::size_t end) {
+      (*static_cast<callable *>(ctx))(begin, end);
+    };
+  }
+
+  struct job;
+  struct worker {
+    std::thread thread;
+    // Index of the NUMA node that the worker is bound to, -1 if unknown
+    int numa_node = -1;
+    // Slot indices to steal from, in order of preference
+    std::vector<std::size_t> victims;
+  };
+
+  void run(std::size_t num_items, std::size_t grain_size, int numa_node,
+           bool allow_stealing, chunk_function f, void *ctx);
+  void work(std::size_t worker_index);
+  // Processes work of the job in the given slot until none is left to steal.
+  // Returns true if any work was processed. If observed_generation is not
+  // null, also returns once new jobs have been submitted since this
+  // generation, such that pool threads can be repartitioned among the jobs.
+  bool participate(job &j, std::size_t slot,
+                   const std::vector<std::size_t> &victims,
+                   const std::size_t *observed_generation = nullptr);
+
+  std::vector<worker> _workers;
+  // Victims for the thread calling parallel_for, which uses
+  // the last slot of each job.
+  std::vector<std::size_t> _caller_victims;
+
+  std::mutex _mutex;
+  std::condition_variable _worker_wakeup;
+  std::vector<std::shared_ptr<job>> _active_jobs;
+  std::atomic<std::size_t> _job_generation;
+  std::atomic<int> _num_parked_workers;
+  bool _is_shutting_down;
+};
+
+}
+}
+
+#endif
@@ -11,6 +11,12 @@
 #ifndef HIPSYCL_MEMCPY_HPP
 #define HIPSYCL_MEMCPY_HPP
 
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 #include "../operations.hpp"
 #include "../util.hpp"
@@ -19,11 +25,39 @@ namespace hipsycl {
 namespace rt {
 
 class backend_manager;
+class worker_thread;
 
+/// Latency and bandwidth of data transfers from one device to another.
+struct memcpy_link_parameters {
+  // Latency in ns
+  double latency = 0.0;
+  // Bandwidth in bytes/ns (= GB/s)
+  double bandwidth = 1.0;
+
+  cost_type estimate_runtime(std::size_t num_bytes) const {
+    return latency + static_cast<double>(num_bytes) / bandwidth;
+  }
+};
+
+/// Estimates the cost of data transfers between devices in ns.
+///
+/// The estimates are based on a per-device-pair table of latency and
+/// bandwidth. Entries are measured with a short benchmark the first time
+/// a device pair is queried (unless disabled with ACPP_RT_MEMCPY_CALIBRATION),
+/// and cached in the persistent storage directory. The benchmark runs on a
+/// background thread, so queries never block on it; until a device pair has
+/// been measured, built-in estimates are used.
 class memcpy_model
 {
 public:
-  memcpy_model(backend_manager* mgr){}
+  struct source_share {
+    memory_location source;
+    // Fraction of the transfer that should be copied from this source
+    double fraction;
+  };
+
+  memcpy_model(backend_manager* mgr);
+  ~memcpy_model();
 
   cost_type estimate_runtime_cost(const memory_location &source,
                                   const memory_location &dest,
@@ -33,6 +67,63 @@ public:
   choose_source(const std::vector<memory_location> &candidate_sources,
                 const memory_location &target, range<3> num_elements) const;
 
+  /// Returns the subset of candidate_sources that a transfer of
+  /// num_elements should be split across to minimize its runtime,
+  /// assuming transfers from different sources proceed concurrently.
+  /// Returns a single source with fraction 1 if splitting does not pay off.
+  std::vector<source_share>
+  split_sources(const std::vector<memory_location> &candidate_sources,
+                const memory_location &target, range<3> num_elements) const;
+
+  /// Sets the parameters for transfers from source to dest, replacing
+  /// measured or built-in values.
+  void set_link_parameters(device_id source, device_id dest,
+                           const memcpy_link_parameters &params);
+  memcpy_link_parameters get_link_parameters(device_id source,
+                                             device_id dest) const;
+private:
+  struct device_pair_hash {
+    std::size_t operator()(const std::pair<device_id, device_id> &p) const {
+      return std::hash<device_id>{}(p.first) ^
+             (std::hash<device_id>{}(p.second) << 1);
+    }
+  };
+  using link_table =
+      std::unordered_map<std::pair<device_id, device_id>,
+                         memcpy_link_parameters, device_pair_hash>;
+
+  // Must be called with _mutex locked. If the link is unknown, schedules
+  // its calibration and returns the built-in estimate in the meantime.
+  memcpy_link_parameters lookup_or_schedule_calibration(device_id source,
+                                                        device_id dest) const;
+  // Runs on the calibration worker without holding _mutex
+  void run_calibration(device_id source, device_id dest) const;
+  memcpy_link_parameters get_builtin_estimate(device_id source,
+                                              device_id dest) const;
+  bool calibrate(device_id source, device_id dest,
+                 memcpy_link_parameters &out) const;
+  // Stable identifier of a device and its driver across application runs
+  std::string get_device_key(device_id dev) const;
+
+  void load_persistent_table() const;
+  void store_persistent_table() const;
+
+  backend_manager* _backends;
+
+  mutable std::mutex _mutex;
+  mutable link_table _links;
+  // Links for which measurement was attempted without success
+  mutable link_table _failed_calibrations;
+  // Links that are currently being measured by the calibration worker
+  mutable std::unordered_set<std::pair<device_id, device_id>,
+                             device_pair_hash>
+      _pending_calibrations;
+  // Created on first use
+  mutable std::unique_ptr<worker_thread> _calibration_worker;
+  // Entries of the file in persistent storage, indexed by device keys
+  mutable std::unordered_map<std::string, memcpy_link_parameters>
+      _persistent_table;
+  mutable bool _is_persistent_table_loaded = false;
 };
 
 
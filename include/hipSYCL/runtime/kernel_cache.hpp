@@ -12,17 +12,24 @@
 #include <string>
 #include <unordered_map>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <cassert>
 #include <memory>
 #include <optional>
 #include <array>
+#include <string_view>
+#include <type_traits>
 #include "hipSYCL/common/hcf_container.hpp"
+#include "hipSYCL/common/jit_cache_archive.hpp"
 #include "hipSYCL/common/small_map.hpp"
 #include "hipSYCL/common/unordered_dense.hpp"
 #include "hipSYCL/common/stable_running_hash.hpp"
 #include "hipSYCL/runtime/kernel_configuration.hpp"
 #include "hipSYCL/runtime/device_id.hpp"
 #include "hipSYCL/runtime/error.hpp"
+#include "hipSYCL/runtime/tracing.hpp"
+#include "hipSYCL/runtime/generic/async_worker.hpp"
 
 #ifndef HIPSYCL_RT_KERNEL_CACHE_HPP
 #define HIPSYCL_RT_KERNEL_CACHE_HPP
@@ -171,6 +178,11 @@ private:
 // Stores all HCF data, and also extracts information for data
 // in the SSCP format.
 //
+// HCF objects that are embedded in the application are registered by
+// reference to their serialized data and only parsed when they are first
+// looked up, such that registration does not slow down application startup.
+// Kernel and image information is likewise extracted on first lookup.
+//
 // This class is thread-safe.
 class hcf_cache {
 public:
@@ -179,6 +191,10 @@ public:
   const common::hcf_container* get_hcf(hcf_object_id obj) const;
   
   hcf_object_id register_hcf_object(const common::hcf_container& obj);
+  /// Registers a serialized HCF object without parsing it. The data is
+  /// referenced in place, and must remain valid until the object is
+  /// unregistered.
+  hcf_object_id register_hcf_data(std::string_view serialized_obj);
   void unregister_hcf_object(hcf_object_id id);
 
   struct device_image_id {
@@ -191,6 +207,8 @@ public:
   template<class Handler>
   void symbol_lookup(const std::vector<std::string>& names, Handler&& h) const {
     std::lock_guard<std::mutex> lock{_mutex};
+    // Any object might export the symbols
+    parse_all_objects();
 
     for(const auto& symbol_name : names) {
       HIPSYCL_DEBUG_INFO << "hcf_cache: Looking up symbol " << symbol_name
@@ -218,9 +236,33 @@ public:
 private:
   hcf_cache() = default;
 
-  std::unordered_map<hcf_object_id, std::unique_ptr<common::hcf_container>>
-      _hcf_objects;
-  std::unordered_map<std::string, symbol_resolver_list> _exported_symbol_providers;
+  using node_index =
+      ankerl::unordered_dense::map<std::string_view,
+                                   const common::hcf_container::node *>;
+
+  struct hcf_object {
+    // Serialized data that has not been parsed yet
+    std::string_view data;
+    // Set once the object has been parsed
+    std::unique_ptr<common::hcf_container> container;
+    // Kernel and image nodes of the container by name
+    node_index kernel_nodes;
+    node_index image_nodes;
+  };
+
+  // These assume that _mutex is locked.
+  hcf_object* get_object(hcf_object_id id) const;
+  void parse_object(hcf_object_id id, hcf_object& obj) const;
+  void parse_all_objects() const;
+  void index_object(hcf_object_id id, hcf_object& obj) const;
+  void add_object(hcf_object_id id, hcf_object obj);
+  void dump_hcf(hcf_object_id id, std::string_view data) const;
+
+  // Parsing happens lazily in const lookup functions
+  mutable std::unordered_map<hcf_object_id, hcf_object> _hcf_objects;
+  mutable std::size_t _num_unparsed_objects = 0;
+  mutable std::unordered_map<std::string, symbol_resolver_list>
+      _exported_symbol_providers;
 
   using info_id = std::array<uint64_t, 2>;
 
@@ -246,14 +288,35 @@ private:
     }
   };
 
-  ankerl::unordered_dense::map<info_id, std::unique_ptr<hcf_kernel_info>, info_id_hash>
+  // Also caches invalid entries, for which lookups return nullptr
+  mutable ankerl::unordered_dense::map<info_id, std::unique_ptr<hcf_kernel_info>, info_id_hash>
       _hcf_kernel_info;
-  ankerl::unordered_dense::map<info_id, std::unique_ptr<hcf_image_info>, info_id_hash>
+  mutable ankerl::unordered_dense::map<info_id, std::unique_ptr<hcf_image_info>, info_id_hash>
       _hcf_image_info;
 
   mutable std::mutex _mutex;
 };
 
+/// A JIT-compiled binary. Either owns its data, or references a binary
+/// in the persistent kernel cache archive without copying it.
+class jit_binary {
+public:
+  explicit jit_binary(std::string data)
+      : _owned_data{std::move(data)}, _data{_owned_data} {}
+
+  explicit jit_binary(common::filesystem::archived_binary archived)
+      : _archived{std::move(archived)}, _data{_archived.data()} {}
+
+  jit_binary(const jit_binary&) = delete;
+  jit_binary& operator=(const jit_binary&) = delete;
+
+  std::string_view data() const { return _data; }
+private:
+  std::string _owned_data;
+  common::filesystem::archived_binary _archived;
+  std::string_view _data;
+};
+
 class kernel_cache {
 public:
   using code_object_id = kernel_configuration::id_type;
@@ -302,8 +365,14 @@ public:
   /// Should return true if the compilation was successful. The binary output of JIT compilation
   /// should be stored in the string reference.
   /// \c c Is expected to turn the JIT-compiled binary into a code_object*. Has signature
-  /// code_object*(const std::string&). It is expected to return nullptr on error. The JIT-compiled
-  /// binary will be passed in as string reference.
+  /// code_object*(std::string_view) or code_object*(const std::string&). It is expected to
+  /// return nullptr on error. Binaries from the persistent cache are only passed in
+  /// without copying them if \c c accepts std::string_view. The binary data is only
+  /// guaranteed to remain valid for the duration of the call.
+  ///
+  /// \c jit_compile is invoked without holding the cache lock, so \c jit_compile
+  /// invocations for different binaries may run concurrently and must be thread-safe.
+  /// Concurrent requests for the same \c id_of_binary result in only one compilation.
   template <class CodeObjectConstructor, class JitCompiler>
   const code_object *get_or_construct_jit_code_object(code_object_id id_of_code_object,
                                                       code_object_id id_of_binary,
@@ -312,47 +381,218 @@ public:
     if(auto* code_object = get_code_object(id_of_code_object)) {
       HIPSYCL_DEBUG_INFO << "kernel_cache: Cache hit for id "
                          << kernel_configuration::to_string(id_of_code_object) << "\n";
+      tracing::instant("code_object_cache_hit", tracing::category::jit, 0,
+                       "code_object_id", id_of_code_object[0]);
       return code_object;
     }
     HIPSYCL_DEBUG_INFO << "kernel_cache: Cache MISS for id "
                       << kernel_configuration::to_string(id_of_code_object) << "\n";
+    tracing::scope trace{"code_object_cache_miss", tracing::category::jit};
+    trace.set_arg("code_object_id", id_of_code_object[0]);
     
-    std::string compiled_binary;
-    // TODO: We might want to allow JIT compilation in parallel at some point
-    std::lock_guard<std::mutex> lock{_mutex};
-
-    if(!persistent_cache_lookup(id_of_binary, compiled_binary)){
-      if(!jit_compile(compiled_binary))
-        return nullptr;
-
-      if(_is_first_jit_compilation) {
-        _is_first_jit_compilation = false;
-        HIPSYCL_DEBUG_WARNING
-            << "kernel_cache: This application run has resulted in new "
-               "binaries being JIT-compiled. This indicates that the runtime "
-               "optimization process has not yet reached peak performance. You "
-               "may want to run the application again until this warning no "
-               "longer appears to achieve optimal performance."
-            << std::endl;
+    // Concurrent requests for the same binary wait on a single compilation,
+    // while compilations of different binaries run in parallel.
+    bool is_compiling_thread = false;
+    std::shared_ptr<const jit_binary> compiled_binary;
+    try {
+      compiled_binary = get_or_compile_binary(id_of_binary, jit_compile,
+                                              is_compiling_thread);
+    } catch (...) {
+      // Waiters have already been released with a null binary; make sure
+      // that subsequent requests can retry the compilation.
+      if(is_compiling_thread) {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _in_flight_compilations.erase(id_of_binary);
       }
-      persistent_cache_store(id_of_binary, compiled_binary);
+      throw;
     }
-    
-    const code_object* new_object = c(compiled_binary);
+
+    std::lock_guard<std::mutex> lock{_mutex};
+    // Erase the in-flight entry only while holding the lock that also
+    // guards construction, such that no other thread can observe a state where
+    // neither the compilation is in flight nor the code object exists.
+    if(is_compiling_thread)
+      _in_flight_compilations.erase(id_of_binary);
+
+    if(!compiled_binary)
+      return nullptr;
+
+    // Another thread waiting on the same compilation might already have
+    // constructed the code object.
+    if(auto* existing_code_object = get_code_object_impl(id_of_code_object))
+      return existing_code_object;
+
+    const code_object* new_object =
+        construct_code_object(c, compiled_binary->data());
     if(new_object)
       _code_objects[id_of_code_object] = code_object_ptr{new_object};
     
     return new_object;
   }
 
+  /// Like \c get_or_construct_jit_code_object(), but never blocks on JIT
+  /// compilation: If the code object is not yet available, JIT compilation
+  /// and code object construction are scheduled on a background compilation
+  /// thread, and nullptr is returned. Once the background compilation has
+  /// completed, the code object becomes visible to all subsequent lookups.
+  ///
+  /// Because the factory functions are executed asynchronously, they are taken
+  /// by value and must not reference state owned by the caller.
+  /// Each \c id_of_code_object is scheduled at most once, so a failed
+  /// background compilation is not retried.
+  template <class CodeObjectConstructor, class JitCompiler>
+  const code_object *
+  get_or_schedule_jit_code_object(code_object_id id_of_code_object,
+                                  code_object_id id_of_binary,
+                                  JitCompiler jit_compile,
+                                  CodeObjectConstructor c) {
+    if(auto* code_object = get_code_object(id_of_code_object))
+      return code_object;
+
+    std::lock_guard<std::mutex> lock{_mutex};
+    if(!_scheduled_background_compilations.insert(id_of_code_object).second)
+      return nullptr;
+
+    HIPSYCL_DEBUG_INFO << "kernel_cache: Scheduling background JIT compilation "
+                          "for id "
+                       << kernel_configuration::to_string(id_of_code_object)
+                       << "\n";
+
+    worker_thread* worker = get_background_compilation_worker();
+    (*worker)([this, id_of_code_object, id_of_binary, jit_compile, c]() mutable {
+      if (!get_or_construct_jit_code_object(id_of_code_object, id_of_binary,
+                                            jit_compile, c)) {
+        HIPSYCL_DEBUG_WARNING
+            << "kernel_cache: Background JIT compilation for id "
+            << kernel_configuration::to_string(id_of_code_object)
+            << " failed, will continue to use fallback code object."
+            << std::endl;
+      }
+    });
+    return nullptr;
+  }
+
+  /// Blocks until all background compilations that have been scheduled
+  /// with \c get_or_schedule_jit_code_object() so far have completed.
+  void wait_for_background_compilations();
+
   // Unload entire cache and release resources to prepare runtime shutdown.
   void unload();
 
   // Stitches together the persisten cache path with the id of the binary to a unique path.
   static std::string get_persistent_cache_file(code_object_id id_of_binary);
 private:
-  bool persistent_cache_lookup(code_object_id id_of_binary, std::string& out) const;
-  void persistent_cache_store(code_object_id id_of_binary, const std::string& data) const;
+  // Tracks a JIT compilation that is currently in progress, such that
+  // other threads requesting the same binary can wait for the result.
+  struct in_flight_compilation {
+    std::mutex mutex;
+    std::condition_variable completion_cv;
+    bool is_complete = false;
+    // nullptr if the compilation failed
+    std::shared_ptr<const jit_binary> binary;
+  };
+
+  /// Returns the binary for id_of_binary from the persistent cache, or
+  /// JIT-compiles it. If another thread is already compiling the same binary,
+  /// waits for its result instead. Does not hold \c _mutex while compiling.
+  /// \c is_compiling_thread will be set to true if the calling thread carried
+  /// out the lookup/compilation; the caller is then responsible for removing
+  /// the entry from \c _in_flight_compilations.
+  template <class JitCompiler>
+  std::shared_ptr<const jit_binary>
+  get_or_compile_binary(code_object_id id_of_binary, JitCompiler &&jit_compile,
+                        bool &is_compiling_thread) {
+    std::shared_ptr<in_flight_compilation> compilation;
+    {
+      std::lock_guard<std::mutex> lock{_mutex};
+      auto it = _in_flight_compilations.find(id_of_binary);
+      if(it != _in_flight_compilations.end()) {
+        compilation = it->second;
+      } else {
+        compilation = std::make_shared<in_flight_compilation>();
+        _in_flight_compilations[id_of_binary] = compilation;
+        is_compiling_thread = true;
+      }
+    }
+
+    if(!is_compiling_thread) {
+      HIPSYCL_DEBUG_INFO << "kernel_cache: Waiting for in-flight JIT "
+                            "compilation of binary "
+                         << kernel_configuration::to_string(id_of_binary)
+                         << "\n";
+      tracing::scope trace{"jit_wait_for_in_flight_compilation",
+                           tracing::category::jit};
+      trace.set_arg("binary_id", id_of_binary[0]);
+      std::unique_lock<std::mutex> lock{compilation->mutex};
+      compilation->completion_cv.wait(
+          lock, [&]() { return compilation->is_complete; });
+      return compilation->binary;
+    }
+
+    std::shared_ptr<const jit_binary> result;
+
+    // Publishes the result to waiting threads on every exit path, including
+    // exceptions thrown by the lookup or the JIT compiler. In the latter case,
+    // waiters observe a null binary, i.e. a failed compilation.
+    struct completion_publisher {
+      in_flight_compilation &compilation;
+      std::shared_ptr<const jit_binary> &result;
+
+      ~completion_publisher() {
+        {
+          std::lock_guard<std::mutex> lock{compilation.mutex};
+          compilation.binary = result;
+          compilation.is_complete = true;
+        }
+        compilation.completion_cv.notify_all();
+      }
+    } publisher{*compilation, result};
+
+    if(persistent_cache_lookup(id_of_binary, result)) {
+      tracing::instant("jit_persistent_cache_hit", tracing::category::jit, 0,
+                       "binary_id", id_of_binary[0]);
+    } else {
+      tracing::scope trace{"jit_compile", tracing::category::jit};
+      trace.set_arg("binary_id", id_of_binary[0]);
+
+      std::string compiled_binary;
+      if(jit_compile(compiled_binary)) {
+        result = std::make_shared<jit_binary>(std::move(compiled_binary));
+
+        if(_is_first_jit_compilation.exchange(false)) {
+          HIPSYCL_DEBUG_WARNING
+              << "kernel_cache: This application run has resulted in new "
+                 "binaries being JIT-compiled. This indicates that the runtime "
+                 "optimization process has not yet reached peak performance. You "
+                 "may want to run the application again until this warning no "
+                 "longer appears to achieve optimal performance."
+              << std::endl;
+        }
+        persistent_cache_store(id_of_binary, result->data());
+      }
+    }
+
+    return result;
+  }
+
+  // Assumes that _mutex is locked.
+  worker_thread* get_background_compilation_worker();
+
+  template <class CodeObjectConstructor>
+  static const code_object *construct_code_object(CodeObjectConstructor &c,
+                                                  std::string_view binary) {
+    if constexpr (std::is_invocable_v<CodeObjectConstructor &,
+                                      std::string_view>) {
+      return c(binary);
+    } else {
+      return c(std::string{binary});
+    }
+  }
+
+  bool persistent_cache_lookup(code_object_id id_of_binary,
+                               std::shared_ptr<const jit_binary> &out) const;
+  void persistent_cache_store(code_object_id id_of_binary,
+                              std::string_view data) const;
   
   const code_object* get_code_object_impl(code_object_id id) const;
 
@@ -379,8 +619,17 @@ private:
 
   ankerl::unordered_dense::map<code_object_id, code_object_ptr, rt::kernel_id_hash>
       _code_objects;
-  
-  bool _is_first_jit_compilation = true;
+  ankerl::unordered_dense::map<code_object_id,
+                               std::shared_ptr<in_flight_compilation>,
+                               rt::kernel_id_hash>
+      _in_flight_compilations;
+
+  ankerl::unordered_dense::set<code_object_id, rt::kernel_id_hash>
+      _scheduled_background_compilations;
+  std::vector<std::unique_ptr<worker_thread>> _background_compilation_workers;
+  std::size_t _next_background_compilation_worker = 0;
+
+  std::atomic<bool> _is_first_jit_compilation = true;
 };
 
 namespace detail {
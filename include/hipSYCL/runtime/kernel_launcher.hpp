@@ -20,6 +20,7 @@
 #include "hipSYCL/runtime/dag_node.hpp"
 #include "hipSYCL/runtime/application.hpp"
 #include "hipSYCL/runtime/error.hpp"
+#include "hipSYCL/runtime/generic/object_pool.hpp"
 #include "hipSYCL/runtime/hints.hpp"
 #include "hipSYCL/runtime/util.hpp"
 #include "hipSYCL/runtime/kernel_configuration.hpp"
@@ -61,7 +62,7 @@ private:
   sscp_code_object_invoker* _sscp_invoker = nullptr;
 };
 
-class backend_kernel_launcher
+class backend_kernel_launcher : public pooled_object
 {
 public:
   virtual ~backend_kernel_launcher(){}
@@ -17,10 +17,15 @@
 namespace hipsycl {
 namespace rt {
 
+class omp_backend;
+
 class omp_allocator : public backend_allocator 
 {
 public:
-  omp_allocator(const device_id &my_device);
+  /// \param numa_node The NUMA node that allocations are placed on,
+  /// or -1 to place them according to the omp_numa_allocation setting
+  omp_allocator(omp_backend *be, const device_id &my_device,
+                int numa_node = -1);
   
   virtual void* raw_allocate(size_t min_alignment, size_t size_bytes,
                              const allocation_hints &hints = {}) override;
@@ -43,7 +48,11 @@ public:
 
   virtual device_id get_device() const override;
 private:
+  void place_on_numa_nodes(void *mem, size_t size_bytes);
+
+  omp_backend *_backend;
   device_id _my_device;
+  int _numa_node;
 };
 
 
@@ -11,8 +11,13 @@
 #ifndef HIPSYCL_OMP_BACKEND_HPP
 #define HIPSYCL_OMP_BACKEND_HPP
 
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include "../backend.hpp"
 #include "../multi_queue_executor.hpp"
+#include "../generic/work_stealing_executor.hpp"
 #include "omp_allocator.hpp"
 #include "omp_hardware_manager.hpp"
 
@@ -39,9 +44,17 @@ public:
 
   std::unique_ptr<backend_executor>
   create_inorder_executor(device_id dev, int priority) override;
+
+  /// The thread pool that executes SSCP kernels of all queues
+  /// of this backend. Constructed on first use.
+  work_stealing_executor& get_kernel_executor();
 private:
-  mutable omp_allocator _allocator;
   mutable omp_hardware_manager _hw;
+  // One allocator per (sub-)device
+  std::vector<std::unique_ptr<omp_allocator>> _allocators;
+  // Must outlive the queues owned by the executors
+  std::once_flag _kernel_executor_init_flag;
+  std::unique_ptr<work_stealing_executor> _kernel_executor;
   mutable lazily_constructed_executor<multi_queue_executor> _executor;
 };
 
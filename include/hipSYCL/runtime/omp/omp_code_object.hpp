@@ -11,8 +11,10 @@
 #ifndef HIPSYCL_OMP_CODE_OBJECT_HPP
 #define HIPSYCL_OMP_CODE_OBJECT_HPP
 
+#include <memory>
 #include <string>
 #include <vector>
+#include <string_view>
 
 #include "hipSYCL/runtime/kernel_configuration.hpp"
 #include "hipSYCL/runtime/device_id.hpp"
@@ -22,6 +24,10 @@
 
 
 namespace hipsycl {
+namespace compiler {
+class HostObjectLoader;
+}
+
 namespace rt {
 
 class omp_sscp_executable_object : public code_object {
@@ -44,7 +50,7 @@ public:
 
   using omp_sscp_kernel = void(const work_group_info *, void **);
 
-  omp_sscp_executable_object(const std::string &shared_lib_path,
+  omp_sscp_executable_object(std::string_view binary,
                              hcf_object_id hcf_source,
                              const std::vector<std::string> &kernel_names,
                              const kernel_configuration &config);
@@ -68,14 +74,19 @@ public:
   virtual omp_sscp_kernel *get_kernel(std::string_view backend_kernel_name) const;
 
 private:
-  result build(const std::string &source, const std::vector<std::string> &kernel_names);
+  result build(std::string_view source, const std::vector<std::string> &kernel_names);
 
   hcf_object_id _hcf;
   kernel_configuration::id_type _id;
+  // Only set if the library had to be written to disk to be loaded
   std::string _kernel_cache_path;
 
   result _build_result;
   void *_module;
+  // Only set if the library was loaded from memory
+  int _image_fd;
+  // Only set if the binary is an object file that was linked in memory
+  std::unique_ptr<compiler::HostObjectLoader> _object_loader;
 
   std::vector<std::string> _kernel_names;
   std::unordered_map<std::string_view, omp_sscp_kernel*> _kernels;
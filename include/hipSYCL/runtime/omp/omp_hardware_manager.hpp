@@ -19,6 +19,14 @@ namespace rt {
 class omp_hardware_context : public hardware_context
 {
 public:
+  /// \param index The index of the (sub-)device
+  /// \param num_sub_devices The number of sub-devices that the
+  /// CPU is partitioned into
+  /// \param numa_node The NUMA node that the sub-device corresponds to,
+  /// or -1 if it is not restricted to a NUMA node
+  omp_hardware_context(std::size_t index = 0, std::size_t num_sub_devices = 1,
+                       int numa_node = -1);
+
   virtual bool is_cpu() const override;
   virtual bool is_gpu() const override;
 
@@ -42,12 +50,25 @@ public:
 
   virtual std::size_t get_platform_index() const override;
 
+  int get_numa_node() const;
+
+  /// \return The sub-group size of kernels that are JIT-compiled from the
+  /// generic SSCP target, as configured by ACPP_RT_OMP_SUB_GROUP_SIZE.
+  /// If it is set to 0, this is derived from the SIMD width of the CPU.
+  static std::size_t get_sscp_sub_group_size();
+
   virtual ~omp_hardware_context() {}
+private:
+  std::size_t _index;
+  std::size_t _num_sub_devices;
+  int _numa_node;
 };
 
 class omp_hardware_manager : public backend_hardware_manager
 {
 public:
+  omp_hardware_manager();
+
   virtual std::size_t get_num_devices() const override;
   virtual hardware_context *get_device(std::size_t index) override;
   virtual device_id get_device_id(std::size_t index) const override;
@@ -55,7 +76,7 @@ public:
 
   virtual ~omp_hardware_manager(){}
 private:
-  omp_hardware_context _device;
+  std::vector<omp_hardware_context> _devices;
 };
 
 } // namespace rt
@@ -86,7 +86,11 @@ public:
 
   worker_thread& get_worker();
 private:
+  omp_backend* _backend;
   const backend_id _backend_id;
+  int _device_index;
+  // NUMA node of the device, -1 if it is not restricted to a NUMA node
+  int _numa_node;
   worker_thread _worker;
 
   omp_sscp_code_object_invoker _sscp_code_object_invoker;
@@ -23,6 +23,7 @@
 #include "instrumentation.hpp"
 #include "device_id.hpp"
 #include "kernel_launcher.hpp"
+#include "generic/object_pool.hpp"
 #include "util.hpp"
 #include "error.hpp"
 #include "hw_model/cost.hpp"
@@ -62,7 +63,9 @@ public:
   virtual ~operation_dispatcher(){}
 };
 
-class operation
+/// Operations are created for every submission, and are therefore
+/// allocated from the object pool.
+class operation : public pooled_object
 {
 public:
   operation() = default;
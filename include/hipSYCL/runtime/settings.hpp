@@ -26,6 +26,7 @@ namespace rt {
 
 enum class scheduler_type { direct, unbound };
 enum class default_selector_behavior { strict, multigpu, system };
+enum class numa_allocation_policy { none, first_touch, interleave };
 
 struct device_visibility_condition{
   int device_index_equality = -1;
@@ -52,6 +53,7 @@ bool has_device_visibility_mask(const visibility_mask_t& mask, backend_id backen
 std::istream &operator>>(std::istream &istr, scheduler_type &out);
 std::istream &operator>>(std::istream &istr, visibility_mask_t &out);
 std::istream &operator>>(std::istream &istr, default_selector_behavior& out);
+std::istream &operator>>(std::istream &istr, numa_allocation_policy& out);
 
 template <class T>
 bool try_get_environment_variable(const std::string& name, T& out) {
@@ -108,7 +110,21 @@ enum class setting {
   jitopt_iads_relative_threshold,
   jitopt_iads_relative_eviction_threshold,
   jitopt_iads_relative_threshold_min_data,
-  enable_allocation_tracking
+  enable_allocation_tracking,
+  jit_background_compilation,
+  jit_background_compilation_threads,
+  omp_kernel_grain_size,
+  omp_kernel_concurrency,
+  memcpy_calibration,
+  scratch_cache_max_size,
+  omp_sub_devices,
+  jit_host_external_compiler,
+  omp_sub_group_size,
+  trace_file,
+  trace_buffer_size,
+  memcpy_chunk_size,
+  omp_numa_sub_devices,
+  omp_numa_allocation
 };
 
 template <setting S> struct setting_trait {};
@@ -148,12 +164,51 @@ HIPSYCL_RT_MAKE_SETTING_TRAIT(setting::jitopt_iads_relative_threshold_min_data,
                               "jitopt_iads_relative_threshold_min_data",
                               std::size_t)
 HIPSYCL_RT_MAKE_SETTING_TRAIT(setting::enable_allocation_tracking, "allocation_tracking", bool)
+HIPSYCL_RT_MAKE_SETTING_TRAIT(setting::jit_background_compilation,
+                              "jit_background_compilation", bool)
+HIPSYCL_RT_MAKE_SETTING_TRAIT(setting::jit_background_compilation_threads,
+                              "jit_background_compilation_threads", std::size_t)
+HIPSYCL_RT_MAKE_SETTING_TRAIT(setting::omp_kernel_grain_size,
+                              "rt_omp_kernel_grain_size", std::size_t)
+HIPSYCL_RT_MAKE_SETTING_TRAIT(setting::omp_kernel_concurrency,
+                              "rt_omp_kernel_concurrency", std::size_t)
+HIPSYCL_RT_MAKE_SETTING_TRAIT(setting::memcpy_calibration,
+                              "rt_memcpy_calibration", bool)
+HIPSYCL_RT_MAKE_SETTING_TRAIT(setting::scratch_cache_max_size,
+                              "rt_scratch_cache_max_size", std::size_t)
+HIPSYCL_RT_MAKE_SETTING_TRAIT(setting::omp_sub_devices,
+                              "rt_omp_sub_devices", std::size_t)
+HIPSYCL_RT_MAKE_SETTING_TRAIT(setting::jit_host_external_compiler,
+                              "jit_host_external_compiler", bool)
+HIPSYCL_RT_MAKE_SETTING_TRAIT(setting::omp_sub_group_size,
+                              "rt_omp_sub_group_size", std::size_t)
+HIPSYCL_RT_MAKE_SETTING_TRAIT(setting::trace_file, "rt_trace_file", std::string)
+HIPSYCL_RT_MAKE_SETTING_TRAIT(setting::trace_buffer_size,
+                              "rt_trace_buffer_size", std::size_t)
+HIPSYCL_RT_MAKE_SETTING_TRAIT(setting::memcpy_chunk_size,
+                              "rt_memcpy_chunk_size", std::size_t)
+HIPSYCL_RT_MAKE_SETTING_TRAIT(setting::omp_numa_sub_devices,
+                              "rt_omp_numa_sub_devices", bool)
+HIPSYCL_RT_MAKE_SETTING_TRAIT(setting::omp_numa_allocation,
+                              "rt_omp_numa_allocation", numa_allocation_policy)
 
 class settings
 {
 public:
 
   template <setting S> typename setting_trait<S>::type get() const {
+    return const_cast<settings *>(this)->get_ref<S>();
+  }
+
+  /// Overrides the value of a setting, e.g. for tests. Not thread-safe;
+  /// it only affects code that reads the setting afterwards.
+  template <setting S>
+  void set(const typename setting_trait<S>::type &value) {
+    get_ref<S>() = value;
+  }
+
+private:
+  template <setting S> typename setting_trait<S>::type &get_ref() {
     if constexpr(S == setting::debug_level){
       return _debug_level;
     } else if constexpr (S == setting::scheduler_type) {
@@ -194,10 +249,39 @@ public:
       return _jitopt_iads_relative_eviction_threshold;
     } else if constexpr(S == setting::enable_allocation_tracking) {
       return _enable_allocation_tracking;
+    } else if constexpr(S == setting::jit_background_compilation) {
+      return _jit_background_compilation;
+    } else if constexpr(S == setting::jit_background_compilation_threads) {
+      return _jit_background_compilation_threads;
+    } else if constexpr(S == setting::omp_kernel_grain_size) {
+      return _omp_kernel_grain_size;
+    } else if constexpr(S == setting::omp_kernel_concurrency) {
+      return _omp_kernel_concurrency;
+    } else if constexpr(S == setting::memcpy_calibration) {
+      return _memcpy_calibration;
+    } else if constexpr(S == setting::scratch_cache_max_size) {
+      return _scratch_cache_max_size;
+    } else if constexpr(S == setting::omp_sub_devices) {
+      return _omp_sub_devices;
+    } else if constexpr(S == setting::jit_host_external_compiler) {
+      return _jit_host_external_compiler;
+    } else if constexpr(S == setting::omp_sub_group_size) {
+      return _omp_sub_group_size;
+    } else if constexpr(S == setting::trace_file) {
+      return _trace_file;
+    } else if constexpr(S == setting::trace_buffer_size) {
+      return _trace_buffer_size;
+    } else if constexpr(S == setting::memcpy_chunk_size) {
+      return _memcpy_chunk_size;
+    } else if constexpr(S == setting::omp_numa_sub_devices) {
+      return _omp_numa_sub_devices;
+    } else {
+      static_assert(S == setting::omp_numa_allocation, "Unknown setting");
+      return _omp_numa_allocation;
     }
-    return typename setting_trait<S>::type{};
   }
 
+public:
   settings() {
     int default_debug_level = 2;
 #ifdef HIPSYCL_DEBUG_LEVEL
@@ -248,6 +332,38 @@ public:
         get_environment_variable_or_default<setting::jitopt_iads_relative_threshold_min_data>(1024);
     _enable_allocation_tracking =
         get_environment_variable_or_default<setting::enable_allocation_tracking>(false);
+    _jit_background_compilation =
+        get_environment_variable_or_default<setting::jit_background_compilation>(false);
+    _jit_background_compilation_threads = get_environment_variable_or_default<
+        setting::jit_background_compilation_threads>(1);
+    _omp_kernel_grain_size =
+        get_environment_variable_or_default<setting::omp_kernel_grain_size>(0);
+    _omp_kernel_concurrency =
+        get_environment_variable_or_default<setting::omp_kernel_concurrency>(1);
+    _memcpy_calibration =
+        get_environment_variable_or_default<setting::memcpy_calibration>(false);
+    _scratch_cache_max_size =
+        get_environment_variable_or_default<setting::scratch_cache_max_size>(
+            std::size_t{512} * 1024 * 1024);
+    _omp_sub_devices =
+        get_environment_variable_or_default<setting::omp_sub_devices>(1);
+    _jit_host_external_compiler = get_environment_variable_or_default<
+        setting::jit_host_external_compiler>(false);
+    _omp_sub_group_size =
+        get_environment_variable_or_default<setting::omp_sub_group_size>(1);
+    _trace_file =
+        get_environment_variable_or_default<setting::trace_file>(std::string{});
+    _trace_buffer_size =
+        get_environment_variable_or_default<setting::trace_buffer_size>(65536);
+    _memcpy_chunk_size =
+        get_environment_variable_or_default<setting::memcpy_chunk_size>(
+            std::size_t{64} * 1024 * 1024);
+    _omp_numa_sub_devices =
+        get_environment_variable_or_default<setting::omp_numa_sub_devices>(
+            false);
+    _omp_numa_allocation =
+        get_environment_variable_or_default<setting::omp_numa_allocation>(
+            numa_allocation_policy::first_touch);
   }
 
 private:
@@ -280,6 +396,20 @@ private:
   double _jitopt_iads_relative_eviction_threshold;
   std::size_t _jitopt_iads_relative_threshold_min_data;
   bool _enable_allocation_tracking;
+  bool _jit_background_compilation;
+  std::size_t _jit_background_compilation_threads;
+  std::size_t _omp_kernel_grain_size;
+  std::size_t _omp_kernel_concurrency;
+  bool _memcpy_calibration;
+  std::size_t _scratch_cache_max_size;
+  std::size_t _omp_sub_devices;
+  bool _jit_host_external_compiler;
+  std::size_t _omp_sub_group_size;
+  std::string _trace_file;
+  std::size_t _trace_buffer_size;
+  std::size_t _memcpy_chunk_size;
+  bool _omp_numa_sub_devices;
+  numa_allocation_policy _omp_numa_allocation;
 };
 
 }
@@ -0,0 +1,106 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+#ifndef HIPSYCL_RT_TRACING_HPP
+#define HIPSYCL_RT_TRACING_HPP
+
+#include <cstdint>
+
+namespace hipsycl {
+namespace rt {
+
+class dag_node;
+
+/// Timeline tracing of runtime activity such as DAG node construction,
+/// scheduling, data transfers, JIT compilation and execution.
+///
+/// Tracing is enabled by setting ACPP_RT_TRACE_FILE. Each thread records
+/// events into its own fixed-size ring buffer without synchronization with
+/// other threads; if a buffer overflows, the oldest events of that thread are
+/// overwritten. The buffers are written to the trace file in the Chrome
+/// trace event JSON format (which can be loaded e.g. by Perfetto or
+/// chrome://tracing) when the runtime shuts down.
+///
+/// Event names and argument names must be string literals, since only
+/// the pointers are stored.
+namespace tracing {
+
+enum class category : std::uint8_t {
+  dag,
+  scheduler,
+  memory,
+  jit,
+  execution
+};
+
+bool is_enabled();
+
+/// Returns a process-wide unique, non-zero id to identify a DAG node
+/// in the trace. Returns 0 if tracing is disabled.
+std::uint64_t make_node_id();
+
+/// Records an event without duration.
+/// If \c node is 0, the node of the current node_context is used.
+void instant(const char *name, category cat, std::uint64_t node = 0,
+             const char *arg_name = nullptr, std::uint64_t arg = 0);
+
+/// Records an event covering the lifetime of the scope object.
+class scope {
+public:
+  scope(const char *name, category cat, std::uint64_t node = 0);
+  scope(const char *name, category cat, const dag_node *node);
+  ~scope();
+
+  scope(const scope &) = delete;
+  scope &operator=(const scope &) = delete;
+
+  void set_node(const dag_node *node);
+  void set_arg(const char *arg_name, std::uint64_t arg) {
+    _arg_name = arg_name;
+    _arg = arg;
+  }
+
+private:
+  const char *_name;
+  const char *_arg_name;
+  std::uint64_t _arg;
+  std::uint64_t _node;
+  std::uint64_t _begin;
+  category _cat;
+  bool _enabled;
+};
+
+/// Associates all events that the current thread records while
+/// the object is alive and that do not name a node explicitly
+/// with the given node, e.g. JIT compilations triggered by its submission.
+class node_context {
+public:
+  node_context(const dag_node *node);
+  explicit node_context(std::uint64_t node);
+  ~node_context();
+
+  node_context(const node_context &) = delete;
+  node_context &operator=(const node_context &) = delete;
+
+private:
+  std::uint64_t _previous;
+  bool _enabled;
+};
+
+/// Writes all events recorded so far to the trace file.
+/// Other threads may continue to record events; events that are recorded
+/// concurrently may be missing from the output, but are never torn.
+void write_trace_file();
+
+}
+}
+}
+
+#endif
@@ -76,6 +76,33 @@ template <class Payload>
 using allocation_map =
     common::allocation_map<Payload, libc_untyped_allocator>;
 
+// Size classes for small allocations that are carved from slabs.
+// Above 64 bytes, each power-of-two interval is split into four classes,
+// which bounds the internal fragmentation to 25%.
+class small_size_classes {
+public:
+  static constexpr int num_classes = 32;
+  static constexpr std::size_t max_size = 8192;
+
+  static constexpr std::size_t get_size(int size_class) {
+    if(size_class < 4)
+      return 16 * (size_class + 1);
+    int group = (size_class - 4) / 4;
+    std::size_t base = std::size_t{64} << group;
+    return base + (base / 4) * ((size_class - 4) % 4 + 1);
+  }
+
+  // size must not exceed max_size
+  static int get_class(std::size_t size) {
+    if(size <= 64)
+      return static_cast<int>((std::max(size, std::size_t{1}) + 15) / 16) - 1;
+    int group = 63 - __builtin_clzll((size - 1) >> 6);
+    std::size_t base = std::size_t{64} << group;
+    std::size_t step = base / 4;
+    return 4 + 4 * group + static_cast<int>((size - base + step - 1) / step) - 1;
+  }
+};
+
 class free_space_map {
 public:
   free_space_map(std::size_t max_assignable_space)
@@ -0,0 +1,358 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+#ifndef HIPSYCL_PSTL_MULTI_DEVICE_HPP
+#define HIPSYCL_PSTL_MULTI_DEVICE_HPP
+
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "hipSYCL/algorithms/algorithm.hpp"
+#include "hipSYCL/algorithms/numeric.hpp"
+#include "hipSYCL/algorithms/util/allocation_cache.hpp"
+#include "execution_fwd.hpp"
+#include "sycl_glue.hpp"
+
+// Multi-device variants of stdpar algorithms. If the multi_device_dispatch
+// decides to split an operation, the try_split_* functions submit it to
+// all participating devices and return true (or the result). Otherwise, they
+// submit nothing and the caller is expected to submit the operation to the
+// single_device_dispatch queue as usual.
+
+namespace hipsycl::stdpar::detail {
+
+template <class... Iterators> constexpr bool are_random_access_iterators() {
+  return (std::is_base_of_v<
+              std::random_access_iterator_tag,
+              typename std::iterator_traits<Iterators>::iterator_category> &&
+          ...);
+}
+
+template <class Policy, class F, class... Iterators>
+bool try_split(std::size_t problem_size, F &&submit_partition,
+               const Iterators &...) {
+  if(!multi_device_dispatch::is_enabled())
+    return false;
+
+  auto& dispatch = multi_device_dispatch::get();
+  if constexpr (!are_random_access_iterators<Iterators...>()) {
+    dispatch.join();
+    return false;
+  } else {
+    return dispatch.try_split(problem_size,
+                              std::is_same_v<Policy, hipsycl::stdpar::par>,
+                              submit_partition);
+  }
+}
+
+/// Like try_split() above, but for partitions that the caller has already
+/// obtained from multi_device_dispatch::get_partitions().
+template <class Policy, class F, class... Iterators>
+bool try_split(const multi_device_dispatch::partition_list &partitions,
+               F &&submit_partition, const Iterators &...) {
+  if(!multi_device_dispatch::is_enabled())
+    return false;
+
+  auto& dispatch = multi_device_dispatch::get();
+  if constexpr (!are_random_access_iterators<Iterators...>()) {
+    dispatch.join();
+    return false;
+  } else {
+    return dispatch.try_split(partitions, submit_partition);
+  }
+}
+
+using scratch_group_list =
+    std::deque<algorithms::util::allocation_group,
+               libc_allocator<algorithms::util::allocation_group>>;
+
+template <algorithms::util::allocation_type AT>
+algorithms::util::allocation_group &
+emplace_scratch_group(scratch_group_list &groups, sycl::queue &q) {
+  return groups.emplace_back(
+      &stdpar_tls_runtime::get().get_scratch_cache<AT>(),
+      q.get_device().AdaptiveCpp_device_id());
+}
+
+template <class Policy, class ForwardIt, class UnaryFunction2>
+bool try_split_for_each(ForwardIt first, ForwardIt last, UnaryFunction2 f) {
+  return try_split<Policy>(
+      std::distance(first, last),
+      [&](const multi_device_dispatch::partition &p, const auto &deps) {
+        auto partition_first = std::next(first, p.offset);
+        return algorithms::for_each(*p.queue, partition_first,
+                                    std::next(partition_first, p.size), f,
+                                    deps);
+      },
+      first);
+}
+
+template <class Policy, class ForwardIt, class Size, class UnaryFunction2>
+bool try_split_for_each_n(ForwardIt first, Size n, UnaryFunction2 f) {
+  if(n <= 0)
+    return false;
+  return try_split<Policy>(
+      static_cast<std::size_t>(n),
+      [&](const multi_device_dispatch::partition &p, const auto &deps) {
+        return algorithms::for_each_n(*p.queue, std::next(first, p.offset),
+                                      p.size, f, deps);
+      },
+      first);
+}
+
+template <class Policy, class ForwardIt1, class ForwardIt2,
+          class UnaryOperation>
+bool try_split_transform(ForwardIt1 first1, ForwardIt1 last1,
+                         ForwardIt2 d_first, UnaryOperation unary_op) {
+  return try_split<Policy>(
+      std::distance(first1, last1),
+      [&](const multi_device_dispatch::partition &p, const auto &deps) {
+        auto partition_first = std::next(first1, p.offset);
+        return algorithms::transform(*p.queue, partition_first,
+                                     std::next(partition_first, p.size),
+                                     std::next(d_first, p.offset), unary_op,
+                                     deps);
+      },
+      first1, d_first);
+}
+
+template <class Policy, class ForwardIt1, class ForwardIt2, class ForwardIt3,
+          class BinaryOperation>
+bool try_split_transform(ForwardIt1 first1, ForwardIt1 last1,
+                         ForwardIt2 first2, ForwardIt3 d_first,
+                         BinaryOperation binary_op) {
+  return try_split<Policy>(
+      std::distance(first1, last1),
+      [&](const multi_device_dispatch::partition &p, const auto &deps) {
+        auto partition_first = std::next(first1, p.offset);
+        return algorithms::transform(
+            *p.queue, partition_first, std::next(partition_first, p.size),
+            std::next(first2, p.offset), std::next(d_first, p.offset),
+            binary_op, deps);
+      },
+      first1, first2, d_first);
+}
+
+/// Computes one partial result per partition, which are combined on the host.
+///
+/// \param get_element Returns the transformed element at the given index
+/// on the host.
+/// \param submit_reduction Submits the reduction of the given range with
+/// signature (queue, scratch group, offset, size, T* out, T init, deps).
+template <class Policy, class T, class BinaryReductionOp, class GetElement,
+          class SubmitReduction, class... Iterators>
+std::optional<T> try_split_reduction(std::size_t problem_size, T init,
+                                     BinaryReductionOp reduce,
+                                     GetElement get_element,
+                                     SubmitReduction submit_reduction,
+                                     const Iterators &...iterators) {
+  if(!multi_device_dispatch::is_enabled())
+    return {};
+
+  auto& dispatch = multi_device_dispatch::get();
+  multi_device_dispatch::partition_list partitions;
+  if(are_random_access_iterators<Iterators...>())
+    partitions =
+        dispatch.get_partitions(problem_size, std::is_same_v<Policy, par>);
+  // Partitions need to read their first element on the host, which
+  // requires all previously submitted operations to have completed.
+  if(partitions.size() > 1 &&
+     stdpar_tls_runtime::get().get_num_outstanding_operations() > 0)
+    dispatch.wait();
+
+  scratch_group_list output_groups;
+  scratch_group_list scratch_groups;
+  std::vector<T*, libc_allocator<T*>> partial_results;
+
+  bool is_split = try_split<Policy>(
+      partitions,
+      [&](const multi_device_dispatch::partition &p, const auto &deps) {
+        auto &output_group =
+            emplace_scratch_group<algorithms::util::allocation_type::host>(
+                output_groups, *p.queue);
+        auto &scratch_group =
+            emplace_scratch_group<algorithms::util::allocation_type::device>(
+                scratch_groups, *p.queue);
+        T *out = output_group.obtain<T>(1);
+        partial_results.push_back(out);
+
+        if(p.offset == 0)
+          return submit_reduction(*p.queue, scratch_group, p.offset, p.size,
+                                  out, init, deps);
+        // There is no identity element for arbitrary reduction operators,
+        // so the other partitions start with their first element instead.
+        return submit_reduction(*p.queue, scratch_group, p.offset + 1,
+                                p.size - 1, out, T(get_element(p.offset)),
+                                deps);
+      },
+      iterators...);
+
+  if(!is_split)
+    return {};
+
+  dispatch.wait();
+  T result = *partial_results[0];
+  for(std::size_t i = 1; i < partial_results.size(); ++i)
+    result = reduce(result, *partial_results[i]);
+  return result;
+}
+
+template <class Policy, class ForwardIt, class T, class BinaryReductionOp,
+          class UnaryTransformOp>
+std::optional<T> try_split_transform_reduce(ForwardIt first, ForwardIt last,
+                                            T init, BinaryReductionOp reduce,
+                                            UnaryTransformOp transform) {
+  return try_split_reduction<Policy>(
+      std::distance(first, last), init, reduce,
+      [&](std::size_t i) { return transform(*std::next(first, i)); },
+      [&](sycl::queue &q, algorithms::util::allocation_group &scratch,
+          std::size_t offset, std::size_t size, T *out, T partial_init,
+          const auto &deps) {
+        auto partition_first = std::next(first, offset);
+        return algorithms::transform_reduce(
+            q, scratch, partition_first, std::next(partition_first, size), out,
+            partial_init, reduce, transform, deps);
+      },
+      first);
+}
+
+template <class Policy, class ForwardIt1, class ForwardIt2, class T,
+          class BinaryReductionOp, class BinaryTransformOp>
+std::optional<T>
+try_split_transform_reduce(ForwardIt1 first1, ForwardIt1 last1,
+                           ForwardIt2 first2, T init, BinaryReductionOp reduce,
+                           BinaryTransformOp transform) {
+  return try_split_reduction<Policy>(
+      std::distance(first1, last1), init, reduce,
+      [&](std::size_t i) {
+        return transform(*std::next(first1, i), *std::next(first2, i));
+      },
+      [&](sycl::queue &q, algorithms::util::allocation_group &scratch,
+          std::size_t offset, std::size_t size, T *out, T partial_init,
+          const auto &deps) {
+        auto partition_first = std::next(first1, offset);
+        return algorithms::transform_reduce(
+            q, scratch, partition_first, std::next(partition_first, size),
+            std::next(first2, offset), out, partial_init, reduce, transform,
+            deps);
+      },
+      first1, first2);
+}
+
+/// Scans each partition independently, and then adds the results of the
+/// preceding partitions to all partitions except the first one.
+///
+/// \param submit_scan Submits the scan of the given range with signature
+/// (queue, scratch group, offset, size, deps). It only needs to apply
+/// the initial value of the scan if offset is 0.
+template <class Policy, class OutputIt, class BinaryOp, class SubmitScan,
+          class... Iterators>
+bool try_split_inclusive_scan(std::size_t problem_size, OutputIt d_first,
+                              BinaryOp op, SubmitScan submit_scan,
+                              const Iterators &...iterators) {
+  multi_device_dispatch::partition_list partitions;
+  scratch_group_list scratch_groups;
+
+  bool is_split = try_split<Policy>(
+      problem_size,
+      [&](const multi_device_dispatch::partition &p, const auto &deps) {
+        partitions.push_back(p);
+        auto &scratch_group =
+            emplace_scratch_group<algorithms::util::allocation_type::device>(
+                scratch_groups, *p.queue);
+        return submit_scan(*p.queue, scratch_group, p.offset, p.size, deps);
+      },
+      d_first, iterators...);
+
+  if(!is_split)
+    return false;
+
+  auto& dispatch = multi_device_dispatch::get();
+  dispatch.wait();
+
+  using value_type = typename std::iterator_traits<OutputIt>::value_type;
+  std::vector<value_type, libc_allocator<value_type>> carries;
+  std::optional<value_type> carry;
+  for(const auto& p : partitions) {
+    value_type partition_result = *std::next(d_first, p.offset + p.size - 1);
+    carry = carry.has_value() ? value_type(op(carry.value(), partition_result))
+                              : partition_result;
+    carries.push_back(carry.value());
+  }
+
+  multi_device_dispatch::partition_list fixup_partitions{
+      std::next(partitions.begin()), partitions.end()};
+  dispatch.submit_partitions(
+      fixup_partitions,
+      [&](const multi_device_dispatch::partition &p, const auto &deps) {
+        // Partitions are ordered, and fixup_partitions starts with the
+        // second partition
+        std::size_t partition_index = &p - fixup_partitions.data() + 1;
+        value_type previous_result = carries[partition_index - 1];
+        auto partition_first = std::next(d_first, p.offset);
+        return algorithms::for_each(
+            *p.queue, partition_first, std::next(partition_first, p.size),
+            [=](auto &x) { x = op(previous_result, x); }, deps);
+      });
+  return true;
+}
+
+template <class Policy, class InputIt, class OutputIt, class BinaryOp,
+          class... T>
+bool try_split_inclusive_scan(InputIt first, InputIt last, OutputIt d_first,
+                              BinaryOp op, const T &...init) {
+  return try_split_inclusive_scan<Policy>(
+      std::distance(first, last), d_first, op,
+      [&](sycl::queue &q, algorithms::util::allocation_group &scratch,
+          std::size_t offset, std::size_t size, const auto &deps) {
+        auto partition_first = std::next(first, offset);
+        auto partition_last = std::next(partition_first, size);
+        auto partition_d_first = std::next(d_first, offset);
+        if(offset == 0)
+          return algorithms::inclusive_scan(q, scratch, partition_first,
+                                            partition_last, partition_d_first,
+                                            op, init..., deps);
+        return algorithms::inclusive_scan(q, scratch, partition_first,
+                                          partition_last, partition_d_first,
+                                          op, deps);
+      },
+      first);
+}
+
+template <class Policy, class InputIt, class OutputIt, class BinaryOp,
+          class UnaryOp, class... T>
+bool try_split_transform_inclusive_scan(InputIt first, InputIt last,
+                                        OutputIt d_first, BinaryOp binary_op,
+                                        UnaryOp unary_op, const T &...init) {
+  return try_split_inclusive_scan<Policy>(
+      std::distance(first, last), d_first, binary_op,
+      [&](sycl::queue &q, algorithms::util::allocation_group &scratch,
+          std::size_t offset, std::size_t size, const auto &deps) {
+        auto partition_first = std::next(first, offset);
+        auto partition_last = std::next(partition_first, size);
+        auto partition_d_first = std::next(d_first, offset);
+        if(offset == 0)
+          return algorithms::transform_inclusive_scan(
+              q, scratch, partition_first, partition_last, partition_d_first,
+              binary_op, unary_op, init..., deps);
+        return algorithms::transform_inclusive_scan(
+            q, scratch, partition_first, partition_last, partition_d_first,
+            binary_op, unary_op, deps);
+      },
+      first);
+}
+
+} // namespace hipsycl::stdpar::detail
+
+#endif
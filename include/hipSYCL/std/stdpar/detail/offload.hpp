@@ -178,12 +178,38 @@ inline void prefetch(sycl::queue& q, const void* ptr, std::size_t bytes) noexcep
   }
 }
 
+template <class AlgorithmCategory>
+constexpr bool is_multi_device_splittable() {
+  namespace category = algorithm_category;
+  return std::is_same_v<AlgorithmCategory, category::for_each> ||
+         std::is_same_v<AlgorithmCategory, category::for_each_n> ||
+         std::is_same_v<AlgorithmCategory, category::transform> ||
+         std::is_same_v<AlgorithmCategory, category::reduce> ||
+         std::is_same_v<AlgorithmCategory, category::transform_reduce> ||
+         std::is_same_v<AlgorithmCategory, category::inclusive_scan> ||
+         std::is_same_v<AlgorithmCategory, category::transform_inclusive_scan>;
+}
+
 template<class AlgorithmType, class Size, typename... Args>
 void prepare_offloading(AlgorithmType type, Size problem_size, const Args&... args) {
   auto& q = detail::single_device_dispatch::get_queue();
   std::size_t current_batch_id = stdpar::detail::stdpar_tls_runtime::get()
                                      .get_current_offloading_batch_id();
 
+  if (multi_device_dispatch::is_enabled() &&
+      multi_device_dispatch::get().get_num_devices() > 1) {
+    if constexpr (is_multi_device_splittable<
+                      typename AlgorithmType::algorithm_category>()) {
+      // The operation is distributed across devices if it is large enough,
+      // so prefetching all data to a single device would be
+      // counterproductive. The multi_device_dispatch takes care of
+      // dependencies in any case.
+      return;
+    } else {
+      multi_device_dispatch::get().join();
+    }
+  }
+
 #ifndef __ACPP_STDPAR_ASSUME_SYSTEM_USM__
   // Use "first" mode in case of automatic prefetch decision for now
   const auto prefetch_mode =
@@ -14,15 +14,18 @@
 #include <cstddef>
 #include <cstdint>
 #include <limits>
-#include <sstream>
 #include <typeinfo>
 #include <unordered_map>
-#include <fstream>
 #include <optional>
 #include <memory>
 #include <vector>
+#include <map>
 #include <mutex>
+#include <iterator>
+#include <algorithm>
 #include "hipSYCL/runtime/settings.hpp"
+#include "hipSYCL/common/appdb.hpp"
+#include "hipSYCL/common/filesystem.hpp"
 #include "hipSYCL/std/stdpar/detail/allocation_map.hpp"
 #include "hipSYCL/common/stable_running_hash.hpp"
 
@@ -76,156 +79,196 @@ using host_malloc_unordered_map =
     std::unordered_map<K, V, std::hash<K>, std::equal_to<K>,
                        libc_allocator<std::pair<const K, V>>>;
 
-class offload_heuristic_db_storage {
+// Piecewise-linear model of the runtime of an operation on one device
+// as a function of the problem size. Measurements are aggregated in
+// problem size buckets, with four buckets per power of two. Runtimes for
+// problem sizes between buckets are interpolated linearly, and runtimes
+// outside of the sampled range are extrapolated.
+class runtime_model {
 public:
+  using sample = common::db::stdpar_sample;
+  using sample_map =
+      std::map<uint64_t, sample, std::less<uint64_t>,
+               libc_allocator<std::pair<const uint64_t, sample>>>;
+
+  static uint64_t get_bucket(uint64_t problem_size) {
+    if(problem_size < 8)
+      return problem_size;
+    // Keep the three most significant bits
+    int shift = 61 - __builtin_clzll(problem_size);
+    return (problem_size >> shift) << shift;
+  }
 
-  static std::shared_ptr<offload_heuristic_db_storage> get() {
-    static std::shared_ptr<offload_heuristic_db_storage> instance =
-        std::make_shared<offload_heuristic_db_storage>();
-    return instance;
+  void add_sample(uint64_t problem_size, uint64_t runtime) {
+    sample& s = _samples[get_bucket(problem_size)];
+    s.total_problem_size += problem_size;
+    s.total_runtime += runtime;
+    ++s.num_samples;
   }
 
-  offload_heuristic_db_storage() {
-    std::fstream f{get_dataset_filename().c_str(), std::ios::in};
-    if(f.is_open()) {
-      std::string line;
-      while(std::getline(f, line)) {
-        std::stringstream sstr{line};
-        uint64_t hash;
-        entry e;
-        sstr >> hash;
-        e.read(sstr);
-
-        _entries[hash] = e;
-      } 
+  // Accepts any map from bucket to sample, in particular those of the appdb
+  template<class SampleMap>
+  void add_samples(const SampleMap& samples) {
+    for(const auto& entry : samples) {
+      sample& s = _samples[entry.first];
+      s.total_problem_size += entry.second.total_problem_size;
+      s.total_runtime += entry.second.total_runtime;
+      s.num_samples += entry.second.num_samples;
     }
   }
 
-  ~offload_heuristic_db_storage() {
-    std::fstream f{get_dataset_filename().c_str(),
-                   std::ios::out | std::ios::trunc};
-    for (const auto &entry : _entries) {
-      f << entry.first << " ";
-      entry.second.write(f);
-      f << "\n";
-    }
+  const sample_map& get_samples() const {
+    return _samples;
   }
 
-  using device_t = int;
+  // Returns 0 if there are no samples
+  double estimate_runtime(uint64_t problem_size) const {
+    if(_samples.empty())
+      return 0.0;
 
-  struct device_entry {
-    device_t dev;
-    uint64_t problem_size;
-    double runtime = std::numeric_limits<double>::max();
-    uint64_t num_samples = 0;
-
-    void merge(const device_entry& other) {
-      if(dev == other.dev && problem_size == other.problem_size) {
-        uint64_t aggregated_num_samples = num_samples + other.num_samples;
-        runtime = (num_samples * runtime + other.num_samples * other.runtime) /
-                  aggregated_num_samples;
-        num_samples = aggregated_num_samples;
-      }
+    const double x = static_cast<double>(problem_size);
+    auto get_x = [](const sample &s) {
+      return static_cast<double>(s.total_problem_size) / s.num_samples;
+    };
+    auto get_y = [](const sample &s) {
+      return static_cast<double>(s.total_runtime) / s.num_samples;
+    };
+    auto interpolate = [&](const sample& a, const sample& b) {
+      double delta_x = get_x(b) - get_x(a);
+      if(delta_x <= 0.0)
+        return get_y(a);
+      return get_y(a) + (get_y(b) - get_y(a)) / delta_x * (x - get_x(a));
+    };
+
+    // Buckets are ordered, and so are the mean problem sizes within them
+    auto upper = _samples.begin();
+    while(upper != _samples.end() && get_x(upper->second) < x)
+      ++upper;
+
+    double result = 0.0;
+    if(_samples.size() == 1) {
+      // Assume that the runtime is proportional to the problem size
+      const sample& s = _samples.begin()->second;
+      result = get_x(s) > 0.0 ? get_y(s) * x / get_x(s) : get_y(s);
+    } else if(upper == _samples.begin()) {
+      const sample& first = upper->second;
+      const sample& second = std::next(upper)->second;
+      // Extrapolation towards small problem sizes can become negative
+      // if the runtime is not linear in the problem size.
+      result = std::max(interpolate(first, second),
+                        get_x(first) > 0.0 ? get_y(first) * x / get_x(first)
+                                           : get_y(first));
+    } else if(upper == _samples.end()) {
+      const sample& last = std::prev(upper)->second;
+      const sample& second_to_last = std::prev(upper, 2)->second;
+      result = std::max(interpolate(second_to_last, last), get_y(last));
+    } else {
+      result = interpolate(std::prev(upper)->second, upper->second);
     }
+    // A result of 0 is interpreted as "couldn't estimate". Here however we
+    // could estimate, but the estimate is just too low due to inaccuracies.
+    // So we just return a value that is smaller than the measurement accuracy.
+    if(result <= 0.0)
+      return 1.e-20;
+    return result;
+  }
+private:
+  sample_map _samples;
+};
 
-    bool is_sampled() const {
-      return runtime < std::numeric_limits<double>::max();
-    }
+class offload_heuristic_db_storage {
+public:
+  using device_t = int;
+  static constexpr device_t host_device_id = -1;
+  static constexpr device_t offload_device_id = 0;
 
-    friend std::istream& operator>>(std::istream& in, device_entry& entry) {
-      in >> entry.dev;
-      in >> entry.problem_size;
-      in >> entry.runtime;
-      in >> entry.num_samples;
+  struct entry {
+    runtime_model host_model;
+    runtime_model offload_model;
 
-      return in;
+    runtime_model& get_model(device_t dev) {
+      return dev == host_device_id ? host_model : offload_model;
     }
 
-    friend std::ostream& operator<<(std::ostream& out, const device_entry& entry) {
-      out << entry.dev << " ";
-      out << entry.problem_size << " ";
-      out << entry.runtime << " ";
-      out << entry.num_samples << " ";
-
-      return out;
+    const runtime_model& get_model(device_t dev) const {
+      return dev == host_device_id ? host_model : offload_model;
     }
-  };
-
-  struct entry {
-    
-    std::vector<device_entry, libc_allocator<device_entry>> entries;
 
     void merge(const entry& other) {
-      auto merge_or_insert = [this](auto& other_entry){
-        for(auto& own_entry : entries) {
-          if (own_entry.dev == other_entry.dev &&
-              own_entry.problem_size == other_entry.problem_size) {
-            own_entry.merge(other_entry);
-            return;
-          }
-        }
-        entries.push_back(other_entry);
-      };
-
-      
-      for(auto& other_entry: other.entries) {
-        merge_or_insert(other_entry);  
-      }
+      host_model.add_samples(other.host_model.get_samples());
+      offload_model.add_samples(other.offload_model.get_samples());
     }
+  };
 
-    void read(std::istream& istr) {
-      
-      int num_entries = 0;
-      istr >> num_entries;
-      for(int i = 0; i < num_entries; ++i) {
-        device_entry dev_entry;
-        istr >> dev_entry;
-        entries.push_back(dev_entry);
-      }
-    }
+  using entry_map = host_malloc_unordered_map<uint64_t, entry>;
 
-    void write(std::ostream& ostr) const {
-      
-      ostr << entries.size() << " ";
-      for(const auto &entry : entries)
-        ostr << entry << " ";
-    }
-  };
+  static std::shared_ptr<offload_heuristic_db_storage> get() {
+    static std::shared_ptr<offload_heuristic_db_storage> instance =
+        std::make_shared<offload_heuristic_db_storage>();
+    return instance;
+  }
 
+  // Measurements are stored in the application database, which takes care
+  // of merging the measurements of concurrent processes.
+  offload_heuristic_db_storage()
+      : _dataset_name{get_dataset_name()},
+        _appdb{common::filesystem::persistent_storage::get().get_this_app_db()} {
+    _appdb.read_access([&](const common::db::appdb_data& data) {
+      auto dataset = data.stdpar_datasets.find(_dataset_name);
+      if(dataset == data.stdpar_datasets.end())
+        return;
+      for(const auto& op : dataset->second.ops) {
+        entry& e = _entries[op.first];
+        e.host_model.add_samples(op.second.host_samples);
+        e.offload_model.add_samples(op.second.offload_samples);
+      }
+    });
+  }
 
   auto get_entries() const {
     std::lock_guard<std::mutex> lock{_lock};
     return _entries;
   }
 
-  void update_entry_map(const host_malloc_unordered_map<uint64_t, entry>& entry_map) {
+  // Adds new measurements, which are not yet part of the entries
+  void add_measurements(const entry_map& new_entries) {
+    if(new_entries.empty())
+      return;
+
     std::lock_guard<std::mutex> lock{_lock};
-    for(const auto& e : entry_map) {
-      auto it = _entries.find(e.first);
-      if(it == _entries.end()) {
-        _entries[e.first] = e.second;
-      } else {
-        auto& own_entry = it->second;
-        own_entry.merge(e.second);
+    for(const auto& e : new_entries)
+      _entries[e.first].merge(e.second);
+
+    _appdb.read_write_access([&](common::db::appdb_data& data) {
+      auto& dataset = data.stdpar_datasets[_dataset_name];
+      auto add_samples = [](auto& target, const runtime_model& model) {
+        for(const auto& s : model.get_samples()) {
+          auto& sample = target[s.first];
+          sample.total_problem_size += s.second.total_problem_size;
+          sample.total_runtime += s.second.total_runtime;
+          sample.num_samples += s.second.num_samples;
+        }
+      };
+      for(const auto& e : new_entries) {
+        auto& op = dataset.ops[e.first];
+        add_samples(op.host_samples, e.second.host_model);
+        add_samples(op.offload_samples, e.second.offload_model);
       }
-    }
-  }
-  
-private:
-
-  static std::string get_dataset_filename() {
-    return ".acpp-stdpar-"+get_dataset_name();
+    });
   }
 
+private:
   static std::string get_dataset_name() {
     std::string dataset_name;
     if(rt::try_get_environment_variable("stdpar_dataset_name", dataset_name)) {
       return dataset_name;
     }
-    return ".acpp-stdpar-profile";
+    return "default";
   }
 
-  host_malloc_unordered_map<uint64_t, entry> _entries;
+  std::string _dataset_name;
+  common::db::appdb& _appdb;
+  entry_map _entries;
   mutable std::mutex _lock;
 };
 
@@ -237,84 +280,21 @@ public:
   }
 
   ~offload_heuristic_db() {
-    _storage->update_entry_map(_entries);
+    _storage->add_measurements(_new_entries);
   }
 
   using device_t = offload_heuristic_db_storage::device_t;
-  static constexpr device_t host_device_id = -1;
-  static constexpr device_t offload_device_id = 0;
+  static constexpr device_t host_device_id =
+      offload_heuristic_db_storage::host_device_id;
+  static constexpr device_t offload_device_id =
+      offload_heuristic_db_storage::offload_device_id;
 
+  // Returns 0 if there is no data for the operation
   double estimate_runtime(uint64_t op_hash, std::size_t problem_size, device_t dev) const {
     auto it = _entries.find(op_hash);
     if(it == _entries.end())
       return 0.0;
-
-    // We attempt to find the closest measurements around the requested problem size,
-    // and then interpolate linearly.
-
-    // First find closest sampling point
-    int64_t delta = std::numeric_limits<int>::max();
-    std::size_t closest_problem_size = 0;
-    double closest_runtime = 0.0;
-    for(auto& e : it->second.entries) {
-      if(e.dev == dev) {
-        // If we find the required problem size exactly, we can just return it.
-        if(e.problem_size == problem_size)
-          return e.runtime;
-
-        int64_t current_delta = std::abs((int64_t)e.problem_size - (int64_t)problem_size);
-        if(current_delta < delta) {
-          delta = current_delta;
-          closest_problem_size = e.problem_size;
-          closest_runtime = e.runtime;
-        }
-      }
-    }
-    // Find 2nd closest sampling point
-    delta = std::numeric_limits<int>::max();
-    std::size_t closest_problem_size2 = 0;
-    double closest_runtime2 = 0.0;
-    for(auto& e : it->second.entries) {
-      if(e.dev == dev) {
-        int64_t current_delta = std::abs((int64_t)e.problem_size - (int64_t)problem_size);
-        if(current_delta < delta && e.problem_size != closest_problem_size) {
-          delta = current_delta;
-          closest_problem_size2 = e.problem_size;
-          closest_runtime2 = e.runtime;
-        }
-      }
-    }
-
-    if(closest_problem_size2 < closest_problem_size) {
-      std::swap(closest_problem_size, closest_problem_size2);
-      std::swap(closest_runtime, closest_runtime2);
-    }
-
-    
-    double runtime_lower = closest_runtime;
-    double runtime_upper = closest_runtime2;
-    std::size_t problem_size_lower = closest_problem_size;
-    std::size_t problem_size_upper = closest_problem_size2;
-
-    // If we have neither, then both lower bound and upper bound problem size might still be 0.
-    // We need to catch this case to avoid division by zero.
-    if(problem_size_lower == problem_size_upper) {
-      return 0.0;
-    }
-
-    double delta_x = problem_size_upper - problem_size_lower;
-    double delta_y = runtime_upper - runtime_lower;
-    
-    double m = delta_y / delta_x;
-
-    double result = m * (problem_size - problem_size_lower) + runtime_lower;
-    // If the interpolation results in a negative value, we cannot just return 0, as this
-    // is generally interpreted as "couldn't estimate". In this case however, we could estimate,
-    // but the estimate is just too low due to inaccuracies. So we just return a value that
-    // is smaller than the measurement accuracy.
-    if(result <= 0.0)
-      return 1.e-20;
-    return result;
+    return it->second.get_model(dev).estimate_runtime(problem_size);
   }
 
   void update_entry(uint64_t op_hash, std::size_t problem_size, device_t dev, double runtime) {
@@ -329,25 +309,17 @@ public:
       ++op_invocation_count;
     }
 
-    auto& e = _entries[op_hash];
-
-    offload_heuristic_db_storage::device_entry d_entry {dev, problem_size, runtime, 1};
-    
-    for(auto& measurement_entry : e.entries) {
-      if(measurement_entry.dev == dev && measurement_entry.problem_size == problem_size) {
-        measurement_entry.merge(d_entry);
-        return;
-      }
-    }
-
-    e.entries.push_back(d_entry);
+    uint64_t runtime_ns = static_cast<uint64_t>(runtime);
+    _entries[op_hash].get_model(dev).add_sample(problem_size, runtime_ns);
+    _new_entries[op_hash].get_model(dev).add_sample(problem_size, runtime_ns);
   }
 
 
 private:
   std::shared_ptr<offload_heuristic_db_storage> _storage;
-  host_malloc_unordered_map<uint64_t, offload_heuristic_db_storage::entry>
-      _entries;
+  offload_heuristic_db_storage::entry_map _entries;
+  // Measurements of this thread that have not been passed to the storage yet
+  offload_heuristic_db_storage::entry_map _new_entries;
   host_malloc_unordered_map<uint64_t, uint64_t> _kernel_invocation_counts;
 };
 
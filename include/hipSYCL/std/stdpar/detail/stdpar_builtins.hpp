@@ -20,7 +20,10 @@ inline void __acpp_stdpar_barrier() noexcept {
   if(num_ops > 0) {
     HIPSYCL_DEBUG_INFO << "[stdpar] Initializing wait for " << num_ops
                        << " operations" << std::endl;
-    rt.get_queue().wait();
+    if(hipsycl::stdpar::detail::multi_device_dispatch::is_enabled())
+      hipsycl::stdpar::detail::multi_device_dispatch::get().wait();
+    else
+      rt.get_queue().wait();
     rt.finalize_offloading_batch();
   }
 }
@@ -14,10 +14,14 @@
 
 
 
+#include <array>
 #include <atomic>
 #include <cstdint>
 #include <cstdlib>
+#include <mutex>
 #include <new>
+#include <thread>
+#include <vector>
 #include <unistd.h>
 
 #include <hipSYCL/algorithms/util/allocation_cache.hpp>
@@ -32,6 +36,7 @@
 
 
 #include "allocation_map.hpp"
+#include "hipSYCL/common/intrusive_free_list.hpp"
 #include "hipSYCL/runtime/application.hpp"
 #include "offload_heuristic_db.hpp"
 #include "hipSYCL/runtime/settings.hpp"
@@ -57,6 +62,21 @@ inline sycl::queue construct_default_queue() {
         hipsycl::sycl::property::queue::AdaptiveCpp_coarse_grained_events{}}};
 }
 
+inline sycl::queue construct_default_queue(const sycl::device& dev) {
+  return sycl::queue{dev, hipsycl::sycl::property_list{
+        hipsycl::sycl::property::queue::in_order{},
+        hipsycl::sycl::property::queue::AdaptiveCpp_coarse_grained_events{}}};
+}
+
+inline bool has_independent_work_item_forward_progress(sycl::queue& q) {
+  auto dev = q.get_device().AdaptiveCpp_device_id();
+  auto* be = q.get_context().AdaptiveCpp_runtime()->backends().get(
+      dev.get_backend());
+  return be->get_hardware_manager()
+      ->get_device(dev.get_id())
+      ->has(rt::device_support_aspect::work_item_independent_forward_progress);
+}
+
 class stdpar_tls_runtime {
 private:
   stdpar_tls_runtime()
@@ -64,14 +84,8 @@ private:
         _device_scratch_cache{algorithms::util::allocation_type::device},
         _shared_scratch_cache{algorithms::util::allocation_type::shared},
         _host_scratch_cache{algorithms::util::allocation_type::host} {
-          auto dev = _queue.get_device().AdaptiveCpp_device_id();
-          auto* be = _queue.get_context().AdaptiveCpp_runtime()->backends().get(
-              dev.get_backend());
-          if (be->get_hardware_manager()
-                  ->get_device(dev.get_id())
-                  ->has(rt::device_support_aspect::
-                            work_item_independent_forward_progress))
-            _has_independent_work_item_forward_progress = true;
+          _has_independent_work_item_forward_progress =
+              has_independent_work_item_forward_progress(_queue);
         }
 
   ~stdpar_tls_runtime() {
@@ -139,18 +153,48 @@ public:
   void finalize_offloading_batch() noexcept {
 #ifndef __ACPP_STDPAR_UNCONDITIONAL_OFFLOAD__
     uint64_t batch_end = get_time_now();
-    double mean_time = static_cast<double>(batch_end - _batch_start_timestamp) /
-                       _instrumented_ops_in_batch.size();
+    double batch_time = static_cast<double>(batch_end - _batch_start_timestamp);
     
     assert(_instrumented_ops_in_batch.size() ==
            _instrumented_op_problem_sizes_in_batch.size());
-    
-    for(std::size_t i = 0; i < _instrumented_ops_in_batch.size(); ++i) {
-      std::size_t problem_size = _instrumented_op_problem_sizes_in_batch[i];
-      _offload_db.update_entry(_instrumented_ops_in_batch[i], problem_size,
+
+    // Operations within a batch run asynchronously, so only the time of the
+    // whole batch can be measured. Attribute it to the individual operations
+    // according to their relative weight, which is their current runtime
+    // estimate, or their problem size if not all of them can be estimated yet.
+    const std::size_t num_ops = _instrumented_ops_in_batch.size();
+    std::vector<double, libc_allocator<double>> weights(num_ops);
+    auto compute_weights = [&](auto get_weight) {
+      double total = 0.0;
+      for(std::size_t i = 0; i < num_ops; ++i) {
+        weights[i] = get_weight(i);
+        if(weights[i] <= 0.0)
+          return 0.0;
+        total += weights[i];
+      }
+      return total;
+    };
+
+    double total_weight = compute_weights([&](std::size_t i) {
+      return _offload_db.estimate_runtime(
+          _instrumented_ops_in_batch[i],
+          _instrumented_op_problem_sizes_in_batch[i],
+          offload_heuristic_db::offload_device_id);
+    });
+    if(total_weight <= 0.0)
+      total_weight = compute_weights([&](std::size_t i) {
+        return static_cast<double>(_instrumented_op_problem_sizes_in_batch[i]);
+      });
+    if(total_weight <= 0.0)
+      total_weight = compute_weights([](std::size_t) { return 1.0; });
+
+    for(std::size_t i = 0; i < num_ops; ++i) {
+      _offload_db.update_entry(_instrumented_ops_in_batch[i],
+                               _instrumented_op_problem_sizes_in_batch[i],
                                offload_heuristic_db::offload_device_id,
-                               mean_time);
+                               batch_time * weights[i] / total_weight);
     }
+
     _instrumented_ops_in_batch.clear();
     _instrumented_op_problem_sizes_in_batch.clear();
 #endif
@@ -170,9 +214,14 @@ public:
 
   template<algorithms::util::allocation_type AT>
   algorithms::util::allocation_group make_scratch_group() {
+    return make_scratch_group<AT>(
+        get_queue().get_device().AdaptiveCpp_device_id());
+  }
+
+  template<algorithms::util::allocation_type AT>
+  algorithms::util::allocation_group make_scratch_group(rt::device_id dev) {
     algorithms::util::allocation_cache& cache = get_scratch_cache<AT>();
-    return algorithms::util::allocation_group{
-        &cache, get_queue().get_device().AdaptiveCpp_device_id()};
+    return algorithms::util::allocation_group{&cache, dev};
   }
 
   static stdpar_tls_runtime& get() {
@@ -188,6 +237,352 @@ public:
   }
 };
 
+/// Distributes data-parallel operations across all devices that can access
+/// the memory of the single_device_dispatch queue, if enabled using
+/// ACPP_STDPAR_MULTI_DEVICE. The problem is partitioned proportionally to
+/// the throughput that was measured for each device in previous operations.
+///
+/// Since the devices have their own in-order queues, partitions of an
+/// operation depend on all outstanding work of the other devices. Operations
+/// that are not split must call join() before submitting to the
+/// single_device_dispatch queue.
+class multi_device_dispatch {
+public:
+  struct partition {
+    sycl::queue* queue;
+    std::size_t device_index;
+    std::size_t offset;
+    std::size_t size;
+  };
+
+  using partition_list =
+      std::vector<partition, libc_allocator<partition>>;
+
+  // Smaller partitions are not worth the overhead of an additional
+  // kernel launch and synchronization
+  static constexpr std::size_t min_partition_size = 1 << 16;
+
+  static bool is_enabled() {
+    static bool is_enabled = [](){
+      bool enabled = false;
+      if(!rt::try_get_environment_variable("stdpar_multi_device", enabled))
+        return false;
+      return enabled;
+    }();
+    return is_enabled;
+  }
+
+  static multi_device_dispatch& get() {
+    static thread_local multi_device_dispatch dispatch;
+    return dispatch;
+  }
+
+  std::size_t get_num_devices() const {
+    return _devices.size();
+  }
+
+  /// Partitions a problem across the devices proportionally to their
+  /// throughput. Returns less than two partitions if the operation
+  /// should not be split.
+  partition_list get_partitions(std::size_t problem_size,
+                                bool requires_forward_progress);
+
+  /// Submits an operation with the given problem size in partitions,
+  /// by invoking submit_partition(const partition&, const
+  /// std::vector<sycl::event>& dependencies) for each partition. It must
+  /// return the event of the last operation that it has submitted.
+  ///
+  /// Returns false without submitting anything if the operation should
+  /// not be split. The caller then needs to submit it to the
+  /// single_device_dispatch queue instead.
+  template <class F>
+  bool try_split(std::size_t problem_size, bool requires_forward_progress,
+                 F &&submit_partition) {
+    partition_list partitions;
+    if(is_enabled())
+      partitions = get_partitions(problem_size, requires_forward_progress);
+    return try_split(partitions, submit_partition);
+  }
+
+  /// Like try_split() above, but for partitions that the caller has already
+  /// obtained from get_partitions().
+  template <class F>
+  bool try_split(const partition_list &partitions, F &&submit_partition) {
+    if(partitions.size() < 2) {
+      join();
+      return false;
+    }
+    submit_partitions(partitions, submit_partition);
+    HIPSYCL_DEBUG_INFO << "[stdpar] Split operation of size "
+                       << partitions.back().offset + partitions.back().size
+                       << " into " << partitions.size() << " partitions"
+                       << std::endl;
+    return true;
+  }
+
+  /// Submits work for the given partitions, which can e.g. be used to
+  /// process the results of a previous split operation on the same devices.
+  template <class F>
+  void submit_partitions(const partition_list &partitions,
+                         F &&submit_partition) {
+    if(!has_outstanding_partitions())
+      _start_timestamp = get_time_now();
+
+    std::vector<sycl::event, libc_allocator<sycl::event>> tails;
+    for(std::size_t i = 0; i < _devices.size(); ++i)
+      tails.push_back(get_tail(i));
+
+    for(const partition& p : partitions) {
+      std::vector<sycl::event> dependencies;
+      for(std::size_t i = 0; i < tails.size(); ++i)
+        if(i != p.device_index && has_outstanding_work(i))
+          dependencies.push_back(tails[i]);
+
+      if(!dependencies.empty())
+        _has_cross_device_dependencies = true;
+
+      device_state& dev = _devices[p.device_index];
+      sycl::event evt = submit_partition(p, dependencies);
+      dev.last_event = evt;
+      dev.outstanding_work += p.size;
+      dev.has_outstanding_partitions = true;
+      if(p.device_index != 0)
+        dev.is_joined = false;
+    }
+  }
+
+  /// Ensures that subsequent operations submitted to the
+  /// single_device_dispatch queue wait for the outstanding partitions
+  /// of other devices.
+  void join() {
+    std::vector<sycl::event> dependencies;
+    for(std::size_t i = 1; i < _devices.size(); ++i) {
+      if(_devices[i].has_outstanding_partitions && !_devices[i].is_joined) {
+        dependencies.push_back(_devices[i].last_event);
+        _devices[i].is_joined = true;
+      }
+    }
+    if(!dependencies.empty())
+      // Effectively an asynchronous barrier
+      _devices[0].queue.AdaptiveCpp_enqueue_custom_operation([](auto &) {},
+                                                             dependencies);
+  }
+
+  /// Waits for all devices, and updates the throughput estimates of
+  /// devices that have processed partitions.
+  void wait() {
+    if(has_outstanding_partitions()) {
+      // Partitions that depend on other devices may not have been
+      // submitted yet, and polling their status does not flush the DAG.
+      rt::runtime_keep_alive_token requires_runtime;
+      requires_runtime.get()->dag().flush_sync();
+
+      std::vector<uint64_t, libc_allocator<uint64_t>> completion_timestamps(
+          _devices.size(), 0);
+      // Poll instead of waiting for one device after another, so that we
+      // know when each of them has completed its work.
+      std::size_t num_remaining = 0;
+      for(const auto& dev : _devices)
+        if(dev.has_outstanding_partitions)
+          ++num_remaining;
+      while(num_remaining > 0) {
+        for(std::size_t i = 0; i < _devices.size(); ++i) {
+          device_state& dev = _devices[i];
+          if(dev.has_outstanding_partitions && completion_timestamps[i] == 0 &&
+             dev.last_event.get_info<
+                 sycl::info::event::command_execution_status>() ==
+                 sycl::info::event_command_status::complete) {
+            completion_timestamps[i] = get_time_now();
+            --num_remaining;
+          }
+        }
+        if(num_remaining > 0)
+          std::this_thread::yield();
+      }
+
+      for(std::size_t i = 0; i < _devices.size(); ++i) {
+        device_state& dev = _devices[i];
+        // If devices have waited for each other, they complete at roughly
+        // the same time regardless of their throughput.
+        if(dev.has_outstanding_partitions && !_has_cross_device_dependencies)
+          update_throughput(dev, completion_timestamps[i] - _start_timestamp);
+        dev.outstanding_work = 0;
+        dev.has_outstanding_partitions = false;
+        dev.is_joined = true;
+      }
+      _has_cross_device_dependencies = false;
+    }
+    for(auto& dev : _devices)
+      dev.queue.wait();
+  }
+
+private:
+  struct device_state {
+    sycl::queue queue;
+    bool has_independent_forward_progress = false;
+    // Measured number of elements processed per ns
+    double throughput = 0.0;
+    bool was_measured = false;
+
+    sycl::event last_event;
+    // Number of elements of partitions since the last wait()
+    std::size_t outstanding_work = 0;
+    bool has_outstanding_partitions = false;
+    // Whether the single_device_dispatch queue already waits for last_event
+    bool is_joined = true;
+  };
+
+  multi_device_dispatch() {
+    sycl::queue& primary = single_device_dispatch::get_queue();
+    add_device(primary);
+    if(!is_enabled())
+      return;
+
+    sycl::device primary_device = primary.get_device();
+    for(const sycl::device& dev : sycl::device::get_devices()) {
+      if(dev == primary_device)
+        continue;
+#ifndef __ACPP_STDPAR_ASSUME_SYSTEM_USM__
+      // Shared allocations are accessible by devices of the same backend,
+      // and by the host.
+      if(dev.get_backend() != primary_device.get_backend() && !dev.is_cpu())
+        continue;
+#endif
+      sycl::queue q = construct_default_queue(dev);
+      add_device(q);
+    }
+    HIPSYCL_DEBUG_INFO << "[stdpar] Multi-device dispatch across "
+                       << _devices.size() << " devices" << std::endl;
+  }
+
+  void add_device(sycl::queue& q) {
+    device_state dev{q};
+    dev.has_independent_forward_progress =
+        has_independent_work_item_forward_progress(q);
+    _devices.push_back(dev);
+  }
+
+  bool has_outstanding_partitions() const {
+    for(const auto& dev : _devices)
+      if(dev.has_outstanding_partitions)
+        return true;
+    return false;
+  }
+
+  bool has_outstanding_work(std::size_t device_index) const {
+    if(device_index == 0)
+      // The single_device_dispatch queue may also process operations
+      // that were not split
+      return _devices[0].has_outstanding_partitions ||
+             stdpar_tls_runtime::get().get_num_outstanding_operations() > 0;
+    return _devices[device_index].has_outstanding_partitions;
+  }
+
+  sycl::event get_tail(std::size_t device_index) {
+    if(!has_outstanding_work(device_index))
+      return sycl::event{};
+    if(device_index == 0) {
+      auto wait_list = _devices[0].queue.get_wait_list();
+      return wait_list.empty() ? sycl::event{} : wait_list.back();
+    }
+    return _devices[device_index].last_event;
+  }
+
+  static void update_throughput(device_state& dev, uint64_t elapsed_time) {
+    // Measurements of very short durations are dominated by noise
+    if(dev.outstanding_work == 0 || elapsed_time < 1000)
+      return;
+    double measured =
+        static_cast<double>(dev.outstanding_work) / elapsed_time;
+    if(!dev.was_measured)
+      dev.throughput = measured;
+    else
+      dev.throughput = 0.5 * dev.throughput + 0.5 * measured;
+    dev.was_measured = true;
+  }
+
+  std::vector<device_state, libc_allocator<device_state>> _devices;
+  // Time of the first partition submission since the last wait()
+  uint64_t _start_timestamp = 0;
+  // Whether partitions since the last wait() depend on other devices
+  bool _has_cross_device_dependencies = false;
+};
+
+inline multi_device_dispatch::partition_list
+multi_device_dispatch::get_partitions(std::size_t problem_size,
+                                      bool requires_forward_progress) {
+  std::vector<char, libc_allocator<char>> is_used(_devices.size(), false);
+  std::vector<double, libc_allocator<double>> throughput(_devices.size(),
+                                                         1.0);
+  // Devices that have not been measured yet are assumed to be as fast
+  // as the average of the measured ones
+  double measured_throughput = 0.0;
+  std::size_t num_measured = 0;
+  for(const auto& dev : _devices) {
+    if(dev.was_measured) {
+      measured_throughput += dev.throughput;
+      ++num_measured;
+    }
+  }
+  for(std::size_t i = 0; i < _devices.size(); ++i) {
+    is_used[i] = !requires_forward_progress ||
+                 _devices[i].has_independent_forward_progress;
+    if(_devices[i].was_measured)
+      throughput[i] = _devices[i].throughput;
+    else if(num_measured > 0)
+      throughput[i] = measured_throughput / num_measured;
+  }
+
+  // Drop the slowest devices until all partitions are large enough
+  for(;;) {
+    double total_throughput = 0.0;
+    std::size_t slowest = _devices.size();
+    for(std::size_t i = 0; i < _devices.size(); ++i) {
+      if(is_used[i]) {
+        total_throughput += throughput[i];
+        if(slowest == _devices.size() ||
+           throughput[i] < throughput[slowest])
+          slowest = i;
+      }
+    }
+    if(slowest == _devices.size())
+      return {};
+
+    double smallest_size = problem_size *
+                           throughput[slowest] / total_throughput;
+    if(smallest_size >= min_partition_size)
+      break;
+    is_used[slowest] = false;
+  }
+
+  double total_throughput = 0.0;
+  for(std::size_t i = 0; i < _devices.size(); ++i)
+    if(is_used[i])
+      total_throughput += throughput[i];
+
+  partition_list result;
+  double cumulative_throughput = 0.0;
+  std::size_t offset = 0;
+  for(std::size_t i = 0; i < _devices.size(); ++i) {
+    if(is_used[i]) {
+      cumulative_throughput += throughput[i];
+      std::size_t end = static_cast<std::size_t>(
+          problem_size * (cumulative_throughput / total_throughput) + 0.5);
+      end = std::min(end, problem_size);
+      partition p;
+      p.queue = &_devices[i].queue;
+      p.device_index = i;
+      p.offset = offset;
+      p.size = end - offset;
+      result.push_back(p);
+      offset = end;
+    }
+  }
+  // Compensate rounding errors
+  result.back().size = problem_size - result.back().offset;
+  return result;
+}
+
 }
 
 #if defined(__clang__) && defined(ACPP_LIBKERNEL_IS_DEVICE_PASS_HOST) &&    \
@@ -222,6 +617,20 @@ private:
 
 namespace hipsycl::stdpar {
 
+// Pool for stdpar USM allocations.
+//
+// The pool consists of arenas that are allocated on demand, each being
+// twice as large as the previous one, until the configured maximum pool
+// size is reached. Within arenas, memory is managed by a buddy allocator.
+// Allocations that do not fit into the pool fall back to
+// sycl::malloc_shared.
+//
+// Small allocations are instead rounded up to size classes and carved from
+// slabs that are claimed from the arenas. Each thread caches free objects
+// per size class, so that small allocations and frees usually neither
+// synchronize with other threads nor touch the buddy allocators. Thread
+// caches belong to a single pool; each thread can cache objects of up to
+// max_cached_pools pools at the same time.
 class memory_pool {
 private:
   uint64_t ceil_division(uint64_t a, uint64_t b) {
@@ -232,68 +641,422 @@ private:
     return ceil_division(a, b) * b;
   }
 public:
-  memory_pool(std::size_t size)
-      : _pool_size{size}, _pool{nullptr},
-        _free_space_map{size > 0 ? size : 1024},
+  struct statistics {
+    std::size_t num_arenas;
+    // Total size of all arenas
+    std::size_t reserved_bytes;
+    // Size of the buddy blocks that are in use, including slabs
+    std::size_t claimed_bytes;
+    // Bytes requested by live allocations served by the buddy allocators
+    std::size_t requested_bytes;
+    // Size of the slabs for small allocations
+    std::size_t slab_bytes;
+    std::size_t num_fallback_allocations;
+    std::size_t fallback_bytes;
+  };
+
+  memory_pool(std::size_t max_size)
+      : _max_size{max_size},
         _page_size{static_cast<std::size_t>(sysconf(_SC_PAGESIZE))} {
     init();
   }
 
   void* claim(std::size_t size) {
-    if(_pool_size == 0)
+    if(_max_size == 0)
       return nullptr;
 
-    if(size < _page_size)
-      size = _page_size;
+    void* ptr = nullptr;
+    if(size <= small_size_classes::max_size)
+      ptr = claim_small(small_size_classes::get_class(size));
+    else if(size < _max_size / 2)
+      ptr = claim_block(size);
 
-    uint64_t address = 0;
-    if(_free_space_map.claim(size, address)) {
-      
-      void* ptr = static_cast<void*>((char*)_base_address + address);
-      assert(is_from_pool(ptr));
-      assert(is_from_pool((char*)ptr+size));
-      assert((uint64_t)ptr % _page_size == 0);
-
-      // Inform the runtime that there is a new user allocation
-      // by invoking the runtime hook. We need to do this manually
-      // because memory pool directly uses raw backend allocation commands.
-      rt::application::event_handler_layer().on_new_allocation(
-          ptr, size,
-          rt::allocation_info{_dev,
-                              rt::allocation_info::allocation_type::shared});
-
-      return ptr;
+    if(!ptr) {
+      _num_fallback_allocations.fetch_add(1, std::memory_order_relaxed);
+      _fallback_bytes.fetch_add(size, std::memory_order_relaxed);
     }
-
-    return nullptr;
+    return ptr;
   }
 
+  // size must be the size that was passed to claim()
   void release(void* ptr, std::size_t size) {
-    if(_pool && is_from_pool(ptr)) {
-      uint64_t address = reinterpret_cast<uint64_t>(ptr)-reinterpret_cast<uint64_t>(_base_address);
-      _free_space_map.release(address, size);
-
+    if(size <= small_size_classes::max_size) {
+      release_small(ptr, small_size_classes::get_class(size));
+    } else if(arena* a = find_arena(ptr)) {
+      release_block(a, ptr, size);
       rt::application::event_handler_layer().on_deallocation(ptr);
     }
   }
 
   ~memory_pool() {
+    // Objects cached by threads that are still running belong to
+    // this pool, so they must not be handed out by another pool that
+    // is created at the same address.
+    detach_thread_caches();
+
     // Memory pool might be destroyed after runtime shutdown, so rely on OS
     // to clean up for now
+    if(_max_size == 0)
+      return;
+
+    statistics stats = get_statistics();
+    HIPSYCL_DEBUG_INFO << "[stdpar] Memory pool statistics: " << stats.num_arenas
+                       << " arenas with " << stats.reserved_bytes
+                       << " bytes, of which " << stats.claimed_bytes
+                       << " bytes are claimed (" << stats.slab_bytes
+                       << " bytes in slabs, " << stats.requested_bytes
+                       << " bytes requested by larger allocations); "
+                       << stats.num_fallback_allocations
+                       << " allocations with " << stats.fallback_bytes
+                       << " bytes fell back to USM allocations" << std::endl;
   }
 
+  /// \return The maximum size of the pool
   std::size_t get_size() const {
-    return _pool_size;
+    return _max_size;
   }
 
   bool is_from_pool(void* ptr) const {
-    if(!_pool)
-      return false;
+    return find_arena(ptr) != nullptr;
+  }
 
-    void* pool_end = (char*)_base_address + _pool_size;
-    return ptr >= _base_address && ptr < pool_end;
+  statistics get_statistics() const {
+    statistics stats;
+    stats.num_arenas = _num_arenas.load(std::memory_order_acquire);
+    stats.reserved_bytes = _reserved_bytes.load(std::memory_order_relaxed);
+    stats.claimed_bytes = _claimed_bytes.load(std::memory_order_relaxed);
+    stats.requested_bytes = _requested_bytes.load(std::memory_order_relaxed);
+    stats.slab_bytes = _slab_bytes.load(std::memory_order_relaxed);
+    stats.num_fallback_allocations =
+        _num_fallback_allocations.load(std::memory_order_relaxed);
+    stats.fallback_bytes = _fallback_bytes.load(std::memory_order_relaxed);
+    return stats;
   }
 private:
+  static constexpr int max_arenas = 32;
+  static constexpr std::size_t min_arena_size = 64 * 1024 * 1024;
+  static constexpr std::size_t slab_size = 256 * 1024;
+
+  struct arena {
+    arena(void* allocation, void* base, std::size_t arena_size)
+        : pool{allocation}, base_address{base}, size{arena_size},
+          free_space{arena_size} {}
+
+    bool contains(void* ptr) const {
+      return ptr >= base_address && ptr < (char*)base_address + size;
+    }
+
+    void* pool;
+    void* base_address;
+    std::size_t size;
+    free_space_map free_space;
+  };
+
+  static constexpr int max_cached_pools = 4;
+
+  // Free objects of one pool that a thread caches. Attached caches are
+  // linked into the list of their pool, so that the pool can detach them
+  // when it is destroyed before the threads exit.
+  class thread_cache {
+  public:
+    memory_pool* get_pool() const {
+      return _pool;
+    }
+
+    common::intrusive_free_list& get_free_objects(int size_class) {
+      return _free_objects[size_class];
+    }
+
+    int get_arena_hint() const {
+      return _arena_hint;
+    }
+  private:
+    friend class memory_pool;
+
+    memory_pool* _pool = nullptr;
+    int _arena_hint = 0;
+    thread_cache* _next = nullptr;
+    thread_cache* _prev = nullptr;
+    std::array<common::intrusive_free_list, small_size_classes::num_classes>
+        _free_objects;
+  };
+
+  // The caches of a thread for the pools it uses
+  class thread_caches {
+  public:
+    ~thread_caches() {
+      _current_thread_caches = nullptr;
+      _are_thread_caches_destroyed = true;
+      std::lock_guard<std::mutex> lock{get_thread_cache_mutex()};
+      for(thread_cache& cache : _caches)
+        if(memory_pool* pool = cache.get_pool())
+          pool->detach_thread_cache(cache, true);
+    }
+
+    std::array<thread_cache, max_cached_pools> _caches;
+  };
+
+  // Protects attaching and detaching thread caches, which happens rarely:
+  // When a thread first uses a pool, and when either of them goes away.
+  static std::mutex& get_thread_cache_mutex() {
+    // Intentionally never destroyed, since threads may still exit
+    // during static destruction. Allocated with __libc_malloc because
+    // operator new may be served by this pool.
+    static std::mutex* mutex =
+        new (__libc_malloc(sizeof(std::mutex))) std::mutex{};
+    return *mutex;
+  }
+
+  // Must be called with the thread cache mutex locked
+  void detach_thread_cache(thread_cache& cache, bool return_objects) {
+    for(int i = 0; i < small_size_classes::num_classes; ++i) {
+      if(return_objects)
+        put_free_objects(i, cache._free_objects[i]);
+      else
+        cache._free_objects[i] = common::intrusive_free_list{};
+    }
+    if(cache._prev)
+      cache._prev->_next = cache._next;
+    else
+      _thread_caches = cache._next;
+    if(cache._next)
+      cache._next->_prev = cache._prev;
+    cache._next = nullptr;
+    cache._prev = nullptr;
+    __atomic_store_n(&cache._pool, nullptr, __ATOMIC_RELAXED);
+  }
+
+  void detach_thread_caches() {
+    std::lock_guard<std::mutex> lock{get_thread_cache_mutex()};
+    while(_thread_caches)
+      detach_thread_cache(*_thread_caches, false);
+  }
+
+  struct alignas(64) free_object_class {
+    std::mutex mutex;
+    common::intrusive_free_list objects;
+  };
+
+  static std::size_t get_num_objects_per_slab(int size_class) {
+    return slab_size / small_size_classes::get_size(size_class);
+  }
+
+  thread_cache* get_thread_cache() {
+    thread_caches* caches = _current_thread_caches;
+    if(!caches) {
+      if(_are_thread_caches_destroyed)
+        return nullptr;
+      static thread_local thread_caches thread_local_caches;
+      _current_thread_caches = &thread_local_caches;
+      caches = _current_thread_caches;
+    }
+
+    thread_cache* unused = nullptr;
+    for(thread_cache& cache : caches->_caches) {
+      memory_pool* pool = __atomic_load_n(&cache._pool, __ATOMIC_RELAXED);
+      if(pool == this)
+        return &cache;
+      if(!pool && !unused)
+        unused = &cache;
+    }
+    // Threads that use too many pools at once fall back to the global
+    // free lists of the additional pools.
+    if(!unused)
+      return nullptr;
+
+    std::lock_guard<std::mutex> lock{get_thread_cache_mutex()};
+    unused->_arena_hint = _next_arena_hint.fetch_add(1, std::memory_order_relaxed);
+    unused->_next = _thread_caches;
+    if(_thread_caches)
+      _thread_caches->_prev = unused;
+    _thread_caches = unused;
+    __atomic_store_n(&unused->_pool, this, __ATOMIC_RELAXED);
+    return unused;
+  }
+
+  void* claim_small(int size_class) {
+    thread_cache* cache = get_thread_cache();
+    if(cache) {
+      common::intrusive_free_list& objects = cache->get_free_objects(size_class);
+      if(void* ptr = objects.pop())
+        return ptr;
+      common::intrusive_free_list refill = take_free_objects(
+          size_class, get_num_objects_per_slab(size_class) / 2);
+      if(refill.empty() && !allocate_slab(size_class, refill))
+        return nullptr;
+      objects.splice(refill);
+      return objects.pop();
+    }
+
+    common::intrusive_free_list objects = take_free_objects(size_class, 1);
+    if(objects.empty() && !allocate_slab(size_class, objects))
+      return nullptr;
+    void* ptr = objects.pop();
+    put_free_objects(size_class, objects);
+    return ptr;
+  }
+
+  void release_small(void* ptr, int size_class) {
+    if(thread_cache* cache = get_thread_cache()) {
+      common::intrusive_free_list& objects = cache->get_free_objects(size_class);
+      objects.push(ptr);
+      std::size_t num_objects_per_slab = get_num_objects_per_slab(size_class);
+      if(objects.size() > num_objects_per_slab) {
+        common::intrusive_free_list batch = objects.split(num_objects_per_slab / 2);
+        put_free_objects(size_class, batch);
+      }
+    } else {
+      common::intrusive_free_list objects;
+      objects.push(ptr);
+      put_free_objects(size_class, objects);
+    }
+  }
+
+  common::intrusive_free_list take_free_objects(int size_class, std::size_t n) {
+    free_object_class& c = _free_objects[size_class];
+    std::lock_guard<std::mutex> lock{c.mutex};
+    return c.objects.split(n);
+  }
+
+  void put_free_objects(int size_class, common::intrusive_free_list& objects) {
+    free_object_class& c = _free_objects[size_class];
+    std::lock_guard<std::mutex> lock{c.mutex};
+    c.objects.splice(objects);
+  }
+
+  bool allocate_slab(int size_class, common::intrusive_free_list& out) {
+    char* slab = static_cast<char*>(claim_block(slab_size));
+    if(!slab)
+      return false;
+    // Slabs are registered as a whole, and never released
+    _requested_bytes.fetch_sub(slab_size, std::memory_order_relaxed);
+    _slab_bytes.fetch_add(slab_size, std::memory_order_relaxed);
+
+    std::size_t object_size = small_size_classes::get_size(size_class);
+    for(std::size_t offset = 0; offset + object_size <= slab_size;
+        offset += object_size)
+      out.push(slab + offset);
+    return true;
+  }
+
+  std::size_t get_block_size(std::size_t size) const {
+    std::size_t block_size = _page_size;
+    while(block_size < size)
+      block_size *= 2;
+    return block_size;
+  }
+
+  void* claim_block(std::size_t size) {
+    if(size < _page_size)
+      size = _page_size;
+
+    thread_cache* cache = get_thread_cache();
+    int arena_hint = cache ? cache->get_arena_hint() : 0;
+
+    for(;;) {
+      int num_arenas = _num_arenas.load(std::memory_order_acquire);
+      // Start at a different arena in each thread to spread contention
+      // on the arena locks
+      for(int i = 0; i < num_arenas; ++i) {
+        arena* a = _arenas[(arena_hint + i) % num_arenas];
+        uint64_t address = 0;
+        if(a->free_space.claim(size, address)) {
+          void* ptr = static_cast<void*>((char*)a->base_address + address);
+          assert(a->contains(ptr));
+          assert((uint64_t)ptr % _page_size == 0);
+
+          _claimed_bytes.fetch_add(get_block_size(size),
+                                   std::memory_order_relaxed);
+          _requested_bytes.fetch_add(size, std::memory_order_relaxed);
+
+          // Inform the runtime that there is a new user allocation
+          // by invoking the runtime hook. We need to do this manually
+          // because memory pool directly uses raw backend allocation commands.
+          rt::application::event_handler_layer().on_new_allocation(
+              ptr, size,
+              rt::allocation_info{_dev,
+                                  rt::allocation_info::allocation_type::shared});
+          return ptr;
+        }
+      }
+      if(!grow(num_arenas, get_block_size(size)))
+        return nullptr;
+    }
+  }
+
+  void release_block(arena* a, void* ptr, std::size_t size) {
+    if(size < _page_size)
+      size = _page_size;
+    uint64_t address = reinterpret_cast<uint64_t>(ptr) -
+                       reinterpret_cast<uint64_t>(a->base_address);
+    a->free_space.release(address, size);
+
+    _claimed_bytes.fetch_sub(get_block_size(size), std::memory_order_relaxed);
+    _requested_bytes.fetch_sub(size, std::memory_order_relaxed);
+  }
+
+  arena* find_arena(void* ptr) const {
+    int num_arenas = _num_arenas.load(std::memory_order_acquire);
+    for(int i = 0; i < num_arenas; ++i)
+      if(_arenas[i]->contains(ptr))
+        return _arenas[i];
+    return nullptr;
+  }
+
+  // Adds an arena that can hold a block of the given size, unless another
+  // thread has already added an arena since num_known_arenas was observed.
+  // Returns false if the pool cannot grow.
+  bool grow(int num_known_arenas, std::size_t block_size) {
+    std::lock_guard<std::mutex> lock{_growth_mutex};
+    int num_arenas = _num_arenas.load(std::memory_order_acquire);
+    if(num_arenas != num_known_arenas)
+      return true;
+    if(!_can_grow || num_arenas == max_arenas)
+      return false;
+
+    std::size_t reserved = _reserved_bytes.load(std::memory_order_relaxed);
+    std::size_t arena_size =
+        num_arenas == 0
+            ? std::max(_max_size / 8, std::min(_max_size, min_arena_size))
+            : 2 * _arenas[num_arenas - 1]->size;
+    // The buddy allocator requires blocks to end before the arena ends
+    arena_size = std::min(std::max(arena_size, 2 * block_size),
+                          _max_size - reserved);
+    arena_size = next_multiple_of(arena_size, _page_size);
+
+    auto& q = detail::single_device_dispatch::get_queue();
+    void* allocation = nullptr;
+    while(arena_size > block_size) {
+      // Make sure to allocate an additional page so that we can fix
+      // alignment if needed
+      allocation = raw_malloc_shared(arena_size + _page_size, q);
+      if(allocation)
+        break;
+      arena_size = next_multiple_of(arena_size / 2, _page_size);
+    }
+    if(!allocation) {
+      HIPSYCL_DEBUG_WARNING << "[stdpar] Could not grow memory pool, "
+                               "subsequent allocations will fall back to USM "
+                               "allocations"
+                            << std::endl;
+      _can_grow = false;
+      return false;
+    }
+
+    HIPSYCL_DEBUG_INFO << "[stdpar] Growing memory pool by "
+                       << static_cast<double>(arena_size) / (1024 * 1024 * 1024)
+                       << " GB" << std::endl;
+
+    void* base_address =
+        (void*)next_multiple_of((uint64_t)allocation, _page_size);
+    arena* a = (arena*)__libc_malloc(sizeof(arena));
+    new (a) arena{allocation, base_address, arena_size};
+
+    _arenas[num_arenas] = a;
+    _reserved_bytes.fetch_add(arena_size, std::memory_order_relaxed);
+    _num_arenas.store(num_arenas + 1, std::memory_order_release);
+    return true;
+  }
 
   void* raw_malloc_shared(std::size_t bytes, sycl::queue& q) {
     auto *allocator = sycl::detail::select_usm_allocator(q.get_context(),
@@ -302,30 +1065,41 @@ private:
   }
 
   void init() {
-    HIPSYCL_DEBUG_INFO << "[stdpar] Building a memory pool of size "
-                       << static_cast<double>(_pool_size) / (1024 * 1024 * 1024)
+    HIPSYCL_DEBUG_INFO << "[stdpar] Building a memory pool with a maximum size of "
+                       << static_cast<double>(_max_size) / (1024 * 1024 * 1024)
                        << " GB" << std::endl;
     auto& q = detail::single_device_dispatch::get_queue();
     _dev = q.get_device().AdaptiveCpp_device_id();
-
-    // We need to call raw_allocate_usm so that we can inform the runtime's allocation
-    // tracking mechanism of actual user allocations, not just of the memory pool as a 
-    // whole.
-    // Make sure to allocate an additional page so that we can fix alignment if needed
-    _pool = raw_malloc_shared(_pool_size + _page_size, q);
-
-    uint64_t aligned_pool_base = next_multiple_of((uint64_t)_pool, _page_size);
-    _base_address = (void*)aligned_pool_base;
-    assert(aligned_pool_base % _page_size == 0);
+    // Arenas are allocated on first use. We need to call raw_allocate_usm
+    // for them so that we can inform the runtime's allocation tracking
+    // mechanism of actual user allocations, not just of the arenas as a whole.
   }
 
-
-  std::size_t _pool_size;
-  void* _pool;
-  void* _base_address;
-  free_space_map _free_space_map;
+  std::size_t _max_size;
   std::size_t _page_size;
   rt::device_id _dev;
+
+  std::array<arena*, max_arenas> _arenas = {};
+  std::atomic<int> _num_arenas = 0;
+  std::mutex _growth_mutex;
+  bool _can_grow = true;
+
+  std::array<free_object_class, small_size_classes::num_classes> _free_objects;
+  std::atomic<int> _next_arena_hint = 0;
+  // Attached thread caches, protected by the thread cache mutex
+  thread_cache* _thread_caches = nullptr;
+
+  std::atomic<std::size_t> _reserved_bytes = 0;
+  std::atomic<std::size_t> _claimed_bytes = 0;
+  std::atomic<std::size_t> _requested_bytes = 0;
+  std::atomic<std::size_t> _slab_bytes = 0;
+  std::atomic<std::size_t> _num_fallback_allocations = 0;
+  std::atomic<std::size_t> _fallback_bytes = 0;
+
+  // Trivially destructible, so they can still be queried after the
+  // thread caches of an exiting thread have been destroyed.
+  inline static thread_local thread_caches* _current_thread_caches = nullptr;
+  inline static thread_local bool _are_thread_caches_destroyed = false;
 };
 
 class unified_shared_memory {
@@ -371,9 +1145,7 @@ public:
           mem_pool = usm_manager.get_memory_pool();
         }
 
-        if(n < mem_pool->get_size() / 2) {
-          ptr = mem_pool->claim(n);
-        }
+        ptr = mem_pool->claim(n);
         // ptr will still be nullptr if pool was not used, or pool allocation
         // failed.
         if(!ptr) {
@@ -19,6 +19,7 @@
 #include "../detail/stdpar_builtins.hpp"
 #include "../detail/stdpar_defs.hpp"
 #include "../detail/offload.hpp"
+#include "../detail/multi_device.hpp"
 #include "hipSYCL/algorithms/algorithm.hpp"
 #include "hipSYCL/algorithms/util/allocation_cache.hpp"
 #include "hipSYCL/std/stdpar/detail/offload_heuristic_db.hpp"
@@ -32,7 +33,9 @@ template <class ForwardIt, class UnaryFunction2>
 HIPSYCL_STDPAR_ENTRYPOINT void for_each(hipsycl::stdpar::par_unseq, ForwardIt first,
                                         ForwardIt last, UnaryFunction2 f) {
   auto offloader = [&](auto& queue) {
-    hipsycl::algorithms::for_each(queue, first, last, f);
+    if(!hipsycl::stdpar::detail::try_split_for_each<
+           hipsycl::stdpar::par_unseq>(first, last, f))
+      hipsycl::algorithms::for_each(queue, first, last, f);
   };
 
   auto fallback = [&](){
@@ -54,7 +57,9 @@ ForwardIt for_each_n(hipsycl::stdpar::par_unseq,
   auto offloader = [&](auto& queue) {
     ForwardIt last = first;
     std::advance(last, std::max(n, Size{0}));
-    hipsycl::algorithms::for_each_n(queue, first, n, f);
+    if(!hipsycl::stdpar::detail::try_split_for_each_n<
+           hipsycl::stdpar::par_unseq>(first, n, f))
+      hipsycl::algorithms::for_each_n(queue, first, n, f);
     return last;
   };
 
@@ -79,7 +84,9 @@ ForwardIt2 transform(hipsycl::stdpar::par_unseq,
   auto offloader = [&](auto& queue){
     ForwardIt2 last = d_first;
     std::advance(last, std::distance(first1, last1));
-    hipsycl::algorithms::transform(queue, first1, last1, d_first, unary_op);
+    if(!hipsycl::stdpar::detail::try_split_transform<
+           hipsycl::stdpar::par_unseq>(first1, last1, d_first, unary_op))
+      hipsycl::algorithms::transform(queue, first1, last1, d_first, unary_op);
     return last;
   };
 
@@ -106,8 +113,11 @@ ForwardIt3 transform(hipsycl::stdpar::par_unseq,
   auto offloader = [&](auto &queue) {
     ForwardIt3 last = d_first;
     std::advance(last, std::distance(first1, last1));
-    hipsycl::algorithms::transform(queue, first1, last1, first2, d_first,
-                                   binary_op);
+    if(!hipsycl::stdpar::detail::try_split_transform<
+           hipsycl::stdpar::par_unseq>(first1, last1, first2, d_first,
+                                       binary_op))
+      hipsycl::algorithms::transform(queue, first1, last1, first2, d_first,
+                                     binary_op);
     return last;
   };
 
@@ -618,7 +628,9 @@ template <class ForwardIt, class UnaryFunction2>
 HIPSYCL_STDPAR_ENTRYPOINT void for_each(hipsycl::stdpar::par, ForwardIt first,
                                         ForwardIt last, UnaryFunction2 f) {
   auto offloader = [&](auto& queue) {
-    hipsycl::algorithms::for_each(queue, first, last, f);
+    if(!hipsycl::stdpar::detail::try_split_for_each<
+           hipsycl::stdpar::par>(first, last, f))
+      hipsycl::algorithms::for_each(queue, first, last, f);
   };
 
   auto fallback = [&](){
@@ -640,7 +652,9 @@ ForwardIt for_each_n(hipsycl::stdpar::par,
   auto offloader = [&](auto& queue) {
     ForwardIt last = first;
     std::advance(last, std::max(n, Size{0}));
-    hipsycl::algorithms::for_each_n(queue, first, n, f);
+    if(!hipsycl::stdpar::detail::try_split_for_each_n<
+           hipsycl::stdpar::par>(first, n, f))
+      hipsycl::algorithms::for_each_n(queue, first, n, f);
     return last;
   };
 
@@ -665,7 +679,9 @@ ForwardIt2 transform(hipsycl::stdpar::par,
   auto offloader = [&](auto& queue){
     ForwardIt2 last = d_first;
     std::advance(last, std::distance(first1, last1));
-    hipsycl::algorithms::transform(queue, first1, last1, d_first, unary_op);
+    if(!hipsycl::stdpar::detail::try_split_transform<
+           hipsycl::stdpar::par>(first1, last1, d_first, unary_op))
+      hipsycl::algorithms::transform(queue, first1, last1, d_first, unary_op);
     return last;
   };
 
@@ -692,8 +708,11 @@ ForwardIt3 transform(hipsycl::stdpar::par,
   auto offloader = [&](auto &queue) {
     ForwardIt3 last = d_first;
     std::advance(last, std::distance(first1, last1));
-    hipsycl::algorithms::transform(queue, first1, last1, first2, d_first,
-                                   binary_op);
+    if(!hipsycl::stdpar::detail::try_split_transform<
+           hipsycl::stdpar::par>(first1, last1, first2, d_first,
+                                 binary_op))
+      hipsycl::algorithms::transform(queue, first1, last1, first2, d_first,
+                                     binary_op);
     return last;
   };
 
@@ -18,6 +18,7 @@
 #include "../detail/sycl_glue.hpp"
 #include "../detail/stdpar_builtins.hpp"
 #include "../detail/offload.hpp"
+#include "../detail/multi_device.hpp"
 #include "hipSYCL/algorithms/util/allocation_cache.hpp"
 #include "hipSYCL/algorithms/numeric.hpp"
 #include <iterator>
@@ -33,6 +34,10 @@ T transform_reduce(hipsycl::stdpar::par_unseq,
                     T init) {
   
   auto offloader = [&](auto& queue) {
+    if(auto result = hipsycl::stdpar::detail::try_split_transform_reduce<
+            hipsycl::stdpar::par_unseq>(first1, last1, first2, init,
+                                        std::plus<T>{}, std::multiplies<T>{}))
+      return *result;
     // Note: Using a scratch allocation_group that expires at the end of the scope
     // is safe because
     // a) We synchronize before the end, so the allocation_group also lives until
@@ -86,6 +91,10 @@ T transform_reduce(hipsycl::stdpar::par_unseq,
                     BinaryReductionOp reduce,
                     BinaryTransformOp transform ) {
   auto offloader = [&](auto& queue){
+    if(auto result = hipsycl::stdpar::detail::try_split_transform_reduce<
+            hipsycl::stdpar::par_unseq>(first1, last1, first2, init, reduce,
+                                        transform))
+      return *result;
     auto output_scratch_group =
         hipsycl::stdpar::detail::stdpar_tls_runtime::get()
             .make_scratch_group<
@@ -133,6 +142,9 @@ T transform_reduce(hipsycl::stdpar::par_unseq,
                     UnaryTransformOp transform ) {
 
   auto offloader = [&](auto& queue) {
+    if(auto result = hipsycl::stdpar::detail::try_split_transform_reduce<
+            hipsycl::stdpar::par_unseq>(first, last, init, reduce, transform))
+      return *result;
     auto output_scratch_group =
         hipsycl::stdpar::detail::stdpar_tls_runtime::get()
             .make_scratch_group<
@@ -176,7 +188,11 @@ reduce(hipsycl::stdpar::par_unseq, ForwardIt first,
   using result_type = typename std::iterator_traits<ForwardIt>::value_type;
 
   auto offloader = [&](auto &queue) {
-
+    if(auto result = hipsycl::stdpar::detail::try_split_transform_reduce<
+            hipsycl::stdpar::par_unseq>(first, last, result_type{},
+                                        std::plus<result_type>{},
+                                        [](auto x) { return x; }))
+      return *result;
     auto output_scratch_group =
         hipsycl::stdpar::detail::stdpar_tls_runtime::get()
             .make_scratch_group<
@@ -215,7 +231,10 @@ T reduce(hipsycl::stdpar::par_unseq, ForwardIt first,
          ForwardIt last, T init) {
 
   auto offloader = [&](auto& queue){
-      
+    if(auto result = hipsycl::stdpar::detail::try_split_transform_reduce<
+            hipsycl::stdpar::par_unseq>(first, last, init, std::plus<T>{},
+                                        [](auto x) { return x; }))
+      return *result;
     auto output_scratch_group =
         hipsycl::stdpar::detail::stdpar_tls_runtime::get()
             .make_scratch_group<
@@ -256,7 +275,10 @@ T reduce(hipsycl::stdpar::par_unseq, ForwardIt first,
          ForwardIt last, T init, BinaryOp binary_op) {
 
   auto offloader = [&](auto& queue){
-      
+    if(auto result = hipsycl::stdpar::detail::try_split_transform_reduce<
+            hipsycl::stdpar::par_unseq>(first, last, init, binary_op,
+                                        [](auto x) { return x; }))
+      return *result;
     auto output_scratch_group =
         hipsycl::stdpar::detail::stdpar_tls_runtime::get()
             .make_scratch_group<
@@ -304,7 +326,9 @@ OutputIt inclusive_scan(hipsycl::stdpar::par_unseq,
     OutputIt result = d_first;
     auto problem_size = std::distance(first, last);
     std::advance(result, problem_size);
-    if(problem_size > 0) {
+    if(problem_size > 0 &&
+       !hipsycl::stdpar::detail::try_split_inclusive_scan<
+           hipsycl::stdpar::par_unseq>(first, last, d_first, op)) {
       auto scratch_group =
         hipsycl::stdpar::detail::stdpar_tls_runtime::get()
             .make_scratch_group<
@@ -339,7 +363,9 @@ HIPSYCL_STDPAR_ENTRYPOINT OutputIt inclusive_scan(hipsycl::stdpar::par_unseq,
     OutputIt result = d_first;
     auto problem_size = std::distance(first, last);
     std::advance(result, problem_size);
-    if(problem_size > 0) {
+    if(problem_size > 0 &&
+       !hipsycl::stdpar::detail::try_split_inclusive_scan<
+           hipsycl::stdpar::par_unseq>(first, last, d_first, op, init)) {
       auto scratch_group =
         hipsycl::stdpar::detail::stdpar_tls_runtime::get()
             .make_scratch_group<
@@ -372,7 +398,9 @@ HIPSYCL_STDPAR_ENTRYPOINT OutputIt inclusive_scan(hipsycl::stdpar::par_unseq,
     OutputIt result = d_first;
     auto problem_size = std::distance(first, last);
     std::advance(result, problem_size);
-    if(problem_size > 0) {
+    if(problem_size > 0 &&
+       !hipsycl::stdpar::detail::try_split_inclusive_scan<
+           hipsycl::stdpar::par_unseq>(first, last, d_first, std::plus<>{})) {
       auto scratch_group =
         hipsycl::stdpar::detail::stdpar_tls_runtime::get()
             .make_scratch_group<
@@ -476,7 +504,10 @@ HIPSYCL_STDPAR_ENTRYPOINT ForwardIt2 transform_inclusive_scan(
     ForwardIt2 result = d_first;
     auto problem_size = std::distance(first, last);
     std::advance(result, problem_size);
-    if (problem_size > 0) {
+    if (problem_size > 0 &&
+        !hipsycl::stdpar::detail::try_split_transform_inclusive_scan<
+            hipsycl::stdpar::par_unseq>(first, last, d_first, binary_op,
+                                        unary_op)) {
       auto scratch_group =
           hipsycl::stdpar::detail::stdpar_tls_runtime::get()
               .make_scratch_group<
@@ -510,7 +541,10 @@ HIPSYCL_STDPAR_ENTRYPOINT ForwardIt2 transform_inclusive_scan(
     ForwardIt2 result = d_first;
     auto problem_size = std::distance(first, last);
     std::advance(result, problem_size);
-    if (problem_size > 0) {
+    if (problem_size > 0 &&
+        !hipsycl::stdpar::detail::try_split_transform_inclusive_scan<
+            hipsycl::stdpar::par_unseq>(first, last, d_first, binary_op,
+                                        unary_op, init)) {
       auto scratch_group =
           hipsycl::stdpar::detail::stdpar_tls_runtime::get()
               .make_scratch_group<
@@ -586,6 +620,10 @@ T transform_reduce(hipsycl::stdpar::par,
                     T init) {
   
   auto offloader = [&](auto& queue) {
+    if(auto result = hipsycl::stdpar::detail::try_split_transform_reduce<
+            hipsycl::stdpar::par>(first1, last1, first2, init, std::plus<T>{},
+                                  std::multiplies<T>{}))
+      return *result;
     // Note: Using a scratch allocation_group that expires at the end of the scope
     // is safe because
     // a) We synchronize before the end, so the allocation_group also lives until
@@ -639,6 +677,10 @@ T transform_reduce(hipsycl::stdpar::par,
                     BinaryReductionOp reduce,
                     BinaryTransformOp transform ) {
   auto offloader = [&](auto& queue){
+    if(auto result = hipsycl::stdpar::detail::try_split_transform_reduce<
+            hipsycl::stdpar::par>(first1, last1, first2, init, reduce,
+                                  transform))
+      return *result;
     auto output_scratch_group =
         hipsycl::stdpar::detail::stdpar_tls_runtime::get()
             .make_scratch_group<
@@ -686,6 +728,9 @@ T transform_reduce(hipsycl::stdpar::par,
                     UnaryTransformOp transform ) {
 
   auto offloader = [&](auto& queue) {
+    if(auto result = hipsycl::stdpar::detail::try_split_transform_reduce<
+            hipsycl::stdpar::par>(first, last, init, reduce, transform))
+      return *result;
     auto output_scratch_group =
         hipsycl::stdpar::detail::stdpar_tls_runtime::get()
             .make_scratch_group<
@@ -729,7 +774,11 @@ reduce(hipsycl::stdpar::par, ForwardIt first,
   using result_type = typename std::iterator_traits<ForwardIt>::value_type;
 
   auto offloader = [&](auto &queue) {
-
+    if(auto result = hipsycl::stdpar::detail::try_split_transform_reduce<
+            hipsycl::stdpar::par>(first, last, result_type{},
+                                  std::plus<result_type>{},
+                                  [](auto x) { return x; }))
+      return *result;
     auto output_scratch_group =
         hipsycl::stdpar::detail::stdpar_tls_runtime::get()
             .make_scratch_group<
@@ -768,7 +817,10 @@ T reduce(hipsycl::stdpar::par, ForwardIt first,
          ForwardIt last, T init) {
 
   auto offloader = [&](auto& queue){
-      
+    if(auto result = hipsycl::stdpar::detail::try_split_transform_reduce<
+            hipsycl::stdpar::par>(first, last, init, std::plus<T>{},
+                                  [](auto x) { return x; }))
+      return *result;
     auto output_scratch_group =
         hipsycl::stdpar::detail::stdpar_tls_runtime::get()
             .make_scratch_group<
@@ -809,7 +861,10 @@ T reduce(hipsycl::stdpar::par, ForwardIt first,
          ForwardIt last, T init, BinaryOp binary_op) {
 
   auto offloader = [&](auto& queue){
-      
+    if(auto result = hipsycl::stdpar::detail::try_split_transform_reduce<
+            hipsycl::stdpar::par>(first, last, init, binary_op,
+                                  [](auto x) { return x; }))
+      return *result;
     auto output_scratch_group =
         hipsycl::stdpar::detail::stdpar_tls_runtime::get()
             .make_scratch_group<
@@ -855,7 +910,9 @@ OutputIt inclusive_scan(hipsycl::stdpar::par,
     OutputIt result = d_first;
     auto problem_size = std::distance(first, last);
     std::advance(result, problem_size);
-    if(problem_size > 0) {
+    if(problem_size > 0 &&
+       !hipsycl::stdpar::detail::try_split_inclusive_scan<
+           hipsycl::stdpar::par>(first, last, d_first, op)) {
       auto scratch_group =
         hipsycl::stdpar::detail::stdpar_tls_runtime::get()
             .make_scratch_group<
@@ -890,7 +947,9 @@ HIPSYCL_STDPAR_ENTRYPOINT OutputIt inclusive_scan(hipsycl::stdpar::par,
     OutputIt result = d_first;
     auto problem_size = std::distance(first, last);
     std::advance(result, problem_size);
-    if(problem_size > 0) {
+    if(problem_size > 0 &&
+       !hipsycl::stdpar::detail::try_split_inclusive_scan<
+           hipsycl::stdpar::par>(first, last, d_first, op, init)) {
       auto scratch_group =
         hipsycl::stdpar::detail::stdpar_tls_runtime::get()
             .make_scratch_group<
@@ -923,7 +982,9 @@ HIPSYCL_STDPAR_ENTRYPOINT OutputIt inclusive_scan(hipsycl::stdpar::par,
     OutputIt result = d_first;
     auto problem_size = std::distance(first, last);
     std::advance(result, problem_size);
-    if(problem_size > 0) {
+    if(problem_size > 0 &&
+       !hipsycl::stdpar::detail::try_split_inclusive_scan<
+           hipsycl::stdpar::par>(first, last, d_first, std::plus<>{})) {
       auto scratch_group =
         hipsycl::stdpar::detail::stdpar_tls_runtime::get()
             .make_scratch_group<
@@ -1025,7 +1086,9 @@ HIPSYCL_STDPAR_ENTRYPOINT ForwardIt2 transform_inclusive_scan(
     ForwardIt2 result = d_first;
     auto problem_size = std::distance(first, last);
     std::advance(result, problem_size);
-    if (problem_size > 0) {
+    if (problem_size > 0 &&
+        !hipsycl::stdpar::detail::try_split_transform_inclusive_scan<
+            hipsycl::stdpar::par>(first, last, d_first, binary_op, unary_op)) {
       auto scratch_group =
           hipsycl::stdpar::detail::stdpar_tls_runtime::get()
               .make_scratch_group<
@@ -1059,7 +1122,10 @@ HIPSYCL_STDPAR_ENTRYPOINT ForwardIt2 transform_inclusive_scan(
     ForwardIt2 result = d_first;
     auto problem_size = std::distance(first, last);
     std::advance(result, problem_size);
-    if (problem_size > 0) {
+    if (problem_size > 0 &&
+        !hipsycl::stdpar::detail::try_split_transform_inclusive_scan<
+            hipsycl::stdpar::par>(first, last, d_first, binary_op, unary_op,
+                                  init)) {
       auto scratch_group =
           hipsycl::stdpar::detail::stdpar_tls_runtime::get()
               .make_scratch_group<
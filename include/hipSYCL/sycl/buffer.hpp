@@ -1191,14 +1191,19 @@ private:
     this->_range = range;
 
     rt::range<3> page_size = rt::embed_in_range3(range);
+    auto page_table_representation = rt::range_store::representation::dense;
     if (this->has_property<property::buffer::AdaptiveCpp_page_size<dimensions>>()) {
       page_size = rt::embed_in_range3(
           this->get_property<property::buffer::AdaptiveCpp_page_size<dimensions>>()
               .get_page_size());
+      // Fine-grained page tables can become large, use the more
+      // compact and faster representation for them.
+      page_table_representation = rt::range_store::representation::bitmap;
     }
 
     _impl->data = std::make_shared<rt::buffer_data_region>(
-        rt::embed_in_range3(range), sizeof(T), page_size);
+        rt::embed_in_range3(range), sizeof(T), page_size,
+        page_table_representation);
   }
 
   void preallocate_host_buffer()
@@ -0,0 +1,60 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+#ifndef HIPSYCL_SYCL_COMMAND_GRAPH_HPP
+#define HIPSYCL_SYCL_COMMAND_GRAPH_HPP
+
+#include <cstddef>
+#include <memory>
+
+#include "hipSYCL/runtime/command_graph.hpp"
+
+namespace hipsycl {
+namespace sycl {
+
+class queue;
+
+/// Holds a sequence of command groups that has been recorded using
+/// queue::AdaptiveCpp_begin_recording() and can be submitted
+/// repeatedly using queue::AdaptiveCpp_replay().
+/// Copies refer to the same graph.
+class AdaptiveCpp_command_graph {
+public:
+  AdaptiveCpp_command_graph()
+  : _graph{std::make_shared<rt::command_graph>()} {}
+
+  /// Number of recorded operations
+  std::size_t size() const {
+    return _graph->size();
+  }
+
+  bool empty() const {
+    return size() == 0;
+  }
+
+  friend bool operator==(const AdaptiveCpp_command_graph &lhs,
+                         const AdaptiveCpp_command_graph &rhs) {
+    return lhs._graph == rhs._graph;
+  }
+
+  friend bool operator!=(const AdaptiveCpp_command_graph &lhs,
+                         const AdaptiveCpp_command_graph &rhs) {
+    return !(lhs == rhs);
+  }
+private:
+  friend class queue;
+
+  std::shared_ptr<rt::command_graph> _graph;
+};
+
+}
+}
+
+#endif
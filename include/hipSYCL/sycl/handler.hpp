@@ -42,10 +42,12 @@
 #include "hipSYCL/runtime/kernel_launcher.hpp"
 #include "hipSYCL/runtime/operations.hpp"
 #include "hipSYCL/runtime/application.hpp"
+#include "hipSYCL/runtime/command_graph.hpp"
 #include "hipSYCL/runtime/dag_manager.hpp"
 #include "hipSYCL/runtime/dag_node.hpp"
 #include "hipSYCL/runtime/device_id.hpp"
 #include "hipSYCL/runtime/executor.hpp"
+#include "hipSYCL/runtime/generic/object_pool.hpp"
 #include "hipSYCL/runtime/util.hpp"
 #include "hipSYCL/glue/embedded_pointer.hpp"
 #include "hipSYCL/glue/kernel_launcher_factory.hpp"
@@ -906,6 +908,11 @@ private:
                   "Overload resolution should never pick this overload without "
                   "reductions");
 
+    if(_recording_graph)
+      throw exception{make_error_code(errc::feature_not_supported),
+                      "handler: Reductions cannot be recorded into a "
+                      "command graph"};
+
     if constexpr(KernelType == rt::kernel_type::ndrange_parallel_for) {
       _command_group_nodes.push_back(
           submit_ndrange_reduction_kernel<KernelName>(global_range, local_range,
@@ -1162,10 +1169,13 @@ private:
   }
 
 
-  rt::dag_node_ptr create_task(std::unique_ptr<rt::operation> op,
+  rt::dag_node_ptr create_task(std::shared_ptr<rt::operation> op,
                                const rt::execution_hints &hints,
                                const rt::requirements_list& requirements) {
 
+    if(_recording_graph)
+      return record_task(std::move(op), hints, requirements);
+
     bool uses_buffers = false;
     bool has_non_instant_dependency = false;
     bool is_unbound = !hints.has_hint<rt::hints::bind_to_device>();
@@ -1203,7 +1213,7 @@ private:
 #endif
     } else {
 
-      rt::dag_node_ptr node = std::make_shared<rt::dag_node>(
+      rt::dag_node_ptr node = rt::make_pooled_shared<rt::dag_node>(
           hints, requirements.get(), std::move(op), _rt);
       node->assign_to_device(
           hints.get_hint<rt::hints::bind_to_device>()->get_device_id());
@@ -1218,11 +1228,47 @@ private:
     }
   }
 
-  rt::dag_node_ptr create_task(std::unique_ptr<rt::operation> op,
+  rt::dag_node_ptr create_task(std::shared_ptr<rt::operation> op,
                                const rt::execution_hints &hints) {
     return create_task(std::move(op), hints, _requirements);
   }
 
+  rt::dag_node_ptr record_task(std::shared_ptr<rt::operation> op,
+                               const rt::execution_hints &hints,
+                               const rt::requirements_list &requirements) {
+    // Buffer requirements would need to be resolved anew for every replay
+    // since data state can change between replays.
+    bool uses_buffers = op->is_requirement();
+    for(const auto& req : requirements.get()) {
+      if(req->get_operation()->is_requirement())
+        uses_buffers = true;
+    }
+    if(uses_buffers)
+      throw exception{make_error_code(errc::feature_not_supported),
+                      "handler: Operations using buffers cannot be recorded "
+                      "into a command graph"};
+
+    return _recording_graph->record(std::move(op), hints, requirements.get(),
+                                    _rt);
+  }
+
+  // Replays all operations of a recorded graph, taking into account
+  // dependencies added to this handler.
+  rt::dag_node_ptr replay_graph(rt::command_graph &graph) {
+    rt::dag_node_ptr last = graph.replay(
+        _requirements.get(), _rt,
+        [this](const std::shared_ptr<rt::operation> &op,
+               const rt::execution_hints &hints, const rt::node_list_t &reqs) {
+          rt::requirements_list req_list{_rt};
+          for(const auto& req : reqs)
+            req_list.add_node_requirement(req);
+          return create_task(op, hints, req_list);
+        });
+    if(last)
+      _command_group_nodes.push_back(last);
+    return last;
+  }
+
   const context _ctx;
   detail::local_memory_allocator _local_mem_allocator;
   async_handler _handler;
@@ -1238,6 +1284,9 @@ private:
   rt::runtime* _rt;
 
   bool _contains_non_instant_nodes = false;
+  // If set, operations are recorded into this graph instead of
+  // being submitted.
+  rt::command_graph* _recording_graph = nullptr;
 
   algorithms::util::allocation_cache* _allocation_cache;
 
@@ -0,0 +1,157 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+
+#ifndef HIPSYCL_SSCP_DETAIL_HOST_SUBGROUP_BUILTINS_HPP
+#define HIPSYCL_SSCP_DETAIL_HOST_SUBGROUP_BUILTINS_HPP
+
+#include "../barrier.hpp"
+#include "../core_typed.hpp"
+#include "../subgroup.hpp"
+#include "utils.hpp"
+
+HIPSYCL_SSCP_BUILTIN void *__acpp_sscp_host_get_internal_local_memory();
+
+// On the host, the work items of a sub-group do not execute in lockstep,
+// but in a loop that CBS creates around the code between two barriers.
+// Sub-group collectives therefore exchange data through the internal
+// local memory, which provides one 64-bit slot per work item, and are
+// work-group barriers. Since sub-groups consist of consecutive work items
+// in x direction, the loops between the barriers operate on contiguous
+// memory and vectorize with the sub-group size as vector width.
+//
+// As with work-group collectives, all work items of the work group must
+// encounter sub-group collectives. This restriction does not apply to the
+// default sub-group size of 1: Since the sub-group size is a constant
+// when CBS runs, the barriers of sub-group collectives are then removed
+// before CBS handles barriers.
+namespace hipsycl::libkernel::sscp {
+
+template <typename T> T *sg_host_get_exchange_memory() {
+  static_assert(sizeof(T) <= sizeof(__acpp_uint64));
+  return static_cast<T *>(__acpp_sscp_host_get_internal_local_memory());
+}
+
+inline bool sg_host_is_scalar() {
+  return __acpp_sscp_get_subgroup_max_size() == 1;
+}
+
+inline void sg_host_barrier() {
+  __acpp_sscp_work_group_barrier(__acpp_sscp_memory_scope::work_group,
+                                 __acpp_sscp_memory_order::relaxed);
+}
+
+/// Returns the value of x of the work item with the given local id within
+/// the sub-group, or x itself if the source lane is out of range.
+template <typename T> T sg_host_exchange(T x, __acpp_int32 source_lane) {
+  if (sg_host_is_scalar())
+    return x;
+
+  T *mem = sg_host_get_exchange_memory<T>();
+  const __acpp_uint32 wg_lid = __acpp_sscp_typed_get_local_linear_id<3, int>();
+  const __acpp_int32 lane = __acpp_sscp_get_subgroup_local_id();
+  const __acpp_int32 sg_size = __acpp_sscp_get_subgroup_size();
+
+  mem[wg_lid] = x;
+  sg_host_barrier();
+  T result = (source_lane >= 0 && source_lane < sg_size) ? mem[wg_lid - lane + source_lane] : x;
+  sg_host_barrier();
+  return result;
+}
+
+template <typename T, typename BinaryOperation> T sg_host_reduce(T x, BinaryOperation op) {
+  if (sg_host_is_scalar())
+    return x;
+
+  T *mem = sg_host_get_exchange_memory<T>();
+  const __acpp_uint32 wg_lid = __acpp_sscp_typed_get_local_linear_id<3, int>();
+  const __acpp_uint32 first = wg_lid - __acpp_sscp_get_subgroup_local_id();
+  const __acpp_uint32 sg_size = __acpp_sscp_get_subgroup_size();
+
+  mem[wg_lid] = x;
+  sg_host_barrier();
+  T result = mem[first];
+  for (__acpp_uint32 i = 1; i < sg_size; ++i)
+    result = op(result, mem[first + i]);
+  sg_host_barrier();
+  return result;
+}
+
+template <typename T, typename BinaryOperation>
+T sg_host_inclusive_scan(T x, BinaryOperation op) {
+  if (sg_host_is_scalar())
+    return x;
+
+  T *mem = sg_host_get_exchange_memory<T>();
+  const __acpp_uint32 wg_lid = __acpp_sscp_typed_get_local_linear_id<3, int>();
+  const __acpp_uint32 lane = __acpp_sscp_get_subgroup_local_id();
+  const __acpp_uint32 first = wg_lid - lane;
+
+  mem[wg_lid] = x;
+  sg_host_barrier();
+  T result = mem[first];
+  for (__acpp_uint32 i = 1; i <= lane; ++i)
+    result = op(result, mem[first + i]);
+  sg_host_barrier();
+  return result;
+}
+
+template <typename T, typename BinaryOperation>
+T sg_host_exclusive_scan(T x, BinaryOperation op, T init) {
+  if (sg_host_is_scalar())
+    return init;
+
+  T *mem = sg_host_get_exchange_memory<T>();
+  const __acpp_uint32 wg_lid = __acpp_sscp_typed_get_local_linear_id<3, int>();
+  const __acpp_uint32 lane = __acpp_sscp_get_subgroup_local_id();
+  const __acpp_uint32 first = wg_lid - lane;
+
+  mem[wg_lid] = x;
+  sg_host_barrier();
+  T result = init;
+  for (__acpp_uint32 i = 0; i < lane; ++i)
+    result = op(result, mem[first + i]);
+  sg_host_barrier();
+  return result;
+}
+
+/// Work-group reduction that first reduces within sub-groups and then
+/// across the sub-group results, using one slot per work item.
+template <typename T, typename BinaryOperation> T wg_host_reduce(T x, BinaryOperation op) {
+  T *mem = sg_host_get_exchange_memory<T>();
+  const __acpp_uint32 wg_lid = __acpp_sscp_typed_get_local_linear_id<3, int>();
+  const __acpp_uint32 wg_size = __acpp_sscp_typed_get_local_size<3, int>();
+  const __acpp_uint32 max_sg_size = __acpp_sscp_get_subgroup_max_size();
+
+  mem[wg_lid] = x;
+  sg_host_barrier();
+  if (wg_lid % max_sg_size == 0) {
+    const __acpp_uint32 end = wg_lid + max_sg_size < wg_size ? wg_lid + max_sg_size : wg_size;
+    T result = mem[wg_lid];
+    for (__acpp_uint32 i = wg_lid + 1; i < end; ++i)
+      result = op(result, mem[i]);
+    mem[wg_lid] = result;
+  }
+  sg_host_barrier();
+  if (wg_lid == 0) {
+    T result = mem[0];
+    for (__acpp_uint32 i = max_sg_size; i < wg_size; i += max_sg_size)
+      result = op(result, mem[i]);
+    mem[0] = result;
+  }
+  sg_host_barrier();
+  T result = mem[0];
+  sg_host_barrier();
+  return result;
+}
+
+} // namespace hipsycl::libkernel::sscp
+
+#endif
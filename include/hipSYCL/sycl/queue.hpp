@@ -32,6 +32,7 @@
 #include "context.hpp"
 #include "event.hpp"
 #include "handler.hpp"
+#include "command_graph.hpp"
 #include "info/info.hpp"
 #include "detail/function_set.hpp"
 
@@ -40,6 +41,7 @@
 #include <memory>
 #include <mutex>
 #include <atomic>
+#include <utility>
 
 namespace hipsycl {
 namespace sycl {
@@ -155,6 +157,12 @@ class queue : public detail::property_carrying_object
     std::shared_ptr<rt::kernel_cache> kernel_cache;
     // For non-emulated in-order queues only
     std::atomic<bool> has_non_instant_operations = false;
+
+    // Set while command groups are recorded instead of submitted
+    std::shared_ptr<rt::command_graph> recording_graph;
+    // previous_submission is replaced by recorded placeholders
+    // during recording and restored afterwards
+    rt::dag_node_ptr previous_submission_before_recording = nullptr;
   };
 
   template<typename, int, access::mode, access::target>
@@ -337,6 +345,10 @@ public:
   }
 
   void wait() {
+    if(AdaptiveCpp_is_recording())
+      throw exception{make_error_code(errc::invalid),
+                      "queue: Cannot wait while recording a command graph"};
+
     if(_impl->is_in_order) {
       if(_impl->needs_in_order_emulation) {
         rt::dag_node_ptr most_recent_event = nullptr;
@@ -443,6 +455,8 @@ public:
     apply_preferred_group_size<2>(prop_list, cgh);
     apply_preferred_group_size<3>(prop_list, cgh);
 
+    cgh._recording_graph = _impl->recording_graph.get();
+
     this->get_hooks()->run_all(cgh);
 
     rt::dag_node_ptr node = execute_submission(cgf, cgh);
@@ -874,6 +888,112 @@ public:
     });
   }
 
+  /// Starts recording command groups into \c graph instead of submitting
+  /// them. Events returned from submissions while recording may be used
+  /// as dependencies for other recorded command groups, but must not be
+  /// waited on. Only command groups operating on USM memory can be recorded.
+  void AdaptiveCpp_begin_recording(AdaptiveCpp_command_graph &graph) {
+    std::lock_guard<std::mutex> lock{_impl->lock};
+
+    if(_impl->recording_graph)
+      throw exception{make_error_code(errc::invalid),
+                      "queue: Already recording a command graph"};
+    if(this->has_property<property::queue::enable_profiling>())
+      throw exception{make_error_code(errc::feature_not_supported),
+                      "queue: Command graphs cannot be recorded on queues "
+                      "with profiling enabled"};
+
+    graph._graph->begin_recording(_impl->is_in_order, _impl->node_group_id);
+    _impl->recording_graph = graph._graph;
+    _impl->previous_submission_before_recording =
+        std::exchange(_impl->previous_submission, nullptr);
+  }
+
+  void AdaptiveCpp_end_recording() {
+    std::shared_ptr<rt::command_graph> graph;
+    {
+      std::lock_guard<std::mutex> lock{_impl->lock};
+      graph = _impl->recording_graph;
+    }
+    if(!graph)
+      throw exception{make_error_code(errc::invalid),
+                      "queue: Not recording a command graph"};
+
+    std::lock_guard<std::mutex> lock{_impl->lock};
+    graph->end_recording();
+    _impl->recording_graph = nullptr;
+    _impl->previous_submission =
+        std::exchange(_impl->previous_submission_before_recording, nullptr);
+  }
+
+  bool AdaptiveCpp_is_recording() const {
+    std::lock_guard<std::mutex> lock{_impl->lock};
+    return _impl->recording_graph != nullptr;
+  }
+
+  /// Submits all operations of a graph previously recorded on this queue.
+  /// Dependencies between the operations have been resolved during
+  /// recording. Code objects are not: Kernels are looked up in the kernel
+  /// cache (and JIT-compiled if necessary) when replayed operations are
+  /// executed, as for regular submissions. Submission hooks and
+  /// command group properties are not applied again.
+  /// \return An event that completes once all replayed operations
+  /// have completed.
+  event AdaptiveCpp_replay(const AdaptiveCpp_command_graph &graph) {
+    std::lock_guard<std::mutex> lock{_impl->lock};
+
+    validate_replayable_graph(graph);
+    if(graph._graph->size() == 0)
+      return event{};
+
+    handler cgh{get_context(),
+                _impl->handler,
+                _impl->default_hints,
+                _impl->requires_runtime.get(),
+                &(_impl->allocation_cache),
+                &(_impl->most_recent_reduction_kernel)};
+
+    rt::dag_node_ptr node = execute_submission(
+        [&](handler &cgh) { cgh.replay_graph(*graph._graph); }, cgh);
+
+    return event{node, _impl->handler};
+  }
+
+  /// Replaces the operation recorded at position \c index (in recording
+  /// order) with the operation from the command group \c cgf, e.g. to update
+  /// kernel arguments. The dependencies of the recorded operation are kept;
+  /// dependencies expressed within \c cgf are ignored.
+  template <typename T>
+  void AdaptiveCpp_update_recorded_operation(AdaptiveCpp_command_graph &graph,
+                                             std::size_t index, T cgf) {
+    std::lock_guard<std::mutex> lock{_impl->lock};
+
+    validate_replayable_graph(graph);
+    if(index >= graph._graph->size())
+      throw exception{make_error_code(errc::invalid),
+                      "queue: Command graph operation index out of range"};
+
+    rt::command_graph updated_graph;
+    updated_graph.begin_recording(false, _impl->node_group_id);
+
+    handler cgh{get_context(),
+                _impl->handler,
+                _impl->default_hints,
+                _impl->requires_runtime.get(),
+                &(_impl->allocation_cache),
+                &(_impl->most_recent_reduction_kernel)};
+    cgh._recording_graph = &updated_graph;
+    cgf(cgh);
+
+    updated_graph.end_recording();
+    if(updated_graph.size() != 1)
+      throw exception{make_error_code(errc::invalid),
+                      "queue: Command group for updating a command graph "
+                      "must contain exactly one operation"};
+
+    graph._graph->update(index, updated_graph.get_operation(0));
+  }
+
   template<class InteropFunction>
   event AdaptiveCpp_enqueue_custom_operation(InteropFunction op) {
     return this->submit([&](sycl::handler &cgh) {
@@ -1079,6 +1199,15 @@ private:
     return node;
   }
       
+  void validate_replayable_graph(const AdaptiveCpp_command_graph &graph) const {
+    if(_impl->recording_graph || graph._graph->is_recording())
+      throw exception{make_error_code(errc::invalid),
+                      "queue: Command graph is still being recorded"};
+    if(graph._graph->get_node_group() != _impl->node_group_id)
+      throw exception{make_error_code(errc::invalid),
+                      "queue: Command graph was not recorded on this queue"};
+  }
+
   bool is_device_in_context(const device &dev, const context &ctx) const {    
     std::vector<device> devices = ctx.get_devices();
     for (const auto context_dev : devices) {
@@ -12,7 +12,9 @@
 #include "hipSYCL/common/appdb.hpp"
 #include "hipSYCL/common/filesystem.hpp"
 #include "hipSYCL/runtime/kernel_configuration.hpp"
+#include <algorithm>
 #include <fstream>
+#include <string_view>
 #include <type_traits>
 
 namespace hipsycl::common::db {
@@ -69,6 +71,35 @@ void binary_entry::dump(std::ostream& ostr, int indentation_level) const {
                        indentation_level);
 }
 
+void stdpar_sample::dump(std::ostream& ostr, int indentation_level) const {
+  print_key_value_pair(ostr, "total_problem_size", total_problem_size,
+                       indentation_level);
+  print_key_value_pair(ostr, "total_runtime", total_runtime, indentation_level);
+  print_key_value_pair(ostr, "num_samples", num_samples, indentation_level);
+}
+
+void stdpar_op_entry::dump(std::ostream& ostr, int indentation_level) const {
+  auto print_samples = [&](const std::string& name, const auto& samples) {
+    print_key_value_pair(ostr, name, "<map>", indentation_level);
+    for(const auto& entry : samples) {
+      print_key_value_pair(ostr, std::to_string(entry.first), "<sample>",
+                           indentation_level + 1);
+      entry.second.dump(ostr, indentation_level + 2);
+    }
+  };
+  print_samples("host_samples", host_samples);
+  print_samples("offload_samples", offload_samples);
+}
+
+void stdpar_dataset::dump(std::ostream& ostr, int indentation_level) const {
+  print_key_value_pair(ostr, "ops", "<map>", indentation_level);
+  for(const auto& entry : ops) {
+    print_key_value_pair(ostr, std::to_string(entry.first), "<op-entry>",
+                         indentation_level + 1);
+    entry.second.dump(ostr, indentation_level + 2);
+  }
+}
+
 void appdb_data::dump(std::ostream& ostr, int indentation_level) const {
   print_key_value_pair(ostr, "content_version", content_version, indentation_level);
   
@@ -94,38 +125,321 @@ void appdb_data::dump(std::ostream& ostr, int indentation_level) const {
     print_key_value_pair(ostr, binary_name, "<binary-entry>", indentation_level+1);
     entry.second.dump(ostr, indentation_level+2);
   }
+
+  print_key_value_pair(ostr, "stdpar_datasets", "<map>", indentation_level);
+
+  for(const auto& entry : stdpar_datasets) {
+    print_key_value_pair(ostr, entry.first, "<stdpar-dataset>", indentation_level+1);
+    entry.second.dump(ostr, indentation_level+2);
+  }
 }
 
-appdb::appdb(const std::string& db_path) 
-: _db_path{db_path}, _lock{0}, _was_modified{false} {
+namespace {
 
-  if(filesystem::exists(db_path)) {
-    std::ifstream file{_db_path, std::ios::in | std::ios::binary | std::ios::ate};
-    if (!file.is_open())
-      return;
-    std::streamsize file_size = file.tellg();
-    
-    file.seekg(0, std::ios::beg);
+bool read_appdb(const std::string& path, appdb_data& out) {
+  if(!filesystem::exists(path))
+    return false;
+
+  std::ifstream file{path, std::ios::in | std::ios::binary | std::ios::ate};
+  if (!file.is_open())
+    return false;
+  std::streamsize file_size = file.tellg();
+
+  file.seekg(0, std::ios::beg);
 
-    std::vector<uint8_t> file_content;
-    file_content.resize(file_size);
-    file.read(reinterpret_cast<char *>(file_content.data()), file_size);
+  std::vector<uint8_t> file_content;
+  file_content.resize(file_size);
+  file.read(reinterpret_cast<char *>(file_content.data()), file_size);
+
+  std::error_code ec;
+  appdb_data result = msgpack::unpack<appdb_data>(file_content, ec);
+  if(ec)
+    return false;
+  out = std::move(result);
+  return true;
+}
 
-    _data = msgpack::unpack<appdb_data>(file_content);
+const kernel_arg_value_statistics *
+find_tracked_value(const kernel_arg_entry &entry, uint64_t value) {
+  for(const auto& statistics : entry.common_values)
+    if(statistics.count > 0 && statistics.value == value)
+      return &statistics;
+  return nullptr;
+}
+
+// Merges the modifications of a kernel argument entry since the last
+// synchronization (local relative to baseline) into the entry on disk.
+// Invocation numbers in last_used of local values that were used since
+// the last synchronization are translated by invocation_offset into the
+// numbering of the merged entry.
+void merge_kernel_arg(kernel_arg_entry &disk, const kernel_arg_entry &local,
+                      const kernel_arg_entry *baseline,
+                      uint64_t baseline_invocations,
+                      int64_t invocation_offset) {
+  for(int i = 0; i < kernel_arg_entry::max_tracked_values; ++i) {
+    const auto& local_value = local.common_values[i];
+    if(local_value.count == 0)
+      continue;
+
+    uint64_t new_count = local_value.count;
+    if (const kernel_arg_value_statistics *baseline_value =
+            baseline ? find_tracked_value(*baseline, local_value.value)
+                     : nullptr) {
+      // If the value was evicted and re-added locally in the meantime,
+      // its count may have decreased; in this case, all of it is new.
+      if(baseline_value->count <= local_value.count)
+        new_count = local_value.count - baseline_value->count;
+    }
+
+    bool was_specialized = local.was_specialized[i];
+    if(new_count == 0 && !was_specialized)
+      continue;
+
+    uint64_t last_used = local_value.last_used;
+    if(last_used > baseline_invocations)
+      last_used = static_cast<uint64_t>(last_used + invocation_offset);
+
+    int target_slot = -1;
+    int empty_slot = -1;
+    int eviction_candidate_slot = -1;
+    for(int j = 0; j < kernel_arg_entry::max_tracked_values; ++j) {
+      const auto& disk_value = disk.common_values[j];
+      if(disk_value.count > 0 && disk_value.value == local_value.value) {
+        target_slot = j;
+        break;
+      } else if(disk_value.count == 0) {
+        empty_slot = j;
+      } else if (!disk.was_specialized[j] &&
+                 disk_value.last_used < last_used &&
+                 (eviction_candidate_slot < 0 ||
+                  disk_value.last_used <
+                      disk.common_values[eviction_candidate_slot].last_used)) {
+        eviction_candidate_slot = j;
+      }
+    }
+
+    if(target_slot >= 0) {
+      auto& disk_value = disk.common_values[target_slot];
+      disk_value.count += new_count;
+      disk_value.last_used = std::max(disk_value.last_used, last_used);
+      disk.was_specialized[target_slot] =
+          disk.was_specialized[target_slot] || was_specialized;
+    } else {
+      int slot = empty_slot >= 0 ? empty_slot : eviction_candidate_slot;
+      // If no slot is available, the disk state has precedence.
+      if(slot >= 0 && new_count > 0) {
+        auto& disk_value = disk.common_values[slot];
+        disk_value.value = local_value.value;
+        disk_value.count = new_count;
+        disk_value.last_used = last_used;
+        disk.was_specialized[slot] = was_specialized;
+      }
+    }
   }
 }
 
+void merge_kernel(kernel_entry &disk, const kernel_entry &local,
+                  const kernel_entry *baseline) {
+  uint64_t baseline_invocations =
+      baseline ? baseline->num_registered_invocations : 0;
+  uint64_t new_invocations =
+      local.num_registered_invocations >= baseline_invocations
+          ? local.num_registered_invocations - baseline_invocations
+          : local.num_registered_invocations;
+  int64_t invocation_offset =
+      static_cast<int64_t>(disk.num_registered_invocations) -
+      static_cast<int64_t>(baseline_invocations);
+
+  if(disk.kernel_args.size() < local.kernel_args.size())
+    disk.kernel_args.resize(local.kernel_args.size());
+
+  for(std::size_t i = 0; i < local.kernel_args.size(); ++i) {
+    const kernel_arg_entry *baseline_arg =
+        (baseline && i < baseline->kernel_args.size())
+            ? &baseline->kernel_args[i]
+            : nullptr;
+    merge_kernel_arg(disk.kernel_args[i], local.kernel_args[i], baseline_arg,
+                     baseline_invocations, invocation_offset);
+  }
+
+  disk.num_registered_invocations += new_invocations;
+
+  for(int idx : local.retained_argument_indices) {
+    if (std::find(disk.retained_argument_indices.begin(),
+                  disk.retained_argument_indices.end(),
+                  idx) == disk.retained_argument_indices.end())
+      disk.retained_argument_indices.push_back(idx);
+  }
+  std::sort(disk.retained_argument_indices.begin(),
+            disk.retained_argument_indices.end());
+
+  disk.first_iads_invocation_run =
+      std::min(disk.first_iads_invocation_run, local.first_iads_invocation_run);
+}
+
+// Samples only accumulate, so the modifications since the last
+// synchronization are the differences to the baseline.
+void merge_stdpar_samples(std::map<uint64_t, stdpar_sample> &disk,
+                          const std::map<uint64_t, stdpar_sample> &local,
+                          const std::map<uint64_t, stdpar_sample> *baseline) {
+  for(const auto& entry : local) {
+    stdpar_sample new_sample = entry.second;
+    if(baseline) {
+      auto baseline_sample = baseline->find(entry.first);
+      if (baseline_sample != baseline->end() &&
+          baseline_sample->second.num_samples <= new_sample.num_samples) {
+        new_sample.total_problem_size -= baseline_sample->second.total_problem_size;
+        new_sample.total_runtime -= baseline_sample->second.total_runtime;
+        new_sample.num_samples -= baseline_sample->second.num_samples;
+      }
+    }
+    if(new_sample.num_samples == 0)
+      continue;
+
+    stdpar_sample& disk_sample = disk[entry.first];
+    disk_sample.total_problem_size += new_sample.total_problem_size;
+    disk_sample.total_runtime += new_sample.total_runtime;
+    disk_sample.num_samples += new_sample.num_samples;
+  }
+}
+
+void merge_stdpar_dataset(stdpar_dataset &disk, const stdpar_dataset &local,
+                          const stdpar_dataset *baseline) {
+  for(const auto& entry : local.ops) {
+    const stdpar_op_entry* baseline_op = nullptr;
+    if(baseline) {
+      auto it = baseline->ops.find(entry.first);
+      if(it != baseline->ops.end())
+        baseline_op = &it->second;
+    }
+    stdpar_op_entry& disk_op = disk.ops[entry.first];
+    merge_stdpar_samples(disk_op.host_samples, entry.second.host_samples,
+                         baseline_op ? &baseline_op->host_samples : nullptr);
+    merge_stdpar_samples(disk_op.offload_samples, entry.second.offload_samples,
+                         baseline_op ? &baseline_op->offload_samples : nullptr);
+  }
+}
+
+// Merges the modifications of local since baseline into disk.
+void merge(appdb_data &disk, const appdb_data &local,
+           const appdb_data &baseline) {
+  for(const auto& entry : local.kernels) {
+    auto baseline_entry = baseline.kernels.find(entry.first);
+    merge_kernel(disk.kernels[entry.first], entry.second,
+                 baseline_entry != baseline.kernels.end()
+                     ? &baseline_entry->second
+                     : nullptr);
+  }
+
+  for(const auto& entry : local.binaries) {
+    auto baseline_entry = baseline.binaries.find(entry.first);
+    if (baseline_entry == baseline.binaries.end() ||
+        baseline_entry->second.jit_cache_filename !=
+            entry.second.jit_cache_filename)
+      disk.binaries[entry.first] = entry.second;
+  }
+
+  for(const auto& entry : local.stdpar_datasets) {
+    auto baseline_entry = baseline.stdpar_datasets.find(entry.first);
+    merge_stdpar_dataset(disk.stdpar_datasets[entry.first], entry.second,
+                         baseline_entry != baseline.stdpar_datasets.end()
+                             ? &baseline_entry->second
+                             : nullptr);
+  }
+}
+
+}
+
+appdb::appdb(const std::string& db_path, std::size_t flush_interval)
+: _db_path{db_path}, _lock{0}, _was_modified{false} {
+
+  read_appdb(_db_path, _data);
+  _last_synchronized_data = _data;
+  _application_run = _data.content_version;
+
+  if(flush_interval > 0)
+    _background_flush_thread =
+        std::thread{[this, flush_interval]() {
+                      run_background_flushes(flush_interval);
+                    }};
+}
+
 appdb::~appdb() {
-  if(_was_modified) {
-    ++_data.content_version;
+  if(_background_flush_thread.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock{_background_flush_mutex};
+      _is_shutting_down = true;
+    }
+    _background_flush_cv.notify_one();
+    _background_flush_thread.join();
+  }
+  flush();
+}
 
-    auto data = msgpack::pack(_data);
-    std::string data_string;
-    data_string.resize(data.size());
-    std::memcpy(data_string.data(), data.data(), data.size());
+void appdb::flush() {
+  std::lock_guard<std::mutex> flush_lock{_flush_mutex};
 
-    common::filesystem::atomic_write(_db_path, data_string);
+  appdb_data local;
+  appdb_data baseline;
+  {
+    write_lock lock{_lock};
+    if(!_was_modified)
+      return;
+    _was_modified = false;
+    local = _data;
+    baseline = _last_synchronized_data;
+  }
+
+  appdb_data merged;
+  {
+    filesystem::file_lock db_lock{_db_path + ".lock", true};
+
+    read_appdb(_db_path, merged);
+    merge(merged, local, baseline);
+    // Each application run is counted once, independent of the number
+    // of flushes.
+    if(!_has_registered_application_run) {
+      ++merged.content_version;
+      _has_registered_application_run = true;
+    }
+
+    auto data = msgpack::pack(merged);
+    std::string_view data_string{reinterpret_cast<const char *>(data.data()),
+                                 data.size()};
+
+    if(!common::filesystem::atomic_write(_db_path, data_string)) {
+      // Retry with the next flush
+      write_lock lock{_lock};
+      _was_modified = true;
+      return;
+    }
+  }
+
+  write_lock lock{_lock};
+  if(_was_modified) {
+    // Modified while we were writing; we cannot adopt the merged
+    // state without losing these modifications. Compute the next
+    // flush relative to what we have just written instead.
+    _last_synchronized_data = std::move(local);
+  } else {
+    // Adopt statistics of other processes
+    merged.content_version = _application_run;
+    _data = merged;
+    _last_synchronized_data = std::move(merged);
   }
 }
 
-}
\ No newline at end of file
+void appdb::run_background_flushes(std::size_t flush_interval) {
+  std::unique_lock<std::mutex> lock{_background_flush_mutex};
+  while(!_is_shutting_down) {
+    _background_flush_cv.wait_for(lock, std::chrono::seconds(flush_interval),
+                                  [this]() { return _is_shutting_down; });
+    if(!_is_shutting_down) {
+      lock.unlock();
+      flush();
+      lock.lock();
+    }
+  }
+}
+
+}
@@ -24,6 +24,8 @@
 #ifndef _WIN32
 #include <dlfcn.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/file.h>
 #include <sys/types.h>
 #include <pwd.h>
 #include <limits.h>
@@ -127,7 +129,7 @@ std::string absolute(const std::string& path) {
   return fs::absolute(path).string();
 }
 
-bool atomic_write(const std::string &filename, const std::string &data) {
+bool atomic_write(const std::string &filename, std::string_view data) {
   fs::path p{filename};
 
   std::string temp_file = std::to_string(random_number<std::size_t>())+".tmp";
@@ -153,6 +155,23 @@ bool remove(const std::string &filename) {
   return false;
 }
 
+file_lock::file_lock(const std::string& lock_path, bool exclusive) {
+#ifndef _WIN32
+  _fd = ::open(lock_path.c_str(), O_RDWR | O_CREAT, 0644);
+  if(_fd >= 0)
+    flock(_fd, exclusive ? LOCK_EX : LOCK_SH);
+#endif
+}
+
+file_lock::~file_lock() {
+#ifndef _WIN32
+  if(_fd >= 0) {
+    flock(_fd, LOCK_UN);
+    ::close(_fd);
+  }
+#endif
+}
+
 persistent_storage::persistent_storage() {
 #ifndef _WIN32
 
@@ -213,11 +232,22 @@ persistent_storage::persistent_storage() {
   fs::create_directories(_this_app_dir);
   fs::create_directories(_jit_cache_dir);
 
+  std::size_t appdb_flush_interval = 60;
+  rt::try_get_environment_variable("rt_appdb_flush_interval",
+                                   appdb_flush_interval);
 #ifndef _WIN32
-  _this_app_db = std::make_unique<db::appdb>(generate_appdb_path(app_path));
+  _this_app_db = std::make_unique<db::appdb>(generate_appdb_path(app_path),
+                                             appdb_flush_interval);
 #else
-  _this_app_db = std::make_unique<db::appdb>(generate_appdb_path(""));
+  _this_app_db = std::make_unique<db::appdb>(generate_appdb_path(""),
+                                             appdb_flush_interval);
 #endif
+
+  std::size_t jit_cache_max_size_mb = 4096;
+  rt::try_get_environment_variable("rt_jit_cache_max_size",
+                                   jit_cache_max_size_mb);
+  _jit_cache_archive = std::make_unique<jit_cache_archive>(
+      _jit_cache_dir, jit_cache_max_size_mb * 1024 * 1024);
 }
 
 std::string persistent_storage::generate_app_dir(const std::string& app_path) const {
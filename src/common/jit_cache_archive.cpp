@@ -0,0 +1,474 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+#include "hipSYCL/common/jit_cache_archive.hpp"
+#include "hipSYCL/common/config.hpp"
+#include "hipSYCL/common/filesystem.hpp"
+#include "hipSYCL/common/stable_running_hash.hpp"
+#include "hipSYCL/common/msgpack/msgpack.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include HIPSYCL_CXX_FILESYSTEM_HEADER
+namespace fs = HIPSYCL_CXX_FILESYSTEM_NAMESPACE;
+
+namespace hipsycl {
+namespace common {
+namespace filesystem {
+
+namespace {
+
+constexpr uint64_t pack_magic = 0x4b434150504341ull;
+constexpr uint64_t record_magic = 0x5243504a50504341ull;
+constexpr uint64_t pack_format_version = 1;
+
+struct pack_header {
+  uint64_t magic;
+  uint64_t version;
+  uint64_t generation;
+};
+
+struct record_header {
+  uint64_t magic;
+  uint64_t id[2];
+  uint64_t size;
+  uint64_t hash;
+};
+
+constexpr uint64_t record_alignment = 8;
+// Only compact if at least this many bytes can be reclaimed
+constexpr uint64_t min_compaction_gain = 1024 * 1024;
+
+uint64_t align_record_offset(uint64_t offset) {
+  return (offset + record_alignment - 1) / record_alignment * record_alignment;
+}
+
+uint64_t now() {
+  return std::chrono::duration_cast<std::chrono::seconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// The LRU timestamp of an entry is only updated on lookups if it has moved
+// by more than this many seconds, such that cache hits usually do not
+// require rewriting the index. This is precise enough for eviction.
+constexpr uint64_t last_used_update_granularity = 24 * 60 * 60;
+
+uint64_t hash_binary(std::string_view data) {
+  stable_running_hash h;
+  h(data.data(), data.size());
+  return h.get_current_hash();
+}
+
+uint64_t generate_pack_generation() {
+  std::random_device rd;
+  std::mt19937_64 gen{rd()};
+  return gen() ^ now();
+}
+
+uint64_t get_file_size(const std::string& path) {
+  std::error_code ec;
+  auto size = fs::file_size(path, ec);
+  if(ec)
+    return 0;
+  return size;
+}
+
+std::string make_pack_header(uint64_t generation) {
+  pack_header header{pack_magic, pack_format_version, generation};
+  return std::string{reinterpret_cast<const char *>(&header), sizeof(header)};
+}
+
+void append_record(std::string &out, const jit_cache_archive::id_type &id,
+                   std::string_view data, uint64_t hash) {
+  record_header header{record_magic, {id[0], id[1]}, data.size(), hash};
+  out.append(reinterpret_cast<const char *>(&header), sizeof(header));
+  out.append(data.data(), data.size());
+  out.append(align_record_offset(out.size()) - out.size(), '\0');
+}
+
+}
+
+std::shared_ptr<const mapped_file> mapped_file::open(const std::string &path) {
+  std::shared_ptr<mapped_file> result{new mapped_file{}};
+#ifndef _WIN32
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if(fd < 0)
+    return nullptr;
+  struct stat file_stat;
+  if(fstat(fd, &file_stat) != 0) {
+    ::close(fd);
+    return nullptr;
+  }
+  result->_size = static_cast<std::size_t>(file_stat.st_size);
+  if(result->_size > 0) {
+    void *ptr = mmap(nullptr, result->_size, PROT_READ, MAP_SHARED, fd, 0);
+    if(ptr == MAP_FAILED) {
+      ::close(fd);
+      return nullptr;
+    }
+    result->_data = static_cast<const char*>(ptr);
+    result->_is_mapped = true;
+  }
+  // The mapping remains valid after closing the file descriptor
+  ::close(fd);
+#else
+  std::ifstream file{path, std::ios::in | std::ios::binary | std::ios::ate};
+  if(!file.is_open())
+    return nullptr;
+  std::streamsize file_size = file.tellg();
+  file.seekg(0, std::ios::beg);
+  result->_fallback_storage.resize(file_size);
+  file.read(result->_fallback_storage.data(), file_size);
+  result->_data = result->_fallback_storage.data();
+  result->_size = result->_fallback_storage.size();
+#endif
+  return result;
+}
+
+mapped_file::~mapped_file() {
+#ifndef _WIN32
+  if(_is_mapped)
+    munmap(const_cast<char *>(_data), _size);
+#endif
+}
+
+jit_cache_archive::jit_cache_archive(const std::string &directory,
+                                     std::size_t max_size)
+    : _pack_path{join_path(directory, "jit-cache.pack")},
+      _index_path{join_path(directory, "jit-cache.idx")},
+      _lock_path{join_path(directory, "jit-cache.lock")}, _max_size{max_size} {
+
+  std::lock_guard<std::mutex> lock{_mutex};
+  file_lock archive_lock{_lock_path, true};
+
+  // If initialization fails, the archive remains empty and
+  // all stores will fail.
+  if(read_pack_generation() == 0)
+    initialize_pack_file();
+  reload();
+}
+
+jit_cache_archive::~jit_cache_archive() {
+  flush();
+}
+
+bool jit_cache_archive::lookup(const id_type &id, archived_binary &out) {
+  std::lock_guard<std::mutex> lock{_mutex};
+
+  auto it = _index.entries.find(id);
+  if(it == _index.entries.end()) {
+    // Another process might have added the binary in the meantime
+    file_lock archive_lock{_lock_path, false};
+    refresh();
+    it = _index.entries.find(id);
+    if(it == _index.entries.end())
+      return false;
+  }
+
+  index_entry& entry = it->second;
+  if(!_mapping || entry.offset + entry.size > _mapping->size())
+    remap();
+  if(!_mapping || entry.offset + entry.size > _mapping->size())
+    return false;
+
+  std::string_view data{_mapping->data() + entry.offset, entry.size};
+
+  if(!_validated_entries[id]) {
+    if(hash_binary(data) != entry.hash) {
+      _index.entries.erase(it);
+      _validated_entries.erase(id);
+      _index_was_modified = true;
+      return false;
+    }
+    _validated_entries[id] = true;
+  }
+
+  uint64_t current_time = now();
+  if(current_time > entry.last_used + last_used_update_granularity) {
+    entry.last_used = current_time;
+    _index_was_modified = true;
+  }
+
+  out = archived_binary{_mapping, data};
+  return true;
+}
+
+bool jit_cache_archive::store(const id_type &id, std::string_view data) {
+  std::lock_guard<std::mutex> lock{_mutex};
+  file_lock archive_lock{_lock_path, true};
+
+  refresh();
+
+  uint64_t hash = hash_binary(data);
+  std::string record;
+  append_record(record, id, data, hash);
+
+  uint64_t record_offset = get_file_size(_pack_path);
+  if(record_offset != _index.covered_pack_size) {
+    // The pack file ends with an incomplete record, e.g. because a process
+    // crashed while writing. Discard it.
+    std::error_code ec;
+    fs::resize_file(_pack_path, _index.covered_pack_size, ec);
+    if(ec)
+      return false;
+    record_offset = _index.covered_pack_size;
+  }
+
+  std::ofstream file{_pack_path,
+                     std::ios::binary | std::ios::out | std::ios::app};
+  if(!file.is_open())
+    return false;
+  file.write(record.data(), record.size());
+  file.close();
+  if(!file)
+    return false;
+
+  index_entry entry;
+  entry.offset = record_offset + sizeof(record_header);
+  entry.size = data.size();
+  entry.hash = hash;
+  entry.last_used = now();
+
+  _index.entries[id] = entry;
+  _index.covered_pack_size = record_offset + record.size();
+  _validated_entries[id] = true;
+  _index_was_modified = true;
+
+  return true;
+}
+
+void jit_cache_archive::flush() {
+  std::lock_guard<std::mutex> lock{_mutex};
+
+  bool exceeds_max_size = _max_size > 0 && get_stored_bytes_impl() > _max_size;
+  if(!_index_was_modified && !exceeds_max_size)
+    return;
+
+  file_lock archive_lock{_lock_path, true};
+
+  // Merge usage information with the index on disk, which might
+  // have been updated by other processes.
+  auto our_entries = _index.entries;
+  uint64_t our_generation = _index.pack_generation;
+  reload();
+  // Entries that are only known to us were evicted by another process,
+  // and binaries that we have stored are picked up from the pack file,
+  // so only usage times need to be merged.
+  if(_index.pack_generation == our_generation) {
+    for(const auto& our_entry : our_entries) {
+      auto it = _index.entries.find(our_entry.first);
+      if(it != _index.entries.end()) {
+        it->second.last_used =
+            std::max(it->second.last_used, our_entry.second.last_used);
+      }
+    }
+  }
+
+  evict_lru_entries();
+
+  uint64_t pack_size = get_file_size(_pack_path);
+  uint64_t stored_bytes = get_stored_bytes_impl();
+  uint64_t unused_bytes = pack_size > stored_bytes ? pack_size - stored_bytes : 0;
+  if(unused_bytes > stored_bytes && unused_bytes > min_compaction_gain) {
+    if(compact()) {
+      _index_was_modified = false;
+      return;
+    }
+  }
+
+  // If the index cannot be written, it is rebuilt from the pack file
+  // by the next process.
+  write_index();
+  _index_was_modified = false;
+}
+
+std::size_t jit_cache_archive::get_num_entries() const {
+  std::lock_guard<std::mutex> lock{_mutex};
+  return _index.entries.size();
+}
+
+std::size_t jit_cache_archive::get_stored_bytes() const {
+  std::lock_guard<std::mutex> lock{_mutex};
+  return get_stored_bytes_impl();
+}
+
+std::size_t jit_cache_archive::get_stored_bytes_impl() const {
+  std::size_t result = 0;
+  for(const auto& entry : _index.entries)
+    result += entry.second.size;
+  return result;
+}
+
+void jit_cache_archive::refresh() {
+  if(read_pack_generation() != _index.pack_generation) {
+    // Pack file was compacted or re-initialized by another process
+    reload();
+  } else if(get_file_size(_pack_path) > _index.covered_pack_size) {
+    remap();
+    scan_pack_tail();
+  }
+}
+
+void jit_cache_archive::reload() {
+  remap();
+  _validated_entries.clear();
+
+  uint64_t generation = read_pack_generation();
+
+  index_data disk_index;
+  if(auto index_file = mapped_file::open(_index_path)) {
+    std::error_code ec;
+    disk_index = msgpack::unpack<index_data>(
+        reinterpret_cast<const uint8_t *>(index_file->data()),
+        index_file->size(), ec);
+    if(ec)
+      disk_index = index_data{};
+  }
+
+  if(disk_index.pack_generation != generation) {
+    disk_index = index_data{};
+    disk_index.pack_generation = generation;
+    disk_index.covered_pack_size = sizeof(pack_header);
+    _index_was_modified = true;
+  }
+  _index = std::move(disk_index);
+
+  scan_pack_tail();
+}
+
+void jit_cache_archive::remap() {
+  _mapping = mapped_file::open(_pack_path);
+}
+
+void jit_cache_archive::scan_pack_tail() {
+  if(!_mapping)
+    return;
+
+  uint64_t current = _index.covered_pack_size;
+  while(current + sizeof(record_header) <= _mapping->size()) {
+    record_header header;
+    std::memcpy(&header, _mapping->data() + current, sizeof(header));
+    if(header.magic != record_magic)
+      break;
+    uint64_t payload_offset = current + sizeof(record_header);
+    uint64_t next = align_record_offset(payload_offset + header.size);
+    // Incomplete record, e.g. from a process that crashed during a write
+    if(next > _mapping->size())
+      break;
+
+    index_entry entry;
+    entry.offset = payload_offset;
+    entry.size = header.size;
+    entry.hash = header.hash;
+    entry.last_used = now();
+    id_type id{header.id[0], header.id[1]};
+    _index.entries[id] = entry;
+    _validated_entries.erase(id);
+    _index_was_modified = true;
+
+    current = next;
+  }
+  _index.covered_pack_size = current;
+}
+
+bool jit_cache_archive::write_index() {
+  auto data = msgpack::pack(_index);
+  return atomic_write(
+      _index_path,
+      std::string_view{reinterpret_cast<const char *>(data.data()), data.size()});
+}
+
+void jit_cache_archive::evict_lru_entries() {
+  if(_max_size == 0)
+    return;
+
+  std::size_t stored_bytes = get_stored_bytes_impl();
+  if(stored_bytes <= _max_size)
+    return;
+
+  std::vector<std::pair<uint64_t, id_type>> entries_by_usage;
+  for(const auto& entry : _index.entries)
+    entries_by_usage.push_back(
+        std::make_pair(entry.second.last_used, entry.first));
+  std::sort(entries_by_usage.begin(), entries_by_usage.end());
+
+  for(const auto& entry : entries_by_usage) {
+    if(stored_bytes <= _max_size)
+      break;
+    stored_bytes -= _index.entries[entry.second].size;
+    _index.entries.erase(entry.second);
+    _validated_entries.erase(entry.second);
+    _index_was_modified = true;
+  }
+}
+
+bool jit_cache_archive::compact() {
+  if(!_mapping)
+    return false;
+
+  index_data new_index;
+  new_index.pack_generation = generate_pack_generation();
+
+  std::string new_pack = make_pack_header(new_index.pack_generation);
+  for(const auto& entry : _index.entries) {
+    if(entry.second.offset + entry.second.size > _mapping->size())
+      continue;
+    index_entry new_entry = entry.second;
+    new_entry.offset = new_pack.size() + sizeof(record_header);
+    append_record(new_pack, entry.first,
+                  std::string_view{_mapping->data() + entry.second.offset,
+                                   entry.second.size},
+                  entry.second.hash);
+    new_index.entries[entry.first] = new_entry;
+  }
+  new_index.covered_pack_size = new_pack.size();
+
+  // If we are interrupted between writing the pack and the index, the
+  // generation mismatch causes the index to be rebuilt from the pack file.
+  if(!atomic_write(_pack_path, new_pack))
+    return false;
+
+  _index = std::move(new_index);
+  remap();
+  return write_index();
+}
+
+uint64_t jit_cache_archive::read_pack_generation() const {
+  std::ifstream file{_pack_path, std::ios::in | std::ios::binary};
+  if(!file.is_open())
+    return 0;
+  pack_header header;
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if(!file || header.magic != pack_magic ||
+     header.version != pack_format_version)
+    return 0;
+  return header.generation;
+}
+
+bool jit_cache_archive::initialize_pack_file() {
+  return atomic_write(_pack_path, make_pack_header(generate_pack_generation()));
+}
+
+}
+}
+}
@@ -21,6 +21,7 @@
 #include "hipSYCL/compiler/cbs/SimplifyKernel.hpp"
 #include "hipSYCL/compiler/cbs/SplitterAnnotationAnalysis.hpp"
 #include "hipSYCL/compiler/cbs/SubCfgFormation.hpp"
+#include "hipSYCL/compiler/cbs/WorkItemLoopVectorizer.hpp"
 #include "hipSYCL/compiler/llvm-to-backend/host/HostKernelWrapperPass.hpp"
 
 #include <llvm/IR/LegacyPassManager.h>
@@ -50,6 +51,7 @@ void registerCBSPipelineLegacy(llvm::legacy::PassManagerBase &PM) {
   PM.add(new RemoveBarrierCallsPassLegacy{});
 
   PM.add(new KernelFlatteningPassLegacy{});
+  PM.add(new WorkItemLoopVectorizerPassLegacy{});
   PM.add(new LoopsParallelMarkerPassLegacy{});
 }
 #endif // LLVM_VERSION_MAJOR < 16
@@ -58,7 +60,8 @@ void registerCBSPipelineLegacy(llvm::legacy::PassManagerBase &PM) {
 #define IS_ROCM_CLANG_VERSION_5_5_0
 #endif
 
-void registerCBSPipeline(llvm::ModulePassManager &MPM, OptLevel Opt, bool IsSscp) {
+void registerCBSPipeline(llvm::ModulePassManager &MPM, OptLevel Opt, bool IsSscp,
+                         unsigned VectorWidth) {
   MPM.addPass(SplitterAnnotationAnalysisCacher{});
 
   llvm::FunctionPassManager FPM;
@@ -95,8 +98,10 @@ void registerCBSPipeline(llvm::ModulePassManager &MPM, OptLevel Opt, bool IsSscp
   FPM.addPass(SubCfgFormationPass{IsSscp});
   FPM.addPass(RemoveBarrierCallsPass{});
 
-  if (Opt == OptLevel::O3)
+  if (Opt == OptLevel::O3) {
     FPM.addPass(KernelFlatteningPass{});
+    FPM.addPass(WorkItemLoopVectorizerPass{VectorWidth});
+  }
   if (Opt != OptLevel::O0)
     FPM.addPass(LoopsParallelMarkerPass{});
   
@@ -0,0 +1,945 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+#include "hipSYCL/compiler/cbs/WorkItemLoopVectorizer.hpp"
+
+#include "hipSYCL/compiler/cbs/IRUtils.hpp"
+#include "hipSYCL/compiler/cbs/SplitterAnnotationAnalysis.hpp"
+#include "hipSYCL/compiler/cbs/UniformityAnalysis.hpp"
+#include "hipSYCL/compiler/cbs/VectorizationInfo.hpp"
+
+#include "hipSYCL/common/debug.hpp"
+
+#include <llvm/Analysis/LoopIterator.h>
+#include <llvm/Analysis/OptimizationRemarkEmitter.h>
+#include <llvm/Analysis/PostDominators.h>
+#include <llvm/Analysis/TargetTransformInfo.h>
+#include <llvm/Analysis/ValueTracking.h>
+#include <llvm/Analysis/VectorUtils.h>
+#include <llvm/IR/Dominators.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/IntrinsicInst.h>
+#include <llvm/IR/PatternMatch.h>
+#include <llvm/Transforms/Utils/LoopUtils.h>
+
+#include <map>
+
+namespace {
+using namespace hipsycl::compiler;
+
+constexpr const char RemarkPassName[] = "acpp-wi-loop-vectorize";
+constexpr unsigned MaxVectorWidth = 64;
+
+bool isScalarIntrinsicOperand(llvm::Intrinsic::ID ID, unsigned Idx,
+                              const llvm::TargetTransformInfo &TTI) {
+#if LLVM_VERSION_MAJOR < 15
+  return llvm::hasVectorInstrinsicScalarOpd(ID, Idx);
+#elif LLVM_VERSION_MAJOR < 20
+  return llvm::isVectorIntrinsicWithScalarOpAtArg(ID, Idx);
+#else
+  return llvm::isVectorIntrinsicWithScalarOpAtArg(ID, Idx, &TTI);
+#endif
+}
+
+// intrinsics without effect on the semantics of the vectorized loop
+bool isDroppableIntrinsic(const llvm::Instruction &I) {
+  if (llvm::isa<llvm::DbgInfoIntrinsic>(I))
+    return true;
+  if (auto *II = llvm::dyn_cast<llvm::IntrinsicInst>(&I)) {
+    switch (II->getIntrinsicID()) {
+    case llvm::Intrinsic::lifetime_start:
+    case llvm::Intrinsic::lifetime_end:
+    case llvm::Intrinsic::assume:
+    case llvm::Intrinsic::experimental_noalias_scope_decl:
+      return true;
+    default:
+      return false;
+    }
+  }
+  return false;
+}
+
+bool isIntDivRem(const llvm::Instruction &I) {
+  switch (I.getOpcode()) {
+  case llvm::Instruction::UDiv:
+  case llvm::Instruction::SDiv:
+  case llvm::Instruction::URem:
+  case llvm::Instruction::SRem:
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool isVectorizableIntrinsic(const llvm::CallInst &CI) {
+  auto *Callee = CI.getCalledFunction();
+  return Callee && Callee->isIntrinsic() && llvm::isTriviallyVectorizable(Callee->getIntrinsicID());
+}
+
+// derives the vector width from the vector register size and the widest type accessed in memory
+unsigned getTargetVectorWidth(const llvm::Loop &L, const llvm::DataLayout &DL,
+                              const llvm::TargetTransformInfo &TTI) {
+  uint64_t WidestType = 0;
+  for (auto *BB : L.blocks())
+    for (auto &I : *BB)
+      if (llvm::isa<llvm::LoadInst>(I) || llvm::isa<llvm::StoreInst>(I)) {
+        auto *T = llvm::getLoadStoreType(&I);
+        if (T->isIntOrPtrTy() || T->isFloatingPointTy())
+          WidestType = std::max<uint64_t>(WidestType, DL.getTypeSizeInBits(T).getFixedValue());
+      }
+  if (WidestType == 0)
+    WidestType = 32;
+
+  const uint64_t RegisterBits =
+      TTI.getRegisterBitWidth(llvm::TargetTransformInfo::RGK_FixedWidthVector).getFixedValue();
+  return static_cast<unsigned>(RegisterBits / WidestType);
+}
+
+class WorkItemLoopVectorizer {
+  llvm::Function &F;
+  llvm::Loop &L;
+  llvm::LoopInfo &LI;
+  llvm::DominatorTree &DT;
+  llvm::PostDominatorTree &PDT;
+  const llvm::TargetTransformInfo &TTI;
+  const llvm::DataLayout &DL;
+  const unsigned Width;
+
+  // shape of the wi-loop: preheader -> header ... latch -> exit
+  llvm::BasicBlock *Preheader = nullptr;
+  llvm::BasicBlock *Header = nullptr;
+  llvm::BasicBlock *Latch = nullptr;
+  llvm::BasicBlock *Exit = nullptr;
+  llvm::PHINode *IndVar = nullptr;
+  llvm::Value *End = nullptr;
+
+  std::unique_ptr<LoopRegion> RegionImpl;
+  std::unique_ptr<Region> LoopBodyRegion;
+  std::unique_ptr<VectorizationInfo> VecInfo;
+
+  // loop blocks in topological order, ignoring the back edge
+  llvm::SmallVector<llvm::BasicBlock *, 8> Blocks;
+  // blocks that are not executed by all work items of an iteration
+  llvm::SmallPtrSet<const llvm::BasicBlock *, 8> PredicatedBlocks;
+  // instructions that are computed for every work item instead of once per iteration
+  llvm::SmallPtrSet<const llvm::Instruction *, 32> Widened;
+  // work-item private allocas that need a copy per vector lane
+  llvm::SmallVector<llvm::AllocaInst *, 4> PrivateAllocas;
+
+  // code generation state
+  llvm::IRBuilder<> Builder;
+  llvm::DenseMap<const llvm::Value *, llvm::Value *> Scalars;
+  llvm::DenseMap<const llvm::Value *, llvm::Value *> Vectors;
+  llvm::DenseMap<const llvm::Value *, llvm::Value *> Splats;
+  llvm::DenseMap<const llvm::Value *, llvm::Value *> FirstLanes;
+  // nullptr masks denote that all work items are active
+  llvm::DenseMap<const llvm::BasicBlock *, llvm::Value *> BlockMasks;
+  std::map<std::pair<const llvm::BasicBlock *, const llvm::BasicBlock *>, llvm::Value *> EdgeMasks;
+
+public:
+  WorkItemLoopVectorizer(llvm::Function &F, llvm::Loop &L, llvm::LoopInfo &LI,
+                         llvm::DominatorTree &DT, llvm::PostDominatorTree &PDT,
+                         const llvm::TargetTransformInfo &TTI, unsigned Width)
+      : F{F}, L{L}, LI{LI}, DT{DT}, PDT{PDT}, TTI{TTI}, DL{F.getParent()->getDataLayout()},
+        Width{Width}, Builder{F.getContext()} {}
+
+  bool canVectorize(std::string &Reason);
+  void vectorize();
+
+private:
+  bool analyzeLoopShape(std::string &Reason);
+  bool collectPrivateAllocas(std::string &Reason);
+  void analyzeUniformity();
+  bool decideWidening(std::string &Reason);
+  bool checkInstruction(const llvm::Instruction &I, std::string &Reason) const;
+
+  bool inLoop(const llvm::Value *V) const {
+    auto *I = llvm::dyn_cast<llvm::Instruction>(V);
+    return I && L.contains(I);
+  }
+  bool isWidened(const llvm::Value *V) const {
+    if (auto *I = llvm::dyn_cast<llvm::Instruction>(V))
+      return Widened.contains(I);
+    return false;
+  }
+  bool isContiguousAccess(const llvm::Value *Ptr, llvm::Type *AccessT) const;
+
+  llvm::Value *getScalar(llvm::Value *V);
+  llvm::Value *getVector(llvm::Value *V);
+  llvm::Value *getFirstLane(llvm::Value *V);
+  llvm::Value *getAllTrueMask();
+  llvm::Value *getEdgeMask(llvm::BasicBlock *From, const llvm::BasicBlock *To);
+  llvm::Value *computeBlockMask(llvm::BasicBlock *BB);
+
+  void emitInstruction(llvm::Instruction &I);
+  void emitScalar(llvm::Instruction &I);
+  void emitPHI(llvm::PHINode &Phi);
+  void emitLoad(llvm::LoadInst &LI);
+  void emitStore(llvm::StoreInst &SI);
+  void emitCall(llvm::CallInst &CI);
+  void emitWidened(llvm::Instruction &I);
+};
+
+bool WorkItemLoopVectorizer::analyzeLoopShape(std::string &Reason) {
+  if (!L.getSubLoops().empty()) {
+    Reason = "the loop body contains loops";
+    return false;
+  }
+
+  Preheader = L.getLoopPreheader();
+  Header = L.getHeader();
+  Latch = L.getLoopLatch();
+  Exit = L.getExitBlock();
+  if (!Preheader || !Latch || !Exit || L.getExitingBlock() != Latch) {
+    Reason = "the loop is not in simplified form";
+    return false;
+  }
+  if (!Exit->phis().empty()) {
+    Reason = "the loop has live-out values";
+    return false;
+  }
+
+  // expect the canonical wi-loop: iv = phi [start, preheader], [iv + 1, latch]
+  // and the latch branching back while iv + 1 < end.
+  for (auto &Phi : Header->phis()) {
+    if (IndVar) {
+      Reason = "the loop carries values between work items";
+      return false;
+    }
+    IndVar = &Phi;
+  }
+  if (!IndVar || !IndVar->getType()->isIntegerTy()) {
+    Reason = "the loop is not a canonical wi-loop";
+    return false;
+  }
+  auto *Term = llvm::dyn_cast<llvm::BranchInst>(Latch->getTerminator());
+  auto *IndVarNext =
+      llvm::dyn_cast<llvm::BinaryOperator>(IndVar->getIncomingValueForBlock(Latch));
+  auto *Cmp = Term && Term->isConditional() ? llvm::dyn_cast<llvm::ICmpInst>(Term->getCondition())
+                                            : nullptr;
+  if (!IndVarNext || IndVarNext->getOpcode() != llvm::Instruction::Add ||
+      IndVarNext->getOperand(0) != IndVar ||
+      !llvm::PatternMatch::match(IndVarNext->getOperand(1), llvm::PatternMatch::m_One()) || !Cmp ||
+      (Cmp->getPredicate() != llvm::CmpInst::ICMP_ULT &&
+       Cmp->getPredicate() != llvm::CmpInst::ICMP_NE) ||
+      Cmp->getOperand(0) != IndVarNext || !L.isLoopInvariant(Cmp->getOperand(1)) ||
+      Term->getSuccessor(0) != Header) {
+    Reason = "the loop is not a canonical wi-loop";
+    return false;
+  }
+  End = Cmp->getOperand(1);
+
+  for (auto *BB : L.blocks())
+    for (auto &I : *BB)
+      for (auto *U : I.users())
+        if (!L.contains(llvm::cast<llvm::Instruction>(U))) {
+          Reason = "the loop has live-out values";
+          return false;
+        }
+
+  llvm::LoopBlocksRPO RPOT{&L};
+  RPOT.perform(&LI);
+  llvm::DenseMap<const llvm::BasicBlock *, size_t> Order;
+  for (auto *BB : RPOT) {
+    Order[BB] = Blocks.size();
+    Blocks.push_back(BB);
+  }
+  for (auto *BB : Blocks)
+    for (auto *Succ : llvm::successors(BB))
+      if (Succ != Header && L.contains(Succ) && Order[Succ] <= Order[BB]) {
+        Reason = "the loop body has irreducible control flow";
+        return false;
+      }
+
+  return true;
+}
+
+// Allocas that were not arrayified by SubCfgFormation are private to the work item
+// executing the current iteration and need to be replicated per lane.
+bool WorkItemLoopVectorizer::collectPrivateAllocas(std::string &Reason) {
+  llvm::SmallPtrSet<llvm::AllocaInst *, 4> Seen;
+  for (auto *BB : Blocks)
+    for (auto &I : *BB) {
+      if (llvm::isa<llvm::AllocaInst>(I)) {
+        Reason = "the loop body contains allocas";
+        return false;
+      }
+      for (auto *Op : I.operand_values()) {
+        auto *Alloca = llvm::dyn_cast<llvm::AllocaInst>(Op);
+        if (!Alloca || Alloca->hasMetadata(MDKind::Arrayified) || !Seen.insert(Alloca).second)
+          continue;
+        if (!llvm::isa<llvm::ConstantInt>(Alloca->getArraySize()) ||
+            utils::anyOfUsers<llvm::Instruction>(
+                Alloca, [this](llvm::Instruction *UI) { return !L.contains(UI); })) {
+          Reason = "a private variable is shared with code outside of the loop";
+          return false;
+        }
+        PrivateAllocas.push_back(Alloca);
+      }
+    }
+  return true;
+}
+
+void WorkItemLoopVectorizer::analyzeUniformity() {
+  RegionImpl = std::make_unique<LoopRegion>(L);
+  LoopBodyRegion = std::make_unique<Region>(*RegionImpl);
+  VecInfo = std::make_unique<VectorizationInfo>(F, *LoopBodyRegion);
+
+  VecInfo->setPinnedShape(*IndVar, VectorShape::cont());
+  for (auto *Alloca : PrivateAllocas)
+    VecInfo->setPinnedShape(*Alloca, VectorShape::varying());
+
+  VectorizationAnalysis VecAna{*VecInfo, LI, DT, PDT};
+  VecAna.analyze();
+}
+
+bool WorkItemLoopVectorizer::checkInstruction(const llvm::Instruction &I,
+                                              std::string &Reason) const {
+  if (I.isTerminator()) {
+    if (!llvm::isa<llvm::BranchInst>(I) && !llvm::isa<llvm::SwitchInst>(I)) {
+      Reason = std::string{"unsupported terminator "} + I.getOpcodeName();
+      return false;
+    }
+    return true;
+  }
+
+  if (auto *LoadI = llvm::dyn_cast<llvm::LoadInst>(&I)) {
+    if (!LoadI->isSimple()) {
+      Reason = "the loop contains atomic or volatile loads";
+      return false;
+    }
+    return true;
+  }
+  if (auto *StoreI = llvm::dyn_cast<llvm::StoreInst>(&I)) {
+    if (!StoreI->isSimple()) {
+      Reason = "the loop contains atomic or volatile stores";
+      return false;
+    }
+    return true;
+  }
+
+  if (auto *CI = llvm::dyn_cast<llvm::CallInst>(&I)) {
+    if (isDroppableIntrinsic(I))
+      return true;
+    auto *Callee = CI->getCalledFunction();
+    if (!Callee) {
+      Reason = "the loop contains indirect calls";
+      return false;
+    }
+    if (isVectorizableIntrinsic(*CI)) {
+      for (unsigned Idx = 0; Idx < CI->arg_size(); ++Idx)
+        if (isScalarIntrinsicOperand(Callee->getIntrinsicID(), Idx, TTI) &&
+            isWidened(CI->getArgOperand(Idx))) {
+          Reason = ("call to " + Callee->getName() + " with non-uniform scalar operand").str();
+          return false;
+        }
+      return true;
+    }
+    if (CI->isConvergent() || !CI->onlyReadsMemory() || CI->mayHaveSideEffects() ||
+        (PredicatedBlocks.contains(CI->getParent()) && !llvm::isSafeToSpeculativelyExecute(CI))) {
+      Reason = ("call to " + Callee->getName() + " that cannot be vectorized").str();
+      return false;
+    }
+    if (isWidened(CI) && !llvm::VectorType::isValidElementType(CI->getType())) {
+      Reason = ("call to " + Callee->getName() + " returning a non-vectorizable type").str();
+      return false;
+    }
+    return true;
+  }
+
+  if (!Widened.contains(&I))
+    return true;
+
+  if (!llvm::isa<llvm::BinaryOperator>(I) && !llvm::isa<llvm::UnaryOperator>(I) &&
+      !llvm::isa<llvm::CastInst>(I) && !llvm::isa<llvm::CmpInst>(I) &&
+      !llvm::isa<llvm::SelectInst>(I) && !llvm::isa<llvm::GetElementPtrInst>(I) &&
+      !llvm::isa<llvm::PHINode>(I) && !llvm::isa<llvm::FreezeInst>(I)) {
+    Reason = std::string{"cannot vectorize "} + I.getOpcodeName() + " instructions";
+    return false;
+  }
+  if (!llvm::VectorType::isValidElementType(I.getType())) {
+    Reason = std::string{"cannot vectorize "} + I.getOpcodeName() + " of non-scalar type";
+    return false;
+  }
+  for (auto *Op : I.operand_values())
+    if (!llvm::isa<llvm::BasicBlock>(Op) && !llvm::VectorType::isValidElementType(Op->getType())) {
+      Reason = std::string{"cannot vectorize "} + I.getOpcodeName() + " with non-scalar operands";
+      return false;
+    }
+  return true;
+}
+
+bool WorkItemLoopVectorizer::decideWidening(std::string &Reason) {
+  for (auto *BB : Blocks)
+    if (!PDT.dominates(BB, Header))
+      PredicatedBlocks.insert(BB);
+  Widened.insert(PrivateAllocas.begin(), PrivateAllocas.end());
+
+  for (auto *BB : Blocks) {
+    const bool IsPredicated = PredicatedBlocks.contains(BB);
+    for (auto &I : *BB) {
+      if (I.isTerminator() || I.getType()->isVoidTy() || isDroppableIntrinsic(I))
+        continue;
+
+      bool Widen = &I == IndVar || !VecInfo->getVectorShape(I).isUniform();
+      // loads and divisions that may trap must not be executed by masked-off work items
+      Widen |= IsPredicated && (llvm::isa<llvm::LoadInst>(I) || isIntDivRem(I)) &&
+               !llvm::isSafeToSpeculativelyExecute(&I);
+      // joins are resolved by selecting with the edge masks
+      if (auto *Phi = llvm::dyn_cast<llvm::PHINode>(&I))
+        Widen |= Phi != IndVar && Phi->getNumIncomingValues() > 1;
+      for (auto *Op : I.operand_values())
+        Widen |= isWidened(Op);
+
+      if (Widen)
+        Widened.insert(&I);
+    }
+  }
+
+  for (auto *BB : Blocks)
+    for (auto &I : *BB) {
+      if (!checkInstruction(I, Reason))
+        return false;
+
+      if (auto *SI = llvm::dyn_cast<llvm::StoreInst>(&I))
+        if ((isWidened(SI->getValueOperand()) || isWidened(SI->getPointerOperand()) ||
+             PredicatedBlocks.contains(BB)) &&
+            !llvm::VectorType::isValidElementType(SI->getValueOperand()->getType())) {
+          Reason = "cannot vectorize stores of non-scalar type";
+          return false;
+        }
+    }
+  return true;
+}
+
+bool WorkItemLoopVectorizer::canVectorize(std::string &Reason) {
+  if (Width < 2) {
+    Reason = "the vector width is " + std::to_string(Width);
+    return false;
+  }
+  if (!analyzeLoopShape(Reason) || !collectPrivateAllocas(Reason))
+    return false;
+
+  analyzeUniformity();
+  return decideWidening(Reason);
+}
+
+bool WorkItemLoopVectorizer::isContiguousAccess(const llvm::Value *Ptr,
+                                                llvm::Type *AccessT) const {
+  const auto Shape = VecInfo->getVectorShape(*Ptr);
+  const auto Size = DL.getTypeStoreSize(AccessT).getFixedValue();
+  return Shape.isContiguousOrStrided() && Shape.getStride() == static_cast<stride_t>(Size) &&
+         DL.typeSizeEqualsStoreSize(AccessT) &&
+         DL.getTypeAllocSize(AccessT).getFixedValue() == Size;
+}
+
+llvm::Value *WorkItemLoopVectorizer::getScalar(llvm::Value *V) {
+  if (!inLoop(V))
+    return V;
+  assert(!isWidened(V) && "Scalar value of widened instruction requested");
+  auto It = Scalars.find(V);
+  assert(It != Scalars.end() && "Use before definition in vectorized loop body");
+  return It->second;
+}
+
+llvm::Value *WorkItemLoopVectorizer::getVector(llvm::Value *V) {
+  if (auto It = Vectors.find(V); It != Vectors.end())
+    return It->second;
+  if (auto It = Splats.find(V); It != Splats.end())
+    return It->second;
+  auto *Splat = Builder.CreateVectorSplat(Width, getScalar(V));
+  Splats[V] = Splat;
+  return Splat;
+}
+
+// The first lane of affine values can be computed on the scalar operands,
+// this provides the base address of contiguous accesses.
+llvm::Value *WorkItemLoopVectorizer::getFirstLane(llvm::Value *V) {
+  if (!isWidened(V))
+    return getScalar(V);
+  if (auto It = FirstLanes.find(V); It != FirstLanes.end())
+    return It->second;
+
+  auto *I = llvm::cast<llvm::Instruction>(V);
+  llvm::Value *Lane = nullptr;
+  if (I != IndVar && (llvm::isa<llvm::BinaryOperator>(I) || llvm::isa<llvm::CastInst>(I) ||
+                      llvm::isa<llvm::GetElementPtrInst>(I))) {
+    auto *Clone = I->clone();
+    for (unsigned Idx = 0; Idx < Clone->getNumOperands(); ++Idx)
+      Clone->setOperand(Idx, getFirstLane(I->getOperand(Idx)));
+    Lane = Builder.Insert(Clone, I->getName() + ".lane0");
+  } else {
+    Lane = Builder.CreateExtractElement(getVector(V), uint64_t{0});
+  }
+  FirstLanes[V] = Lane;
+  return Lane;
+}
+
+llvm::Value *WorkItemLoopVectorizer::getAllTrueMask() {
+  return llvm::ConstantInt::getTrue(llvm::FixedVectorType::get(Builder.getInt1Ty(), Width));
+}
+
+// Masks are combined with select-based logical operations, such that masked-off
+// lanes never propagate poison from conditions they did not evaluate.
+llvm::Value *WorkItemLoopVectorizer::getEdgeMask(llvm::BasicBlock *From,
+                                                 const llvm::BasicBlock *To) {
+  auto Key = std::make_pair(From, To);
+  if (auto It = EdgeMasks.find(Key); It != EdgeMasks.end())
+    return It->second;
+
+  // compute the masks of all outgoing edges at once, so that conditions are evaluated once
+  llvm::Value *SourceMask = BlockMasks.lookup(From);
+  llvm::DenseMap<const llvm::BasicBlock *, llvm::Value *> Conds;
+  auto AddCond = [&](const llvm::BasicBlock *Succ, llvm::Value *C) {
+    auto &SuccCond = Conds[Succ];
+    SuccCond = SuccCond ? Builder.CreateLogicalOr(SuccCond, C) : C;
+  };
+
+  auto *Term = From->getTerminator();
+  if (auto *Br = llvm::dyn_cast<llvm::BranchInst>(Term);
+      Br && Br->isConditional() && Br->getSuccessor(0) != Br->getSuccessor(1)) {
+    auto *Cond = getVector(Br->getCondition());
+    AddCond(Br->getSuccessor(0), Cond);
+    AddCond(Br->getSuccessor(1), Builder.CreateNot(Cond));
+  } else if (auto *Switch = llvm::dyn_cast<llvm::SwitchInst>(Term)) {
+    auto *Cond = getVector(Switch->getCondition());
+    llvm::Value *AnyCase = nullptr;
+    for (auto &Case : Switch->cases()) {
+      if (Case.getCaseSuccessor() == Switch->getDefaultDest())
+        continue;
+      auto *IsCase = Builder.CreateICmpEQ(Cond, getVector(Case.getCaseValue()));
+      AnyCase = AnyCase ? Builder.CreateLogicalOr(AnyCase, IsCase) : IsCase;
+      AddCond(Case.getCaseSuccessor(), IsCase);
+    }
+    if (AnyCase)
+      AddCond(Switch->getDefaultDest(), Builder.CreateNot(AnyCase));
+  }
+
+  // successors without condition are taken by all work items that execute From
+  for (auto *Succ : llvm::successors(From)) {
+    llvm::Value *Mask = SourceMask;
+    if (auto *Cond = Conds.lookup(Succ))
+      Mask = SourceMask ? Builder.CreateLogicalAnd(SourceMask, Cond) : Cond;
+    EdgeMasks[std::make_pair(From, Succ)] = Mask;
+  }
+  return EdgeMasks[Key];
+}
+
+llvm::Value *WorkItemLoopVectorizer::computeBlockMask(llvm::BasicBlock *BB) {
+  if (!PredicatedBlocks.contains(BB))
+    return nullptr;
+
+  llvm::Value *Mask = nullptr;
+  for (auto *Pred : llvm::predecessors(BB)) {
+    auto *EdgeMask = getEdgeMask(Pred, BB);
+    if (!EdgeMask)
+      return nullptr;
+    Mask = Mask ? Builder.CreateLogicalOr(Mask, EdgeMask) : EdgeMask;
+  }
+  return Mask;
+}
+
+void WorkItemLoopVectorizer::emitScalar(llvm::Instruction &I) {
+  auto *Clone = I.clone();
+  for (unsigned Idx = 0; Idx < Clone->getNumOperands(); ++Idx)
+    if (!llvm::isa<llvm::BasicBlock>(I.getOperand(Idx)))
+      Clone->setOperand(Idx, getScalar(I.getOperand(Idx)));
+  Builder.Insert(Clone, I.getName());
+  Scalars[&I] = Clone;
+}
+
+void WorkItemLoopVectorizer::emitPHI(llvm::PHINode &Phi) {
+  if (!Widened.contains(&Phi)) {
+    Scalars[&Phi] = getScalar(Phi.getIncomingValue(0));
+    return;
+  }
+  if (Phi.getNumIncomingValues() == 1) {
+    Vectors[&Phi] = getVector(Phi.getIncomingValue(0));
+    return;
+  }
+
+  // exactly one incoming edge is active for each active work item
+  llvm::Value *Result = getVector(Phi.getIncomingValue(0));
+  for (unsigned Idx = 1; Idx < Phi.getNumIncomingValues(); ++Idx) {
+    auto *Incoming = getVector(Phi.getIncomingValue(Idx));
+    auto *EdgeMask = getEdgeMask(Phi.getIncomingBlock(Idx), Phi.getParent());
+    Result = EdgeMask ? Builder.CreateSelect(EdgeMask, Incoming, Result, Phi.getName()) : Incoming;
+  }
+  Vectors[&Phi] = Result;
+}
+
+void WorkItemLoopVectorizer::emitLoad(llvm::LoadInst &Load) {
+  if (!Widened.contains(&Load))
+    return emitScalar(Load);
+
+  auto *Mask = BlockMasks.lookup(Load.getParent());
+  auto *VecT = llvm::FixedVectorType::get(Load.getType(), Width);
+  auto *Ptr = Load.getPointerOperand();
+
+  llvm::Value *Result = nullptr;
+  if (isContiguousAccess(Ptr, Load.getType())) {
+    auto *VecPtr = Builder.CreatePointerCast(
+        getFirstLane(Ptr), llvm::PointerType::get(VecT, Load.getPointerAddressSpace()));
+    if (Mask)
+      Result = Builder.CreateMaskedLoad(VecT, VecPtr, Load.getAlign(), Mask, nullptr,
+                                        Load.getName());
+    else
+      Result = Builder.CreateAlignedLoad(VecT, VecPtr, Load.getAlign(), Load.getName());
+  } else if (!Mask && !isWidened(Ptr)) {
+    Result = Builder.CreateVectorSplat(
+        Width, Builder.CreateAlignedLoad(Load.getType(), getScalar(Ptr), Load.getAlign()));
+  } else {
+    Result = Builder.CreateMaskedGather(VecT, getVector(Ptr), Load.getAlign(),
+                                        Mask ? Mask : getAllTrueMask(), nullptr, Load.getName());
+  }
+  Vectors[&Load] = Result;
+}
+
+void WorkItemLoopVectorizer::emitStore(llvm::StoreInst &Store) {
+  auto *Val = Store.getValueOperand();
+  auto *Ptr = Store.getPointerOperand();
+  auto *Mask = BlockMasks.lookup(Store.getParent());
+
+  if (!Mask && !isWidened(Val) && !isWidened(Ptr))
+    return emitScalar(Store);
+
+  auto *ValT = Val->getType();
+  if (isContiguousAccess(Ptr, ValT)) {
+    auto *VecPtr = Builder.CreatePointerCast(
+        getFirstLane(Ptr), llvm::PointerType::get(llvm::FixedVectorType::get(ValT, Width),
+                                                  Store.getPointerAddressSpace()));
+    if (Mask)
+      Builder.CreateMaskedStore(getVector(Val), VecPtr, Store.getAlign(), Mask);
+    else
+      Builder.CreateAlignedStore(getVector(Val), VecPtr, Store.getAlign());
+  } else {
+    // scatters write lanes in order, so uniform addresses end up with the value of
+    // the last active work item as in the scalar loop.
+    Builder.CreateMaskedScatter(getVector(Val), getVector(Ptr), Store.getAlign(),
+                                Mask ? Mask : getAllTrueMask());
+  }
+}
+
+void WorkItemLoopVectorizer::emitCall(llvm::CallInst &CI) {
+  const bool HasWidenedArgs =
+      llvm::any_of(CI.args(), [this](const llvm::Use &Arg) { return isWidened(Arg.get()); });
+  if (!Widened.contains(&CI) && !HasWidenedArgs)
+    return emitScalar(CI);
+
+  auto *Callee = CI.getCalledFunction();
+  if (isVectorizableIntrinsic(CI)) {
+    const auto ID = Callee->getIntrinsicID();
+    llvm::SmallPtrSet<llvm::Type *, 4> VectorTypes;
+    VectorTypes.insert(CI.getType());
+    llvm::SmallVector<llvm::Value *, 4> Args;
+    for (unsigned Idx = 0; Idx < CI.arg_size(); ++Idx) {
+      auto *Arg = CI.getArgOperand(Idx);
+      if (isScalarIntrinsicOperand(ID, Idx, TTI)) {
+        Args.push_back(getScalar(Arg));
+      } else {
+        VectorTypes.insert(Arg->getType());
+        Args.push_back(getVector(Arg));
+      }
+    }
+
+    llvm::SmallVector<llvm::Type *, 4> OverloadTypes;
+    llvm::Intrinsic::getIntrinsicSignature(Callee, OverloadTypes);
+    for (auto &T : OverloadTypes)
+      if (VectorTypes.contains(T))
+        T = llvm::FixedVectorType::get(T, Width);
+
+    auto *VecCallee = llvm::Intrinsic::getDeclaration(F.getParent(), ID, OverloadTypes);
+    auto *VecCall = Builder.CreateCall(VecCallee, Args, CI.getName());
+    VecCall->copyIRFlags(&CI);
+    Vectors[&CI] = VecCall;
+    return;
+  }
+
+  // no vector variant known: call once per lane
+  llvm::Value *Result = CI.getType()->isVoidTy()
+                            ? nullptr
+                            : llvm::PoisonValue::get(llvm::FixedVectorType::get(CI.getType(), Width));
+  for (unsigned Lane = 0; Lane < Width; ++Lane) {
+    llvm::SmallVector<llvm::Value *, 4> Args;
+    for (auto &Arg : CI.args())
+      Args.push_back(isWidened(Arg.get())
+                         ? Builder.CreateExtractElement(getVector(Arg.get()), uint64_t{Lane})
+                         : getScalar(Arg.get()));
+    auto *LaneCall = Builder.CreateCall(CI.getFunctionType(), CI.getCalledOperand(), Args);
+    LaneCall->setAttributes(CI.getAttributes());
+    LaneCall->setCallingConv(CI.getCallingConv());
+    LaneCall->copyIRFlags(&CI);
+    if (Result)
+      Result = Builder.CreateInsertElement(Result, LaneCall, uint64_t{Lane});
+  }
+  if (Result)
+    Vectors[&CI] = Result;
+}
+
+void WorkItemLoopVectorizer::emitWidened(llvm::Instruction &I) {
+  auto *Mask = BlockMasks.lookup(I.getParent());
+  auto VectorOf = [this](llvm::Type *T) { return llvm::FixedVectorType::get(T, Width); };
+
+  llvm::Value *Result = nullptr;
+  if (auto *BinOp = llvm::dyn_cast<llvm::BinaryOperator>(&I)) {
+    auto *RHS = getVector(BinOp->getOperand(1));
+    // masked-off lanes must not trap
+    if (Mask && isIntDivRem(I) && !llvm::isSafeToSpeculativelyExecute(&I))
+      RHS = Builder.CreateSelect(Mask, RHS, llvm::ConstantInt::get(RHS->getType(), 1));
+    Result = Builder.CreateBinOp(BinOp->getOpcode(), getVector(BinOp->getOperand(0)), RHS);
+  } else if (auto *UnOp = llvm::dyn_cast<llvm::UnaryOperator>(&I)) {
+    Result = Builder.CreateUnOp(UnOp->getOpcode(), getVector(UnOp->getOperand(0)));
+  } else if (auto *Cast = llvm::dyn_cast<llvm::CastInst>(&I)) {
+    Result = Builder.CreateCast(Cast->getOpcode(), getVector(Cast->getOperand(0)),
+                                VectorOf(Cast->getDestTy()));
+  } else if (auto *Cmp = llvm::dyn_cast<llvm::CmpInst>(&I)) {
+    Result = Builder.CreateCmp(Cmp->getPredicate(), getVector(Cmp->getOperand(0)),
+                               getVector(Cmp->getOperand(1)));
+  } else if (auto *Select = llvm::dyn_cast<llvm::SelectInst>(&I)) {
+    Result = Builder.CreateSelect(getVector(Select->getCondition()),
+                                  getVector(Select->getTrueValue()),
+                                  getVector(Select->getFalseValue()));
+  } else if (auto *Freeze = llvm::dyn_cast<llvm::FreezeInst>(&I)) {
+    Result = Builder.CreateFreeze(getVector(Freeze->getOperand(0)));
+  } else if (auto *GEP = llvm::dyn_cast<llvm::GetElementPtrInst>(&I)) {
+    // constant indices stay scalar, as required for struct member indices
+    llvm::SmallVector<llvm::Value *, 4> Indices;
+    for (auto &Idx : GEP->indices())
+      Indices.push_back(llvm::isa<llvm::Constant>(Idx) ? Idx.get() : getVector(Idx.get()));
+    Result = Builder.CreateGEP(GEP->getSourceElementType(), getVector(GEP->getPointerOperand()),
+                               Indices);
+  } else {
+    llvm_unreachable("Instruction should have been rejected by canVectorize()");
+  }
+
+  if (auto *NewI = llvm::dyn_cast<llvm::Instruction>(Result)) {
+    NewI->copyIRFlags(&I);
+    NewI->setName(I.getName());
+  }
+  Vectors[&I] = Result;
+}
+
+void WorkItemLoopVectorizer::emitInstruction(llvm::Instruction &I) {
+  if (I.isTerminator() || isDroppableIntrinsic(I))
+    return;
+
+  Builder.SetCurrentDebugLocation(I.getDebugLoc());
+  if (auto *Phi = llvm::dyn_cast<llvm::PHINode>(&I))
+    emitPHI(*Phi);
+  else if (auto *Load = llvm::dyn_cast<llvm::LoadInst>(&I))
+    emitLoad(*Load);
+  else if (auto *Store = llvm::dyn_cast<llvm::StoreInst>(&I))
+    emitStore(*Store);
+  else if (auto *CI = llvm::dyn_cast<llvm::CallInst>(&I))
+    emitCall(*CI);
+  else if (Widened.contains(&I))
+    emitWidened(I);
+  else
+    emitScalar(I);
+}
+
+// Creates the vector loop in front of the wi-loop, which then handles the remaining
+// work items:
+//
+//   preheader -> vector.ph -> vector.body <-> vector.body -> middle -> exit
+//                    |                                         |
+//                    +-------------> scalar.ph <---------------+
+//                                        |
+//                                     header (wi-loop) ... latch -> exit
+void WorkItemLoopVectorizer::vectorize() {
+  auto &Ctx = F.getContext();
+  const std::string Suffix = "." + Header->getName().str();
+  auto *VecPh = llvm::BasicBlock::Create(Ctx, "wi.vector.ph" + Suffix, &F, Header);
+  auto *VecBody = llvm::BasicBlock::Create(Ctx, "wi.vector.body" + Suffix, &F, Header);
+  auto *Middle = llvm::BasicBlock::Create(Ctx, "wi.vector.middle" + Suffix, &F, Header);
+  auto *ScalarPh = llvm::BasicBlock::Create(Ctx, "wi.scalar.ph" + Suffix, &F, Header);
+
+  Preheader->getTerminator()->replaceSuccessorWith(Header, VecPh);
+
+  // only enter the vector loop if it executes at least one full vector of work items
+  Builder.SetInsertPoint(VecPh);
+  auto *IndT = IndVar->getType();
+  auto *Start = IndVar->getIncomingValueForBlock(Preheader);
+  auto *VF = llvm::ConstantInt::get(IndT, Width);
+  auto *TripCount = Builder.CreateSub(End, Start, "wi.trip.count");
+  auto *VecEnd = Builder.CreateAdd(
+      Start, Builder.CreateMul(Builder.CreateUDiv(TripCount, VF), VF), "wi.vector.end");
+  auto *HasVectorIter = Builder.CreateAnd(Builder.CreateICmpULT(Start, End),
+                                          Builder.CreateICmpUGE(TripCount, VF));
+
+  // private allocas: one copy per lane, addressed by a vector of pointers
+  for (auto *Alloca : PrivateAllocas) {
+    llvm::Type *ElementT = Alloca->getAllocatedType();
+    const auto ArraySize = llvm::cast<llvm::ConstantInt>(Alloca->getArraySize())->getZExtValue();
+    if (ArraySize != 1)
+      ElementT = llvm::ArrayType::get(ElementT, ArraySize);
+    llvm::IRBuilder<> AllocaBuilder{Alloca};
+    auto *LaneAlloca = AllocaBuilder.CreateAlloca(llvm::ArrayType::get(ElementT, Width), nullptr,
+                                                  Alloca->getName() + ".lanes");
+    LaneAlloca->setAlignment(Alloca->getAlign());
+
+    llvm::SmallVector<llvm::Value *, 3> Indices{Builder.getInt32(0),
+                                                 Builder.CreateStepVector(llvm::FixedVectorType::get(
+                                                     Builder.getInt32Ty(), Width))};
+    if (ArraySize != 1)
+      Indices.push_back(Builder.getInt32(0));
+    Vectors[Alloca] = Builder.CreateInBoundsGEP(LaneAlloca->getAllocatedType(), LaneAlloca,
+                                                Indices, Alloca->getName() + ".lane.ptrs");
+  }
+  Builder.CreateCondBr(HasVectorIter, VecBody, ScalarPh);
+
+  Builder.SetInsertPoint(VecBody);
+  auto *VecIndVar = Builder.CreatePHI(IndT, 2, IndVar->getName() + ".vec");
+  Vectors[IndVar] = Builder.CreateAdd(
+      Builder.CreateVectorSplat(Width, VecIndVar),
+      Builder.CreateStepVector(llvm::FixedVectorType::get(IndT, Width)), IndVar->getName());
+  FirstLanes[IndVar] = VecIndVar;
+
+  for (auto *BB : Blocks) {
+    BlockMasks[BB] = computeBlockMask(BB);
+    for (auto &I : *BB)
+      if (&I != IndVar)
+        emitInstruction(I);
+  }
+
+  Builder.SetCurrentDebugLocation(llvm::DebugLoc{});
+  auto *VecIndVarNext = Builder.CreateAdd(VecIndVar, VF, IndVar->getName() + ".vec.next", true);
+  auto *VecBackedge =
+      Builder.CreateCondBr(Builder.CreateICmpULT(VecIndVarNext, VecEnd), VecBody, Middle);
+  VecIndVar->addIncoming(Start, VecPh);
+  VecIndVar->addIncoming(VecIndVarNext, VecBody);
+
+  auto MakeLoopHint = [&](llvm::StringRef Name) {
+    return llvm::MDNode::get(Ctx, {llvm::MDString::get(Ctx, Name),
+                                   llvm::ConstantAsMetadata::get(Builder.getInt32(1))});
+  };
+  VecBackedge->setMetadata(
+      llvm::LLVMContext::MD_loop,
+      llvm::makePostTransformationMetadata(
+          Ctx, nullptr, {},
+          {MakeLoopHint("llvm.loop.isvectorized"), MakeLoopHint("llvm.loop.unroll.runtime.disable")}));
+
+  Builder.SetInsertPoint(Middle);
+  Builder.CreateCondBr(Builder.CreateICmpEQ(VecEnd, End), Exit, ScalarPh);
+
+  Builder.SetInsertPoint(ScalarPh);
+  auto *ScalarStart = Builder.CreatePHI(IndT, 2, IndVar->getName() + ".start");
+  ScalarStart->addIncoming(Start, VecPh);
+  ScalarStart->addIncoming(VecEnd, Middle);
+  Builder.CreateBr(Header);
+
+  const int PreheaderIdx = IndVar->getBasicBlockIndex(Preheader);
+  IndVar->setIncomingBlock(PreheaderIdx, ScalarPh);
+  IndVar->setIncomingValue(PreheaderIdx, ScalarStart);
+
+  // the remainder must not be vectorized again
+  L.setLoopID(llvm::makePostTransformationMetadata(Ctx, L.getLoopID(), {},
+                                                   {MakeLoopHint("llvm.loop.isvectorized")}));
+}
+
+unsigned getVectorWidth(const llvm::Loop &L, const llvm::DataLayout &DL,
+                        const llvm::TargetTransformInfo &TTI, unsigned RequestedWidth) {
+  unsigned Width = RequestedWidth > 0 ? RequestedWidth : getTargetVectorWidth(L, DL, TTI);
+  return std::min(Width, MaxVectorWidth);
+}
+
+bool vectorizeWorkItemLoops(llvm::Function &F, const llvm::TargetTransformInfo &TTI,
+                            unsigned RequestedWidth) {
+  llvm::OptimizationRemarkEmitter ORE{&F};
+  const auto &DL = F.getParent()->getDataLayout();
+
+  bool Changed = false;
+  llvm::SmallPtrSet<llvm::BasicBlock *, 8> HandledHeaders;
+  while (true) {
+    // vectorization adds blocks, so recompute the analyses for every wi-loop
+    llvm::DominatorTree DT{F};
+    llvm::PostDominatorTree PDT{F};
+    llvm::LoopInfo LI{DT};
+
+    llvm::Loop *L = nullptr;
+    for (auto *Candidate : utils::getLoopsInPreorder(LI))
+      if (utils::isWorkItemLoop(*Candidate) && !HandledHeaders.contains(Candidate->getHeader())) {
+        L = Candidate;
+        break;
+      }
+    if (!L)
+      break;
+    HandledHeaders.insert(L->getHeader());
+
+    const auto Loc = L->getStartLoc();
+    auto *Header = L->getHeader();
+    const unsigned Width = getVectorWidth(*L, DL, TTI, RequestedWidth);
+
+    WorkItemLoopVectorizer Vectorizer{F, *L, LI, DT, PDT, TTI, Width};
+    std::string Reason;
+    if (!Vectorizer.canVectorize(Reason)) {
+      HIPSYCL_DEBUG_INFO << "[WILoopVectorizer] Not vectorizing " << Header->getName() << " in "
+                         << F.getName() << ": " << Reason << "\n";
+      ORE.emit([&]() {
+        return llvm::OptimizationRemarkMissed(RemarkPassName, "NotVectorized", Loc, Header)
+               << "work-item loop in kernel " << llvm::ore::NV("Kernel", F.getName())
+               << " not vectorized: " << Reason;
+      });
+      continue;
+    }
+
+    Vectorizer.vectorize();
+    Changed = true;
+    HIPSYCL_DEBUG_INFO << "[WILoopVectorizer] Vectorized " << Header->getName() << " in "
+                       << F.getName() << " with width " << Width << "\n";
+    ORE.emit([&]() {
+      return llvm::OptimizationRemark(RemarkPassName, "Vectorized", Loc, Header)
+             << "vectorized work-item loop in kernel " << llvm::ore::NV("Kernel", F.getName())
+             << " (vectorization width: " << llvm::ore::NV("VectorizationFactor", Width) << ")";
+    });
+  }
+  return Changed;
+}
+} // namespace
+
+void hipsycl::compiler::WorkItemLoopVectorizerPassLegacy::getAnalysisUsage(
+    llvm::AnalysisUsage &AU) const {
+  AU.addRequired<SplitterAnnotationAnalysisLegacy>();
+  AU.addPreserved<SplitterAnnotationAnalysisLegacy>();
+  AU.addRequired<llvm::TargetTransformInfoWrapperPass>();
+  AU.addPreserved<llvm::TargetTransformInfoWrapperPass>();
+}
+
+bool hipsycl::compiler::WorkItemLoopVectorizerPassLegacy::runOnFunction(llvm::Function &F) {
+  const auto &SAA = getAnalysis<SplitterAnnotationAnalysisLegacy>().getAnnotationInfo();
+  if (!SAA.isKernelFunc(&F))
+    return false;
+
+  const auto &TTI = getAnalysis<llvm::TargetTransformInfoWrapperPass>().getTTI(F);
+  return vectorizeWorkItemLoops(F, TTI, VectorWidth_);
+}
+
+llvm::PreservedAnalyses
+hipsycl::compiler::WorkItemLoopVectorizerPass::run(llvm::Function &F,
+                                                   llvm::FunctionAnalysisManager &AM) {
+  const auto &MAMProxy = AM.getResult<llvm::ModuleAnalysisManagerFunctionProxy>(F);
+  const auto *SAA = MAMProxy.getCachedResult<SplitterAnnotationAnalysis>(*F.getParent());
+  if (!SAA) {
+    llvm::errs() << "SplitterAnnotationAnalysis not cached.\n";
+    return llvm::PreservedAnalyses::all();
+  }
+  if (!SAA->isKernelFunc(&F))
+    return llvm::PreservedAnalyses::all();
+
+  const auto &TTI = AM.getResult<llvm::TargetIRAnalysis>(F);
+  if (!vectorizeWorkItemLoops(F, TTI, VectorWidth_))
+    return llvm::PreservedAnalyses::all();
+
+  llvm::PreservedAnalyses PA;
+  PA.preserve<SplitterAnnotationAnalysis>();
+  return PA;
+}
+
+char hipsycl::compiler::WorkItemLoopVectorizerPassLegacy::ID = 0;
@@ -49,6 +49,7 @@
 #include <cstdlib>
 #include <sstream>
 #include <unordered_set>
+#include <mutex>
 
 namespace hipsycl {
 namespace compiler {
@@ -86,7 +87,11 @@ void printModuleToFile(llvm::Module& M, const std::string& File,
 
   // Desired behavior is to truncate files for each application run,
   // but append content in the dump file within one application run.
+  // JIT compilations may run concurrently, so the lock is held for the
+  // entire dump to also avoid interleaving output in the same file.
+  static std::mutex UsedFilesMutex;
   static std::unordered_set<std::string> UsedFiles;
+  std::lock_guard<std::mutex> Lock{UsedFilesMutex};
   auto OpenFlag = llvm::sys::fs::OpenFlags::OF_Append;
   if(UsedFiles.find(File) == UsedFiles.end()) {
     OpenFlag = llvm::sys::fs::OpenFlags::OF_None;
@@ -0,0 +1,150 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+#include "hipSYCL/compiler/llvm-to-backend/host/HostObjectLoader.hpp"
+
+#include "hipSYCL/common/debug.hpp"
+
+#include <llvm/BinaryFormat/Magic.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/TargetSelect.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace hipsycl {
+namespace compiler {
+
+namespace {
+
+// The JIT is shared by all loaders and intentionally never destroyed:
+// Kernels may still be referenced by code objects that are released
+// during static destruction, after the JIT would have been torn down.
+llvm::orc::LLJIT *getHostJIT(std::string &ErrorMessage) {
+  static llvm::orc::LLJIT *JIT = nullptr;
+  static std::string InitError;
+  static std::once_flag Flag;
+
+  std::call_once(Flag, [&]() {
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+
+    auto J = llvm::orc::LLJITBuilder().create();
+    if (auto E = J.takeError()) {
+      InitError = "Could not create host JIT: " + llvm::toString(std::move(E));
+      return;
+    }
+    JIT = J->release();
+  });
+
+  if (!JIT)
+    ErrorMessage = InitError;
+  return JIT;
+}
+
+// LLJIT::lookup() returns JITEvaluatedSymbol in older LLVM versions
+// and ExecutorAddr in newer ones.
+template <class T>
+auto symbolToPointer(const T &Sym, int) -> decltype(Sym.template toPtr<void *>()) {
+  return Sym.template toPtr<void *>();
+}
+
+template <class T> void *symbolToPointer(const T &Sym, long) {
+  return reinterpret_cast<void *>(static_cast<uintptr_t>(Sym.getAddress()));
+}
+
+} // namespace
+
+bool isRelocatableHostObject(std::string_view Binary) {
+  auto Magic = llvm::identify_magic(llvm::StringRef{Binary.data(), Binary.size()});
+  return Magic == llvm::file_magic::elf_relocatable ||
+         Magic == llvm::file_magic::macho_object ||
+         Magic == llvm::file_magic::coff_object;
+}
+
+struct HostObjectLoader::Impl {
+  llvm::orc::LLJIT *JIT = nullptr;
+  llvm::orc::JITDylib *JD = nullptr;
+};
+
+HostObjectLoader::HostObjectLoader() : I{std::make_unique<Impl>()} {}
+
+HostObjectLoader::~HostObjectLoader() {
+  if (I->JIT && I->JD) {
+    if (auto E = I->JIT->getExecutionSession().removeJITDylib(*I->JD)) {
+      HIPSYCL_DEBUG_WARNING << "HostObjectLoader: Could not unload object: "
+                            << llvm::toString(std::move(E)) << "\n";
+    }
+  }
+}
+
+bool HostObjectLoader::load(std::string_view Object, std::string &ErrorMessage) {
+  if (I->JD) {
+    ErrorMessage = "HostObjectLoader: An object has already been loaded";
+    return false;
+  }
+
+  I->JIT = getHostJIT(ErrorMessage);
+  if (!I->JIT)
+    return false;
+
+  // Each object gets its own JITDylib, such that kernels with identical
+  // names from different objects do not clash and can be unloaded individually.
+  static std::atomic<std::size_t> ObjectCounter = 0;
+  std::string DylibName = "acpp-host-object-" + std::to_string(ObjectCounter++);
+
+  auto JD = I->JIT->getExecutionSession().createJITDylib(DylibName);
+  if (auto E = JD.takeError()) {
+    ErrorMessage = "HostObjectLoader: Could not create JITDylib: " +
+                   llvm::toString(std::move(E));
+    return false;
+  }
+  I->JD = &(*JD);
+
+  // Resolve external symbols (e.g. libm functions) against the process
+  auto Generator = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+      I->JIT->getDataLayout().getGlobalPrefix());
+  if (auto E = Generator.takeError()) {
+    ErrorMessage = "HostObjectLoader: Could not create symbol generator: " +
+                   llvm::toString(std::move(E));
+    return false;
+  }
+  I->JD->addGenerator(std::move(*Generator));
+
+  auto Buffer = llvm::MemoryBuffer::getMemBufferCopy(
+      llvm::StringRef{Object.data(), Object.size()}, DylibName);
+  if (auto E = I->JIT->addObjectFile(*I->JD, std::move(Buffer))) {
+    ErrorMessage = "HostObjectLoader: Could not add object file: " +
+                   llvm::toString(std::move(E));
+    return false;
+  }
+
+  return true;
+}
+
+void *HostObjectLoader::getSymbol(const std::string &Name) const {
+  if (!I->JD)
+    return nullptr;
+
+  auto Sym = I->JIT->lookup(*I->JD, Name);
+  if (auto E = Sym.takeError()) {
+    HIPSYCL_DEBUG_ERROR << "HostObjectLoader: Could not find symbol " << Name
+                        << ": " << llvm::toString(std::move(E)) << "\n";
+    return nullptr;
+  }
+  return symbolToPointer(*Sym, 0);
+}
+
+}
+}
@@ -26,6 +26,7 @@
 #include "hipSYCL/glue/llvm-sscp/jit-reflection/queries.hpp"
 
 #include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringMap.h>
 #include <llvm/Bitcode/BitcodeWriter.h>
 #include <llvm/IR/Attributes.h>
 #include <llvm/IR/CallingConv.h>
@@ -35,12 +36,17 @@
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Metadata.h>
 #include <llvm/IR/Module.h>
+#include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/PassManager.h>
+#include <llvm/MC/TargetRegistry.h>
 #include <llvm/Passes/PassBuilder.h>
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Support/MemoryBuffer.h>
 #include <llvm/Support/Program.h>
+#include <llvm/Support/TargetSelect.h>
 #include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/Target/TargetOptions.h>
 #if LLVM_VERSION_MAJOR < 16
 #include <llvm/ADT/Triple.h>
 #include <llvm/Support/Host.h>
@@ -50,6 +56,7 @@
 #endif
 
 #include <cassert>
+#include <chrono>
 #include <fstream>
 #include <memory>
 #include <string>
@@ -59,6 +66,36 @@
 namespace hipsycl {
 namespace compiler {
 
+namespace {
+
+llvm::StringMap<bool> getHostCPUFeatures() {
+#if LLVM_VERSION_MAJOR < 20
+  llvm::StringMap<bool> HostFeatures;
+  if (!llvm::sys::getHostCPUFeatures(HostFeatures))
+    HostFeatures.clear();
+  return HostFeatures;
+#else
+  return llvm::sys::getHostCPUFeatures();
+#endif
+}
+
+// Sub-groups span as many work items as fit 32-bit elements into a vector register
+int getDefaultSubGroupSize() {
+  auto Features = getHostCPUFeatures();
+  auto HasFeature = [&](llvm::StringRef Name) {
+    auto It = Features.find(Name);
+    return It != Features.end() && It->second;
+  };
+
+  if (HasFeature("avx512f"))
+    return 16;
+  if (HasFeature("avx"))
+    return 8;
+  return 4;
+}
+
+} // namespace
+
 LLVMToHostTranslator::LLVMToHostTranslator(const std::vector<std::string> &KN)
     : LLVMToBackendTranslator{static_cast<int>(sycl::AdaptiveCpp_jit::compiler_backend::host), KN, KN},
       KernelNames{KN} {}
@@ -91,6 +128,17 @@ bool LLVMToHostTranslator::toBackendFlavor(llvm::Module &M, PassHandler &PH) {
   if (!this->linkBitcodeFile(M, BuiltinBitcodeFile))
     return false;
 
+  if (SubGroupSize <= 0)
+    SubGroupSize = getDefaultSubGroupSize();
+  HIPSYCL_DEBUG_INFO << "LLVMToHost: Using sub-group size " << SubGroupSize << "\n";
+  // The sub-group size is a compile-time constant, such that sub-group index
+  // calculations fold and CBS can treat it as uniform.
+  if (auto *SubGroupSizeGV = M.getGlobalVariable(cbs::SubGroupSizeGlobalName)) {
+    SubGroupSizeGV->setInitializer(
+        llvm::ConstantInt::get(SubGroupSizeGV->getValueType(), SubGroupSize));
+    SubGroupSizeGV->setConstant(true);
+  }
+
   // Internalize all constant global variables that don't their definition
   // to be imported from external sources - this is fine because llvm-to-backend
   // lowering always happens *after* linking in all dependencies, and therefore
@@ -109,7 +157,8 @@ bool LLVMToHostTranslator::toBackendFlavor(llvm::Module &M, PassHandler &PH) {
     MAM.registerPass([] { return SplitterAnnotationAnalysis{}; });
   });
   PH.PassBuilder->registerModuleAnalyses(*PH.ModuleAnalysisManager);
-  registerCBSPipeline(MPM, hipsycl::compiler::OptLevel::O3, true);
+  // Sub-groups are laid out to match the SIMD width, so vectorize wi-loops with the same width
+  registerCBSPipeline(MPM, hipsycl::compiler::OptLevel::O3, true, SubGroupSize);
 
   llvm::FunctionPassManager FPM;
   FPM.addPass(HostKernelWrapperPass{KnownLocalMemSize, KnownGroupSizeX, KnownGroupSizeY, KnownGroupSizeZ});
@@ -122,6 +171,101 @@ bool LLVMToHostTranslator::toBackendFlavor(llvm::Module &M, PassHandler &PH) {
 
 bool LLVMToHostTranslator::translateToBackendFormat(llvm::Module &FlavoredModule,
                                                     std::string &out) {
+  auto Start = std::chrono::high_resolution_clock::now();
+
+  bool Result = UseExternalCompiler ? compileWithExternalCompiler(FlavoredModule, out)
+                                    : emitObjectFile(FlavoredModule, out);
+
+  auto Ticks = std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::high_resolution_clock::now() - Start)
+                   .count();
+  HIPSYCL_DEBUG_INFO << "LLVMToHost: Code generation "
+                     << (UseExternalCompiler ? "using external compiler" : "in-process")
+                     << " took " << static_cast<double>(Ticks) * 1.e-3 << " ms\n";
+  return Result;
+}
+
+bool LLVMToHostTranslator::emitObjectFile(llvm::Module &FlavoredModule, std::string &out) {
+  llvm::InitializeNativeTarget();
+  llvm::InitializeNativeTargetAsmPrinter();
+
+  const std::string Triple = llvm::sys::getProcessTriple();
+  std::string Error;
+  const llvm::Target *Target = llvm::TargetRegistry::lookupTarget(Triple, Error);
+  if (!Target) {
+    this->registerError("LLVMToHost: Could not find host target: " + Error);
+    return false;
+  }
+
+  // Equivalent of -march=native
+  std::string Features;
+  for (const auto &F : getHostCPUFeatures()) {
+    if (!Features.empty())
+      Features += ",";
+    Features += (F.second ? "+" : "-");
+    Features += F.first().str();
+  }
+
+  llvm::TargetOptions Options;
+  std::unique_ptr<llvm::TargetMachine> TM{Target->createTargetMachine(
+      Triple, llvm::sys::getHostCPUName(), Features, Options, llvm::Reloc::PIC_, {},
+#if LLVM_VERSION_MAJOR >= 18
+      llvm::CodeGenOptLevel::Aggressive
+#else
+      llvm::CodeGenOpt::Aggressive
+#endif
+      )};
+  if (!TM) {
+    this->registerError("LLVMToHost: Could not create target machine for " + Triple);
+    return false;
+  }
+
+  FlavoredModule.setTargetTriple(Triple);
+  FlavoredModule.setDataLayout(TM->createDataLayout());
+
+  // The flavored IR has been optimized without knowledge of the target.
+  // Rerun the optimization pipeline with target information, as clang -O3
+  // would do, so that e.g. the vectorizers can use the available ISA.
+  {
+    llvm::LoopAnalysisManager LAM;
+    llvm::FunctionAnalysisManager FAM;
+    llvm::CGSCCAnalysisManager CGAM;
+    llvm::ModuleAnalysisManager MAM;
+
+    llvm::PassBuilder PB{TM.get()};
+    PB.registerModuleAnalyses(MAM);
+    PB.registerCGSCCAnalyses(CGAM);
+    PB.registerFunctionAnalyses(FAM);
+    PB.registerLoopAnalyses(LAM);
+    PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+    llvm::ModulePassManager MPM =
+        PB.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O3);
+    MPM.run(FlavoredModule, MAM);
+  }
+
+  llvm::SmallVector<char, 0> ObjectBuffer;
+  llvm::raw_svector_ostream ObjectStream{ObjectBuffer};
+
+  llvm::legacy::PassManager CodegenPM;
+  if (TM->addPassesToEmitFile(CodegenPM, ObjectStream, nullptr,
+#if LLVM_VERSION_MAJOR >= 18
+                              llvm::CodeGenFileType::ObjectFile
+#else
+                              llvm::CGFT_ObjectFile
+#endif
+                              )) {
+    this->registerError("LLVMToHost: Target machine cannot emit object files");
+    return false;
+  }
+  CodegenPM.run(FlavoredModule);
+
+  out.assign(ObjectBuffer.begin(), ObjectBuffer.end());
+  return true;
+}
+
+bool LLVMToHostTranslator::compileWithExternalCompiler(llvm::Module &FlavoredModule,
+                                                       std::string &out) {
   auto InputFile = llvm::sys::fs::TempFile::create("acpp-sscp-host-%%%%%%.bc");
   auto OutputFile = llvm::sys::fs::TempFile::create("acpp-sscp-host-%%%%%%.so");
 
@@ -193,7 +337,19 @@ bool LLVMToHostTranslator::translateToBackendFormat(llvm::Module &FlavoredModule
   return true;
 }
 
+bool LLVMToHostTranslator::applyBuildFlag(const std::string &Flag) {
+  if (Flag == "host-external-compiler") {
+    UseExternalCompiler = true;
+    return true;
+  }
+  return false;
+}
+
 bool LLVMToHostTranslator::applyBuildOption(const std::string &Option, const std::string &Value) {
+  if (Option == "host-sub-group-size") {
+    SubGroupSize = std::stoi(Value);
+    return true;
+  }
   return false;
 }
 
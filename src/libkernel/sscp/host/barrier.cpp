@@ -9,6 +9,7 @@
  */
 // SPDX-License-Identifier: BSD-2-Clause
 #include "hipSYCL/sycl/libkernel/sscp/builtins/barrier.hpp"
+#include "hipSYCL/sycl/libkernel/sscp/builtins/subgroup.hpp"
 
 extern "C" [[clang::convergent]] void __acpp_cbs_barrier();
 
@@ -33,5 +34,13 @@ HIPSYCL_SSCP_CONVERGENT_BUILTIN void
 __acpp_sscp_sub_group_barrier(__acpp_sscp_memory_scope fence_scope,
                               __acpp_sscp_memory_order order) {
 
-  __acpp_cpu_mem_fence(fence_scope, order);
+  // Work items of a sub-group are not executed in lockstep,
+  // so a work group barrier is required unless sub-groups consist
+  // of a single work item.
+  if(__acpp_sscp_get_subgroup_max_size() > 1)
+    __acpp_cbs_barrier();
+  if(fence_scope != __acpp_sscp_memory_scope::work_group &&
+     fence_scope != __acpp_sscp_memory_scope::sub_group) {
+    __acpp_cpu_mem_fence(fence_scope, order);
+  }
 }
@@ -9,24 +9,22 @@
  */
 // SPDX-License-Identifier: BSD-2-Clause
 
-#include "hipSYCL/sycl/libkernel/sscp/builtins/detail/reduction.hpp"
+#include "hipSYCL/sycl/libkernel/sscp/builtins/detail/subgroup_host.hpp"
 #include "hipSYCL/sycl/libkernel/sscp/builtins/reduction.hpp"
 
-HIPSYCL_SSCP_BUILTIN void *__acpp_sscp_host_get_internal_local_memory();
-
 #define ACPP_SUBGROUP_FLOAT_REDUCTION(type)                                                        \
   HIPSYCL_SSCP_CONVERGENT_BUILTIN                                                                  \
   __acpp_##type __acpp_sscp_sub_group_reduce_##type(__acpp_sscp_algorithm_op op,                   \
                                                     __acpp_##type x) {                             \
     switch (op) {                                                                                  \
     case __acpp_sscp_algorithm_op::plus:                                                           \
-      return hipsycl::libkernel::sscp::sg_reduce<__acpp_sscp_algorithm_op::plus>(x);               \
+      return hipsycl::libkernel::sscp::sg_host_reduce(x, hipsycl::libkernel::sscp::plus{});        \
     case __acpp_sscp_algorithm_op::multiply:                                                       \
-      return hipsycl::libkernel::sscp::sg_reduce<__acpp_sscp_algorithm_op::multiply>(x);           \
+      return hipsycl::libkernel::sscp::sg_host_reduce(x, hipsycl::libkernel::sscp::multiply{});    \
     case __acpp_sscp_algorithm_op::min:                                                            \
-      return hipsycl::libkernel::sscp::sg_reduce<__acpp_sscp_algorithm_op::min>(x);                \
+      return hipsycl::libkernel::sscp::sg_host_reduce(x, hipsycl::libkernel::sscp::min{});         \
     case __acpp_sscp_algorithm_op::max:                                                            \
-      return hipsycl::libkernel::sscp::sg_reduce<__acpp_sscp_algorithm_op::max>(x);                \
+      return hipsycl::libkernel::sscp::sg_host_reduce(x, hipsycl::libkernel::sscp::max{});         \
     default:                                                                                       \
       return __acpp_##type{};                                                                      \
     }                                                                                              \
@@ -42,23 +40,23 @@ ACPP_SUBGROUP_FLOAT_REDUCTION(f64)
                                                          __acpp_##type x) {                        \
     switch (op) {                                                                                  \
     case __acpp_sscp_algorithm_op::plus:                                                           \
-      return hipsycl::libkernel::sscp::sg_reduce<__acpp_sscp_algorithm_op::plus>(x);               \
+      return hipsycl::libkernel::sscp::sg_host_reduce(x, hipsycl::libkernel::sscp::plus{});        \
     case __acpp_sscp_algorithm_op::multiply:                                                       \
-      return hipsycl::libkernel::sscp::sg_reduce<__acpp_sscp_algorithm_op::multiply>(x);           \
+      return hipsycl::libkernel::sscp::sg_host_reduce(x, hipsycl::libkernel::sscp::multiply{});    \
     case __acpp_sscp_algorithm_op::min:                                                            \
-      return hipsycl::libkernel::sscp::sg_reduce<__acpp_sscp_algorithm_op::min>(x);                \
+      return hipsycl::libkernel::sscp::sg_host_reduce(x, hipsycl::libkernel::sscp::min{});         \
     case __acpp_sscp_algorithm_op::max:                                                            \
-      return hipsycl::libkernel::sscp::sg_reduce<__acpp_sscp_algorithm_op::max>(x);                \
+      return hipsycl::libkernel::sscp::sg_host_reduce(x, hipsycl::libkernel::sscp::max{});         \
     case __acpp_sscp_algorithm_op::bit_and:                                                        \
-      return hipsycl::libkernel::sscp::sg_reduce<__acpp_sscp_algorithm_op::bit_and>(x);            \
+      return hipsycl::libkernel::sscp::sg_host_reduce(x, hipsycl::libkernel::sscp::bit_and{});     \
     case __acpp_sscp_algorithm_op::bit_or:                                                         \
-      return hipsycl::libkernel::sscp::sg_reduce<__acpp_sscp_algorithm_op::bit_or>(x);             \
+      return hipsycl::libkernel::sscp::sg_host_reduce(x, hipsycl::libkernel::sscp::bit_or{});      \
     case __acpp_sscp_algorithm_op::bit_xor:                                                        \
-      return hipsycl::libkernel::sscp::sg_reduce<__acpp_sscp_algorithm_op::bit_xor>(x);            \
+      return hipsycl::libkernel::sscp::sg_host_reduce(x, hipsycl::libkernel::sscp::bit_xor{});     \
     case __acpp_sscp_algorithm_op::logical_and:                                                    \
-      return hipsycl::libkernel::sscp::sg_reduce<__acpp_sscp_algorithm_op::logical_and>(x);        \
+      return hipsycl::libkernel::sscp::sg_host_reduce(x, hipsycl::libkernel::sscp::logical_and{}); \
     case __acpp_sscp_algorithm_op::logical_or:                                                     \
-      return hipsycl::libkernel::sscp::sg_reduce<__acpp_sscp_algorithm_op::logical_or>(x);         \
+      return hipsycl::libkernel::sscp::sg_host_reduce(x, hipsycl::libkernel::sscp::logical_or{});  \
     default:                                                                                       \
       return __acpp_##type{};                                                                      \
     }                                                                                              \
@@ -77,22 +75,15 @@ ACPP_SUBGROUP_INT_REDUCTION(u64, uint64)
   HIPSYCL_SSCP_CONVERGENT_BUILTIN                                                                  \
   __acpp_##type __acpp_sscp_work_group_reduce_##type(__acpp_sscp_algorithm_op op,                  \
                                                      __acpp_##type x) {                            \
-    constexpr int shmem_array_length = 32;                                                      \
-    __acpp_##type *shrd_mem =                                                                      \
-        static_cast<__acpp_##type *>(__acpp_sscp_host_get_internal_local_memory());                \
     switch (op) {                                                                                  \
     case __acpp_sscp_algorithm_op::plus:                                                           \
-      return hipsycl::libkernel::sscp::wg_reduce<shmem_array_length>(                              \
-          x, hipsycl::libkernel::sscp::plus{}, shrd_mem);                                          \
+      return hipsycl::libkernel::sscp::wg_host_reduce(x, hipsycl::libkernel::sscp::plus{});        \
     case __acpp_sscp_algorithm_op::multiply:                                                       \
-      return hipsycl::libkernel::sscp::wg_reduce<shmem_array_length>(                              \
-          x, hipsycl::libkernel::sscp::multiply{}, shrd_mem);                                      \
+      return hipsycl::libkernel::sscp::wg_host_reduce(x, hipsycl::libkernel::sscp::multiply{});    \
     case __acpp_sscp_algorithm_op::min:                                                            \
-      return hipsycl::libkernel::sscp::wg_reduce<shmem_array_length>(                              \
-          x, hipsycl::libkernel::sscp::min{}, shrd_mem);                                           \
+      return hipsycl::libkernel::sscp::wg_host_reduce(x, hipsycl::libkernel::sscp::min{});         \
     case __acpp_sscp_algorithm_op::max:                                                            \
-      return hipsycl::libkernel::sscp::wg_reduce<shmem_array_length>(                              \
-          x, hipsycl::libkernel::sscp::max{}, shrd_mem);                                           \
+      return hipsycl::libkernel::sscp::wg_host_reduce(x, hipsycl::libkernel::sscp::max{});         \
     default:                                                                                       \
       return __acpp_##type{};                                                                      \
     }                                                                                              \
@@ -106,37 +97,25 @@ ACPP_WORKGROUP_FLOAT_REDUCTION(f64)
   HIPSYCL_SSCP_CONVERGENT_BUILTIN                                                                  \
   __acpp_##type __acpp_sscp_work_group_reduce_##fn_suffix(__acpp_sscp_algorithm_op op,             \
                                                           __acpp_##type x) {                       \
-    constexpr int shmem_array_length = 32;                                                      \
-    __acpp_##type *shrd_mem =                                                                      \
-        static_cast<__acpp_##type *>(__acpp_sscp_host_get_internal_local_memory());                \
     switch (op) {                                                                                  \
     case __acpp_sscp_algorithm_op::plus:                                                           \
-      return hipsycl::libkernel::sscp::wg_reduce<shmem_array_length>(                              \
-          x, hipsycl::libkernel::sscp::plus{}, shrd_mem);                                          \
+      return hipsycl::libkernel::sscp::wg_host_reduce(x, hipsycl::libkernel::sscp::plus{});        \
     case __acpp_sscp_algorithm_op::multiply:                                                       \
-      return hipsycl::libkernel::sscp::wg_reduce<shmem_array_length>(                              \
-          x, hipsycl::libkernel::sscp::multiply{}, shrd_mem);                                      \
+      return hipsycl::libkernel::sscp::wg_host_reduce(x, hipsycl::libkernel::sscp::multiply{});    \
     case __acpp_sscp_algorithm_op::min:                                                            \
-      return hipsycl::libkernel::sscp::wg_reduce<shmem_array_length>(                              \
-          x, hipsycl::libkernel::sscp::min{}, shrd_mem);                                           \
+      return hipsycl::libkernel::sscp::wg_host_reduce(x, hipsycl::libkernel::sscp::min{});         \
     case __acpp_sscp_algorithm_op::max:                                                            \
-      return hipsycl::libkernel::sscp::wg_reduce<shmem_array_length>(                              \
-          x, hipsycl::libkernel::sscp::max{}, shrd_mem);                                           \
+      return hipsycl::libkernel::sscp::wg_host_reduce(x, hipsycl::libkernel::sscp::max{});         \
     case __acpp_sscp_algorithm_op::bit_and:                                                        \
-      return hipsycl::libkernel::sscp::wg_reduce<shmem_array_length>(                              \
-          x, hipsycl::libkernel::sscp::bit_and{}, shrd_mem);                                       \
+      return hipsycl::libkernel::sscp::wg_host_reduce(x, hipsycl::libkernel::sscp::bit_and{});     \
     case __acpp_sscp_algorithm_op::bit_or:                                                         \
-      return hipsycl::libkernel::sscp::wg_reduce<shmem_array_length>(                              \
-          x, hipsycl::libkernel::sscp::bit_or{}, shrd_mem);                                        \
+      return hipsycl::libkernel::sscp::wg_host_reduce(x, hipsycl::libkernel::sscp::bit_or{});      \
     case __acpp_sscp_algorithm_op::bit_xor:                                                        \
-      return hipsycl::libkernel::sscp::wg_reduce<shmem_array_length>(                              \
-          x, hipsycl::libkernel::sscp::bit_xor{}, shrd_mem);                                       \
+      return hipsycl::libkernel::sscp::wg_host_reduce(x, hipsycl::libkernel::sscp::bit_xor{});     \
     case __acpp_sscp_algorithm_op::logical_and:                                                    \
-      return hipsycl::libkernel::sscp::wg_reduce<shmem_array_length>(                              \
-          x, hipsycl::libkernel::sscp::logical_and{}, shrd_mem);                                   \
+      return hipsycl::libkernel::sscp::wg_host_reduce(x, hipsycl::libkernel::sscp::logical_and{}); \
     case __acpp_sscp_algorithm_op::logical_or:                                                     \
-      return hipsycl::libkernel::sscp::wg_reduce<shmem_array_length>(                              \
-          x, hipsycl::libkernel::sscp::logical_or{}, shrd_mem);                                    \
+      return hipsycl::libkernel::sscp::wg_host_reduce(x, hipsycl::libkernel::sscp::logical_or{});  \
     default:                                                                                       \
       return __acpp_##type{};                                                                      \
     }                                                                                              \
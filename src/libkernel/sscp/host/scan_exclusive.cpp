@@ -12,7 +12,7 @@
 
 #include "hipSYCL/sycl/libkernel/sscp/builtins/scan_exclusive.hpp"
 #include "hipSYCL/sycl/libkernel/sscp/builtins/detail/scan_host.hpp"
-#include "hipSYCL/sycl/libkernel/sscp/builtins/detail/scan_subgroup.hpp"
+#include "hipSYCL/sycl/libkernel/sscp/builtins/detail/subgroup_host.hpp"
 
 HIPSYCL_SSCP_BUILTIN void *__acpp_sscp_host_get_internal_local_memory();
 
@@ -22,17 +22,17 @@ HIPSYCL_SSCP_BUILTIN void *__acpp_sscp_host_get_internal_local_memory();
                                                             __acpp_##type x, __acpp_##type init) { \
     switch (op) {                                                                                  \
     case __acpp_sscp_algorithm_op::plus:                                                           \
-      return hipsycl::libkernel::sscp::sg_exclusive_scan(x, hipsycl::libkernel::sscp::plus{},      \
-                                                         init);                                    \
+      return hipsycl::libkernel::sscp::sg_host_exclusive_scan(                                     \
+          x, hipsycl::libkernel::sscp::plus{}, init);                                              \
     case __acpp_sscp_algorithm_op::multiply:                                                       \
-      return hipsycl::libkernel::sscp::sg_exclusive_scan(x, hipsycl::libkernel::sscp::multiply{},  \
-                                                         init);                                    \
+      return hipsycl::libkernel::sscp::sg_host_exclusive_scan(                                     \
+          x, hipsycl::libkernel::sscp::multiply{}, init);                                          \
     case __acpp_sscp_algorithm_op::min:                                                            \
-      return hipsycl::libkernel::sscp::sg_exclusive_scan(x, hipsycl::libkernel::sscp::min{},       \
-                                                         init);                                    \
+      return hipsycl::libkernel::sscp::sg_host_exclusive_scan(                                     \
+          x, hipsycl::libkernel::sscp::min{}, init);                                               \
     case __acpp_sscp_algorithm_op::max:                                                            \
-      return hipsycl::libkernel::sscp::sg_exclusive_scan(x, hipsycl::libkernel::sscp::max{},       \
-                                                         init);                                    \
+      return hipsycl::libkernel::sscp::sg_host_exclusive_scan(                                     \
+          x, hipsycl::libkernel::sscp::max{}, init);                                               \
     default:                                                                                       \
       return __acpp_##type{};                                                                      \
     }                                                                                              \
@@ -48,32 +48,32 @@ ACPP_SUBGROUP_FLOAT_SCAN(f64)
       __acpp_sscp_algorithm_op op, __acpp_##type x, __acpp_##type init) {                          \
     switch (op) {                                                                                  \
     case __acpp_sscp_algorithm_op::plus:                                                           \
-      return hipsycl::libkernel::sscp::sg_exclusive_scan(x, hipsycl::libkernel::sscp::plus{},      \
-                                                         init);                                    \
+      return hipsycl::libkernel::sscp::sg_host_exclusive_scan(                                     \
+          x, hipsycl::libkernel::sscp::plus{}, init);                                              \
     case __acpp_sscp_algorithm_op::multiply:                                                       \
-      return hipsycl::libkernel::sscp::sg_exclusive_scan(x, hipsycl::libkernel::sscp::multiply{},  \
-                                                         init);                                    \
+      return hipsycl::libkernel::sscp::sg_host_exclusive_scan(                                     \
+          x, hipsycl::libkernel::sscp::multiply{}, init);                                          \
     case __acpp_sscp_algorithm_op::min:                                                            \
-      return hipsycl::libkernel::sscp::sg_exclusive_scan(x, hipsycl::libkernel::sscp::min{},       \
-                                                         init);                                    \
+      return hipsycl::libkernel::sscp::sg_host_exclusive_scan(                                     \
+          x, hipsycl::libkernel::sscp::min{}, init);                                               \
     case __acpp_sscp_algorithm_op::max:                                                            \
-      return hipsycl::libkernel::sscp::sg_exclusive_scan(x, hipsycl::libkernel::sscp::max{},       \
-                                                         init);                                    \
+      return hipsycl::libkernel::sscp::sg_host_exclusive_scan(                                     \
+          x, hipsycl::libkernel::sscp::max{}, init);                                               \
     case __acpp_sscp_algorithm_op::bit_and:                                                        \
-      return hipsycl::libkernel::sscp::sg_exclusive_scan(x, hipsycl::libkernel::sscp::bit_and{},   \
-                                                         init);                                    \
+      return hipsycl::libkernel::sscp::sg_host_exclusive_scan(                                     \
+          x, hipsycl::libkernel::sscp::bit_and{}, init);                                           \
     case __acpp_sscp_algorithm_op::bit_or:                                                         \
-      return hipsycl::libkernel::sscp::sg_exclusive_scan(x, hipsycl::libkernel::sscp::bit_or{},    \
-                                                         init);                                    \
+      return hipsycl::libkernel::sscp::sg_host_exclusive_scan(                                     \
+          x, hipsycl::libkernel::sscp::bit_or{}, init);                                            \
     case __acpp_sscp_algorithm_op::bit_xor:                                                        \
-      return hipsycl::libkernel::sscp::sg_exclusive_scan(x, hipsycl::libkernel::sscp::bit_xor{},   \
-                                                         init);                                    \
+      return hipsycl::libkernel::sscp::sg_host_exclusive_scan(                                     \
+          x, hipsycl::libkernel::sscp::bit_xor{}, init);                                           \
     case __acpp_sscp_algorithm_op::logical_and:                                                    \
-      return hipsycl::libkernel::sscp::sg_exclusive_scan(                                          \
-          x, hipsycl::libkernel::sscp::logical_and{}, init);                                       \
+      return hipsycl::libkernel::sscp::sg_host_exclusive_scan(                                     \
+           x, hipsycl::libkernel::sscp::logical_and{}, init);                                      \
     case __acpp_sscp_algorithm_op::logical_or:                                                     \
-      return hipsycl::libkernel::sscp::sg_exclusive_scan(                                          \
-          x, hipsycl::libkernel::sscp::logical_or{}, init);                                        \
+      return hipsycl::libkernel::sscp::sg_host_exclusive_scan(                                     \
+           x, hipsycl::libkernel::sscp::logical_or{}, init);                                       \
     default:                                                                                       \
       return __acpp_##type{};                                                                      \
     }                                                                                              \
@@ -12,7 +12,7 @@
 
 #include "hipSYCL/sycl/libkernel/sscp/builtins/scan_inclusive.hpp"
 #include "hipSYCL/sycl/libkernel/sscp/builtins/detail/scan_host.hpp"
-#include "hipSYCL/sycl/libkernel/sscp/builtins/detail/scan_subgroup.hpp"
+#include "hipSYCL/sycl/libkernel/sscp/builtins/detail/subgroup_host.hpp"
 
 HIPSYCL_SSCP_BUILTIN void *__acpp_sscp_host_get_internal_local_memory();
 
@@ -22,13 +22,15 @@ HIPSYCL_SSCP_BUILTIN void *__acpp_sscp_host_get_internal_local_memory();
                                                             __acpp_##type x) {                     \
     switch (op) {                                                                                  \
     case __acpp_sscp_algorithm_op::plus:                                                           \
-      return hipsycl::libkernel::sscp::sg_inclusive_scan(x, hipsycl::libkernel::sscp::plus{});     \
+      return hipsycl::libkernel::sscp::sg_host_inclusive_scan(                                     \
+          x, hipsycl::libkernel::sscp::plus{});                                                    \
     case __acpp_sscp_algorithm_op::multiply:                                                       \
-      return hipsycl::libkernel::sscp::sg_inclusive_scan(x, hipsycl::libkernel::sscp::multiply{}); \
+      return hipsycl::libkernel::sscp::sg_host_inclusive_scan(                                     \
+          x, hipsycl::libkernel::sscp::multiply{});                                                \
     case __acpp_sscp_algorithm_op::min:                                                            \
-      return hipsycl::libkernel::sscp::sg_inclusive_scan(x, hipsycl::libkernel::sscp::min{});      \
+      return hipsycl::libkernel::sscp::sg_host_inclusive_scan(x, hipsycl::libkernel::sscp::min{}); \
     case __acpp_sscp_algorithm_op::max:                                                            \
-      return hipsycl::libkernel::sscp::sg_inclusive_scan(x, hipsycl::libkernel::sscp::max{});      \
+      return hipsycl::libkernel::sscp::sg_host_inclusive_scan(x, hipsycl::libkernel::sscp::max{}); \
     default:                                                                                       \
       return __acpp_##type{};                                                                      \
     }                                                                                              \
@@ -44,25 +46,30 @@ ACPP_SUBGROUP_FLOAT_SCAN(f64)
                                                                  __acpp_##type x) {                \
     switch (op) {                                                                                  \
     case __acpp_sscp_algorithm_op::plus:                                                           \
-      return hipsycl::libkernel::sscp::sg_inclusive_scan(x, hipsycl::libkernel::sscp::plus{});     \
+      return hipsycl::libkernel::sscp::sg_host_inclusive_scan(                                     \
+          x, hipsycl::libkernel::sscp::plus{});                                                    \
     case __acpp_sscp_algorithm_op::multiply:                                                       \
-      return hipsycl::libkernel::sscp::sg_inclusive_scan(x, hipsycl::libkernel::sscp::multiply{}); \
+      return hipsycl::libkernel::sscp::sg_host_inclusive_scan(                                     \
+          x, hipsycl::libkernel::sscp::multiply{});                                                \
     case __acpp_sscp_algorithm_op::min:                                                            \
-      return hipsycl::libkernel::sscp::sg_inclusive_scan(x, hipsycl::libkernel::sscp::min{});      \
+      return hipsycl::libkernel::sscp::sg_host_inclusive_scan(x, hipsycl::libkernel::sscp::min{}); \
     case __acpp_sscp_algorithm_op::max:                                                            \
-      return hipsycl::libkernel::sscp::sg_inclusive_scan(x, hipsycl::libkernel::sscp::max{});      \
+      return hipsycl::libkernel::sscp::sg_host_inclusive_scan(x, hipsycl::libkernel::sscp::max{}); \
     case __acpp_sscp_algorithm_op::bit_and:                                                        \
-      return hipsycl::libkernel::sscp::sg_inclusive_scan(x, hipsycl::libkernel::sscp::bit_and{});  \
+      return hipsycl::libkernel::sscp::sg_host_inclusive_scan(                                     \
+          x, hipsycl::libkernel::sscp::bit_and{});                                                 \
     case __acpp_sscp_algorithm_op::bit_or:                                                         \
-      return hipsycl::libkernel::sscp::sg_inclusive_scan(x, hipsycl::libkernel::sscp::bit_or{});   \
+      return hipsycl::libkernel::sscp::sg_host_inclusive_scan(                                     \
+          x, hipsycl::libkernel::sscp::bit_or{});                                                  \
     case __acpp_sscp_algorithm_op::bit_xor:                                                        \
-      return hipsycl::libkernel::sscp::sg_inclusive_scan(x, hipsycl::libkernel::sscp::bit_xor{});  \
+      return hipsycl::libkernel::sscp::sg_host_inclusive_scan(                                     \
+          x, hipsycl::libkernel::sscp::bit_xor{});                                                 \
     case __acpp_sscp_algorithm_op::logical_and:                                                    \
-      return hipsycl::libkernel::sscp::sg_inclusive_scan(x,                                        \
-                                                         hipsycl::libkernel::sscp::logical_and{}); \
+      return hipsycl::libkernel::sscp::sg_host_inclusive_scan(                                     \
+          x, hipsycl::libkernel::sscp::logical_and{});                                             \
     case __acpp_sscp_algorithm_op::logical_or:                                                     \
-      return hipsycl::libkernel::sscp::sg_inclusive_scan(x,                                        \
-                                                         hipsycl::libkernel::sscp::logical_or{});  \
+      return hipsycl::libkernel::sscp::sg_host_inclusive_scan(                                     \
+          x, hipsycl::libkernel::sscp::logical_or{});                                              \
     default:                                                                                       \
       return __acpp_##type{};                                                                      \
     }                                                                                              \
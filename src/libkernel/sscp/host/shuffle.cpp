@@ -11,43 +11,46 @@
 
 #include "hipSYCL/sycl/libkernel/sscp/builtins/shuffle.hpp"
 #include "hipSYCL/sycl/libkernel/sscp/builtins/detail/shuffle.hpp"
+#include "hipSYCL/sycl/libkernel/sscp/builtins/detail/subgroup_host.hpp"
 
-#define SUBGROUP_SIZE_ONE_SHUFLLE(int_size, direction)                                             \
+#define HOST_SUBGROUP_SHUFFLE(int_size, direction, source_lane)                                    \
   HIPSYCL_SSCP_CONVERGENT_BUILTIN                                                                  \
   __acpp_int##int_size __acpp_sscp_sub_group_##direction##_i##int_size(__acpp_int##int_size value, \
                                                                        __acpp_uint32 delta) {      \
-    return delta == 0 ? value : 0;                                                                 \
+    __acpp_int32 lane = __acpp_sscp_get_subgroup_local_id();                                       \
+    return hipsycl::libkernel::sscp::sg_host_exchange(value, source_lane);                         \
   }
 
-SUBGROUP_SIZE_ONE_SHUFLLE(8, shl)
-SUBGROUP_SIZE_ONE_SHUFLLE(16, shl)
-SUBGROUP_SIZE_ONE_SHUFLLE(32, shl)
-SUBGROUP_SIZE_ONE_SHUFLLE(64, shl)
-SUBGROUP_SIZE_ONE_SHUFLLE(8, shr)
-SUBGROUP_SIZE_ONE_SHUFLLE(16, shr)
-SUBGROUP_SIZE_ONE_SHUFLLE(32, shr)
-SUBGROUP_SIZE_ONE_SHUFLLE(64, shr)
+HOST_SUBGROUP_SHUFFLE(8, shl, lane + static_cast<__acpp_int32>(delta))
+HOST_SUBGROUP_SHUFFLE(16, shl, lane + static_cast<__acpp_int32>(delta))
+HOST_SUBGROUP_SHUFFLE(32, shl, lane + static_cast<__acpp_int32>(delta))
+HOST_SUBGROUP_SHUFFLE(64, shl, lane + static_cast<__acpp_int32>(delta))
+HOST_SUBGROUP_SHUFFLE(8, shr, lane - static_cast<__acpp_int32>(delta))
+HOST_SUBGROUP_SHUFFLE(16, shr, lane - static_cast<__acpp_int32>(delta))
+HOST_SUBGROUP_SHUFFLE(32, shr, lane - static_cast<__acpp_int32>(delta))
+HOST_SUBGROUP_SHUFFLE(64, shr, lane - static_cast<__acpp_int32>(delta))
 
-#define SUBGROUP_SIZE_ONE_PERMUTE(int_size)                                                        \
+#define HOST_SUBGROUP_PERMUTE(int_size)                                                            \
   HIPSYCL_SSCP_CONVERGENT_BUILTIN                                                                  \
   __acpp_int##int_size __acpp_sscp_sub_group_permute_i##int_size(__acpp_int##int_size value,       \
                                                                  __acpp_int32 mask) {              \
-    return mask xor 0 ? value : 0;                                                                 \
+    __acpp_int32 lane = __acpp_sscp_get_subgroup_local_id();                                       \
+    return hipsycl::libkernel::sscp::sg_host_exchange(value, lane ^ mask);                         \
   }
 
-SUBGROUP_SIZE_ONE_PERMUTE(8)
-SUBGROUP_SIZE_ONE_PERMUTE(16)
-SUBGROUP_SIZE_ONE_PERMUTE(32)
-SUBGROUP_SIZE_ONE_PERMUTE(64)
+HOST_SUBGROUP_PERMUTE(8)
+HOST_SUBGROUP_PERMUTE(16)
+HOST_SUBGROUP_PERMUTE(32)
+HOST_SUBGROUP_PERMUTE(64)
 
-#define SUBGROUP_SIZE_ONE_SELECT(int_size)                                                         \
+#define HOST_SUBGROUP_SELECT(int_size)                                                             \
   HIPSYCL_SSCP_CONVERGENT_BUILTIN                                                                  \
   __acpp_int##int_size __acpp_sscp_sub_group_select_i##int_size(__acpp_int##int_size value,        \
-                                                                __acpp_int32 mask) {               \
-    return mask == 0 ? value : 0;                                                                  \
+                                                                __acpp_int32 id) {                 \
+    return hipsycl::libkernel::sscp::sg_host_exchange(value, id);                                  \
   }
 
-SUBGROUP_SIZE_ONE_SELECT(8)
-SUBGROUP_SIZE_ONE_SELECT(16)
-SUBGROUP_SIZE_ONE_SELECT(32)
-SUBGROUP_SIZE_ONE_SELECT(64)
+HOST_SUBGROUP_SELECT(8)
+HOST_SUBGROUP_SELECT(16)
+HOST_SUBGROUP_SELECT(32)
+HOST_SUBGROUP_SELECT(64)
@@ -10,30 +10,41 @@
 // SPDX-License-Identifier: BSD-2-Clause
 #include "hipSYCL/sycl/libkernel/sscp/builtins/subgroup.hpp"
 #include "hipSYCL/sycl/libkernel/sscp/builtins/core.hpp"
+#include "hipSYCL/sycl/libkernel/sscp/builtins/core_typed.hpp"
+#include <stddef.h>
+
+// Replaced with a constant by the JIT compiler, see LLVMToHost.
+// Sub-groups consist of consecutive work items in linear id order.
+extern "C" size_t __acpp_cbs_sub_group_size;
 
 HIPSYCL_SSCP_BUILTIN __acpp_uint32 __acpp_sscp_get_subgroup_local_id() {
-  return 0;
+  return __acpp_sscp_typed_get_local_linear_id<3, __acpp_uint32>() %
+         static_cast<__acpp_uint32>(__acpp_cbs_sub_group_size);
 }
 
 HIPSYCL_SSCP_BUILTIN __acpp_uint32 __acpp_sscp_get_subgroup_size() {
-  return 1;
+  __acpp_uint32 wg_size = __acpp_sscp_typed_get_local_size<3, __acpp_uint32>();
+  __acpp_uint32 first_lid = __acpp_sscp_get_subgroup_id() *
+                            static_cast<__acpp_uint32>(__acpp_cbs_sub_group_size);
+  // The last sub-group is smaller if the work group size is not a multiple
+  // of the sub-group size.
+  __acpp_uint32 remaining = wg_size - first_lid;
+  return remaining < __acpp_cbs_sub_group_size
+             ? remaining
+             : static_cast<__acpp_uint32>(__acpp_cbs_sub_group_size);
 }
 
 HIPSYCL_SSCP_BUILTIN __acpp_uint32 __acpp_sscp_get_subgroup_max_size() {
-  return 1;
+  return static_cast<__acpp_uint32>(__acpp_cbs_sub_group_size);
 }
 
 HIPSYCL_SSCP_BUILTIN __acpp_uint32 __acpp_sscp_get_subgroup_id() {
-  __acpp_uint32 local_tid =
-      __acpp_sscp_get_local_id_x() +
-      __acpp_sscp_get_local_id_y() * (__acpp_sscp_get_local_size_x() +
-      __acpp_sscp_get_local_id_z() * __acpp_sscp_get_local_size_x());
-  return local_tid;
+  return __acpp_sscp_typed_get_local_linear_id<3, __acpp_uint32>() /
+         static_cast<__acpp_uint32>(__acpp_cbs_sub_group_size);
 }
 
 HIPSYCL_SSCP_BUILTIN __acpp_uint32 __acpp_sscp_get_num_subgroups() {
-  auto wg_size = __acpp_sscp_get_local_size_x() *
-                 __acpp_sscp_get_local_size_y() *
-                 __acpp_sscp_get_local_size_z();
-  return wg_size;
+  __acpp_uint32 wg_size = __acpp_sscp_typed_get_local_size<3, __acpp_uint32>();
+  __acpp_uint32 sg_size = static_cast<__acpp_uint32>(__acpp_cbs_sub_group_size);
+  return (wg_size + sg_size - 1) / sg_size;
 }
@@ -198,6 +198,23 @@ kernel_adaptivity_engine::kernel_adaptivity_engine(
 kernel_configuration::id_type
 kernel_adaptivity_engine::finalize_binary_configuration(
     kernel_configuration &config) {
+  return finalize_binary_configuration(config, _adaptivity_level, true);
+}
+
+kernel_configuration::id_type
+kernel_adaptivity_engine::finalize_fallback_binary_configuration(
+    kernel_configuration &config, int adaptivity_level) {
+  return finalize_binary_configuration(config, adaptivity_level, false);
+}
+
+int kernel_adaptivity_engine::get_adaptivity_level() const {
+  return _adaptivity_level;
+}
+
+kernel_configuration::id_type
+kernel_adaptivity_engine::finalize_binary_configuration(
+    kernel_configuration &config, int adaptivity_level,
+    bool update_statistics) {
     
   // At any adaptivity level need to handle function call specializations.
   for (int i = 0; i < _kernel_info->get_num_parameters(); ++i) {
@@ -214,7 +231,7 @@ kernel_adaptivity_engine::finalize_binary_configuration(
     }
   }
 
-  if(_adaptivity_level > 0) {
+  if(adaptivity_level > 0) {
     // Enter single-kernel code model
     config.append_base_configuration(
         kernel_base_config_parameter::single_kernel, _kernel_name);
@@ -334,7 +351,9 @@ kernel_adaptivity_engine::finalize_binary_configuration(
     }
   }
   
-  if(_adaptivity_level > 1) {
+  // Invariant argument detection relies on statistics that are updated
+  // with each invocation, so it is only available if we are allowed to update them.
+  if(adaptivity_level > 1 && update_statistics) {
 
     auto base_id = config.generate_id();
     
@@ -391,7 +410,12 @@ kernel_adaptivity_engine::finalize_binary_configuration(
 
 std::string kernel_adaptivity_engine::select_image_and_kernels(
     std::vector<std::string> *kernel_names_out) {
-  if(_adaptivity_level > 0) {
+  return select_image_and_kernels(kernel_names_out, _adaptivity_level);
+}
+
+std::string kernel_adaptivity_engine::select_image_and_kernels(
+    std::vector<std::string> *kernel_names_out, int adaptivity_level) {
+  if(adaptivity_level > 0) {
     *kernel_names_out = std::vector{std::string{_kernel_name}};
 
     std::vector<std::string> all_kernels_in_image;
@@ -0,0 +1,169 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+#include <algorithm>
+#include <cassert>
+
+#include "hipSYCL/runtime/command_graph.hpp"
+#include "hipSYCL/runtime/generic/object_pool.hpp"
+#include "hipSYCL/runtime/runtime.hpp"
+#include "hipSYCL/common/debug.hpp"
+
+namespace hipsycl {
+namespace rt {
+
+void command_graph::begin_recording(bool is_in_order, std::size_t node_group) {
+  std::lock_guard<std::mutex> lock{_mutex};
+
+  _entries.clear();
+  _placeholders.clear();
+  _placeholder_indices.clear();
+  _previous_replay.clear();
+  _sinks.clear();
+
+  _is_recording = true;
+  _is_in_order = is_in_order;
+  _node_group = node_group;
+}
+
+void command_graph::end_recording() {
+  std::lock_guard<std::mutex> lock{_mutex};
+
+  _is_recording = false;
+
+  // Remember the entries that no entry depends on, such that replay()
+  // can return a node that completes after all replayed nodes.
+  // In-order graphs are a chain that ends with the last entry.
+  _sinks.clear();
+  if(_is_in_order) {
+    if(!_entries.empty())
+      _sinks.push_back(_entries.size() - 1);
+  } else {
+    std::vector<bool> is_sink(_entries.size(), true);
+    for(const auto& e : _entries)
+      for(std::size_t dep : e.internal_dependencies)
+        is_sink[dep] = false;
+
+    for(std::size_t i = 0; i < _entries.size(); ++i)
+      if(is_sink[i])
+        _sinks.push_back(i);
+  }
+
+  // Placeholders are only needed to resolve dependencies
+  // while recording
+  _placeholders.clear();
+  _placeholder_indices.clear();
+
+  HIPSYCL_DEBUG_INFO << "command_graph: Recorded " << _entries.size()
+                     << " operations" << std::endl;
+}
+
+bool command_graph::is_recording() const {
+  std::lock_guard<std::mutex> lock{_mutex};
+  return _is_recording;
+}
+
+dag_node_ptr command_graph::record(std::shared_ptr<operation> op,
+                                   const execution_hints &hints,
+                                   const node_list_t &requirements,
+                                   runtime *rt) {
+  std::lock_guard<std::mutex> lock{_mutex};
+  assert(_is_recording);
+
+  entry e;
+  e.op = op;
+  e.hints = hints;
+
+  auto add_internal_dependency = [&](std::size_t index) {
+    if (std::find(e.internal_dependencies.begin(),
+                  e.internal_dependencies.end(),
+                  index) == e.internal_dependencies.end())
+      e.internal_dependencies.push_back(index);
+  };
+
+  for(const auto& req : requirements) {
+    auto it = _placeholder_indices.find(req.get());
+    if(it != _placeholder_indices.end())
+      add_internal_dependency(it->second);
+    else if(!req->is_known_complete())
+      e.external_dependencies.push_back(req);
+  }
+  if(_is_in_order && !_entries.empty())
+    add_internal_dependency(_entries.size() - 1);
+
+  auto placeholder =
+      make_pooled_shared<dag_node>(hints, requirements, std::move(op), rt);
+
+  _placeholder_indices[placeholder.get()] = _entries.size();
+  _placeholders.push_back(placeholder);
+  _entries.push_back(std::move(e));
+
+  return placeholder;
+}
+
+void command_graph::update(std::size_t index, std::shared_ptr<operation> op) {
+  std::lock_guard<std::mutex> lock{_mutex};
+  assert(index < _entries.size());
+
+  _entries[index].op = std::move(op);
+}
+
+std::shared_ptr<operation>
+command_graph::get_operation(std::size_t index) const {
+  std::lock_guard<std::mutex> lock{_mutex};
+  assert(index < _entries.size());
+
+  return _entries[index].op;
+}
+
+std::size_t command_graph::size() const {
+  std::lock_guard<std::mutex> lock{_mutex};
+  return _entries.size();
+}
+
+std::size_t command_graph::get_node_group() const {
+  std::lock_guard<std::mutex> lock{_mutex};
+  return _node_group;
+}
+
+bool command_graph::is_in_order() const {
+  std::lock_guard<std::mutex> lock{_mutex};
+  return _is_in_order;
+}
+
+dag_node_ptr command_graph::join_sinks(const std::vector<dag_node_ptr> &nodes,
+                                       runtime *rt) {
+  if(_sinks.empty())
+    return nullptr;
+  if(_sinks.size() == 1)
+    return nodes[_sinks.front()];
+
+  node_list_t sink_nodes;
+  bool all_submitted = true;
+  for(std::size_t index : _sinks) {
+    sink_nodes.push_back(nodes[index]);
+    all_submitted = all_submitted && nodes[index]->is_submitted();
+  }
+  // A virtual node takes the events of its requirements when it is marked
+  // as submitted, so the sinks have to be submitted first.
+  if(!all_submitted)
+    rt->dag().flush_sync();
+
+  // The join node is never executed. It only carries the operation of
+  // the last sink because requirements are expected to have an operation.
+  const entry& last_sink = _entries[_sinks.back()];
+  auto join = make_pooled_shared<dag_node>(last_sink.hints, sink_nodes,
+                                           last_sink.op, rt);
+  join->mark_virtually_submitted();
+  return join;
+}
+
+}
+}
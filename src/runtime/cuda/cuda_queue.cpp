@@ -19,6 +19,7 @@
 #include "hipSYCL/runtime/code_object_invoker.hpp"
 #include "hipSYCL/runtime/cuda/cuda_instrumentation.hpp"
 #include "hipSYCL/runtime/error.hpp"
+#include "hipSYCL/runtime/generic/object_pool.hpp"
 #include "hipSYCL/runtime/util.hpp"
 #include "hipSYCL/runtime/cuda/cuda_queue.hpp"
 #include "hipSYCL/runtime/cuda/cuda_backend.hpp"
@@ -87,7 +88,7 @@ public:
 
       op.get_instrumentations()
           .add_instrumentation<instrumentations::submission_timestamp>(
-            std::make_shared<cuda_submission_timestamp>(profiler_clock::now()));
+            make_pooled_shared<cuda_submission_timestamp>(profiler_clock::now()));
     }
 
     if (_node->get_execution_hints().has_hint<
@@ -97,7 +98,7 @@ public:
 
       op.get_instrumentations()
           .add_instrumentation<instrumentations::execution_start_timestamp>(
-              std::make_shared<cuda_execution_start_timestamp>(
+              make_pooled_shared<cuda_execution_start_timestamp>(
                   _queue->get_timing_reference(), _task_start));
     }
   }
@@ -113,12 +114,12 @@ public:
       if(_task_start) {
         _operation->get_instrumentations()
             .add_instrumentation<instrumentations::execution_finish_timestamp>(
-                std::make_shared<cuda_execution_finish_timestamp>(
+                make_pooled_shared<cuda_execution_finish_timestamp>(
                     _queue->get_timing_reference(), _task_start, task_finish));
       } else {
         _operation->get_instrumentations()
             .add_instrumentation<instrumentations::execution_finish_timestamp>(
-                std::make_shared<cuda_execution_finish_timestamp>(
+                make_pooled_shared<cuda_execution_finish_timestamp>(
                     _queue->get_timing_reference(), task_finish));
       }
     }
@@ -225,12 +226,12 @@ std::shared_ptr<dag_node_event> cuda_queue::insert_event() {
     return nullptr;
   }
 
-  return std::make_shared<cuda_node_event>(_dev, evt,
+  return make_pooled_shared<cuda_node_event>(_dev, evt,
                                            _backend->get_event_pool(_dev));
 }
 
 std::shared_ptr<dag_node_event> cuda_queue::create_queue_completion_event() {
-  return std::make_shared<queue_completion_event<cudaEvent_t, cuda_node_event>>(
+  return make_pooled_shared<queue_completion_event<cudaEvent_t, cuda_node_event>>(
       this);
 }
 
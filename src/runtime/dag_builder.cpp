@@ -13,7 +13,9 @@
 #include "hipSYCL/runtime/util.hpp"
 #include "hipSYCL/runtime/operations.hpp"
 #include "hipSYCL/runtime/dag_builder.hpp"
+#include "hipSYCL/runtime/generic/object_pool.hpp"
 #include "hipSYCL/runtime/serialization/serialization.hpp"
+#include "hipSYCL/runtime/tracing.hpp"
 #include "hipSYCL/sycl/access.hpp"
 
 #include <mutex>
@@ -140,11 +142,12 @@ class prefetch_operation;
 
 dag_builder::dag_builder(runtime *rt) : _rt{rt} {}
 
-dag_node_ptr dag_builder::build_node(std::unique_ptr<operation> op,
+dag_node_ptr dag_builder::build_node(std::shared_ptr<operation> op,
                                      const requirements_list& requirements,
                                      const execution_hints& hints)
 {
   assert(op);
+  tracing::scope trace{"build_node", tracing::category::dag};
 
   // Calculate additional requirements:
   // Iterate over all requirements and look for conflicting accesses
@@ -180,8 +183,9 @@ dag_node_ptr dag_builder::build_node(std::unique_ptr<operation> op,
     }
   };
 
-  auto operation_node = std::make_shared<dag_node>(
+  auto operation_node = make_pooled_shared<dag_node>(
       hints, requirements.get(), std::move(op), _rt);
+  trace.set_node(operation_node.get());
   
   bool is_req = operation_node->get_operation()->is_requirement();
 
@@ -212,7 +216,7 @@ dag_node_ptr dag_builder::build_node(std::unique_ptr<operation> op,
 }
 
 dag_node_ptr
-dag_builder::add_command_group(std::unique_ptr<operation> op,
+dag_builder::add_command_group(std::shared_ptr<operation> op,
                                const requirements_list &requirements,
                                const execution_hints &hints)
 {
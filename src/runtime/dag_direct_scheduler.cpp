@@ -9,7 +9,10 @@
  */
 // SPDX-License-Identifier: BSD-2-Clause
 #include <algorithm>
+#include <array>
+#include <vector>
 
+#include "hipSYCL/runtime/application.hpp"
 #include "hipSYCL/runtime/device_id.hpp"
 #include "hipSYCL/runtime/hints.hpp"
 #include "hipSYCL/runtime/operations.hpp"
@@ -20,8 +23,14 @@
 #include "hipSYCL/runtime/util.hpp"
 #include "hipSYCL/runtime/dag_manager.hpp"
 #include "hipSYCL/runtime/generic/multi_event.hpp"
+#include "hipSYCL/runtime/generic/object_pool.hpp"
 #include "hipSYCL/runtime/serialization/serialization.hpp"
 #include "hipSYCL/runtime/allocator.hpp"
+#include "hipSYCL/runtime/hw_model/hw_model.hpp"
+#include "hipSYCL/runtime/hw_model/memcpy.hpp"
+#include "hipSYCL/runtime/settings.hpp"
+#include "hipSYCL/runtime/tracing.hpp"
+#include "hipSYCL/common/small_vector.hpp"
 
 namespace hipsycl {
 namespace rt {
@@ -107,58 +116,188 @@ result ensure_allocation_exists(runtime *rt,
   return make_success();
 }
 
-void for_each_explicit_operation(
-    dag_node_ptr node, std::function<void(operation *)> explicit_op_handler) {
-  if (node->is_submitted())
-    return;
-  
-  if (!node->get_operation()->is_requirement()) {
-    explicit_op_handler(node->get_operation());
-    return;
-  } else {
-    execute_if_buffer_requirement(node,
-                                  [&](buffer_memory_requirement *bmem_req) {
-          
-          device_id target_device = node->get_assigned_device();
-
-          std::vector<range_store::rect> outdated_regions;
-          bmem_req->get_data_region()->get_outdated_regions(
-              target_device, bmem_req->get_access_offset3d(),
-              bmem_req->get_access_range3d(), outdated_regions);
-
-          for (range_store::rect region : outdated_regions) {
-            std::vector<std::pair<device_id, range_store::rect>> update_sources;
-
-            bmem_req->get_data_region()->get_update_source_candidates(
-                target_device, region, update_sources);
-
-            if (update_sources.empty()) {
-              register_error(
-                  __acpp_here(),
-                  error_info{"dag_direct_scheduler: Could not obtain data "
-                             "update sources when trying to materialize "
-                             "implicit requirement"});
-              node->cancel();
-              return;
-            }
-
-            // Just use first source for now:
-            memory_location src{update_sources[0].first,
-                                update_sources[0].second.first,
-                                bmem_req->get_data_region()};
-            memory_location dest{target_device, region.first,
-                                 bmem_req->get_data_region()};
-            std::unique_ptr<operation> op =
-                std::make_unique<memcpy_operation>(src, dest, region.second);
-
-            explicit_op_handler(op.get());
-            /// TODO This has to be changed once we support multi-operation nodes
-            node->assign_effective_operation(std::move(op));
-          }
-        });
+}
+
+void coalesce_regions(std::vector<update_region> &regions) {
+  auto try_merge = [](update_region &a, const update_region &b, int dim) {
+    for (int i = 0; i < 3; ++i)
+      if (i != dim && (a.rect.first[i] != b.rect.first[i] ||
+                       a.rect.second[i] != b.rect.second[i]))
+        return false;
+    if (a.rect.first[dim] + a.rect.second[dim] != b.rect.first[dim])
+      return false;
+
+    common::small_vector<device_id, 4> common_sources;
+    for (const auto &source : a.sources)
+      if (std::find(b.sources.begin(), b.sources.end(), source) !=
+          b.sources.end())
+        common_sources.push_back(source);
+    if (common_sources.empty())
+      return false;
+
+    a.rect.second[dim] += b.rect.second[dim];
+    a.sources = common_sources;
+    return true;
+  };
+
+  // Start with the fastest dimension, where merged regions are
+  // contiguous in memory.
+  for (int dim = 2; dim >= 0; --dim) {
+    auto get_sort_key = [dim](const range_store::rect &r) {
+      std::array<std::size_t, 5> key;
+      int n = 0;
+      for (int i = 0; i < 3; ++i) {
+        if (i != dim) {
+          key[n++] = r.first[i];
+          key[n++] = r.second[i];
+        }
+      }
+      key[4] = r.first[dim];
+      return key;
+    };
+    std::sort(regions.begin(), regions.end(),
+              [&](const update_region &a, const update_region &b) {
+                return get_sort_key(a.rect) < get_sort_key(b.rect);
+              });
+
+    std::size_t num_merged = 0;
+    for (std::size_t i = 0; i < regions.size(); ++i) {
+      if (num_merged > 0 && try_merge(regions[num_merged - 1], regions[i], dim))
+        continue;
+      if (num_merged != i)
+        regions[num_merged] = regions[i];
+      ++num_merged;
+    }
+    regions.resize(num_merged);
   }
 }
 
+void split_region(const range_store::rect &region, std::size_t num_chunks,
+                  std::vector<range_store::rect> &out) {
+  int dim = 0;
+  while (dim < 2 && region.second[dim] == 1)
+    ++dim;
+
+  std::size_t extent = region.second[dim];
+  num_chunks = std::max<std::size_t>(1, std::min(num_chunks, extent));
+  for (std::size_t i = 0; i < num_chunks; ++i) {
+    std::size_t begin = i * extent / num_chunks;
+    std::size_t end = (i + 1) * extent / num_chunks;
+
+    range_store::rect chunk = region;
+    chunk.first[dim] += begin;
+    chunk.second[dim] = end - begin;
+    out.push_back(chunk);
+  }
+}
+
+namespace {
+
+// Creates the data transfers that are needed to make the range accessed by
+// a buffer requirement valid on the device assigned to the node.
+//
+// Adjacent outdated regions are coalesced if they can be updated from a
+// common source. Regions larger than the memcpy chunk size are split into
+// chunks, which are distributed across update sources according to the
+// memcpy model and can be transferred concurrently.
+result create_requirement_transfers(
+    runtime *rt, dag_node_ptr node,
+    std::vector<std::unique_ptr<operation>> &transfers) {
+  result res = make_success();
+  execute_if_buffer_requirement(node, [&](buffer_memory_requirement *bmem_req) {
+    device_id target_device = node->get_assigned_device();
+    auto data = bmem_req->get_data_region();
+
+    std::vector<range_store::rect> outdated_rects;
+    data->get_outdated_regions(target_device, bmem_req->get_access_offset3d(),
+                               bmem_req->get_access_range3d(),
+                               outdated_rects);
+
+    std::vector<update_region> outdated_regions;
+    outdated_regions.reserve(outdated_rects.size());
+    std::vector<std::pair<device_id, range_store::rect>> update_sources;
+    std::vector<range_store::rect> pages;
+    auto add_region = [&](const range_store::rect &rect) {
+      update_region region;
+      region.rect = rect;
+      for (const auto &source : update_sources)
+        region.sources.push_back(source.first);
+      outdated_regions.push_back(region);
+    };
+
+    for (const range_store::rect &rect : outdated_rects) {
+      data->find_update_source_candidates(target_device, rect, update_sources);
+      if (!update_sources.empty()) {
+        add_region(rect);
+        continue;
+      }
+      // No device holds valid data for the entire region, e.g. because
+      // its pages were written on different devices. Look up sources for
+      // each page; pages sharing a source are coalesced again below.
+      pages.clear();
+      data->split_into_pages(rect, pages);
+      for (const range_store::rect &page : pages) {
+        data->find_update_source_candidates(target_device, page,
+                                            update_sources);
+        if (update_sources.empty()) {
+          res = make_error(
+              __acpp_here(),
+              error_info{"dag_direct_scheduler: Could not obtain data "
+                         "update sources when trying to materialize "
+                         "implicit requirement"});
+          return;
+        }
+        add_region(page);
+      }
+    }
+    coalesce_regions(outdated_regions);
+
+    const std::size_t chunk_size =
+        application::get_settings().get<setting::memcpy_chunk_size>();
+
+    for (const update_region &outdated : outdated_regions) {
+      const range_store::rect &region = outdated.rect;
+
+      std::vector<memory_location> candidate_sources;
+      for (const auto &source : outdated.sources)
+        candidate_sources.push_back(memory_location{source, region.first, data});
+      memory_location dest{target_device, region.first, data};
+
+      std::vector<memcpy_model::source_share> shares =
+          rt->backends().hardware_model().get_memcpy_model()->split_sources(
+              candidate_sources, dest, region.second);
+
+      std::size_t num_bytes = region.second.size() * data->get_element_size();
+      std::size_t num_chunks = shares.size();
+      if (chunk_size > 0)
+        num_chunks =
+            std::max(num_chunks, (num_bytes + chunk_size - 1) / chunk_size);
+
+      std::vector<range_store::rect> chunks;
+      split_region(region, num_chunks, chunks);
+
+      // Assign consecutive chunks to the sources according to their share
+      std::size_t current_share = 0;
+      double accumulated_fraction = shares[0].fraction;
+      for (std::size_t i = 0; i < chunks.size(); ++i) {
+        double chunk_center = (static_cast<double>(i) + 0.5) / chunks.size();
+        while (chunk_center > accumulated_fraction &&
+               current_share + 1 < shares.size()) {
+          ++current_share;
+          accumulated_fraction += shares[current_share].fraction;
+        }
+
+        memory_location src{shares[current_share].source.get_device(),
+                            chunks[i].first, data};
+        memory_location chunk_dest{target_device, chunks[i].first, data};
+        transfers.push_back(std::make_unique<memcpy_operation>(
+            src, chunk_dest, chunks[i].second));
+      }
+    }
+  });
+  return res;
+}
+
 std::pair<backend_executor *, device_id>
 select_executor(runtime *rt, dag_node_ptr node, operation *op) {
   device_id dev = node->get_assigned_device();
@@ -224,6 +363,10 @@ result submit_requirement(runtime* rt, dag_node_ptr req) {
   if (!req->get_operation()->is_requirement() || req->is_submitted())
     return make_success();
 
+  tracing::scope trace{"materialize_requirement", tracing::category::memory,
+                       req.get()};
+  std::uint64_t num_transfers = 0;
+
   sycl::access::mode access_mode = sycl::access::mode::read_write;
 
   // Make sure that all required allocations exist
@@ -254,52 +397,74 @@ result submit_requirement(runtime* rt, dag_node_ptr req) {
                   bmem_req->get_access_range3d());
         });
     if(has_initialized_content){
-      for_each_explicit_operation(req, [&](operation *op) {
-        if (!op->is_data_transfer()) {
-          res = make_error(
-              __acpp_here(),
-              error_info{
-                  "dag_direct_scheduler: only data transfers are supported "
-                  "as operations generated from implicit requirements.",
-                  error_type::feature_not_supported});
-        } else {
-          std::pair<backend_executor *, device_id> execution_config =
-              select_executor(rt, req, op);
-          // TODO What if we need to copy between two device backends through
-          // host?
-          
-          // TODO: The following is super-hacky and hints that we might
-          // have to do some larger architectural changes here:
-          //
-          // For host accessors, their target device will be set to the host
-          // device, but that might not be the correct device to carry
-          // out the memcpy, because the host device cannot access e.g. GPU memory.
-          // So we set the assigned device to the one we get from select_executor()
-          // which takes such considerations into account.
-          // Without this, since the executor tries to execute on the device
-          // assigned to the node, it might attempt to dispatch to some invalid device.
-          //
-          // However, at the end of submit() below this section, we then try to
-          // to update the data state for device assigned to the node.
-          // For a host accessor, because we have in fact updated the host memory,
-          // we need to be able to obtain the original device at this point.
-          //
-          // We solve this by ensuring that the bind_to_device hint is always present
-          // and returns the target device id. get_assigned_device() instead reaturns
-          // the device that has processed the data transfer.
-          //
-          // We CANNOT assign_to_device the original device after the submit call,
-          // since the executors need to know which device actually has processed
-          // the operation to setup dependencies correctly.
-          auto original_device = req->get_assigned_device();
-          req->assign_to_device(execution_config.second);
-          submit(execution_config.first, req, op);
+      std::vector<std::unique_ptr<operation>> transfers;
+      res = create_requirement_transfers(rt, req, transfers);
+      if (!res.is_success())
+        return res;
+
+      const device_id target_device = req->get_assigned_device();
+      auto submit_transfer = [&](dag_node_ptr node, operation *op) {
+        node->assign_to_device(target_device);
+        std::pair<backend_executor *, device_id> execution_config =
+            select_executor(rt, node, op);
+        // TODO What if we need to copy between two device backends through
+        // host?
+
+        // TODO: The following is super-hacky and hints that we might
+        // have to do some larger architectural changes here:
+        //
+        // For host accessors, their target device will be set to the host
+        // device, but that might not be the correct device to carry
+        // out the memcpy, because the host device cannot access e.g. GPU memory.
+        // So we set the assigned device to the one we get from select_executor()
+        // which takes such considerations into account.
+        // Without this, since the executor tries to execute on the device
+        // assigned to the node, it might attempt to dispatch to some invalid device.
+        //
+        // However, at the end of submit() below this section, we then try to
+        // to update the data state for device assigned to the node.
+        // For a host accessor, because we have in fact updated the host memory,
+        // we need to be able to obtain the original device at this point.
+        //
+        // We solve this by ensuring that the bind_to_device hint is always present
+        // and returns the target device id. get_assigned_device() instead reaturns
+        // the device that has processed the data transfer.
+        //
+        // We CANNOT assign_to_device the original device after the submit call,
+        // since the executors need to know which device actually has processed
+        // the operation to setup dependencies correctly.
+        node->assign_to_device(execution_config.second);
+        submit(execution_config.first, node, op);
+      };
+
+      if (transfers.size() == 1) {
+        submit_transfer(req, transfers[0].get());
+        /// TODO This has to be changed once we support multi-operation nodes
+        req->assign_effective_operation(std::move(transfers[0]));
+      } else if (transfers.size() > 1) {
+        // A node can only be submitted once, so each transfer is submitted
+        // as a separate node that req depends on. req is then virtually
+        // submitted below, such that users of req synchronize with all
+        // transfers, which in turn can be processed concurrently.
+        node_list_t req_requirements;
+        for (auto weak_req : req->get_requirements())
+          if (auto r = weak_req.lock())
+            req_requirements.push_back(r);
+
+        for (auto &op : transfers) {
+          auto transfer_node = make_pooled_shared<dag_node>(
+              req->get_execution_hints(), req_requirements, std::move(op), rt);
+          submit_transfer(transfer_node, transfer_node->get_operation());
+          req->add_requirement(transfer_node);
+          // Keeps the transfer node alive until it has completed
+          rt->dag().register_submitted_ops(transfer_node);
         }
-      });
+      }
+      num_transfers = transfers.size();
     }
   }
-  if (!res.is_success())
-    return res;
+
+  trace.set_arg("num_transfers", num_transfers);
 
   // If the requirement did not result in any operations...
   if (!req->get_event()) {
@@ -336,6 +501,10 @@ dag_direct_scheduler::dag_direct_scheduler(runtime* rt)
 : _rt{rt} {}
 
 void dag_direct_scheduler::submit(dag_node_ptr node) {
+  tracing::scope trace{"schedule", tracing::category::scheduler, node.get()};
+  // Attribute e.g. JIT compilations triggered by the submission to this node
+  tracing::node_context trace_ctx{node.get()};
+
   if (!node->get_execution_hints().has_hint<hints::bind_to_device>()) {
     register_error(__acpp_here(),
                    error_info{"dag_direct_scheduler: Direct scheduler does not "
@@ -19,6 +19,7 @@
 #include "hipSYCL/runtime/dag_unbound_scheduler.hpp"
 #include "hipSYCL/runtime/operations.hpp"
 #include "hipSYCL/runtime/settings.hpp"
+#include "hipSYCL/runtime/tracing.hpp"
 #include "hipSYCL/runtime/util.hpp"
 #include "hipSYCL/runtime/runtime.hpp"
 
@@ -44,6 +45,8 @@ dag_manager::~dag_manager()
   flush_sync();
   wait();
 
+  tracing::write_trace_file();
+
   HIPSYCL_DEBUG_INFO << "dag_manager: Shutdown." << std::endl;
 }
 
@@ -71,8 +74,13 @@ void dag_manager::flush_async()
     dag new_dag = _builder->finish_and_reset();
 
     if(new_dag.num_nodes() > 0) {
+      tracing::instant("flush_async", tracing::category::dag, 0, "num_nodes",
+                       new_dag.num_nodes());
+
       _worker([this, new_dag](){
         HIPSYCL_DEBUG_INFO << "dag_manager [async]: Flushing!" << std::endl;
+        tracing::scope trace{"flush", tracing::category::dag};
+        trace.set_arg("num_nodes", new_dag.num_nodes());
         
         for(dag_node_ptr req : new_dag.get_memory_requirements()){
           assert_is<memory_requirement>(req->get_operation());
@@ -16,19 +16,21 @@
 #include "hipSYCL/runtime/dag_node.hpp"
 #include "hipSYCL/runtime/hints.hpp"
 #include "hipSYCL/runtime/operations.hpp"
+#include "hipSYCL/runtime/tracing.hpp"
 #include "hipSYCL/runtime/generic/multi_event.hpp"
+#include "hipSYCL/runtime/generic/object_pool.hpp"
 
 namespace hipsycl {
 namespace rt {
 
 dag_node::dag_node(const execution_hints &hints,
                    const node_list_t &requirements,
-                   std::unique_ptr<operation> op,
+                   std::shared_ptr<operation> op,
                    runtime* rt)
     : _hints{hints},
       _assigned_executor{nullptr}, _event{nullptr}, _operation{std::move(op)},
       _is_submitted{false}, _is_complete{false}, _is_virtual{false},
-      _is_cancelled{false}, _rt{rt} {
+      _is_cancelled{false}, _rt{rt}, _trace_id{tracing::make_node_id()} {
   
   for(const auto& req : requirements)
     _requirements.push_back(req);
@@ -79,7 +81,7 @@ void dag_node::mark_virtually_submitted()
       events.push_back(r->get_event());
     }
   }
-  mark_submitted(std::make_shared<dag_multi_node_event>(events));
+  mark_submitted(make_pooled_shared<dag_multi_node_event>(events));
 }
     
 void dag_node::cancel() {
@@ -272,5 +274,9 @@ runtime* dag_node::get_runtime() const {
   return _rt;
 }
 
+std::uint64_t dag_node::get_trace_id() const {
+  return _trace_id;
+}
+
 }
 }
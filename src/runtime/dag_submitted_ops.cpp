@@ -19,49 +19,136 @@ namespace rt {
 
 namespace {
 
-void erase_known_completed_nodes(std::vector<dag_node_ptr> &ops) {
-  ops.erase(std::remove_if(ops.begin(), ops.end(),
-                           [&](dag_node_ptr node) -> bool {
-                             return node->is_known_complete();
-                           }),
-            ops.end());
-}
+// Number of nodes per submission whose completion is queried from the backend
+// in order to retire completed nodes without waiting for garbage collection.
+constexpr std::size_t submission_poll_limit = 2;
+
 }
 
 dag_submitted_ops::~dag_submitted_ops() {
   this->purge_known_completed();
 }
 
-void dag_submitted_ops::copy_node_list(std::vector<dag_node_ptr>& out) const {
-  std::lock_guard lock{_lock};
-  out = _ops;
+std::size_t dag_submitted_ops::get_node_group(const dag_node_ptr &node) {
+  if (const hints::node_group *g =
+          node->get_execution_hints().get_hint<hints::node_group>())
+    return g->get_id();
+  return ungrouped_node_group;
+}
+
+dag_submitted_ops::node_fifo *
+dag_submitted_ops::get_fifo(std::size_t node_group) {
+  auto it = _groups.find(node_group);
+  if(it == _groups.end())
+    return nullptr;
+  return &(it->second);
+}
+
+const dag_submitted_ops::node_fifo *
+dag_submitted_ops::get_fifo(std::size_t node_group) const {
+  auto it = _groups.find(node_group);
+  if(it == _groups.end())
+    return nullptr;
+  return &(it->second);
+}
+
+void dag_submitted_ops::retire_completed(std::size_t node_group,
+                                         std::size_t poll_limit) {
+  auto it = _groups.find(node_group);
+  if(it == _groups.end())
+    return;
+
+  node_fifo& fifo = it->second;
+  std::size_t num_polled = 0;
+  while(!fifo.empty()) {
+    const dag_node_ptr& node = fifo.front().node;
+    if(!node->is_known_complete()) {
+      if(num_polled >= poll_limit)
+        break;
+      ++num_polled;
+      if(!node->is_complete())
+        break;
+    }
+    fifo.pop_front();
+    --_num_nodes;
+  }
+
+  if(fifo.empty())
+    _groups.erase(it);
+}
+
+void dag_submitted_ops::wait_and_retire(std::size_t node_group) {
+  dag_node_ptr newest_node;
+  std::size_t newest_index = 0;
+  {
+    std::lock_guard lock{_lock};
+    const node_fifo* fifo = get_fifo(node_group);
+    if(!fifo)
+      return;
+    newest_node = fifo->back().node;
+    newest_index = fifo->back().submission_index;
+  }
+
+  // Waiting on the newest node first marks its requirements as complete,
+  // which turns waits on older nodes, e.g. of in-order queues, into no-ops.
+  HIPSYCL_DEBUG_INFO << "dag_submitted_ops: Waiting for node group "
+                     << node_group << "; current node: " << newest_node.get()
+                     << std::endl;
+  newest_node->wait();
+  newest_node = nullptr;
+
+  // Wait on the remaining older nodes that the newest node
+  // does not depend on.
+  for(;;) {
+    dag_node_ptr oldest_node;
+    {
+      std::lock_guard lock{_lock};
+      retire_completed(node_group, 0);
+      const node_fifo* fifo = get_fifo(node_group);
+      if(fifo && fifo->front().submission_index <= newest_index)
+        oldest_node = fifo->front().node;
+    }
+    if(!oldest_node)
+      return;
+    assert(oldest_node->is_submitted());
+    oldest_node->wait();
+  }
 }
 
 void dag_submitted_ops::purge_known_completed() {
   std::lock_guard lock{_lock};
 
-  erase_known_completed_nodes(_ops);
+  std::vector<std::size_t> group_ids;
+  for(const auto& group : _groups)
+    group_ids.push_back(group.first);
+  for(std::size_t g : group_ids)
+    retire_completed(g, 0);
+}
+
+void dag_submitted_ops::get_group_ids(std::vector<std::size_t> &out) const {
+  std::lock_guard lock{_lock};
+  out.clear();
+  for(const auto& group : _groups)
+    out.push_back(group.first);
 }
 
 std::size_t dag_submitted_ops::get_num_nodes() const {
   std::lock_guard lock{_lock};
-  return _ops.size();
+  return _num_nodes;
 }
 
 void dag_submitted_ops::async_wait_and_unregister() {
     
     // If the updater thread is currently not busy with anything,
-    // create a new task that waits and purges all nodes starting
-    // from the most recent node
+    // create a new task that waits and retires the nodes submitted
+    // so far, one node group at a time
     if(_updater_thread.queue_size() == 0) {
       _updater_thread([this](){
-        std::vector<dag_node_ptr> gc_node_list;
-        this->copy_node_list(gc_node_list);
+        std::vector<std::size_t> group_ids;
+        this->get_group_ids(group_ids);
 
-        for(int i = gc_node_list.size() - 1; i >= 0; --i)
-          gc_node_list[i]->wait();
-        
-        this->purge_known_completed();
+        for(std::size_t g : group_ids)
+          this->wait_and_retire(g);
       });
     }
 }
@@ -70,51 +157,27 @@ void dag_submitted_ops::update_with_submission(dag_node_ptr single_node) {
   std::lock_guard lock{_lock};
 
   assert(single_node->is_submitted());
-  _ops.push_back(single_node);
+  std::size_t node_group = get_node_group(single_node);
+  _groups[node_group].push_back(
+      submitted_node{std::move(single_node), _num_submitted_nodes++});
+  ++_num_nodes;
+
+  retire_completed(node_group, submission_poll_limit);
 }
 
 void dag_submitted_ops::wait_for_all() {
-  std::vector<dag_node_ptr> current_ops;
-  {
-    std::lock_guard lock{_lock};
-    current_ops = _ops;
-  }
-  
-  for(dag_node_ptr node : current_ops) {
-    assert(node->is_submitted());
-    node->wait();
-  }
+  std::vector<std::size_t> group_ids;
+  get_group_ids(group_ids);
+
+  for(std::size_t g : group_ids)
+    wait_and_retire(g);
 }
 
 void dag_submitted_ops::wait_for_group(std::size_t node_group) {
   HIPSYCL_DEBUG_INFO << "dag_submitted_ops: Waiting for node group "
                      << node_group << std::endl;
   
-  std::vector<dag_node_ptr> current_ops;
-  {
-    std::lock_guard lock{_lock};  
-    current_ops = _ops;
-  }
-
-  // Iterate in reverse order over the nodes, since current_ops
-  // will contain the nodes in submission order.
-  // This means that the last nodes will be the newest. Waiting
-  // on them first might turn waits on earlier nodes into no-ops
-  // since dag_node::wait() also marks all requirements recursively
-  // as complete.
-  for(int i = current_ops.size() - 1; i >= 0; --i) {
-    const dag_node_ptr& node = current_ops[i];
-    assert(node->is_submitted());
-    if (const hints::node_group *g =
-            node->get_execution_hints().get_hint<hints::node_group>()) {
-      if (g->get_id() == node_group) {
-        HIPSYCL_DEBUG_INFO
-            << "dag_submitted_ops: Waiting for node group; current node: "
-            << node.get() << std::endl;
-        node->wait();
-      }
-    }
-  }
+  wait_and_retire(node_group);
 }
 
 node_list_t dag_submitted_ops::get_group(std::size_t node_group) {
@@ -122,13 +185,10 @@ node_list_t dag_submitted_ops::get_group(std::size_t node_group) {
   node_list_t ops;
   {
     std::lock_guard lock{_lock};
-    for(dag_node_ptr node : _ops) {
-      assert(node->is_submitted());
-      if (const hints::node_group *g =
-              node->get_execution_hints().get_hint<hints::node_group>()) {
-        if (g->get_id() == node_group) {
-          ops.push_back(node);
-        }
+    if(const node_fifo* fifo = get_fifo(node_group)) {
+      for(const auto& entry : *fifo) {
+        assert(entry.node->is_submitted());
+        ops.push_back(entry.node);
       }
     }
   }
@@ -138,9 +198,11 @@ node_list_t dag_submitted_ops::get_group(std::size_t node_group) {
 bool dag_submitted_ops::contains_node(dag_node_ptr node) const {
   std::lock_guard lock{_lock};
 
-  for(dag_node_ptr n : _ops) {
-    if(n == node)
-      return true;
+  if(const node_fifo* fifo = get_fifo(get_node_group(node))) {
+    for(const auto& entry : *fifo) {
+      if(entry.node == node)
+        return true;
+    }
   }
   return false;
 }
@@ -16,10 +16,49 @@
 #include "hipSYCL/runtime/error.hpp"
 #include "hipSYCL/runtime/hints.hpp"
 #include "hipSYCL/runtime/hardware.hpp"
+#include "hipSYCL/runtime/hw_model/hw_model.hpp"
+#include "hipSYCL/runtime/operations.hpp"
+#include "hipSYCL/runtime/util.hpp"
+#include "hipSYCL/runtime/tracing.hpp"
+
+#include <algorithm>
+#include <limits>
 
 namespace hipsycl {
 namespace rt {
 
+namespace {
+
+// We do not yet have a model for execution times of kernels, so assume
+// that all operations take similar amounts of time. This still allows
+// comparing backlogs of devices in terms of the number of queued operations,
+// and trading them off against data transfers.
+constexpr cost_type default_operation_cost = 20000.0;
+
+// Cost if data cannot be made available on a device because no device
+// holds valid data for some page. Such placements should be avoided.
+constexpr cost_type unavailable_data_cost = 1.e12;
+
+// Maximum number of nodes per backlog whose completion is queried from
+// the backend on each placement.
+constexpr std::size_t backlog_poll_limit = 4;
+
+buffer_memory_requirement *get_buffer_requirement(const dag_node_ptr &node) {
+  operation *op = node->get_operation();
+  if (op->is_requirement() &&
+      cast<requirement>(op)->is_memory_requirement() &&
+      cast<memory_requirement>(op)->is_buffer_requirement())
+    return cast<buffer_memory_requirement>(op);
+  return nullptr;
+}
+
+bool is_discarding(sycl::access::mode mode) {
+  return mode == sycl::access::mode::discard_write ||
+         mode == sycl::access::mode::discard_read_write;
+}
+
+}
+
 dag_unbound_scheduler::dag_unbound_scheduler(runtime* rt)
 : _direct_scheduler{rt}, _rt{rt} {}
 
@@ -38,6 +77,8 @@ void dag_unbound_scheduler::submit(dag_node_ptr node) {
   }
 
   if(!node->get_execution_hints().has_hint<hints::bind_to_device>()){
+    tracing::scope trace{"select_device", tracing::category::scheduler,
+                         node.get()};
     std::vector<rt::device_id> eligible_devices;
     if(node->get_execution_hints().has_hint<hints::bind_to_device_group>()) {
       eligible_devices = node->get_execution_hints()
@@ -56,18 +97,162 @@ void dag_unbound_scheduler::submit(dag_node_ptr node) {
       node->cancel();
       return;
     }
-    // Round-robin as placeholder. This is not intended
-    // for anything practical, it's a _placeholder_
-    static std::size_t dev = 0;
-    ++dev;
 
-    rt::device_id target_dev = eligible_devices[dev % eligible_devices.size()];
+    rt::device_id target_dev = select_device(node, eligible_devices);
     node->get_execution_hints().set_hint(rt::hints::bind_to_device{target_dev});
   }
 
   _direct_scheduler.submit(node);
 }
 
+device_id dag_unbound_scheduler::select_device(
+    const dag_node_ptr &node, const std::vector<device_id> &eligible_devices) {
+  assert(!eligible_devices.empty());
+
+  if(eligible_devices.size() == 1)
+    return eligible_devices[0];
+
+  remove_completed_from_backlog();
+
+  std::size_t best_device_index = 0;
+  cost_type best_finish_time = std::numeric_limits<cost_type>::max();
+  cost_type best_node_cost = 0.0;
+  for(std::size_t i = 0; i < eligible_devices.size(); ++i) {
+    device_id dev = eligible_devices[i];
+    cost_type node_cost = estimate_data_transfer_cost(node, dev) +
+                          estimate_execution_cost(node, dev);
+    cost_type finish_time = get_backlog(dev) + node_cost;
+
+    HIPSYCL_DEBUG_INFO << "dag_unbound_scheduler: Estimated finish time on "
+                          "device "
+                       << dev.get_id() << " of backend "
+                       << static_cast<int>(dev.get_backend()) << ": "
+                       << finish_time << " ns" << std::endl;
+
+    if(finish_time < best_finish_time) {
+      best_finish_time = finish_time;
+      best_node_cost = node_cost;
+      best_device_index = i;
+    }
+  }
+
+  device_id selected_device = eligible_devices[best_device_index];
+  auto backlog = std::find_if(
+      _backlogs.begin(), _backlogs.end(),
+      [&](const device_backlog &b) { return b.dev == selected_device; });
+  if(backlog == _backlogs.end()) {
+    _backlogs.push_back(device_backlog{selected_device});
+    backlog = _backlogs.end() - 1;
+  }
+  backlog->nodes.push_back(std::make_pair(node, best_node_cost));
+  backlog->total_cost += best_node_cost;
+
+  return selected_device;
+}
+
+cost_type
+dag_unbound_scheduler::estimate_data_transfer_cost(const dag_node_ptr &node,
+                                                   device_id dev) const {
+  memcpy_model* model = _rt->backends().hardware_model().get_memcpy_model();
+
+  cost_type cost = 0.0;
+  std::vector<range_store::rect> outdated_regions;
+  std::vector<std::pair<device_id, range_store::rect>> update_sources;
+  std::vector<memory_location> candidate_sources;
+  std::vector<range_store::rect> pages;
+
+  for(auto weak_req : node->get_requirements()) {
+    auto req = weak_req.lock();
+    if(!req || req->is_submitted())
+      continue;
+    buffer_memory_requirement* bmem_req = get_buffer_requirement(req);
+    if(!bmem_req || is_discarding(bmem_req->get_access_mode()))
+      continue;
+
+    auto data = bmem_req->get_data_region();
+    if (!data->has_initialized_content(bmem_req->get_access_offset3d(),
+                                       bmem_req->get_access_range3d()))
+      continue;
+
+    if(data->has_allocation(dev)) {
+      data->get_outdated_regions(dev, bmem_req->get_access_offset3d(),
+                                 bmem_req->get_access_range3d(),
+                                 outdated_regions);
+    } else {
+      outdated_regions.clear();
+      outdated_regions.push_back(std::make_pair(
+          bmem_req->get_access_offset3d(), bmem_req->get_access_range3d()));
+    }
+
+    // Adds the cost of the cheapest transfer of the region from a single
+    // source, returns false if no device holds valid data for all of it.
+    auto add_transfer_cost = [&](const range_store::rect& region) {
+      data->find_update_source_candidates(dev, region, update_sources);
+      if(update_sources.empty())
+        return false;
+
+      candidate_sources.clear();
+      for(const auto& source : update_sources)
+        candidate_sources.push_back(
+            memory_location{source.first, source.second.first, data});
+      memory_location dest{dev, region.first, data};
+
+      cost_type min_cost = std::numeric_limits<cost_type>::max();
+      for(const auto& source : candidate_sources)
+        min_cost = std::min(min_cost, model->estimate_runtime_cost(
+                                          source, dest, region.second));
+      cost += min_cost;
+      return true;
+    };
+
+    for(const range_store::rect& region : outdated_regions) {
+      if(add_transfer_cost(region))
+        continue;
+      // Pages of the region may be valid on different devices
+      pages.clear();
+      data->split_into_pages(region, pages);
+      for(const range_store::rect& page : pages)
+        if(!add_transfer_cost(page))
+          cost += unavailable_data_cost;
+    }
+  }
+  return cost;
 }
+
+cost_type
+dag_unbound_scheduler::estimate_execution_cost(const dag_node_ptr &node,
+                                               device_id dev) const {
+  return default_operation_cost;
+}
+
+cost_type dag_unbound_scheduler::get_backlog(device_id dev) const {
+  for(const auto& b : _backlogs) {
+    if(b.dev == dev)
+      return b.total_cost;
+  }
+  return 0.0;
 }
 
+void dag_unbound_scheduler::remove_completed_from_backlog() {
+  for(auto& b : _backlogs) {
+    std::size_t num_polled = 0;
+    while(!b.nodes.empty()) {
+      const dag_node_ptr& node = b.nodes.front().first;
+      if(!node->is_cancelled() && !node->is_known_complete()) {
+        if(num_polled >= backlog_poll_limit)
+          break;
+        ++num_polled;
+        if(!node->is_complete())
+          break;
+      }
+      b.total_cost -= b.nodes.front().second;
+      b.nodes.pop_front();
+    }
+    // Avoid accumulating rounding errors
+    if(b.nodes.empty())
+      b.total_cost = 0.0;
+  }
+}
+
+}
+}
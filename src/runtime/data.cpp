@@ -70,12 +70,69 @@ void data_user_tracker::release_dead_users()
                _users.end());
 }
 
-range_store::range_store(range<3> size)
-: _size{size}, _contained_data(size.size())
-{}
+namespace {
+
+constexpr std::size_t bits_per_word = 64;
+
+// Bits of word index w that lie within [begin, end)
+inline uint64_t word_mask(std::size_t w, std::size_t begin, std::size_t end) {
+  std::size_t word_begin = w * bits_per_word;
+  std::size_t lo = std::max(begin, word_begin) - word_begin;
+  std::size_t hi = std::min(end, word_begin + bits_per_word) - word_begin;
+  uint64_t upper = (hi == bits_per_word) ? ~uint64_t{0} : ((uint64_t{1} << hi) - 1);
+  uint64_t lower = (uint64_t{1} << lo) - 1;
+  return upper & ~lower;
+}
+
+// Returns the first bit position in [begin, end) for which the word
+// returned by get_word(w) has a set bit, or end if there is none.
+template<class F>
+inline std::size_t find_first_set(std::size_t begin, std::size_t end,
+                                  F&& get_word) {
+  if(begin >= end)
+    return end;
+  std::size_t last_word = (end - 1) / bits_per_word;
+  for(std::size_t w = begin / bits_per_word; w <= last_word; ++w) {
+    uint64_t bits = get_word(w) & word_mask(w, begin, end);
+    if(bits)
+      return w * bits_per_word + __builtin_ctzll(bits);
+  }
+  return end;
+}
+
+inline void fill_bits(uint64_t *row, std::size_t begin, std::size_t end,
+                      bool value) {
+  if(begin >= end)
+    return;
+  std::size_t last_word = (end - 1) / bits_per_word;
+  for(std::size_t w = begin / bits_per_word; w <= last_word; ++w) {
+    uint64_t mask = word_mask(w, begin, end);
+    if(value)
+      row[w] |= mask;
+    else
+      row[w] &= ~mask;
+  }
+}
+
+}
+
+range_store::range_store(range<3> size, representation r)
+: _size{size}, _representation{r}, _words_per_row{0}
+{
+  if(_representation == representation::bitmap) {
+    _words_per_row = (size[2] + bits_per_word - 1) / bits_per_word;
+    _bits.resize(size[0] * size[1] * _words_per_row, 0);
+  } else {
+    _contained_data.resize(size.size());
+  }
+}
 
 void range_store::add(const rect& r)
 {
+  if(_representation == representation::bitmap) {
+    bitmap_fill(r, true);
+    return;
+  }
   this->for_each_element_in_range(r,
     [](id<3>, data_state& s){
       s = data_state::available;
@@ -84,6 +141,10 @@ void range_store::add(const rect& r)
 
 void range_store::remove(const rect& r)
 {
+  if(_representation == representation::bitmap) {
+    bitmap_fill(r, false);
+    return;
+  }
   this->for_each_element_in_range(r, 
     [](id<3>, data_state& s){
       s = data_state::empty;
@@ -98,6 +159,11 @@ void range_store::intersections_with(const rect& r,
                                     std::vector<rect>& out) const
 {
   out.clear();
+
+  if(_representation == representation::bitmap) {
+    bitmap_intersections_with(r, desired_state == data_state::available, out);
+    return;
+  }
   
   id<3> rect_begin = r.first;
   id<3> rect_max = 
@@ -142,6 +208,10 @@ void range_store::intersections_with(const rect& r,
 bool range_store::entire_range_equals(
     const rect& r, data_state desired_state) const
 {
+  if(_representation == representation::bitmap)
+    return bitmap_entire_range_equals(r,
+                                      desired_state == data_state::available);
+
   for(size_t x = r.first[0]; x < r.second[0]+r.first[0]; ++x){
     for(size_t y = r.first[1]; y < r.second[1]+r.first[1]; ++y){
       for(size_t z = r.first[2]; z < r.second[2]+r.first[2]; ++z){
@@ -157,5 +227,101 @@ bool range_store::entire_range_equals(
   return true;
 }
 
+void range_store::bitmap_fill(const rect& r, bool value)
+{
+  for(size_t x = r.first[0]; x < r.second[0]+r.first[0]; ++x){
+    for(size_t y = r.first[1]; y < r.second[1]+r.first[1]; ++y){
+      fill_bits(_bits.data() + get_row_offset(x, y), r.first[2],
+                r.first[2] + r.second[2], value);
+    }
+  }
+}
+
+bool range_store::bitmap_entire_range_equals(const rect& r, bool value) const
+{
+  const std::size_t z_begin = r.first[2];
+  const std::size_t z_end = r.first[2] + r.second[2];
+  for(size_t x = r.first[0]; x < r.second[0]+r.first[0]; ++x){
+    for(size_t y = r.first[1]; y < r.second[1]+r.first[1]; ++y){
+      const uint64_t* row = _bits.data() + get_row_offset(x, y);
+      // Look for the first page that does *not* have the desired state
+      if (find_first_set(z_begin, z_end, [&](std::size_t w) {
+            return value ? ~row[w] : row[w];
+          }) != z_end)
+        return false;
+    }
+  }
+  return true;
+}
+
+void range_store::bitmap_intersections_with(const rect& r, bool value,
+                                            std::vector<rect>& out) const
+{
+  const std::size_t x_end = r.first[0] + r.second[0];
+  const std::size_t y_end = r.first[1] + r.second[1];
+  const std::size_t z_end = r.first[2] + r.second[2];
+
+  std::vector<uint64_t> visited(_bits.size(), 0);
+
+  // Bits of pages that are of the desired state and not yet covered
+  // by a previously found rect
+  auto candidates = [&](std::size_t x, std::size_t y) {
+    std::size_t offset = get_row_offset(x, y);
+    const uint64_t* row = _bits.data() + offset;
+    const uint64_t* visited_row = visited.data() + offset;
+    return [=](std::size_t w) {
+      return (value ? row[w] : ~row[w]) & ~visited_row[w];
+    };
+  };
+  auto is_row_segment_candidate = [&](std::size_t x, std::size_t y,
+                                      std::size_t z_begin, std::size_t z_size) {
+    auto c = candidates(x, y);
+    return find_first_set(z_begin, z_begin + z_size, [&](std::size_t w) {
+             return ~c(w);
+           }) == z_begin + z_size;
+  };
+
+  for(std::size_t x = r.first[0]; x < x_end; ++x) {
+    for(std::size_t y = r.first[1]; y < y_end; ++y) {
+      auto c = candidates(x, y);
+      std::size_t z = r.first[2];
+      while(true) {
+        z = find_first_set(z, z_end, c);
+        if(z == z_end)
+          break;
+        // Extend the rect as far as possible, first along z, then along y
+        // and x.
+        std::size_t z_size =
+            find_first_set(z, z_end, [&](std::size_t w) { return ~c(w); }) - z;
+
+        std::size_t y_size = 1;
+        while(y + y_size < y_end &&
+              is_row_segment_candidate(x, y + y_size, z, z_size))
+          ++y_size;
+
+        std::size_t x_size = 1;
+        while(x + x_size < x_end) {
+          bool is_plane_candidate = true;
+          for(std::size_t i = 0; i < y_size && is_plane_candidate; ++i)
+            is_plane_candidate =
+                is_row_segment_candidate(x + x_size, y + i, z, z_size);
+          if(!is_plane_candidate)
+            break;
+          ++x_size;
+        }
+
+        out.push_back(std::make_pair(id<3>{x, y, z},
+                                     range<3>{x_size, y_size, z_size}));
+
+        for(std::size_t i = 0; i < x_size; ++i)
+          for(std::size_t j = 0; j < y_size; ++j)
+            fill_bits(visited.data() + get_row_offset(x + i, y + j), z,
+                      z + z_size, true);
+        z += z_size;
+      }
+    }
+  }
+}
+
 }
 }
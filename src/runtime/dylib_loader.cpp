@@ -17,6 +17,8 @@
 
 #ifndef _WIN32
 #include <dlfcn.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #else
 #include <windows.h>
 #endif
@@ -63,6 +65,54 @@ void *load_library(const std::string &filename, std::string_view loader) {
   return nullptr;
 }
 
+void *load_library_from_memory(std::string_view image, std::string_view loader,
+                               int &image_fd) {
+  image_fd = -1;
+#if !defined(_WIN32) && defined(MFD_CLOEXEC)
+  int fd = memfd_create("acpp-library", MFD_CLOEXEC);
+  if (fd < 0) {
+    HIPSYCL_DEBUG_INFO << loader
+                       << ": memfd_create() failed, cannot load library "
+                          "from memory" << std::endl;
+    return nullptr;
+  }
+
+  std::size_t written = 0;
+  while (written < image.size()) {
+    ssize_t n = write(fd, image.data() + written, image.size() - written);
+    if (n <= 0) {
+      HIPSYCL_DEBUG_WARNING << loader
+                            << ": Could not write library image to memfd"
+                            << std::endl;
+      close(fd);
+      return nullptr;
+    }
+    written += static_cast<std::size_t>(n);
+  }
+
+  // The dynamic loader identifies loaded libraries by path. The descriptor
+  // must therefore stay open while the library is loaded, otherwise the
+  // next image would get the same descriptor number and thus the same path,
+  // and dlopen() would return the handle of this library for it.
+  void *handle =
+      load_library("/proc/self/fd/" + std::to_string(fd), loader);
+  if (handle)
+    image_fd = fd;
+  else
+    close(fd);
+  return handle;
+#else
+  return nullptr;
+#endif
+}
+
+void close_library_image(int image_fd) {
+#ifndef _WIN32
+  if (image_fd >= 0)
+    close(image_fd);
+#endif
+}
+
 void *get_symbol_from_library(void *handle, const std::string &symbolName, std::string_view loader) {
 #ifndef _WIN32
   void *symbol = dlsym(handle, symbolName.c_str());
@@ -11,15 +11,49 @@
 #include "hipSYCL/runtime/generic/async_worker.hpp"
 #include "hipSYCL/common/debug.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <mutex>
 
 namespace hipsycl {
 namespace rt {
 
+namespace {
+
+constexpr int min_worker_spin_iterations = 64;
+constexpr int max_worker_spin_iterations = 16384;
+constexpr int waiter_spin_iterations = 1024;
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+// Spinning only makes sense if the producer can run concurrently
+bool is_spinning_enabled() {
+  static const bool enabled = std::thread::hardware_concurrency() > 1;
+  return enabled;
+}
+
+}
+
+static_assert((worker_thread::ring_capacity &
+               (worker_thread::ring_capacity - 1)) == 0,
+              "Ring capacity must be a power of two");
+
 worker_thread::worker_thread()
-    : _continue{true}
+    : _cells{new cell[ring_capacity]}, _enqueue_pos{0}, _dequeue_pos{0},
+      _spin_budget{max_worker_spin_iterations}, _num_submitted{0},
+      _num_completed{0}, _num_overflow_operations{0}, _continue{true},
+      _is_worker_parked{false}, _num_parked_waiters{0}
 {
+  for(std::size_t i = 0; i < ring_capacity; ++i)
+    _cells[i].sequence.store(i, std::memory_order_relaxed);
+
   _worker_thread = std::thread{[this](){ work(); } };
 }
 
@@ -28,20 +62,38 @@ worker_thread::~worker_thread()
 {
   halt();
 
-  assert(_enqueued_operations.empty());
+  assert(queue_size() == 0);
+}
+
+template<class Predicate>
+bool worker_thread::spin_until(Predicate p, int max_iterations) const {
+  if(!is_spinning_enabled())
+    return p();
+
+  for(int i = 0; i < max_iterations; ++i) {
+    if(p())
+      return true;
+    cpu_relax();
+  }
+  return p();
 }
 
 void worker_thread::wait()
 {
-  std::unique_lock<std::mutex> lock(_mutex);
-  if(!_enqueued_operations.empty())
+  auto is_complete = [this]() {
+    return _num_completed.load(std::memory_order_seq_cst) ==
+           _num_submitted.load(std::memory_order_seq_cst);
+  };
+
+  if(spin_until(is_complete, waiter_spin_iterations))
+    return;
+
+  _num_parked_waiters.fetch_add(1, std::memory_order_seq_cst);
   {
-    // Before going to sleep, wake up the other thread to avoid deadlocks
-    _condition_wait.notify_all();
-    // Wait until no operation is pending
-    _condition_wait.wait(lock, [this]{return _enqueued_operations.empty();});
+    std::unique_lock<std::mutex> lock(_park_mutex);
+    _waiter_wakeup.wait(lock, is_complete);
   }
-  assert(_enqueued_operations.empty());
+  _num_parked_waiters.fetch_sub(1, std::memory_order_seq_cst);
 }
 
 
@@ -50,77 +102,142 @@ void worker_thread::halt()
   wait();
 
   {
-    std::unique_lock<std::mutex> lock(_mutex);
+    std::lock_guard<std::mutex> lock(_park_mutex);
     _continue = false;
-    _condition_wait.notify_all();
   }
+  _worker_wakeup.notify_all();
+
   if(_worker_thread.joinable())
     _worker_thread.join();
 }
 
+bool worker_thread::try_push(async_function& f) {
+  std::size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+  cell* c = nullptr;
+  for(;;) {
+    c = &_cells[pos & (ring_capacity - 1)];
+    std::size_t seq = c->sequence.load(std::memory_order_acquire);
+    auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+    if(diff == 0) {
+      if (_enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_seq_cst,
+                                             std::memory_order_relaxed))
+        break;
+    } else if(diff < 0) {
+      // The ring is full
+      return false;
+    } else {
+      pos = _enqueue_pos.load(std::memory_order_relaxed);
+    }
+  }
+
+  c->operation = std::move(f);
+  c->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+bool worker_thread::try_pop(async_function& out) {
+  cell* c = &_cells[_dequeue_pos & (ring_capacity - 1)];
+  std::size_t seq = c->sequence.load(std::memory_order_acquire);
+  if(seq != _dequeue_pos + 1)
+    return false;
+
+  out = std::move(c->operation);
+  c->sequence.store(_dequeue_pos + ring_capacity, std::memory_order_release);
+  ++_dequeue_pos;
+  return true;
+}
+
+bool worker_thread::has_pending_operations() const {
+  return _enqueue_pos.load(std::memory_order_seq_cst) != _dequeue_pos ||
+         _num_overflow_operations.load(std::memory_order_seq_cst) > 0;
+}
+
 void worker_thread::work()
 {
   // This is the main function executed by the worker thread.
   // The loop is executed as long as there are enqueued operations,
-  // (_is_operation_pending) or we should wait for new operations
-  // (_continue).
-  while(_continue || queue_size() > 0)
-  {
-    {
-      std::unique_lock<std::mutex> lock(_mutex);
-
-      // Before going to sleep, wake up the other thread in case it is is waiting
-      // for the queue to get empty
-      _condition_wait.notify_all();
-      // Wait until we have work, or until _continue becomes false
-      _condition_wait.wait(lock,
-                           [this](){
-        return _enqueued_operations.size()>0 || !_continue;
-      });
+  // or we should wait for new operations (_continue).
+  async_function operation;
+  for(;;) {
+    bool has_operation = try_pop(operation);
+
+    if (!has_operation &&
+        _enqueue_pos.load(std::memory_order_seq_cst) != _dequeue_pos) {
+      // A producer has claimed the next slot, but not yet
+      // stored its operation. We cannot fall back to the overflow
+      // queue here, as this might violate submission order.
+      cpu_relax();
+      continue;
     }
 
-    // In any way, process the pending operations
-
-    async_function operation = [](){};
-    bool has_operation = false;
+    if (!has_operation &&
+        _num_overflow_operations.load(std::memory_order_seq_cst) > 0) {
+      std::lock_guard<std::mutex> lock{_overflow_mutex};
+      operation = std::move(_overflow_operations.front());
+      _overflow_operations.pop_front();
+      _num_overflow_operations.fetch_sub(1, std::memory_order_seq_cst);
+      has_operation = true;
+    }
 
-    {
-      std::lock_guard<std::mutex> lock(_mutex);
+    if(has_operation) {
+      operation();
+      operation.reset();
 
-      if(!_enqueued_operations.empty())
-      {
-        operation = _enqueued_operations.front();
-        has_operation = true;
+      _num_completed.fetch_add(1, std::memory_order_seq_cst);
+      if(_num_parked_waiters.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock{_park_mutex};
+        _waiter_wakeup.notify_all();
       }
+      continue;
     }
 
-    operation();
-
-    {
-      std::lock_guard<std::mutex> lock{_mutex};
-      if(has_operation)
-        _enqueued_operations.pop();
+    if(!_continue)
+      break;
+
+    // Idle: Spin first, and only park if nothing arrives in time.
+    // The spin budget adapts to how often spinning pays off.
+    if (spin_until(
+            [this]() { return has_pending_operations() || !_continue; },
+            _spin_budget)) {
+      _spin_budget = std::min(2 * _spin_budget, max_worker_spin_iterations);
+    } else {
+      _spin_budget = std::max(_spin_budget / 2, min_worker_spin_iterations);
+
+      std::unique_lock<std::mutex> lock{_park_mutex};
+      _is_worker_parked.store(true, std::memory_order_seq_cst);
+      _worker_wakeup.wait(lock, [this]() {
+        return has_pending_operations() || !_continue;
+      });
+      _is_worker_parked.store(false, std::memory_order_relaxed);
     }
-
-    _condition_wait.notify_all();
-
   }
 }
 
 void worker_thread::operator()(worker_thread::async_function f)
 {
-  std::unique_lock<std::mutex> lock(_mutex);
-
-  _enqueued_operations.push(f);
+  _num_submitted.fetch_add(1, std::memory_order_seq_cst);
+
+  // As long as there are operations in the overflow queue, new operations
+  // must go there too to preserve submission order.
+  if (_num_overflow_operations.load(std::memory_order_seq_cst) > 0 ||
+      !try_push(f)) {
+    std::lock_guard<std::mutex> lock{_overflow_mutex};
+    _overflow_operations.push_back(std::move(f));
+    _num_overflow_operations.fetch_add(1, std::memory_order_seq_cst);
+  }
 
-  lock.unlock();
-  _condition_wait.notify_all();
+  if(_is_worker_parked.load(std::memory_order_seq_cst)) {
+    std::lock_guard<std::mutex> lock{_park_mutex};
+    _worker_wakeup.notify_one();
+  }
 }
 
 std::size_t worker_thread::queue_size() const
 {
-  std::lock_guard<std::mutex> lock(_mutex);
-  return _enqueued_operations.size();
+  // Load completed operations first, so that the result cannot underflow
+  std::size_t num_completed = _num_completed.load(std::memory_order_acquire);
+  return _num_submitted.load(std::memory_order_acquire) - num_completed;
 }
 
 
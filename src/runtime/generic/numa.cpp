@@ -0,0 +1,190 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+#include "hipSYCL/runtime/generic/numa.hpp"
+#include "hipSYCL/common/debug.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <fstream>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace hipsycl {
+namespace rt {
+namespace numa {
+
+namespace {
+
+#ifdef __linux__
+// MPOL_INTERLEAVE from linux/mempolicy.h
+constexpr int mpol_interleave = 3;
+
+// Parses cpu lists of the form "0-3,8,10-11"
+std::vector<int> parse_cpu_list(const std::string& list) {
+  std::vector<int> result;
+  std::size_t pos = 0;
+  while(pos < list.size()) {
+    std::size_t next = list.find(',', pos);
+    if(next == std::string::npos)
+      next = list.size();
+    std::string entry = list.substr(pos, next - pos);
+    if(!entry.empty()) {
+      std::size_t dash = entry.find('-');
+      try {
+        int first = std::stoi(entry.substr(0, dash));
+        int last = dash == std::string::npos ? first
+                                             : std::stoi(entry.substr(dash + 1));
+        for(int i = first; i <= last; ++i)
+          result.push_back(i);
+      } catch(...) {}
+    }
+    pos = next + 1;
+  }
+  return result;
+}
+
+bool make_node_mask(int node, cpu_set_t& mask) {
+  CPU_ZERO(&mask);
+  bool has_cpus = false;
+  for(const auto& c : get_topology()) {
+    if(c.numa_node == node) {
+      CPU_SET(c.cpu, &mask);
+      has_cpus = true;
+    }
+  }
+  return has_cpus;
+}
+#endif
+
+std::vector<cpu_info> determine_topology() {
+  std::vector<cpu_info> result;
+#ifdef __linux__
+  cpu_set_t process_mask;
+  CPU_ZERO(&process_mask);
+  if(sched_getaffinity(0, sizeof(process_mask), &process_mask) != 0)
+    return {};
+
+  int num_nodes_with_cpus = 0;
+  for(int node = 0;; ++node) {
+    std::ifstream file{"/sys/devices/system/node/node" + std::to_string(node) +
+                       "/cpulist"};
+    if(!file.is_open())
+      break;
+    std::string list;
+    std::getline(file, list);
+
+    bool has_cpus = false;
+    for(int cpu : parse_cpu_list(list)) {
+      if(cpu < CPU_SETSIZE && CPU_ISSET(cpu, &process_mask)) {
+        result.push_back(cpu_info{cpu, node});
+        has_cpus = true;
+      }
+    }
+    if(has_cpus)
+      ++num_nodes_with_cpus;
+  }
+
+  if(num_nodes_with_cpus < 2)
+    return {};
+#endif
+  return result;
+}
+
+}
+
+const std::vector<cpu_info>& get_topology() {
+  static const std::vector<cpu_info> topology = determine_topology();
+  return topology;
+}
+
+std::vector<int> get_nodes() {
+  std::vector<int> nodes;
+  for(const auto& c : get_topology())
+    if(nodes.empty() || nodes.back() != c.numa_node)
+      nodes.push_back(c.numa_node);
+  return nodes;
+}
+
+std::size_t get_num_cpus(int node) {
+  const auto& topology = get_topology();
+  return std::count_if(topology.begin(), topology.end(),
+                       [node](const cpu_info &c) { return c.numa_node == node; });
+}
+
+bool bind_thread(std::thread &t, int node) {
+#ifdef __linux__
+  cpu_set_t mask;
+  if(make_node_mask(node, mask) &&
+     pthread_setaffinity_np(t.native_handle(), sizeof(mask), &mask) == 0)
+    return true;
+  HIPSYCL_DEBUG_WARNING << "numa: Could not bind thread to NUMA node " << node
+                        << std::endl;
+#endif
+  return false;
+}
+
+bool bind_current_thread(int node) {
+#ifdef __linux__
+  cpu_set_t mask;
+  if(make_node_mask(node, mask) &&
+     pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) == 0)
+    return true;
+  HIPSYCL_DEBUG_WARNING << "numa: Could not bind thread to NUMA node " << node
+                        << std::endl;
+#endif
+  return false;
+}
+
+bool interleave_memory(void *ptr, std::size_t num_bytes,
+                       const std::vector<int> &nodes) {
+#if defined(__linux__) && defined(SYS_mbind)
+  constexpr std::size_t bits_per_word = sizeof(unsigned long) * CHAR_BIT;
+  int max_node = 0;
+  for(int node : nodes)
+    max_node = std::max(max_node, node);
+
+  std::vector<unsigned long> node_mask(max_node / bits_per_word + 1, 0);
+  for(int node : nodes)
+    node_mask[node / bits_per_word] |= 1ul << (node % bits_per_word);
+
+  // The kernel expects the mask size in bits plus one
+  if(syscall(SYS_mbind, ptr, num_bytes, mpol_interleave, node_mask.data(),
+             node_mask.size() * bits_per_word + 1, 0) == 0)
+    return true;
+  HIPSYCL_DEBUG_WARNING << "numa: Could not set interleaved memory policy"
+                        << std::endl;
+#endif
+  return false;
+}
+
+std::size_t get_page_size() {
+#ifndef _WIN32
+  return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#else
+  SYSTEM_INFO si;
+  GetSystemInfo(&si);
+  return si.dwPageSize;
+#endif
+}
+
+}
+}
+}
@@ -0,0 +1,170 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+#include "hipSYCL/runtime/generic/object_pool.hpp"
+#include "hipSYCL/common/intrusive_free_list.hpp"
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <new>
+
+namespace hipsycl {
+namespace rt {
+
+namespace {
+
+constexpr std::size_t num_size_classes =
+    object_pool::max_object_size / object_pool::alignment;
+constexpr std::size_t slab_size = 64 * 1024;
+// Number of free objects per size class that a thread retains
+constexpr std::size_t max_cached_objects = 256;
+// Number of objects that are moved between thread and global free lists
+// at once
+constexpr std::size_t transfer_batch_size = 64;
+
+using free_list = common::intrusive_free_list;
+
+class global_free_lists {
+public:
+  // Intentionally never destroyed, since objects may still be
+  // freed during static destruction.
+  static global_free_lists& get() {
+    static global_free_lists* lists = new global_free_lists{};
+    return *lists;
+  }
+
+  void put(std::size_t size_class, free_list& objects) {
+    size_class_data& data = _size_classes[size_class];
+    std::lock_guard<std::mutex> lock{data.mutex};
+    data.objects.splice(objects);
+  }
+
+  free_list take(std::size_t size_class, std::size_t n) {
+    size_class_data& data = _size_classes[size_class];
+    std::lock_guard<std::mutex> lock{data.mutex};
+    return data.objects.split(n);
+  }
+private:
+  struct alignas(64) size_class_data {
+    std::mutex mutex;
+    free_list objects;
+  };
+
+  std::array<size_class_data, num_size_classes> _size_classes;
+};
+
+std::size_t get_object_size(std::size_t size_class) {
+  return (size_class + 1) * object_pool::alignment;
+}
+
+free_list allocate_slab(std::size_t size_class) {
+  const std::size_t object_size = get_object_size(size_class);
+  char *slab = static_cast<char *>(
+      ::operator new(slab_size, std::align_val_t{object_pool::alignment}));
+
+  free_list result;
+  for(std::size_t offset = 0; offset + object_size <= slab_size;
+      offset += object_size)
+    result.push(slab + offset);
+  return result;
+}
+
+class thread_cache;
+// Trivially destructible, so they can still be queried after the
+// thread cache of an exiting thread has been destroyed.
+thread_local thread_cache* current_thread_cache = nullptr;
+thread_local bool is_thread_cache_destroyed = false;
+
+class thread_cache {
+public:
+  ~thread_cache() {
+    current_thread_cache = nullptr;
+    is_thread_cache_destroyed = true;
+    for(std::size_t i = 0; i < num_size_classes; ++i)
+      global_free_lists::get().put(i, _lists[i]);
+  }
+
+  void* allocate(std::size_t size_class) {
+    free_list& list = _lists[size_class];
+    if(list.empty()) {
+      free_list refill =
+          global_free_lists::get().take(size_class, transfer_batch_size);
+      if(refill.empty())
+        refill = allocate_slab(size_class);
+      list.splice(refill);
+    }
+    return list.pop();
+  }
+
+  void deallocate(void* ptr, std::size_t size_class) {
+    free_list& list = _lists[size_class];
+    list.push(ptr);
+    if(list.size() > max_cached_objects) {
+      free_list batch = list.split(transfer_batch_size);
+      global_free_lists::get().put(size_class, batch);
+    }
+  }
+private:
+  std::array<free_list, num_size_classes> _lists;
+};
+
+thread_cache* get_thread_cache() {
+  if(current_thread_cache)
+    return current_thread_cache;
+  if(is_thread_cache_destroyed)
+    return nullptr;
+  static thread_local thread_cache cache;
+  current_thread_cache = &cache;
+  return current_thread_cache;
+}
+
+std::size_t get_size_class(std::size_t size) {
+  return (std::max(size, std::size_t{1}) - 1) / object_pool::alignment;
+}
+
+}
+
+void *object_pool::allocate(std::size_t size) {
+  if(size > max_object_size)
+    return ::operator new(size, std::align_val_t{alignment});
+
+  std::size_t size_class = get_size_class(size);
+  if(thread_cache* cache = get_thread_cache())
+    return cache->allocate(size_class);
+
+  free_list objects = global_free_lists::get().take(size_class, 1);
+  if(objects.empty())
+    objects = allocate_slab(size_class);
+  void* result = objects.pop();
+  global_free_lists::get().put(size_class, objects);
+  return result;
+}
+
+void object_pool::deallocate(void *ptr, std::size_t size) noexcept {
+  if(!ptr)
+    return;
+  if(size > max_object_size) {
+    ::operator delete(ptr, std::align_val_t{alignment});
+    return;
+  }
+
+  std::size_t size_class = get_size_class(size);
+  if(thread_cache* cache = get_thread_cache()) {
+    cache->deallocate(ptr, size_class);
+  } else {
+    free_list objects;
+    objects.push(ptr);
+    global_free_lists::get().put(size_class, objects);
+  }
+}
+
+}
+}
@@ -0,0 +1,331 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+#include "hipSYCL/runtime/generic/work_stealing_executor.hpp"
+#include "hipSYCL/runtime/generic/numa.hpp"
+#include "hipSYCL/common/spin_lock.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace hipsycl {
+namespace rt {
+
+namespace {
+
+constexpr int worker_spin_iterations = 4096;
+constexpr int caller_spin_iterations = 4096;
+// With automatic grain size, each thread's initial range is split
+// into this many chunks.
+constexpr std::size_t chunks_per_thread = 16;
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+// Orders the other slots by preference to steal from: Slots on the same
+// NUMA node first, starting with the next slot to spread stealing.
+std::vector<std::size_t> make_victim_list(std::size_t own_slot,
+                                          const std::vector<int> &slot_nodes) {
+  std::size_t num_slots = slot_nodes.size();
+  std::vector<std::size_t> same_node;
+  std::vector<std::size_t> other_nodes;
+  for(std::size_t i = 1; i < num_slots; ++i) {
+    std::size_t victim = (own_slot + i) % num_slots;
+    if(slot_nodes[own_slot] >= 0 && slot_nodes[victim] == slot_nodes[own_slot])
+      same_node.push_back(victim);
+    else
+      other_nodes.push_back(victim);
+  }
+  same_node.insert(same_node.end(), other_nodes.begin(), other_nodes.end());
+  return same_node;
+}
+
+}
+
+struct work_stealing_executor::job {
+  struct alignas(64) range_slot {
+    common::spin_lock lock;
+    std::size_t begin = 0;
+    std::size_t end = 0;
+  };
+
+  // The items are distributed evenly among the owner slots,
+  // all other slots start out empty.
+  job(std::size_t num_items, std::size_t num_slots,
+      const std::vector<std::size_t> &owner_slots, std::size_t grain,
+      int numa_node, bool allow_stealing, chunk_function f, void *ctx)
+      : invoke{f}, ctx{ctx}, grain_size{grain}, numa_node{numa_node},
+        allow_stealing{allow_stealing}, slots{new range_slot[num_slots]},
+        num_slots{num_slots}, remaining_items{num_items},
+        is_caller_parked{false} {
+    std::size_t num_owners = owner_slots.size();
+    for(std::size_t i = 0; i < num_owners; ++i) {
+      slots[owner_slots[i]].begin = num_items * i / num_owners;
+      slots[owner_slots[i]].end = num_items * (i + 1) / num_owners;
+    }
+  }
+
+  bool take_chunk(std::size_t slot, std::size_t& begin, std::size_t& end) {
+    range_slot& s = slots[slot];
+    common::spin_lock_guard lock{s.lock};
+    if(s.begin == s.end)
+      return false;
+    begin = s.begin;
+    end = std::min(s.begin + grain_size, s.end);
+    s.begin = end;
+    return true;
+  }
+
+  // Moves the back half of the victim's range into the slot, which
+  // must be empty.
+  bool steal(std::size_t victim, std::size_t slot) {
+    std::size_t begin, end;
+    {
+      range_slot& v = slots[victim];
+      common::spin_lock_guard lock{v.lock};
+      std::size_t n = v.end - v.begin;
+      if(n == 0)
+        return false;
+      begin = n <= grain_size ? v.begin : v.begin + n / 2;
+      end = v.end;
+      v.end = begin;
+    }
+    range_slot& s = slots[slot];
+    common::spin_lock_guard lock{s.lock};
+    s.begin = begin;
+    s.end = end;
+    return true;
+  }
+
+  void complete_items(std::size_t n) {
+    if(remaining_items.fetch_sub(n, std::memory_order_seq_cst) == n) {
+      if(is_caller_parked.load(std::memory_order_seq_cst)) {
+        std::lock_guard<std::mutex> lock{completion_mutex};
+        completion_cv.notify_one();
+      }
+    }
+  }
+
+  bool is_complete() const {
+    return remaining_items.load(std::memory_order_seq_cst) == 0;
+  }
+
+  chunk_function invoke;
+  void* ctx;
+  std::size_t grain_size;
+  // Only pool threads on this NUMA node participate, unless it is -1
+  int numa_node;
+  bool allow_stealing;
+  std::unique_ptr<range_slot[]> slots;
+  std::size_t num_slots;
+
+  std::atomic<std::size_t> remaining_items;
+  std::atomic<bool> is_caller_parked;
+  std::mutex completion_mutex;
+  std::condition_variable completion_cv;
+};
+
+work_stealing_executor::work_stealing_executor(std::size_t num_threads)
+    : _job_generation{0}, _num_parked_workers{0}, _is_shutting_down{false} {
+  std::size_t num_workers = std::max(num_threads, std::size_t{1}) - 1;
+
+  const std::vector<numa::cpu_info>& topology = numa::get_topology();
+
+  // The calling thread occupies the last slot, and its NUMA node is unknown.
+  std::vector<int> slot_nodes(num_workers + 1, -1);
+  if(!topology.empty()) {
+    for(std::size_t i = 0; i < num_workers; ++i)
+      slot_nodes[i] = topology[i % topology.size()].numa_node;
+  }
+
+  _workers.resize(num_workers);
+  for(std::size_t i = 0; i < num_workers; ++i) {
+    _workers[i].numa_node = slot_nodes[i];
+    _workers[i].victims = make_victim_list(i, slot_nodes);
+  }
+  _caller_victims = make_victim_list(num_workers, slot_nodes);
+
+  for(std::size_t i = 0; i < num_workers; ++i) {
+    _workers[i].thread = std::thread{[this, i]() { work(i); }};
+    if(_workers[i].numa_node >= 0)
+      numa::bind_thread(_workers[i].thread, _workers[i].numa_node);
+  }
+}
+
+work_stealing_executor::~work_stealing_executor() {
+  {
+    std::lock_guard<std::mutex> lock{_mutex};
+    _is_shutting_down = true;
+  }
+  _worker_wakeup.notify_all();
+  for(auto& w : _workers)
+    if(w.thread.joinable())
+      w.thread.join();
+}
+
+bool work_stealing_executor::participate(
+    job &j, std::size_t slot, const std::vector<std::size_t> &victims,
+    const std::size_t *observed_generation) {
+  auto has_new_jobs = [&]() {
+    return observed_generation &&
+           _job_generation.load(std::memory_order_relaxed) !=
+               *observed_generation;
+  };
+
+  bool has_processed_work = false;
+  for(;;) {
+    std::size_t begin, end;
+    while(j.take_chunk(slot, begin, end)) {
+      j.invoke(j.ctx, begin, end);
+      j.complete_items(end - begin);
+      has_processed_work = true;
+      // Remaining items in our slot can still be stolen by the other
+      // participants, and we return to this job after repartitioning.
+      if(has_new_jobs())
+        return true;
+    }
+    if(!j.allow_stealing)
+      return has_processed_work;
+
+    bool has_stolen = false;
+    for(std::size_t victim : victims) {
+      if(j.steal(victim, slot)) {
+        has_stolen = true;
+        break;
+      }
+    }
+    if(!has_stolen)
+      return has_processed_work;
+  }
+}
+
+void work_stealing_executor::run(std::size_t num_items, std::size_t grain_size,
+                                 int numa_node, bool allow_stealing,
+                                 chunk_function f, void *ctx) {
+  if(num_items == 0)
+    return;
+
+  std::size_t num_slots = _workers.size() + 1;
+  // The calling thread always owns the last slot
+  std::vector<std::size_t> owner_slots;
+  for(std::size_t i = 0; i < _workers.size(); ++i)
+    if(numa_node < 0 || _workers[i].numa_node == numa_node)
+      owner_slots.push_back(i);
+  if(owner_slots.empty()) {
+    numa_node = -1;
+    for(std::size_t i = 0; i < _workers.size(); ++i)
+      owner_slots.push_back(i);
+  }
+  owner_slots.push_back(num_slots - 1);
+
+  if(grain_size == 0)
+    grain_size = std::max(std::size_t{1},
+                          num_items / (owner_slots.size() * chunks_per_thread));
+
+  // Nothing to distribute
+  if(owner_slots.size() == 1 || (allow_stealing && num_items <= grain_size)) {
+    for(std::size_t begin = 0; begin < num_items; begin += grain_size)
+      f(ctx, begin, std::min(begin + grain_size, num_items));
+    return;
+  }
+
+  auto j = std::make_shared<job>(num_items, num_slots, owner_slots, grain_size,
+                                 numa_node, allow_stealing, f, ctx);
+  {
+    std::lock_guard<std::mutex> lock{_mutex};
+    _active_jobs.push_back(j);
+    _job_generation.fetch_add(1, std::memory_order_seq_cst);
+    if(_num_parked_workers.load(std::memory_order_seq_cst) > 0)
+      _worker_wakeup.notify_all();
+  }
+
+  participate(*j, num_slots - 1, _caller_victims);
+
+  // The remaining chunks are being processed by other threads
+  for(int i = 0; i < caller_spin_iterations && !j->is_complete(); ++i)
+    cpu_relax();
+  if(!j->is_complete()) {
+    j->is_caller_parked.store(true, std::memory_order_seq_cst);
+    std::unique_lock<std::mutex> lock{j->completion_mutex};
+    j->completion_cv.wait(lock, [&]() { return j->is_complete(); });
+  }
+
+  std::lock_guard<std::mutex> lock{_mutex};
+  _active_jobs.erase(std::find(_active_jobs.begin(), _active_jobs.end(), j));
+}
+
+void work_stealing_executor::work(std::size_t worker_index) {
+  const worker& self = _workers[worker_index];
+  std::vector<std::shared_ptr<job>> jobs;
+
+  for(;;) {
+    std::size_t generation = _job_generation.load(std::memory_order_seq_cst);
+    {
+      std::lock_guard<std::mutex> lock{_mutex};
+      if(_is_shutting_down)
+        return;
+      jobs = _active_jobs;
+    }
+
+    // Partition the workers into contiguous blocks among the concurrently
+    // active jobs. Since workers are ordered by NUMA node, this keeps
+    // each job on as few NUMA nodes as possible. Once the job of its
+    // partition has run out of work, a worker helps with the other jobs.
+    // When new jobs are submitted, workers leave their current job after
+    // the current chunk to rebalance.
+    bool has_processed_work = false;
+    std::size_t partition = worker_index * jobs.size() / _workers.size();
+    for(std::size_t i = 0; i < jobs.size(); ++i) {
+      job& j = *jobs[(partition + i) % jobs.size()];
+      if(j.numa_node < 0 || j.numa_node == self.numa_node)
+        has_processed_work |=
+            participate(j, worker_index, self.victims, &generation);
+    }
+    jobs.clear();
+
+    if(has_processed_work)
+      continue;
+
+    // Idle: Wait until new jobs are submitted
+    auto has_new_jobs = [&]() {
+      return _job_generation.load(std::memory_order_seq_cst) != generation;
+    };
+
+    static const bool is_spinning_enabled =
+        std::thread::hardware_concurrency() > 1;
+    bool has_spun_successfully = false;
+    if(is_spinning_enabled) {
+      for(int i = 0; i < worker_spin_iterations; ++i) {
+        if(has_new_jobs()) {
+          has_spun_successfully = true;
+          break;
+        }
+        cpu_relax();
+      }
+    }
+
+    if(!has_spun_successfully) {
+      std::unique_lock<std::mutex> lock{_mutex};
+      _num_parked_workers.fetch_add(1, std::memory_order_seq_cst);
+      _worker_wakeup.wait(lock, [&]() {
+        return has_new_jobs() || _is_shutting_down;
+      });
+      _num_parked_workers.fetch_sub(1, std::memory_order_seq_cst);
+    }
+  }
+}
+
+}
+}
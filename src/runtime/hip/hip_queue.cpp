@@ -16,6 +16,7 @@
 #include "hipSYCL/runtime/hip/hip_queue.hpp"
 #include "hipSYCL/runtime/hip/hip_backend.hpp"
 #include "hipSYCL/runtime/error.hpp"
+#include "hipSYCL/runtime/generic/object_pool.hpp"
 #include "hipSYCL/runtime/hip/hip_event.hpp"
 #include "hipSYCL/runtime/hip/hip_device_manager.hpp"
 #include "hipSYCL/runtime/hip/hip_target.hpp"
@@ -74,7 +75,7 @@ public:
 
       op.get_instrumentations()
           .add_instrumentation<instrumentations::submission_timestamp>(
-            std::make_shared<hip_submission_timestamp>(profiler_clock::now()));
+            make_pooled_shared<hip_submission_timestamp>(profiler_clock::now()));
     }
 
     if (_node->get_execution_hints().has_hint<
@@ -84,7 +85,7 @@ public:
 
       op.get_instrumentations()
           .add_instrumentation<instrumentations::execution_start_timestamp>(
-              std::make_shared<hip_execution_start_timestamp>(
+              make_pooled_shared<hip_execution_start_timestamp>(
                   _queue->get_timing_reference(), _task_start));
     }
   }
@@ -100,12 +101,12 @@ public:
       if(_task_start) {
         _operation->get_instrumentations()
             .add_instrumentation<instrumentations::execution_finish_timestamp>(
-                std::make_shared<hip_execution_finish_timestamp>(
+                make_pooled_shared<hip_execution_finish_timestamp>(
                     _queue->get_timing_reference(), _task_start, task_finish));
       } else {
         _operation->get_instrumentations()
             .add_instrumentation<instrumentations::execution_finish_timestamp>(
-                std::make_shared<hip_execution_finish_timestamp>(
+                make_pooled_shared<hip_execution_finish_timestamp>(
                     _queue->get_timing_reference(), task_finish));
       }
     }
@@ -216,12 +217,12 @@ std::shared_ptr<dag_node_event> hip_queue::insert_event() {
     return nullptr;
   }
 
-  return std::make_shared<hip_node_event>(_dev, std::move(evt),
+  return make_pooled_shared<hip_node_event>(_dev, std::move(evt),
                                           _backend->get_event_pool(_dev));
 }
 
 std::shared_ptr<dag_node_event> hip_queue::create_queue_completion_event() {
-  return std::make_shared<queue_completion_event<hipEvent_t, hip_node_event>>(
+  return make_pooled_shared<queue_completion_event<hipEvent_t, hip_node_event>>(
       this);
 }
 
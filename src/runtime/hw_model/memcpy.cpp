@@ -9,33 +9,102 @@
  */
 // SPDX-License-Identifier: BSD-2-Clause
 #include "hipSYCL/runtime/hw_model/memcpy.hpp"
+#include "hipSYCL/runtime/allocator.hpp"
+#include "hipSYCL/runtime/application.hpp"
+#include "hipSYCL/runtime/backend.hpp"
+#include "hipSYCL/runtime/generic/async_worker.hpp"
+#include "hipSYCL/runtime/hardware.hpp"
+#include "hipSYCL/runtime/inorder_executor.hpp"
+#include "hipSYCL/runtime/inorder_queue.hpp"
+#include "hipSYCL/runtime/settings.hpp"
+#include "hipSYCL/common/debug.hpp"
+#include "hipSYCL/common/filesystem.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
 #include <limits>
+#include <sstream>
 
 
 namespace hipsycl {
 namespace rt {
 
+namespace {
+
+constexpr const char* persistent_table_filename = "memcpy_model.v2.txt";
+
+std::string get_persistent_table_path() {
+  return common::filesystem::join_path(
+      common::filesystem::persistent_storage::get().get_base_dir(),
+      persistent_table_filename);
+}
+
+std::string make_link_key(const std::string &source_key,
+                          const std::string &dest_key) {
+  return source_key + "\t" + dest_key;
+}
+
+// File format: One line per link, with tab-separated
+// source key, dest key, latency and bandwidth.
+void read_persistent_table(
+    const std::string &path,
+    std::unordered_map<std::string, memcpy_link_parameters> &out) {
+  std::ifstream file{path};
+  std::string line;
+  while(std::getline(file, line)) {
+    std::size_t first_tab = line.find('\t');
+    if(first_tab == std::string::npos)
+      continue;
+    std::size_t second_tab = line.find('\t', first_tab + 1);
+    if(second_tab == std::string::npos)
+      continue;
+
+    memcpy_link_parameters params;
+    std::istringstream values{line.substr(second_tab + 1)};
+    if((values >> params.latency >> params.bandwidth) &&
+       params.latency >= 0.0 && params.bandwidth > 0.0)
+      out[line.substr(0, second_tab)] = params;
+  }
+}
+
+}
+
+memcpy_model::memcpy_model(backend_manager* mgr)
+: _backends{mgr} {}
+
+memcpy_model::~memcpy_model() {
+  std::unique_ptr<worker_thread> worker;
+  {
+    std::lock_guard<std::mutex> lock{_mutex};
+    worker = std::move(_calibration_worker);
+  }
+  // Calibrations need to acquire _mutex, so we must not hold it
+  // while waiting for them to finish.
+  if(worker)
+    worker->halt();
+}
 
 cost_type
 memcpy_model::estimate_runtime_cost(const memory_location &source,
                                     const memory_location &dest,
                                     range<3> num_elements) const
 {
-  // Strongly prefer transfers from the same device to the same device
-  if(source.get_device() == dest.get_device())
-    return 1.0;
-
-  if (source.get_device().get_full_backend_descriptor().hw_platform ==
-      dest.get_device().get_full_backend_descriptor().hw_platform)
-    return 2.0;
+  std::size_t num_bytes = num_elements.size() * source.get_element_size();
 
-  return 3.0;
+  std::lock_guard<std::mutex> lock{_mutex};
+  return lookup_or_schedule_calibration(source.get_device(), dest.get_device())
+      .estimate_runtime(num_bytes);
 }
 
 memory_location memcpy_model::choose_source(
     const std::vector<memory_location> &candidate_sources,
-    const memory_location &target, range<3> num_elements) const 
+    const memory_location &target, range<3> num_elements) const
 {
+  // Avoid calibrating links if there is no choice anyway
+  if(candidate_sources.size() == 1)
+    return candidate_sources[0];
+
   std::size_t best_transfer_index = 0;
   cost_type best_cost = std::numeric_limits<cost_type>::max();
 
@@ -50,5 +119,292 @@ memory_location memcpy_model::choose_source(
   return candidate_sources[best_transfer_index];
 }
 
+std::vector<memcpy_model::source_share> memcpy_model::split_sources(
+    const std::vector<memory_location> &candidate_sources,
+    const memory_location &target, range<3> num_elements) const {
+
+  if(candidate_sources.size() <= 1)
+    return {source_share{candidate_sources.at(0), 1.0}};
+
+  std::size_t num_bytes =
+      num_elements.size() * candidate_sources[0].get_element_size();
+
+  std::vector<std::pair<memcpy_link_parameters, std::size_t>> links;
+  {
+    std::lock_guard<std::mutex> lock{_mutex};
+    for(std::size_t i = 0; i < candidate_sources.size(); ++i)
+      links.push_back(std::make_pair(
+          lookup_or_schedule_calibration(candidate_sources[i].get_device(),
+                                         target.get_device()),
+          i));
+  }
+  std::stable_sort(links.begin(), links.end(), [&](const auto& a, const auto& b){
+    return a.first.estimate_runtime(num_bytes) <
+           b.first.estimate_runtime(num_bytes);
+  });
+
+  // When splitting across the k best sources proportionally to their
+  // bandwidth, all parts finish after roughly the largest latency plus the
+  // time to transfer the data at the accumulated bandwidth.
+  std::size_t best_num_sources = 1;
+  cost_type best_cost = links[0].first.estimate_runtime(num_bytes);
+  double max_latency = 0.0;
+  double accumulated_bandwidth = 0.0;
+  for(std::size_t k = 0; k < links.size(); ++k) {
+    max_latency = std::max(max_latency, links[k].first.latency);
+    accumulated_bandwidth += links[k].first.bandwidth;
+    cost_type cost =
+        max_latency + static_cast<double>(num_bytes) / accumulated_bandwidth;
+    if(cost < best_cost) {
+      best_cost = cost;
+      best_num_sources = k + 1;
+    }
+  }
+
+  double total_bandwidth = 0.0;
+  for(std::size_t k = 0; k < best_num_sources; ++k)
+    total_bandwidth += links[k].first.bandwidth;
+
+  std::vector<source_share> result;
+  for(std::size_t k = 0; k < best_num_sources; ++k)
+    result.push_back(source_share{candidate_sources[links[k].second],
+                                  links[k].first.bandwidth / total_bandwidth});
+  return result;
+}
+
+void memcpy_model::set_link_parameters(device_id source, device_id dest,
+                                       const memcpy_link_parameters &params) {
+  std::lock_guard<std::mutex> lock{_mutex};
+  _links[std::make_pair(source, dest)] = params;
+}
+
+memcpy_link_parameters memcpy_model::get_link_parameters(device_id source,
+                                                         device_id dest) const {
+  std::lock_guard<std::mutex> lock{_mutex};
+  return lookup_or_schedule_calibration(source, dest);
+}
+
+memcpy_link_parameters
+memcpy_model::lookup_or_schedule_calibration(device_id source,
+                                             device_id dest) const {
+  auto link = std::make_pair(source, dest);
+  auto it = _links.find(link);
+  if(it != _links.end())
+    return it->second;
+
+  auto failed_it = _failed_calibrations.find(link);
+  if(failed_it != _failed_calibrations.end())
+    return failed_it->second;
+
+  load_persistent_table();
+  auto persistent_it = _persistent_table.find(
+      make_link_key(get_device_key(source), get_device_key(dest)));
+  if(persistent_it != _persistent_table.end()) {
+    _links[link] = persistent_it->second;
+    return persistent_it->second;
+  }
+
+  if(_backends &&
+     application::get_settings().get<setting::memcpy_calibration>()) {
+    // The benchmark takes a while and would stall the submission of the
+    // operation that queried the model. Measure in the background instead,
+    // and use the built-in estimate until the result is available.
+    if(_pending_calibrations.insert(link).second) {
+      if(!_calibration_worker)
+        _calibration_worker = std::make_unique<worker_thread>();
+      (*_calibration_worker)(
+          [this, source, dest]() { run_calibration(source, dest); });
+    }
+    return get_builtin_estimate(source, dest);
+  }
+
+  memcpy_link_parameters params = get_builtin_estimate(source, dest);
+  _failed_calibrations[link] = params;
+  return params;
+}
+
+void memcpy_model::run_calibration(device_id source, device_id dest) const {
+  auto link = std::make_pair(source, dest);
+
+  memcpy_link_parameters params;
+  bool success = calibrate(source, dest, params);
+
+  std::lock_guard<std::mutex> lock{_mutex};
+  _pending_calibrations.erase(link);
+  // The link might have been set explicitly in the meantime
+  if(_links.find(link) != _links.end())
+    return;
+
+  if(!success) {
+    _failed_calibrations[link] = get_builtin_estimate(source, dest);
+    return;
+  }
+
+  HIPSYCL_DEBUG_INFO << "memcpy_model: Measured latency " << params.latency
+                     << " ns and bandwidth " << params.bandwidth
+                     << " GB/s for transfers from "
+                     << get_device_key(source) << " to "
+                     << get_device_key(dest) << std::endl;
+  _links[link] = params;
+  _persistent_table[make_link_key(get_device_key(source),
+                                  get_device_key(dest))] = params;
+  store_persistent_table();
+}
+
+memcpy_link_parameters
+memcpy_model::get_builtin_estimate(device_id source, device_id dest) const {
+  // Strongly prefer transfers from the same device to the same device
+  if(source == dest)
+    return memcpy_link_parameters{1000.0, 100.0};
+
+  if (source.get_full_backend_descriptor().hw_platform ==
+      dest.get_full_backend_descriptor().hw_platform)
+    return memcpy_link_parameters{5000.0, 20.0};
+
+  return memcpy_link_parameters{10000.0, 10.0};
+}
+
+bool memcpy_model::calibrate(device_id source, device_id dest,
+                             memcpy_link_parameters &out) const {
+  constexpr std::size_t small_transfer_size = 4096;
+  constexpr std::size_t large_transfer_size = 16 * 1024 * 1024;
+  constexpr int num_repetitions = 3;
+
+  if(!_backends)
+    return false;
+
+  backend* source_backend = _backends->get(source.get_backend());
+  backend* dest_backend = _backends->get(dest.get_backend());
+  if(!source_backend || !dest_backend)
+    return false;
+
+  auto make_memcpy = [&](void *source_mem, void *dest_mem,
+                         std::size_t num_bytes) {
+    range<3> shape{1, 1, num_bytes};
+    return memcpy_operation{
+        memory_location{source, source_mem, id<3>{0, 0, 0}, shape, 1},
+        memory_location{dest, dest_mem, id<3>{0, 0, 0}, shape, 1}, shape};
+  };
+
+  // Set up the queue first - not all backends support creating them
+  backend_id executor_backend = dest.get_backend();
+  device_id executor_device = dest;
+  make_memcpy(nullptr, nullptr, 1)
+      .has_preferred_backend(executor_backend, executor_device);
+
+  std::unique_ptr<backend_executor> executor =
+      _backends->get(executor_backend)
+          ->create_inorder_executor(executor_device, 0);
+  auto* inorder = dynamic_cast<inorder_executor*>(executor.get());
+  if(!inorder)
+    return false;
+
+  backend_allocator* source_allocator = source_backend->get_allocator(source);
+  backend_allocator* dest_allocator = dest_backend->get_allocator(dest);
+
+  void* source_mem =
+      allocate_device(source_allocator, 256, large_transfer_size);
+  if(!source_mem)
+    return false;
+  void* dest_mem = allocate_device(dest_allocator, 256, large_transfer_size);
+  if(!dest_mem) {
+    deallocate(source_allocator, source_mem);
+    return false;
+  }
+
+  bool success = false;
+  memcpy_operation small_transfer =
+      make_memcpy(source_mem, dest_mem, small_transfer_size);
+  memcpy_operation large_transfer =
+      make_memcpy(source_mem, dest_mem, large_transfer_size);
+
+  inorder_queue* q = inorder->get_queue();
+
+  // Returns the minimum runtime in ns, or a negative value on error
+  auto measure = [&](memcpy_operation& op) -> double {
+    double min_time = std::numeric_limits<double>::max();
+    // The first repetition is a warmup run
+    for(int i = 0; i <= num_repetitions; ++i) {
+      auto start = std::chrono::steady_clock::now();
+      if(!q->submit_memcpy(op, nullptr).is_success() ||
+         !q->wait().is_success())
+        return -1.0;
+      auto end = std::chrono::steady_clock::now();
+      if(i > 0)
+        min_time = std::min(
+            min_time,
+            std::chrono::duration<double, std::nano>(end - start).count());
+    }
+    return min_time;
+  };
+
+  double small_time = measure(small_transfer);
+  double large_time = measure(large_transfer);
+
+  if(small_time >= 0.0 && large_time > small_time) {
+    out.bandwidth = static_cast<double>(large_transfer_size -
+                                        small_transfer_size) /
+                    (large_time - small_time);
+    out.latency = std::max(
+        0.0, small_time - static_cast<double>(small_transfer_size) /
+                              out.bandwidth);
+    success = true;
+  }
+
+  deallocate(source_allocator, source_mem);
+  deallocate(dest_allocator, dest_mem);
+  return success;
+}
+
+std::string memcpy_model::get_device_key(device_id dev) const {
+  std::string name;
+  if(_backends) {
+    if(backend* b = _backends->get(dev.get_backend())) {
+      name = b->get_name() + ":" + std::to_string(dev.get_id());
+      backend_hardware_manager* hw = b->get_hardware_manager();
+      // Measurements are only valid for the same hardware and driver
+      if(dev.get_id() >= 0 &&
+         static_cast<std::size_t>(dev.get_id()) < hw->get_num_devices()) {
+        hardware_context* ctx = hw->get_device(dev.get_id());
+        name += ":" + ctx->get_device_name() + ":" + ctx->get_driver_version();
+      }
+    }
+  }
+  if(name.empty())
+    name = "backend" + std::to_string(static_cast<int>(dev.get_backend())) +
+           ":" + std::to_string(dev.get_id());
+  // Tabs separate the fields in the persistent table
+  std::replace(name.begin(), name.end(), '\t', ' ');
+  return name;
+}
+
+void memcpy_model::load_persistent_table() const {
+  if(_is_persistent_table_loaded)
+    return;
+  _is_persistent_table_loaded = true;
+  read_persistent_table(get_persistent_table_path(), _persistent_table);
+}
+
+void memcpy_model::store_persistent_table() const {
+  std::string path = get_persistent_table_path();
+  // Merge with entries that other processes might have
+  // measured in the meantime
+  common::filesystem::file_lock lock{path + ".lock", true};
+
+  std::unordered_map<std::string, memcpy_link_parameters> table;
+  read_persistent_table(path, table);
+  for(const auto& entry : _persistent_table)
+    table[entry.first] = entry.second;
+
+  std::ostringstream content;
+  for(const auto& entry : table)
+    content << entry.first << "\t" << entry.second.latency << "\t"
+            << entry.second.bandwidth << "\n";
+
+  if(!common::filesystem::atomic_write(path, content.str()))
+    HIPSYCL_DEBUG_WARNING << "memcpy_model: Could not write " << path
+                          << std::endl;
+}
+
 }
 }
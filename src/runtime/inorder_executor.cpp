@@ -14,6 +14,7 @@
 #include "hipSYCL/runtime/inorder_queue.hpp"
 #include "hipSYCL/runtime/operations.hpp"
 #include "hipSYCL/runtime/serialization/serialization.hpp"
+#include "hipSYCL/runtime/tracing.hpp"
 
 namespace hipsycl {
 namespace rt {
@@ -100,6 +101,7 @@ void inorder_executor::submit_directly(const dag_node_ptr& node, operation *op,
   if (node->is_submitted())
     return;
 
+  tracing::scope trace{"dispatch", tracing::category::execution, node.get()};
   node->assign_to_execution_lane(_q.get());
 
   node->assign_execution_index(++_num_submitted_operations);
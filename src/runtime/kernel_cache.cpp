@@ -47,8 +47,7 @@ void for_each_exported_symbol_list(const common::hcf_container& hcf, F&& handler
 }
 
 extern "C" void __acpp_register_hcf(const char* hcf, std::size_t size) {
-  std::string hcf_data{hcf, size};
-  hcf_cache::get().register_hcf_object(common::hcf_container{hcf_data});
+  hcf_cache::get().register_hcf_data(std::string_view{hcf, size});
 }
 
 extern "C" void __acpp_unregister_hcf(std::size_t hcf_object_id) {
@@ -263,94 +262,42 @@ hcf_object_id hcf_cache::register_hcf_object(const common::hcf_container &obj) {
   hcf_object_id id = std::stoull(*data);
   HIPSYCL_DEBUG_INFO << "hcf_cache: Registering HCF object " << id << "..." << std::endl;
 
-  if (_hcf_objects.count(id) > 0) {
-    HIPSYCL_DEBUG_ERROR
-        << "hcf_cache: Detected hcf object id collision " << id
-        << ", this should not happen. Some kernels might be unavailable."
-        << std::endl;
-  } else {
-    common::hcf_container* stored_obj = new common::hcf_container{obj};
-    _hcf_objects[id] = std::unique_ptr<common::hcf_container>{stored_obj};
-    // Check if the HCF exports some symbols
-    for_each_exported_symbol_list(
-        // Don't use obj here, since we have copied it into the cache, and need
-        // to ensure that the pointers to image nodes are stable
-        *stored_obj,
-        [&](const common::hcf_container::node *image_node,
-            const std::vector<std::string> &exported_symbols) {
-
-          for (const auto &symbol : exported_symbols) {
-
-            _exported_symbol_providers[symbol].push_back(
-                device_image_id{id, image_node});
-
-            HIPSYCL_DEBUG_INFO << "hcf_cache: Symbol " << symbol
-                               << " is registered as exported by object " << id
-                               << " and image " << image_node->node_id
-                               << " @" << image_node << std::endl;
-          }
-        });
-    // See if stored object has kernel nodes that we can parse
-    if(auto* kernels_node = stored_obj->root_node()->get_subnode("kernels")) {
-      for(const auto& kernel_name : kernels_node->get_subnodes()) {
-        std::unique_ptr<hcf_kernel_info> kernel_info{
-            new hcf_kernel_info{id, kernels_node->get_subnode(kernel_name)}};
-        if(kernel_info->is_valid()) {
-          HIPSYCL_DEBUG_INFO << "hcf_cache: Registering kernel info for kernel "
-                             << kernel_name << " from HCF object " << id
-                             << std::endl;
-          HIPSYCL_DEBUG_INFO << "  kernel_info: hcf object id = "
-                             << kernel_info->get_hcf_object_id() << std::endl;
-          for(int i = 0; i < kernel_info->get_num_parameters(); ++i) {
-            HIPSYCL_DEBUG_INFO
-                << "  kernel_info: parameter " << i
-                << ": offset = " << kernel_info->get_argument_offset(i)
-                << " size = " << kernel_info->get_argument_size(i)
-                << " original index = "
-                << kernel_info->get_original_argument_index(i) << std::endl;
-          }
-          _hcf_kernel_info[generate_info_id(id, kernel_name)] =
-              std::move(kernel_info);
-        }
-      }
-    }
-    // Same for image nodes
-    if(auto* images_node = stored_obj->root_node()->get_subnode("images")) {
-      for(const auto& image_name : images_node->get_subnodes()) {
-        std::unique_ptr<hcf_image_info> image_info{new hcf_image_info{
-            stored_obj, images_node->get_subnode(image_name)}};
-        
-        if(image_info->is_valid()) {
-          HIPSYCL_DEBUG_INFO << "hcf_cache: Registering image info for image "
-                             << image_name << " from HCF object " << id
-                             << std::endl;
-          _hcf_image_info[generate_info_id(id, image_name)] =
-              std::move(image_info);
-        }
-      }
-    }
-  }
+  hcf_object stored_obj;
+  stored_obj.container = std::make_unique<common::hcf_container>(obj);
+  add_object(id, std::move(stored_obj));
+  dump_hcf(id, obj.serialize());
 
-  std::string hcf_dump_dir =
-      application::get_settings().get<setting::hcf_dump_directory>();
-  if(!hcf_dump_dir.empty()) {
-    std::string out_filename = hcf_dump_dir;
+  return id;
+}
 
-    if(out_filename.back() != '/' && out_filename.back() != '\\')
-      out_filename += '/';
-    
-    out_filename += "hipsycl_object_"+std::to_string(id)+".hcf";
+hcf_object_id hcf_cache::register_hcf_data(std::string_view serialized_obj) {
+  std::lock_guard<std::mutex> lock{_mutex};
 
-    std::ofstream out_file(out_filename.c_str(), std::ios::binary);
-    if(!out_file.is_open()) {
-      HIPSYCL_DEBUG_ERROR << "Could not open file " << out_filename
-                          << " for writing." << std::endl;
+  hcf_object stored_obj;
+  stored_obj.data = serialized_obj;
 
-    } else {
-      std::string hcf_data = obj.serialize();
-      out_file.write(hcf_data.c_str(), hcf_data.size());
+  hcf_object_id id;
+  if (auto object_id = common::hcf_container::peek_root_value(serialized_obj,
+                                                              "object-id")) {
+    id = std::stoull(std::string{*object_id});
+  } else {
+    // The object id is not where serialize() places it, so we need to
+    // parse the object to find it.
+    stored_obj.container = std::make_unique<common::hcf_container>(
+        serialized_obj, common::hcf_container::reference_binary_appendix);
+    const std::string *data =
+        stored_obj.container->root_node()->get_value("object-id");
+    if (!data) {
+      HIPSYCL_DEBUG_ERROR
+          << "hcf_cache: Invalid hcf object (missing object id)" << std::endl;
+      return 0;
     }
+    id = std::stoull(*data);
   }
+  HIPSYCL_DEBUG_INFO << "hcf_cache: Registering HCF object " << id << "..." << std::endl;
+
+  add_object(id, std::move(stored_obj));
+  dump_hcf(id, serialized_obj);
 
   return id;
 }
@@ -360,50 +307,83 @@ void hcf_cache::unregister_hcf_object(hcf_object_id id) {
 
   auto it = _hcf_objects.find(id);
   if(it != _hcf_objects.end()) {
-    // First remove the HCF object as a symbol provider for runtime linking and
-    // symbol resolution. This ensures that it gets no longer selected
-    // for symbol resolution.
-
-    // 1. Go through each symbol list (all device images) exported by this
-    // HCF file
-    for_each_exported_symbol_list(
-        *(it->second), [&](const common::hcf_container::node* image_node,
-                 const std::vector<std::string> &exported_symbols) {
-          // 2. Iterate over all symbols exported in this HCF
-          for (const auto &symbol : exported_symbols) {
-            // 3. Remove all references to this HCF in the symbol providers map  
-            auto& symbol_providers = _exported_symbol_providers[symbol];
-            symbol_providers.erase(
-                std::remove_if(symbol_providers.begin(), symbol_providers.end(),
-                               [&](const device_image_id &img) {
-                                 return img.hcf_id == id;
-                               }),
-                symbol_providers.end());
-          }
-        });
+    if(!it->second.container) {
+      // Unparsed objects cannot have been selected as symbol providers
+      --_num_unparsed_objects;
+    } else {
+      // First remove the HCF object as a symbol provider for runtime linking and
+      // symbol resolution. This ensures that it gets no longer selected
+      // for symbol resolution.
+
+      // 1. Go through each symbol list (all device images) exported by this
+      // HCF file
+      for_each_exported_symbol_list(
+          *(it->second.container), [&](const common::hcf_container::node* image_node,
+                   const std::vector<std::string> &exported_symbols) {
+            // 2. Iterate over all symbols exported in this HCF
+            for (const auto &symbol : exported_symbols) {
+              // 3. Remove all references to this HCF in the symbol providers map  
+              auto& symbol_providers = _exported_symbol_providers[symbol];
+              symbol_providers.erase(
+                  std::remove_if(symbol_providers.begin(), symbol_providers.end(),
+                                 [&](const device_image_id &img) {
+                                   return img.hcf_id == id;
+                                 }),
+                  symbol_providers.end());
+            }
+          });
+    }
     // Then we can remove the HCF itself.
     // Note: We don't necessarily need to remove the HCF kernel info, since
     // just maintaining this data won't have any side effects as long as 
     // the HCF object is no longer selected for execution.
-    _hcf_objects.erase(id);
+    _hcf_objects.erase(it);
   }
 }
 
 const common::hcf_container* hcf_cache::get_hcf(hcf_object_id obj) const {
   std::lock_guard<std::mutex> lock{_mutex};
 
-  auto it = _hcf_objects.find(obj);
-  if(it == _hcf_objects.end())
+  hcf_object* stored_obj = get_object(obj);
+  if(!stored_obj)
     return nullptr;
-  return it->second.get();
+  parse_object(obj, *stored_obj);
+  return stored_obj->container.get();
 }
 
 const hcf_kernel_info *
 hcf_cache::get_kernel_info(hcf_object_id obj,
                            std::string_view kernel_name) const {
   std::lock_guard<std::mutex> lock{_mutex};
-  auto it = _hcf_kernel_info.find(generate_info_id(obj, kernel_name));
-  if(it == _hcf_kernel_info.end())
+  info_id id = generate_info_id(obj, kernel_name);
+  auto it = _hcf_kernel_info.find(id);
+  if(it == _hcf_kernel_info.end()) {
+    hcf_object* stored_obj = get_object(obj);
+    if(!stored_obj)
+      return nullptr;
+    parse_object(obj, *stored_obj);
+
+    auto node = stored_obj->kernel_nodes.find(kernel_name);
+    if(node == stored_obj->kernel_nodes.end())
+      return nullptr;
+
+    auto kernel_info = std::make_unique<hcf_kernel_info>(obj, node->second);
+    if(kernel_info->is_valid()) {
+      HIPSYCL_DEBUG_INFO << "hcf_cache: Extracted kernel info for kernel "
+                         << kernel_name << " from HCF object " << obj
+                         << std::endl;
+      for(int i = 0; i < kernel_info->get_num_parameters(); ++i) {
+        HIPSYCL_DEBUG_INFO
+            << "  kernel_info: parameter " << i
+            << ": offset = " << kernel_info->get_argument_offset(i)
+            << " size = " << kernel_info->get_argument_size(i)
+            << " original index = "
+            << kernel_info->get_original_argument_index(i) << std::endl;
+      }
+    }
+    it = _hcf_kernel_info.emplace(id, std::move(kernel_info)).first;
+  }
+  if(!it->second->is_valid())
     return nullptr;
   return it->second.get();
 }
@@ -418,12 +398,123 @@ const hcf_image_info *
 hcf_cache::get_image_info(hcf_object_id obj,
                           const std::string &image_name) const {
   std::lock_guard<std::mutex> lock{_mutex};
-  auto it = _hcf_image_info.find(generate_info_id(obj, image_name));
-  if(it == _hcf_image_info.end())
+  info_id id = generate_info_id(obj, image_name);
+  auto it = _hcf_image_info.find(id);
+  if(it == _hcf_image_info.end()) {
+    hcf_object* stored_obj = get_object(obj);
+    if(!stored_obj)
+      return nullptr;
+    parse_object(obj, *stored_obj);
+
+    auto node = stored_obj->image_nodes.find(image_name);
+    if(node == stored_obj->image_nodes.end())
+      return nullptr;
+
+    auto image_info = std::make_unique<hcf_image_info>(
+        stored_obj->container.get(), node->second);
+    if(image_info->is_valid())
+      HIPSYCL_DEBUG_INFO << "hcf_cache: Extracted image info for image "
+                         << image_name << " from HCF object " << obj
+                         << std::endl;
+    it = _hcf_image_info.emplace(id, std::move(image_info)).first;
+  }
+  if(!it->second->is_valid())
     return nullptr;
   return it->second.get();
 }
 
+hcf_cache::hcf_object* hcf_cache::get_object(hcf_object_id id) const {
+  auto it = _hcf_objects.find(id);
+  if(it == _hcf_objects.end())
+    return nullptr;
+  return &(it->second);
+}
+
+void hcf_cache::add_object(hcf_object_id id, hcf_object obj) {
+  if (_hcf_objects.count(id) > 0) {
+    HIPSYCL_DEBUG_ERROR
+        << "hcf_cache: Detected hcf object id collision " << id
+        << ", this should not happen. Some kernels might be unavailable."
+        << std::endl;
+    return;
+  }
+  bool is_parsed = obj.container != nullptr;
+  hcf_object& stored_obj = _hcf_objects[id] = std::move(obj);
+  if(is_parsed)
+    index_object(id, stored_obj);
+  else
+    ++_num_unparsed_objects;
+}
+
+void hcf_cache::parse_object(hcf_object_id id, hcf_object& obj) const {
+  if(obj.container)
+    return;
+
+  HIPSYCL_DEBUG_INFO << "hcf_cache: Parsing HCF object " << id << std::endl;
+  obj.container = std::make_unique<common::hcf_container>(
+      obj.data, common::hcf_container::reference_binary_appendix);
+  --_num_unparsed_objects;
+  index_object(id, obj);
+}
+
+void hcf_cache::parse_all_objects() const {
+  if(_num_unparsed_objects == 0)
+    return;
+  for(auto& entry : _hcf_objects)
+    parse_object(entry.first, entry.second);
+}
+
+void hcf_cache::index_object(hcf_object_id id, hcf_object& obj) const {
+  const common::hcf_container::node* root = obj.container->root_node();
+
+  if(const auto* kernels_node = root->get_subnode("kernels"))
+    for(const auto& kernel_node : kernels_node->subnodes)
+      obj.kernel_nodes[kernel_node.node_id] = &kernel_node;
+  if(const auto* images_node = root->get_subnode("images"))
+    for(const auto& image_node : images_node->subnodes)
+      obj.image_nodes[image_node.node_id] = &image_node;
+
+  // Check if the HCF exports some symbols
+  for_each_exported_symbol_list(
+      *obj.container,
+      [&](const common::hcf_container::node *image_node,
+          const std::vector<std::string> &exported_symbols) {
+
+        for (const auto &symbol : exported_symbols) {
+
+          _exported_symbol_providers[symbol].push_back(
+              device_image_id{id, image_node});
+
+          HIPSYCL_DEBUG_INFO << "hcf_cache: Symbol " << symbol
+                             << " is registered as exported by object " << id
+                             << " and image " << image_node->node_id
+                             << " @" << image_node << std::endl;
+        }
+      });
+}
+
+void hcf_cache::dump_hcf(hcf_object_id id, std::string_view data) const {
+  std::string hcf_dump_dir =
+      application::get_settings().get<setting::hcf_dump_directory>();
+  if(!hcf_dump_dir.empty()) {
+    std::string out_filename = hcf_dump_dir;
+
+    if(out_filename.back() != '/' && out_filename.back() != '\\')
+      out_filename += '/';
+    
+    out_filename += "hipsycl_object_"+std::to_string(id)+".hcf";
+
+    std::ofstream out_file(out_filename.c_str(), std::ios::binary);
+    if(!out_file.is_open()) {
+      HIPSYCL_DEBUG_ERROR << "Could not open file " << out_filename
+                          << " for writing." << std::endl;
+
+    } else {
+      out_file.write(data.data(), data.size());
+    }
+  }
+}
+
 
 
 
@@ -434,10 +525,51 @@ std::shared_ptr<kernel_cache> kernel_cache::get() {
   return c;
 }
 
+void kernel_cache::wait_for_background_compilations() {
+  std::vector<worker_thread*> background_workers;
+  {
+    std::lock_guard<std::mutex> lock{_mutex};
+    for(auto& worker : _background_compilation_workers)
+      background_workers.push_back(worker.get());
+  }
+  // Background compilations need to acquire _mutex, so we must not
+  // hold it while waiting for them to finish.
+  for(auto* worker : background_workers)
+    worker->wait();
+}
+
 void kernel_cache::unload() {
+  std::vector<std::unique_ptr<worker_thread>> background_workers;
+  {
+    std::lock_guard<std::mutex> lock{_mutex};
+    background_workers = std::move(_background_compilation_workers);
+    _background_compilation_workers.clear();
+  }
+  // Background compilations need to acquire _mutex, so we must not
+  // hold it while waiting for them to finish.
+  for(auto& worker : background_workers)
+    worker->halt();
+  background_workers.clear();
+
   std::lock_guard<std::mutex> lock{_mutex};
 
   _code_objects.clear();
+  _scheduled_background_compilations.clear();
+}
+
+worker_thread* kernel_cache::get_background_compilation_worker() {
+  if(_background_compilation_workers.empty()) {
+    std::size_t num_workers = std::max(
+        std::size_t{1},
+        application::get_settings()
+            .get<setting::jit_background_compilation_threads>());
+    for(std::size_t i = 0; i < num_workers; ++i)
+      _background_compilation_workers.emplace_back(
+          std::make_unique<worker_thread>());
+  }
+  std::size_t index = _next_background_compilation_worker++ %
+                      _background_compilation_workers.size();
+  return _background_compilation_workers[index].get();
 }
 
 const code_object* kernel_cache::get_code_object(code_object_id id) const {
@@ -458,8 +590,21 @@ std::string kernel_cache::get_persistent_cache_file(code_object_id id_of_binary)
   return join_path(cache_dir, kernel_configuration::to_string(id_of_binary)+".jit");
 }
 
-bool kernel_cache::persistent_cache_lookup(code_object_id id_of_binary,
-                                           std::string &out) const {
+bool kernel_cache::persistent_cache_lookup(
+    code_object_id id_of_binary, std::shared_ptr<const jit_binary> &out) const {
+  common::filesystem::archived_binary archived;
+  if (common::filesystem::persistent_storage::get()
+          .get_jit_cache_archive()
+          .lookup(id_of_binary, archived)) {
+    HIPSYCL_DEBUG_INFO << "kernel_cache: Persistent cache hit for id "
+                       << kernel_configuration::to_string(id_of_binary)
+                       << " in JIT cache archive" << std::endl;
+    out = std::make_shared<jit_binary>(std::move(archived));
+    return true;
+  }
+
+  // Fall back to binaries that were stored as individual files by
+  // older versions
   std::string filename;
 
   bool filename_lookup_succeeded =
@@ -488,35 +633,30 @@ bool kernel_cache::persistent_cache_lookup(code_object_id id_of_binary,
 
   std::streamsize file_size = file.tellg();
   file.seekg(0, std::ios::beg);
-  out.resize(file_size);
-  file.read(out.data(), file_size);
-  
+  std::string data;
+  data.resize(file_size);
+  file.read(data.data(), file_size);
+
+  out = std::make_shared<jit_binary>(std::move(data));
   return true;
 }
 
 void kernel_cache::persistent_cache_store(code_object_id id_of_binary,
-                                          const std::string &data) const {
+                                          std::string_view data) const {
   if(application::get_settings().get<setting::no_jit_cache_population>())
     return;
 
-  std::string filename = get_persistent_cache_file(id_of_binary);
-
   HIPSYCL_DEBUG_INFO << "kernel_cache: Storing compiled binary with id "
                      << kernel_configuration::to_string(id_of_binary)
-                     << " in persistent cache file " << filename << std::endl;
-  
+                     << " in JIT cache archive" << std::endl;
 
-  if(!common::filesystem::atomic_write(filename, data)) {
+  if (!common::filesystem::persistent_storage::get()
+           .get_jit_cache_archive()
+           .store(id_of_binary, data)) {
     HIPSYCL_DEBUG_ERROR
-        << "Could not store JIT result in persistent kernel cache in file "
-        << filename << std::endl;
+        << "Could not store JIT result in persistent kernel cache archive"
+        << std::endl;
   }
-
-  common::filesystem::persistent_storage::get()
-      .get_this_app_db()
-      .read_write_access([&](common::db::appdb_data &appdb) {
-        appdb.binaries[id_of_binary].jit_cache_filename = filename;
-      });
 }
 
 } // rt
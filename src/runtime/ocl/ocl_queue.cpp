@@ -15,6 +15,7 @@
 #include "hipSYCL/runtime/kernel_cache.hpp"
 #include "hipSYCL/runtime/inorder_queue.hpp"
 #include "hipSYCL/runtime/executor.hpp"
+#include "hipSYCL/runtime/generic/object_pool.hpp"
 #include "hipSYCL/runtime/code_object_invoker.hpp"
 #include "hipSYCL/runtime/ocl/ocl_code_object.hpp"
 #include "hipSYCL/runtime/queue_completion_event.hpp"
@@ -161,7 +162,7 @@ std::shared_ptr<dag_node_event> ocl_queue::insert_event() {
 }
 
 std::shared_ptr<dag_node_event> ocl_queue::create_queue_completion_event() {
-  return std::make_shared<queue_completion_event<cl::Event, ocl_node_event>>(
+  return make_pooled_shared<queue_completion_event<cl::Event, ocl_node_event>>(
       this);
 }
 
@@ -608,7 +609,7 @@ result ocl_queue::submit_sscp_kernel_from_code_object(
 }
 
 void ocl_queue::register_submitted_op(cl::Event evt) {
-  this->_state.set_most_recent_event(std::make_shared<ocl_node_event>(
+  this->_state.set_most_recent_event(make_pooled_shared<ocl_node_event>(
       _hw_manager->get_device_id(_device_index), evt));
 }
 
@@ -8,27 +8,33 @@
  * See file LICENSE in the project root for full license details.
  */
 // SPDX-License-Identifier: BSD-2-Clause
+#include <algorithm>
 #include <cstdlib>
 
+#include "hipSYCL/runtime/application.hpp"
 #include "hipSYCL/runtime/device_id.hpp"
 #include "hipSYCL/runtime/error.hpp"
+#include "hipSYCL/runtime/generic/numa.hpp"
 #include "hipSYCL/runtime/hints.hpp"
 #include "hipSYCL/runtime/omp/omp_allocator.hpp"
+#include "hipSYCL/runtime/omp/omp_backend.hpp"
+#include "hipSYCL/runtime/settings.hpp"
 #include "hipSYCL/runtime/util.hpp"
 
 namespace hipsycl {
 namespace rt {
 
-omp_allocator::omp_allocator(const device_id &my_device)
-    : _my_device{my_device} {}
+namespace {
 
-void *omp_allocator::raw_allocate(size_t min_alignment, size_t size_bytes,
-                                  const allocation_hints &hints) {
+// Smaller allocations are not worth distributing across NUMA nodes
+constexpr std::size_t numa_placement_min_size = 1024 * 1024;
+
+void *allocate_aligned(size_t min_alignment, size_t size_bytes) {
   if(min_alignment < 32) {
     // Enforce alignment by default for performance reasons.
     // 32 is chosen since this is what is currently needed by the adaptivity
     // engine to consider an allocation strongly aligned.
-    return raw_allocate(32, size_bytes, hints);
+    return allocate_aligned(32, size_bytes);
   }
 
 #if !defined(_WIN32)
@@ -45,8 +51,8 @@ void *omp_allocator::raw_allocate(size_t min_alignment, size_t size_bytes,
 #endif
 
   if(min_alignment > 0 && size_bytes % min_alignment != 0)
-    return raw_allocate(min_alignment,
-                        next_multiple_of(size_bytes, min_alignment), hints);
+    return allocate_aligned(min_alignment,
+                            next_multiple_of(size_bytes, min_alignment));
 
     // ToDo: Mac OS CI has a problem with std::aligned_alloc
     // but it's unclear if it's a Mac, or libc++, or toolchain issue
@@ -60,6 +66,28 @@ void *omp_allocator::raw_allocate(size_t min_alignment, size_t size_bytes,
 #endif
 }
 
+}
+
+omp_allocator::omp_allocator(omp_backend *be, const device_id &my_device,
+                             int numa_node)
+    : _backend{be}, _my_device{my_device}, _numa_node{numa_node} {}
+
+void *omp_allocator::raw_allocate(size_t min_alignment, size_t size_bytes,
+                                  const allocation_hints &hints) {
+  if (numa::get_topology().empty() || size_bytes < numa_placement_min_size ||
+      application::get_settings().get<setting::omp_numa_allocation>() ==
+          numa_allocation_policy::none)
+    return allocate_aligned(min_alignment, size_bytes);
+
+  // Page alignment ensures that the pages are not shared with other
+  // allocations that may have been placed differently.
+  void *mem = allocate_aligned(std::max(min_alignment, numa::get_page_size()),
+                               size_bytes);
+  if(mem)
+    place_on_numa_nodes(mem, size_bytes);
+  return mem;
+}
+
 void *omp_allocator::raw_allocate_optimized_host(size_t min_alignment,
                                                  size_t bytes,
                                                  const allocation_hints &hints) {
@@ -86,6 +114,31 @@ bool omp_allocator::is_usm_accessible_from(backend_descriptor b) const {
   return false;
 }
 
+void omp_allocator::place_on_numa_nodes(void *mem, size_t size_bytes) {
+  if(_numa_node >= 0) {
+    numa::interleave_memory(mem, size_bytes, {_numa_node});
+    return;
+  }
+
+  auto policy = application::get_settings().get<setting::omp_numa_allocation>();
+  if(policy == numa_allocation_policy::interleave) {
+    numa::interleave_memory(mem, size_bytes, numa::get_nodes());
+  } else if(policy == numa_allocation_policy::first_touch) {
+    // Touch the pages with the distribution that the kernel executor
+    // initially uses for work groups, such that kernels whose work groups
+    // access consecutive parts of the allocation mostly access pages
+    // on the NUMA node of the executing thread.
+    const std::size_t page_size = numa::get_page_size();
+    const std::size_t num_pages = (size_bytes + page_size - 1) / page_size;
+    char *pages = static_cast<char *>(mem);
+    _backend->get_kernel_executor().parallel_for_static(
+        num_pages, [&](std::size_t begin, std::size_t end) {
+          for(std::size_t i = begin; i < end; ++i)
+            pages[i * page_size] = 0;
+        });
+  }
+}
+
 device_id omp_allocator::get_device() const {
   return _my_device;
 }
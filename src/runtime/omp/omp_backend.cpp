@@ -17,6 +17,7 @@
 #include "hipSYCL/runtime/error.hpp"
 #include "hipSYCL/runtime/multi_queue_executor.hpp"
 #include <memory>
+#include <omp.h>
 
 
 HIPSYCL_PLUGIN_API_EXPORT
@@ -52,12 +53,16 @@ create_multi_queue_executor(omp_backend *b) {
 }
 
 omp_backend::omp_backend()
-    : _allocator{device_id{
-          backend_descriptor{omp_backend::get_hardware_platform(), omp_backend::get_api_platform()}, 0}},
-      _hw{},
+    : _hw{},
       _executor([this](){
         return create_multi_queue_executor(this);
-      }) {}
+      }) {
+  for(std::size_t i = 0; i < _hw.get_num_devices(); ++i) {
+    auto *dev = static_cast<omp_hardware_context *>(_hw.get_device(i));
+    _allocators.push_back(std::make_unique<omp_allocator>(
+        this, _hw.get_device_id(i), dev->get_numa_node()));
+  }
+}
 
 api_platform omp_backend::get_api_platform() const {
   return api_platform::omp;
@@ -75,6 +80,14 @@ backend_hardware_manager* omp_backend::get_hardware_manager() const {
   return &_hw;
 }
 
+work_stealing_executor& omp_backend::get_kernel_executor() {
+  std::call_once(_kernel_executor_init_flag, [this]() {
+    _kernel_executor = std::make_unique<work_stealing_executor>(
+        static_cast<std::size_t>(omp_get_max_threads()));
+  });
+  return *_kernel_executor;
+}
+
 backend_executor* omp_backend::get_executor(device_id dev) const {
   if(dev.get_backend() != this->get_unique_backend_id()) {
     register_error(__acpp_here(),
@@ -93,7 +106,14 @@ backend_allocator* omp_backend::get_allocator(device_id dev) const {
                               error_type::invalid_parameter_error});
     return nullptr;
   }
-  return &_allocator;
+  if(static_cast<std::size_t>(dev.get_id()) >= _allocators.size()) {
+    register_error(__acpp_here(),
+                   error_info{"omp_backend: Requested allocator for "
+                              "non-existent device",
+                              error_type::invalid_parameter_error});
+    return nullptr;
+  }
+  return _allocators[dev.get_id()].get();
 }
 
 std::string omp_backend::get_name() const {
@@ -21,6 +21,7 @@
 #include "hipSYCL/common/debug.hpp"
 #include "hipSYCL/common/filesystem.hpp"
 #include "hipSYCL/common/hcf_container.hpp"
+#include "hipSYCL/compiler/llvm-to-backend/host/HostObjectLoader.hpp"
 #include "hipSYCL/runtime/kernel_configuration.hpp"
 #include "hipSYCL/runtime/device_id.hpp"
 #include "hipSYCL/runtime/dylib_loader.hpp"
@@ -31,9 +32,10 @@ namespace rt {
 
 namespace {
 
-result make_shared_library_from_blob(void *&module, const std::string &blob,
+result make_shared_library_from_blob(void *&module, std::string_view blob,
                                      const std::string &cache_file) {
-  // Write binary image to temporary file
+  // Write binary image to temporary file. Only needed if the platform
+  // cannot load libraries from memory.
   if (!common::filesystem::atomic_write(cache_file, blob)) {
     HIPSYCL_DEBUG_ERROR << "Could not store JIT kernel library in temporary "
                            "kernel cache in file "
@@ -59,18 +61,24 @@ result make_shared_library_from_blob(void *&module, const std::string &blob,
 } // namespace
 
 omp_sscp_executable_object::omp_sscp_executable_object(
-    const std::string &binary, hcf_object_id hcf_source,
+    std::string_view binary, hcf_object_id hcf_source,
     const std::vector<std::string> &kernel_names,
     const kernel_configuration &config)
     : _hcf{hcf_source}, _id{config.generate_id()}, _module{nullptr},
-      _kernel_cache_path(kernel_cache::get_persistent_cache_file(_id) + ".so") {
+      _image_fd{-1} {
   _build_result = build(binary, kernel_names);
 }
 
 omp_sscp_executable_object::~omp_sscp_executable_object() {
+  // In-memory objects are unloaded by the destruction of _object_loader
+  if (_object_loader)
+    return;
+
   if (_module)
     detail::close_library(_module, "omp_sscp_executable");
-  if(!common::filesystem::remove(_kernel_cache_path)) {
+  detail::close_library_image(_image_fd);
+  if (!_kernel_cache_path.empty() &&
+      !common::filesystem::remove(_kernel_cache_path)) {
     HIPSYCL_DEBUG_ERROR << "Could not remove kernel cache file: "
                         << _kernel_cache_path << std::endl;
   }
@@ -110,20 +118,47 @@ omp_sscp_executable_object::supported_backend_kernel_names() const {
 void *omp_sscp_executable_object::get_module() const { return _module; }
 
 result omp_sscp_executable_object::build(
-    const std::string &source, const std::vector<std::string> &kernel_names) {
+    std::string_view source, const std::vector<std::string> &kernel_names) {
     
   if (_module != nullptr)
     return make_success();
 
-  if (auto result = make_shared_library_from_blob(_module, source, _kernel_cache_path);
-      !result.is_success())
-    return result;
+  // Object files are linked into the process in memory; shared libraries
+  // (from the external compiler path or older kernel caches) are dlopen'd.
+  if (compiler::isRelocatableHostObject(source)) {
+    auto loader = std::make_unique<compiler::HostObjectLoader>();
+    std::string err;
+    if (!loader->load(source, err))
+      return make_error(__acpp_here(),
+                        error_info{"omp_sscp_executable_object: could not load "
+                                   "kernel object: " + err});
+    _object_loader = std::move(loader);
+    _module = _object_loader.get();
+  } else {
+    // Avoid writing the library to disk, which would duplicate the
+    // binary that is already stored in the persistent kernel cache.
+    _module = detail::load_library_from_memory(source, "omp_sscp_executable",
+                                               _image_fd);
+    if (!_module) {
+      _kernel_cache_path = kernel_cache::get_persistent_cache_file(_id) + ".so";
+      if (auto result = make_shared_library_from_blob(_module, source,
+                                                      _kernel_cache_path);
+          !result.is_success())
+        return result;
+    }
+  }
+
+  auto get_kernel_symbol = [&](const std::string &kernel_name) -> void * {
+    if (_object_loader)
+      return _object_loader->getSymbol(kernel_name);
+    return detail::get_symbol_from_library(_module, kernel_name,
+                                           "omp_sscp_exectuable_object");
+  };
 
   _kernel_names = kernel_names;
   // find all kernel symbols
   for (const auto &kernel_name : _kernel_names) {
-    if (auto kernel = (omp_sscp_kernel *)detail::get_symbol_from_library(
-            _module, kernel_name, "omp_sscp_exectuable_object")) {
+    if (auto kernel = (omp_sscp_kernel *)get_kernel_symbol(kernel_name)) {
       _kernels.emplace(kernel_name, kernel);
     } else {
       return make_error(__acpp_here(),
@@ -9,13 +9,14 @@
  */
 // SPDX-License-Identifier: BSD-2-Clause
 #include "hipSYCL/runtime/omp/omp_event.hpp"
+#include "hipSYCL/runtime/generic/object_pool.hpp"
 
 
 namespace hipsycl {
 namespace rt {
 
 omp_node_event::omp_node_event()
-: _signal_channel{std::make_shared<signal_channel>()}
+: _signal_channel{make_pooled_shared<signal_channel>()}
 {}
 
 omp_node_event::~omp_node_event()
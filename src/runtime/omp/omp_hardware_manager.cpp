@@ -9,16 +9,24 @@
  */
 // SPDX-License-Identifier: BSD-2-Clause
 #include <omp.h>
+#include <algorithm>
 #include <limits>
 
 #include "hipSYCL/runtime/omp/omp_hardware_manager.hpp"
+#include "hipSYCL/runtime/application.hpp"
 #include "hipSYCL/runtime/error.hpp"
 #include "hipSYCL/runtime/device_id.hpp"
+#include "hipSYCL/runtime/generic/numa.hpp"
 
 namespace hipsycl {
 namespace rt {
 
 
+omp_hardware_context::omp_hardware_context(std::size_t index,
+                                           std::size_t num_sub_devices,
+                                           int numa_node)
+    : _index{index}, _num_sub_devices{num_sub_devices}, _numa_node{numa_node} {}
+
 bool omp_hardware_context::is_cpu() const {
   return true;
 }
@@ -28,7 +36,9 @@ bool omp_hardware_context::is_gpu() const {
 }
 
 std::size_t omp_hardware_context::get_max_kernel_concurrency() const {
-  return 1;
+  return std::max(
+      application::get_settings().get<setting::omp_kernel_concurrency>(),
+      std::size_t{1});
 }
   
 // TODO We could actually copy have more memcpy concurrency
@@ -37,6 +47,12 @@ std::size_t omp_hardware_context::get_max_memcpy_concurrency() const {
 }
 
 std::string omp_hardware_context::get_device_name() const {
+  if(_numa_node >= 0)
+    return "AdaptiveCpp OpenMP host device (NUMA node " +
+           std::to_string(_numa_node) + ")";
+  if(_num_sub_devices > 1)
+    return "AdaptiveCpp OpenMP host device (sub-device " +
+           std::to_string(_index) + ")";
   return "AdaptiveCpp OpenMP host device";
 }
 
@@ -282,14 +298,34 @@ omp_hardware_context::get_property(device_uint_property prop) const {
 std::vector<std::size_t> omp_hardware_context::get_property(device_uint_list_property prop) const
 {
   switch(prop) {
-  case device_uint_list_property::sub_group_sizes:
-    return std::vector<std::size_t>{1};
+  case device_uint_list_property::sub_group_sizes: {
+    // Kernels compiled ahead of time always use a sub-group size of 1
+    std::size_t sscp_sub_group_size = get_sscp_sub_group_size();
+    if(sscp_sub_group_size == 1)
+      return std::vector<std::size_t>{1};
+    return std::vector<std::size_t>{sscp_sub_group_size, 1};
+  }
     break;
   }
   assert(false && "Invalid device property");
   std::terminate();
 }
 
+std::size_t omp_hardware_context::get_sscp_sub_group_size() {
+  std::size_t sub_group_size =
+      application::get_settings().get<setting::omp_sub_group_size>();
+  if(sub_group_size > 0)
+    return sub_group_size;
+  // As many work items as fit 32-bit elements into a vector register
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+  if(__builtin_cpu_supports("avx512f"))
+    return 16;
+  if(__builtin_cpu_supports("avx"))
+    return 8;
+#endif
+  return 4;
+}
+
 std::string omp_hardware_context::get_driver_version() const { return "1.2"; }
 
 std::string omp_hardware_context::get_profile() const {
@@ -300,17 +336,43 @@ std::size_t omp_hardware_context::get_platform_index() const {
   return 0;
 }
 
+int omp_hardware_context::get_numa_node() const {
+  return _numa_node;
+}
+
 std::size_t omp_hardware_manager::get_num_platforms() const {
   return 1;
 }
 
 
 
-std::size_t omp_hardware_manager::get_num_devices() const { return 1; }
+omp_hardware_manager::omp_hardware_manager() {
+  if(application::get_settings().get<setting::omp_numa_sub_devices>()) {
+    std::vector<int> nodes = numa::get_nodes();
+    if(nodes.size() > 1) {
+      for(std::size_t i = 0; i < nodes.size(); ++i)
+        _devices.emplace_back(i, nodes.size(), nodes[i]);
+      return;
+    }
+    HIPSYCL_DEBUG_WARNING << "omp_hardware_manager: NUMA sub-devices were "
+                             "requested, but no NUMA topology was found"
+                          << std::endl;
+  }
+
+  std::size_t num_devices = std::max(
+      application::get_settings().get<setting::omp_sub_devices>(),
+      std::size_t{1});
+  for(std::size_t i = 0; i < num_devices; ++i)
+    _devices.emplace_back(i, num_devices);
+}
+
+std::size_t omp_hardware_manager::get_num_devices() const {
+  return _devices.size();
+}
 
 
 hardware_context* omp_hardware_manager::get_device(std::size_t index) {
-  if(index != 0) {
+  if(index >= _devices.size()) {
     register_error(__acpp_here(),
                    error_info{"omp_hardware_manager: Requested device " +
                                   std::to_string(index) + " does not exist.",
@@ -318,7 +380,7 @@ hardware_context* omp_hardware_manager::get_device(std::size_t index) {
     return nullptr;
   }
 
-  return &_device;
+  return &_devices[index];
 }
 
 device_id omp_hardware_manager::get_device_id(std::size_t index) const {
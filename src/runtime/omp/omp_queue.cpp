@@ -16,6 +16,9 @@
 #include "hipSYCL/runtime/error.hpp"
 #include "hipSYCL/runtime/event.hpp"
 #include "hipSYCL/runtime/generic/async_worker.hpp"
+#include "hipSYCL/runtime/generic/numa.hpp"
+#include "hipSYCL/runtime/generic/object_pool.hpp"
+#include "hipSYCL/runtime/generic/work_stealing_executor.hpp"
 #include "hipSYCL/runtime/hints.hpp"
 #include "hipSYCL/runtime/inorder_queue.hpp"
 #include "hipSYCL/runtime/instrumentation.hpp"
@@ -25,6 +28,7 @@
 #include "hipSYCL/runtime/operations.hpp"
 #include "hipSYCL/runtime/queue_completion_event.hpp"
 #include "hipSYCL/runtime/signal_channel.hpp"
+#include "hipSYCL/runtime/tracing.hpp"
 #include "hipSYCL/runtime/util.hpp"
 
 #ifdef HIPSYCL_WITH_SSCP_COMPILER
@@ -43,6 +47,7 @@
 
 #include <omp.h>
 
+#include <algorithm>
 #include <memory>
 
 namespace hipsycl {
@@ -115,8 +120,11 @@ class instrumentation_task_guard {
 public:
   instrumentation_task_guard(
       std::shared_ptr<omp_execution_start_timestamp> start,
-      std::shared_ptr<omp_execution_finish_timestamp> finish)
-      : _finish{finish} {
+      std::shared_ptr<omp_execution_finish_timestamp> finish,
+      const char *trace_name, std::uint64_t trace_node)
+      : _finish{finish},
+        _trace{trace_name, tracing::category::execution, trace_node},
+        _trace_ctx{trace_node} {
     if (start)
       start->record_time();
   }
@@ -128,27 +136,33 @@ public:
 
 private:
   std::shared_ptr<omp_execution_finish_timestamp> _finish;
+  tracing::scope _trace;
+  tracing::node_context _trace_ctx;
 };
 
 class omp_instrumentation_setup {
 public:
-  omp_instrumentation_setup(operation &op, dag_node_ptr node) {
+  omp_instrumentation_setup(operation &op, dag_node_ptr node,
+                            const char *trace_name)
+      : _trace_name{trace_name} {
     if (!node)
       return;
 
+    _trace_node = node->get_trace_id();
+
     if (node->get_execution_hints()
             .has_hint<
                 rt::hints::request_instrumentation_submission_timestamp>()) {
 
       op.get_instrumentations()
           .add_instrumentation<instrumentations::submission_timestamp>(
-              std::make_shared<omp_submission_timestamp>(
+              make_pooled_shared<omp_submission_timestamp>(
                   profiler_clock::now()));
     }
     if (node->get_execution_hints()
             .has_hint<rt::hints::request_instrumentation_start_timestamp>()) {
 
-      _start = std::make_shared<omp_execution_start_timestamp>();
+      _start = make_pooled_shared<omp_execution_start_timestamp>();
 
       op.get_instrumentations()
           .add_instrumentation<instrumentations::execution_start_timestamp>(
@@ -157,7 +171,7 @@ public:
     if (node->get_execution_hints()
             .has_hint<rt::hints::request_instrumentation_finish_timestamp>()) {
 
-      _finish = std::make_shared<omp_execution_finish_timestamp>();
+      _finish = make_pooled_shared<omp_execution_finish_timestamp>();
 
       op.get_instrumentations()
           .add_instrumentation<instrumentations::execution_finish_timestamp>(
@@ -166,10 +180,13 @@ public:
   }
 
   instrumentation_task_guard instrument_task() const {
-    return instrumentation_task_guard{_start, _finish};
+    return instrumentation_task_guard{_start, _finish, _trace_name,
+                                      _trace_node};
   }
 
 private:
+  const char *_trace_name;
+  std::uint64_t _trace_node = 0;
   std::shared_ptr<omp_execution_start_timestamp> _start;
   std::shared_ptr<omp_execution_finish_timestamp> _finish;
 };
@@ -202,7 +219,9 @@ void *resize_and_strongly_align(std::vector<char> &data, std::size_t size) {
 }
 
 result
-launch_kernel_from_so(omp_sscp_executable_object::omp_sscp_kernel *kernel,
+launch_kernel_from_so(work_stealing_executor &executor, std::size_t grain_size,
+                      int numa_node,
+                      omp_sscp_executable_object::omp_sscp_kernel *kernel,
                       const rt::range<3> &num_groups,
                       const rt::range<3> &local_size, unsigned shared_memory,
                       void **kernel_args) {
@@ -220,47 +239,78 @@ launch_kernel_from_so(omp_sscp_executable_object::omp_sscp_kernel *kernel,
     return make_success();
   }
 
-#ifndef _OPENMP
-  HIPSYCL_DEBUG_WARNING << "omp_queue: SSCP kernel launching was built without OpenMP "
-                          "support, the kernel will execute sequentially!"
-                        << std::endl;
-#endif
+  const std::size_t num_groups_x = num_groups.get(0);
+  const std::size_t num_groups_xy = num_groups_x * num_groups.get(1);
+
+  executor.parallel_for(
+      num_groups.size(), grain_size,
+      [&](std::size_t begin, std::size_t end) {
+        // get page aligned local memory from heap
+        static thread_local std::vector<char> local_memory;
+        static thread_local std::vector<char> internal_local_memory;
+        auto aligned_local_memory =
+            resize_and_strongly_align(local_memory, shared_memory);
+        auto aligned_internal_local_memory = resize_and_strongly_align(
+            internal_local_memory, local_size.size() * sizeof(uint64_t));
+
+        for (std::size_t group = begin; group < end; ++group) {
+          std::size_t k = group / num_groups_xy;
+          std::size_t j = (group % num_groups_xy) / num_groups_x;
+          std::size_t i = group % num_groups_x;
 
-#ifdef _OPENMP
-#pragma omp parallel
-#endif
-  {
-    // get page aligned local memory from heap
-    static thread_local std::vector<char> local_memory;
-    static thread_local std::vector<char> internal_local_memory;
-    auto aligned_local_memory =
-        resize_and_strongly_align(local_memory, shared_memory);
-    auto aligned_internal_local_memory = resize_and_strongly_align(
-        internal_local_memory, local_size.size() * sizeof(uint64_t));
-#ifdef _OPENMP
-#pragma omp for collapse(3)
-#endif
-    for (std::size_t k = 0; k < num_groups.get(2); ++k) {
-      for (std::size_t j = 0; j < num_groups.get(1); ++j) {
-        for (std::size_t i = 0; i < num_groups.get(0); ++i) {
           omp_sscp_executable_object::work_group_info info{
               num_groups, rt::id<3>{i, j, k}, local_size, aligned_local_memory,
               aligned_internal_local_memory};
           kernel(&info, kernel_args);
         }
-      }
-    }
-  }
+      },
+      numa_node);
   return make_success();
 }
 #endif
 } // namespace
 
 omp_queue::omp_queue(omp_backend* be, int dev)
-    : _backend_id{be->get_unique_backend_id()}, _sscp_code_object_invoker{this},
+    : _backend{be}, _backend_id{be->get_unique_backend_id()},
+      _device_index{dev}, _sscp_code_object_invoker{this},
       _kernel_cache{kernel_cache::get()} {
   _reflection_map = glue::jit::construct_default_reflection_map(
       be->get_hardware_manager()->get_device(dev));
+
+  // NUMA sub-devices execute OpenMP kernels with the CPUs of their node,
+  // and SSCP kernels with the kernel executor threads of their node.
+  // Threads of OpenMP parallel regions inherit the affinity of the
+  // worker thread.
+  _numa_node = static_cast<omp_hardware_context *>(
+                   be->get_hardware_manager()->get_device(dev))
+                   ->get_numa_node();
+  // If the CPU is partitioned into sub-devices, OpenMP kernels of each
+  // sub-device only use their share of the threads. SSCP kernels of
+  // concurrently busy sub-devices are partitioned by the kernel executor.
+  std::size_t num_sub_devices = be->get_hardware_manager()->get_num_devices();
+  int num_threads = omp_get_max_threads();
+  if(_numa_node >= 0)
+    num_threads = static_cast<int>(
+        std::max(numa::get_num_cpus(_numa_node), std::size_t{1}));
+  else if(num_sub_devices > 1)
+    num_threads = std::max(
+        1, num_threads / static_cast<int>(num_sub_devices));
+  // With multiple kernel lanes, the OpenMP parallel regions of concurrently
+  // running kernels would otherwise oversubscribe the CPU, so each lane
+  // only uses its share of the threads.
+  int kernel_concurrency = static_cast<int>(
+      be->get_hardware_manager()->get_device(dev)->get_max_kernel_concurrency());
+  num_threads = std::max(1, num_threads / kernel_concurrency);
+
+  if(_numa_node >= 0) {
+    int node = _numa_node;
+    _worker([node, num_threads]() {
+      numa::bind_current_thread(node);
+      omp_set_num_threads(num_threads);
+    });
+  } else if(num_threads != omp_get_max_threads()) {
+    _worker([num_threads]() { omp_set_num_threads(num_threads); });
+  }
 }
 
 omp_queue::~omp_queue() { _worker.halt(); }
@@ -268,7 +318,7 @@ omp_queue::~omp_queue() { _worker.halt(); }
 std::shared_ptr<dag_node_event> omp_queue::insert_event() {
   HIPSYCL_DEBUG_INFO << "omp_queue: Inserting event into queue..." << std::endl;
 
-  auto evt = std::make_shared<omp_node_event>();
+  auto evt = make_pooled_shared<omp_node_event>();
   auto signal_channel = evt->get_signal_channel();
 
   _worker([signal_channel] { signal_channel->signal(); });
@@ -277,7 +327,7 @@ std::shared_ptr<dag_node_event> omp_queue::insert_event() {
 }
 
 std::shared_ptr<dag_node_event> omp_queue::create_queue_completion_event() {
-  return std::make_shared<
+  return make_pooled_shared<
       queue_completion_event<std::shared_ptr<signal_channel>, omp_node_event>>(
       this);
 }
@@ -315,7 +365,7 @@ result omp_queue::submit_memcpy(memcpy_operation &op, const dag_node_ptr& node)
   bool is_dest_contiguous =
       is_contigous(dest_offset, transferred_range, dest_allocation_shape);
 
-  omp_instrumentation_setup instrumentation_setup{op, node};
+  omp_instrumentation_setup instrumentation_setup{op, node, "execute_memcpy"};
 
   _worker([=]() {
     auto instrumentation_guard = instrumentation_setup.instrument_task();
@@ -391,7 +441,7 @@ result omp_queue::submit_kernel(kernel_operation &op, const dag_node_ptr& node)
   void* params = this;
   rt::dag_node* node_ptr = node.get();
 
-  omp_instrumentation_setup instrumentation_setup{op, node};
+  omp_instrumentation_setup instrumentation_setup{op, node, "execute_kernel"};
   _worker([=, &op]() {
     auto instrumentation_guard = instrumentation_setup.instrument_task();
 
@@ -433,71 +483,133 @@ result omp_queue::submit_sscp_kernel_from_code_object(
       hcf_object, kernel_name, kernel_info, _arg_mapper, num_groups,
       group_size, args,        arg_sizes,   num_args, local_mem_size};
 
-  _config = initial_config;
+  auto make_base_configuration = [&](kernel_configuration& config) {
+    config = initial_config;
+
+    config.append_base_configuration(
+        kernel_base_config_parameter::backend_id, backend_id::omp);
+    config.append_base_configuration(
+        kernel_base_config_parameter::compilation_flow,
+        compilation_flow::sscp);
+    config.append_base_configuration(
+        kernel_base_config_parameter::hcf_object_id, hcf_object);
+
+    if (application::get_settings()
+            .get<setting::jit_host_external_compiler>())
+      config.set_build_flag(kernel_build_flag::host_external_compiler);
+
+    // Always pass the sub-group size, such that the kernels use the size
+    // that the device reports.
+    config.set_build_option(kernel_build_option::host_sub_group_size,
+                            omp_hardware_context::get_sscp_sub_group_size());
+  };
 
-  _config.append_base_configuration(
-      kernel_base_config_parameter::backend_id, backend_id::omp);
-  _config.append_base_configuration(
-      kernel_base_config_parameter::compilation_flow,
-      compilation_flow::sscp);
-  _config.append_base_configuration(
-      kernel_base_config_parameter::hcf_object_id, hcf_object);
+  make_base_configuration(_config);
 
   auto binary_configuration_id =
       adaptivity_engine.finalize_binary_configuration(_config);
   auto code_object_configuration_id = binary_configuration_id;
 
-  auto get_image_and_kernel_names =
-      [&](std::vector<std::string> &contained_kernels) -> std::string {
-    return adaptivity_engine.select_image_and_kernels(&contained_kernels);
-  };
-
-  auto jit_compiler = [&](std::string &compiled_image) -> bool {
-    const common::hcf_container *hcf = rt::hcf_cache::get().get_hcf(hcf_object);
-
-    std::vector<std::string> kernel_names;
-    std::string selected_image_name = get_image_and_kernel_names(kernel_names);
-
-    // Construct Host translator to compile the specified kernels
-    std::unique_ptr<compiler::LLVMToBackendTranslator> translator =
-        compiler::createLLVMToHostTranslator(kernel_names);
-
-    // Lower kernels to binary
-    auto err = glue::jit::compile(translator.get(), hcf, selected_image_name,
-                                  _config, _reflection_map, compiled_image);
-
-    if (!err.is_success()) {
-      register_error(err);
-      return false;
-    }
-    return true;
-  };
-
-  auto code_object_constructor =
-      [&](const std::string &binary_image) -> code_object * {
+  // Constructs the JIT compiler and code object constructor for the given
+  // configuration. They only capture by value, such that they can
+  // also be used for background compilation.
+  auto make_jit_functions = [&](const kernel_configuration &config,
+                                int adaptivity_level) {
     std::vector<std::string> kernel_names;
-    get_image_and_kernel_names(kernel_names);
+    std::string selected_image_name =
+        adaptivity_engine.select_image_and_kernels(&kernel_names,
+                                                   adaptivity_level);
+
+    auto jit_compiler = [config, kernel_names, selected_image_name, hcf_object,
+                         reflection_map = _reflection_map](
+                            std::string &compiled_image) -> bool {
+      const common::hcf_container *hcf =
+          rt::hcf_cache::get().get_hcf(hcf_object);
+
+      // Construct Host translator to compile the specified kernels
+      std::unique_ptr<compiler::LLVMToBackendTranslator> translator =
+          compiler::createLLVMToHostTranslator(kernel_names);
+
+      // Lower kernels to binary
+      auto err = glue::jit::compile(translator.get(), hcf, selected_image_name,
+                                    config, reflection_map, compiled_image);
+
+      if (!err.is_success()) {
+        register_error(err);
+        return false;
+      }
+      return true;
+    };
 
-    omp_sscp_executable_object *exec_obj = new omp_sscp_executable_object{
-        binary_image, hcf_object, kernel_names, _config};
-    result r = exec_obj->get_build_result();
+    auto code_object_constructor =
+        [config, kernel_names,
+         hcf_object](std::string_view binary_image) -> code_object * {
+      omp_sscp_executable_object *exec_obj = new omp_sscp_executable_object{
+          binary_image, hcf_object, kernel_names, config};
+      result r = exec_obj->get_build_result();
+
+      if (!r.is_success()) {
+        register_error(r);
+        delete exec_obj;
+        return nullptr;
+      }
 
-    if (!r.is_success()) {
-      register_error(r);
-      delete exec_obj;
-      return nullptr;
-    }
+      HIPSYCL_DEBUG_INFO
+          << "omp_queue: Successfully compiled SSCP kernels to module "
+          << exec_obj->get_module() << std::endl;
 
-    HIPSYCL_DEBUG_INFO
-        << "omp_queue: Successfully compiled SSCP kernels to module "
-        << exec_obj->get_module() << std::endl;
+      return exec_obj;
+    };
 
-    return exec_obj;
+    return std::make_pair(jit_compiler, code_object_constructor);
   };
 
-  const code_object *obj = _kernel_cache->get_or_construct_jit_code_object(
-      code_object_configuration_id, binary_configuration_id, jit_compiler,
-      code_object_constructor);
+  const code_object *obj =
+      _kernel_cache->get_code_object(code_object_configuration_id);
+
+  if(!obj) {
+    int adaptivity_level = adaptivity_engine.get_adaptivity_level();
+    auto [jit_compiler, code_object_constructor] =
+        make_jit_functions(_config, adaptivity_level);
+
+    if (adaptivity_level > 0 &&
+        application::get_settings().get<setting::jit_background_compilation>()) {
+      obj = _kernel_cache->get_or_schedule_jit_code_object(
+          code_object_configuration_id, binary_configuration_id, jit_compiler,
+          code_object_constructor);
+      // While the specialized kernel is being compiled in the background,
+      // use the most specialized variant that is already available.
+      // If none is available, fall back to the adaptivity level 0 variant. This
+      // contains all kernels of the image, so it only needs to be compiled once
+      // per image.
+      for (int fallback_level = adaptivity_level - 1;
+           !obj && fallback_level >= 0; --fallback_level) {
+        kernel_configuration fallback_config;
+        make_base_configuration(fallback_config);
+        auto fallback_id = adaptivity_engine.finalize_fallback_binary_configuration(
+            fallback_config, fallback_level);
+
+        if (fallback_level > 0) {
+          obj = _kernel_cache->get_code_object(fallback_id);
+        } else {
+          auto [fallback_jit_compiler, fallback_code_object_constructor] =
+              make_jit_functions(fallback_config, fallback_level);
+          obj = _kernel_cache->get_or_construct_jit_code_object(
+              fallback_id, fallback_id, fallback_jit_compiler,
+              fallback_code_object_constructor);
+        }
+        if (obj) {
+          HIPSYCL_DEBUG_INFO << "omp_queue: Specialized kernel not yet available, "
+                                "launching fallback variant of adaptivity level "
+                             << fallback_level << std::endl;
+        }
+      }
+    } else {
+      obj = _kernel_cache->get_or_construct_jit_code_object(
+          code_object_configuration_id, binary_configuration_id, jit_compiler,
+          code_object_constructor);
+    }
+  }
 
   if (!obj) {
     return make_error(__acpp_here(),
@@ -508,8 +620,11 @@ result omp_queue::submit_sscp_kernel_from_code_object(
       static_cast<const omp_sscp_executable_object *>(obj)->get_kernel(
           kernel_name);
 
-  return launch_kernel_from_so(kernel, num_groups, group_size, local_mem_size,
-                               _arg_mapper.get_mapped_args());
+  return launch_kernel_from_so(
+      _backend->get_kernel_executor(),
+      application::get_settings().get<setting::omp_kernel_grain_size>(),
+      _numa_node, kernel, num_groups, group_size, local_mem_size,
+      _arg_mapper.get_mapped_args());
 
 #else
   return make_error(
@@ -527,7 +642,7 @@ result omp_queue::submit_prefetch(prefetch_operation &op, const dag_node_ptr& no
   // (TODO: maybe we should handle the case that we have USM memory from another
   // backend here)
 
-  omp_instrumentation_setup instrumentation_setup{op, node};
+  omp_instrumentation_setup instrumentation_setup{op, node, "execute_prefetch"};
   {
     auto instrumentation_guard = instrumentation_setup.instrument_task();
     // empty instrumentation region because of no-op
@@ -547,7 +662,7 @@ result omp_queue::submit_memset(memset_operation &op, const dag_node_ptr& node)
             "omp_queue: submit_memset(): Invalid argument, pointer is null."});
   }
 
-  omp_instrumentation_setup instrumentation_setup{op, node};
+  omp_instrumentation_setup instrumentation_setup{op, node, "execute_memset"};
   _worker([=]() {
     auto instrumentation_guard = instrumentation_setup.instrument_task();
 
@@ -570,7 +685,19 @@ result omp_queue::submit_queue_wait_for(const dag_node_ptr& node) {
                    error_type::invalid_parameter_error});
   }
 
-  _worker([=]() { evt->wait(); });
+  using omp_inorder_queue_event =
+      inorder_queue_event<std::shared_ptr<signal_channel>>;
+  if(dynamic_is<omp_inorder_queue_event>(evt.get())) {
+    // Queue completion events would wait for all operations of the other
+    // queue, including those submitted later on. This deadlocks if the
+    // other queue in turn waits for this one, so request an event for
+    // the current state of the other queue instead.
+    std::shared_ptr<signal_channel> signal =
+        cast<omp_inorder_queue_event>(evt.get())->request_backend_event();
+    _worker([=]() { signal->wait(); });
+  } else {
+    _worker([=]() { evt->wait(); });
+  }
 
   return make_success();
 }
@@ -605,7 +732,8 @@ worker_thread &omp_queue::get_worker() { return _worker; }
 
 device_id omp_queue::get_device() const {
   return device_id{
-      backend_descriptor{hardware_platform::cpu, api_platform::omp}, 0};
+      backend_descriptor{hardware_platform::cpu, api_platform::omp},
+      _device_index};
 }
 
 void *omp_queue::get_native_type() const { return nullptr; }
@@ -196,5 +196,19 @@ std::istream &operator>>(std::istream &istr, default_selector_behavior& out) {
   return istr;
 }
 
+std::istream &operator>>(std::istream &istr, numa_allocation_policy& out) {
+  std::string str;
+  istr >> str;
+  if (str == "none")
+    out = numa_allocation_policy::none;
+  else if (str == "first_touch")
+    out = numa_allocation_policy::first_touch;
+  else if (str == "interleave")
+    out = numa_allocation_policy::interleave;
+  else
+    istr.setstate(std::ios_base::failbit);
+  return istr;
+}
+
 }
 }
\ No newline at end of file
@@ -0,0 +1,349 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+#include "hipSYCL/runtime/tracing.hpp"
+#include "hipSYCL/runtime/application.hpp"
+#include "hipSYCL/runtime/dag_node.hpp"
+#include "hipSYCL/runtime/instrumentation.hpp"
+#include "hipSYCL/runtime/settings.hpp"
+#include "hipSYCL/common/debug.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
+
+namespace hipsycl {
+namespace rt {
+namespace tracing {
+
+namespace {
+
+constexpr std::uint64_t instant_duration =
+    std::numeric_limits<std::uint64_t>::max();
+
+struct event_record {
+  const char *name;
+  const char *arg_name;
+  std::uint64_t arg;
+  std::uint64_t node;
+  std::uint64_t begin;
+  // instant_duration for events without duration
+  std::uint64_t duration;
+  category cat;
+};
+
+std::uint64_t now() {
+  return profiler_clock::ns_ticks(profiler_clock::now());
+}
+
+const char* get_category_name(category cat) {
+  switch(cat) {
+  case category::dag:
+    return "dag";
+  case category::scheduler:
+    return "scheduler";
+  case category::memory:
+    return "memory";
+  case category::jit:
+    return "jit";
+  case category::execution:
+    return "execution";
+  }
+  return "unknown";
+}
+
+int get_process_id() {
+#ifndef _WIN32
+  return static_cast<int>(getpid());
+#else
+  return _getpid();
+#endif
+}
+
+// Ring buffer that is written by a single thread. It may be read by other
+// threads while the owner keeps recording: Each slot carries a sequence
+// number that is odd while the slot is being written (seqlock), so readers
+// can skip slots that are written concurrently instead of reading torn
+// records.
+class thread_buffer {
+public:
+  thread_buffer(std::size_t capacity, std::size_t thread_id)
+      : _head{0}, _thread_id{thread_id} {
+    std::size_t size = 1;
+    while(size < std::max(capacity, std::size_t{1}))
+      size *= 2;
+    _slots = std::make_unique<slot[]>(size);
+    _num_slots = size;
+  }
+
+  void push(const event_record& evt) {
+    std::uint64_t pos = _head.load(std::memory_order_relaxed);
+    slot& s = _slots[pos & (_num_slots - 1)];
+
+    s.sequence.store(2 * pos + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    s.store(evt);
+    s.sequence.store(2 * pos + 2, std::memory_order_release);
+
+    _head.store(pos + 1, std::memory_order_release);
+  }
+
+  template<class F>
+  void for_each_event(F&& f) const {
+    std::uint64_t head = _head.load(std::memory_order_acquire);
+    std::uint64_t num_events = std::min<std::uint64_t>(head, _num_slots);
+    for(std::uint64_t i = head - num_events; i < head; ++i) {
+      const slot& s = _slots[i & (_num_slots - 1)];
+
+      std::uint64_t sequence = s.sequence.load(std::memory_order_acquire);
+      // Slot is being written, or already holds a newer event
+      if(sequence != 2 * i + 2)
+        continue;
+      event_record evt = s.load();
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if(s.sequence.load(std::memory_order_relaxed) != sequence)
+        continue;
+
+      f(evt);
+    }
+  }
+
+  std::uint64_t get_num_dropped_events() const {
+    std::uint64_t head = _head.load(std::memory_order_acquire);
+    return head > _num_slots ? head - _num_slots : 0;
+  }
+
+  std::size_t get_thread_id() const {
+    return _thread_id;
+  }
+private:
+  // Fields are atomic only such that concurrent reads of a slot that is
+  // being overwritten are well-defined; relaxed accesses are plain loads
+  // and stores on common architectures.
+  struct slot {
+    std::atomic<std::uint64_t> sequence{0};
+    std::atomic<const char *> name{nullptr};
+    std::atomic<const char *> arg_name{nullptr};
+    std::atomic<std::uint64_t> arg{0};
+    std::atomic<std::uint64_t> node{0};
+    std::atomic<std::uint64_t> begin{0};
+    std::atomic<std::uint64_t> duration{0};
+    std::atomic<category> cat{category::dag};
+
+    void store(const event_record& evt) {
+      name.store(evt.name, std::memory_order_relaxed);
+      arg_name.store(evt.arg_name, std::memory_order_relaxed);
+      arg.store(evt.arg, std::memory_order_relaxed);
+      node.store(evt.node, std::memory_order_relaxed);
+      begin.store(evt.begin, std::memory_order_relaxed);
+      duration.store(evt.duration, std::memory_order_relaxed);
+      cat.store(evt.cat, std::memory_order_relaxed);
+    }
+
+    event_record load() const {
+      event_record evt;
+      evt.name = name.load(std::memory_order_relaxed);
+      evt.arg_name = arg_name.load(std::memory_order_relaxed);
+      evt.arg = arg.load(std::memory_order_relaxed);
+      evt.node = node.load(std::memory_order_relaxed);
+      evt.begin = begin.load(std::memory_order_relaxed);
+      evt.duration = duration.load(std::memory_order_relaxed);
+      evt.cat = cat.load(std::memory_order_relaxed);
+      return evt;
+    }
+  };
+
+  std::unique_ptr<slot[]> _slots;
+  std::size_t _num_slots;
+  std::atomic<std::uint64_t> _head;
+  std::size_t _thread_id;
+};
+
+class trace_recorder {
+public:
+  // Intentionally never destroyed, since threads may still record
+  // events during static destruction.
+  static trace_recorder& get() {
+    static trace_recorder* recorder = new trace_recorder{};
+    return *recorder;
+  }
+
+  void record(const event_record& evt) {
+    thread_local thread_buffer* buffer = nullptr;
+    if(!buffer) {
+      std::lock_guard<std::mutex> lock{_mutex};
+      _buffers.push_back(std::make_unique<thread_buffer>(
+          _buffer_size, _buffers.size() + 1));
+      buffer = _buffers.back().get();
+    }
+    buffer->push(evt);
+  }
+
+  void write(const std::string& filename) const {
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    std::ofstream file{filename, std::ios::out | std::ios::trunc};
+    if(!file.is_open()) {
+      HIPSYCL_DEBUG_ERROR << "tracing: Could not open trace file " << filename
+                          << std::endl;
+      return;
+    }
+
+    const int pid = get_process_id();
+    // Chrome trace timestamps are in microseconds
+    auto to_us = [](std::uint64_t ns) { return static_cast<double>(ns) * 1.e-3; };
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid
+         << ",\"args\":{\"name\":\"AdaptiveCpp runtime\"}}";
+
+    std::size_t num_events = 0;
+    for(const auto& buffer : _buffers) {
+      if(auto dropped = buffer->get_num_dropped_events(); dropped > 0) {
+        HIPSYCL_DEBUG_WARNING
+            << "tracing: " << dropped << " oldest events of thread "
+            << buffer->get_thread_id()
+            << " were overwritten, consider increasing ACPP_RT_TRACE_BUFFER_SIZE"
+            << std::endl;
+      }
+
+      buffer->for_each_event([&](const event_record& evt){
+        std::uint64_t begin = evt.begin > _origin ? evt.begin - _origin : 0;
+
+        file << ",\n{\"name\":\"" << evt.name << "\",\"cat\":\""
+             << get_category_name(evt.cat) << "\",";
+        if(evt.duration == instant_duration)
+          file << "\"ph\":\"i\",\"s\":\"t\",";
+        else
+          file << "\"ph\":\"X\",\"dur\":" << to_us(evt.duration) << ",";
+        file << "\"ts\":" << to_us(begin) << ",\"pid\":" << pid
+             << ",\"tid\":" << buffer->get_thread_id() << ",\"args\":{";
+        bool has_args = false;
+        if(evt.node != 0) {
+          file << "\"node\":" << evt.node;
+          has_args = true;
+        }
+        if(evt.arg_name) {
+          file << (has_args ? "," : "") << "\"" << evt.arg_name
+               << "\":" << evt.arg;
+        }
+        file << "}}";
+        ++num_events;
+      });
+    }
+    file << "\n]}\n";
+
+    HIPSYCL_DEBUG_INFO << "tracing: Wrote " << num_events
+                       << " events to " << filename << std::endl;
+  }
+private:
+  trace_recorder()
+  : _origin{now()}, _buffer_size{application::get_settings()
+                                     .get<setting::trace_buffer_size>()} {}
+
+  mutable std::mutex _mutex;
+  std::vector<std::unique_ptr<thread_buffer>> _buffers;
+  std::uint64_t _origin;
+  std::size_t _buffer_size;
+};
+
+thread_local std::uint64_t current_node = 0;
+
+void record(const char *name, category cat, std::uint64_t node,
+            std::uint64_t begin, std::uint64_t duration, const char *arg_name,
+            std::uint64_t arg) {
+  event_record evt;
+  evt.name = name;
+  evt.cat = cat;
+  evt.node = node != 0 ? node : current_node;
+  evt.begin = begin;
+  evt.duration = duration;
+  evt.arg_name = arg_name;
+  evt.arg = arg;
+  trace_recorder::get().record(evt);
+}
+
+}
+
+bool is_enabled() {
+  static const bool enabled =
+      !application::get_settings().get<setting::trace_file>().empty();
+  return enabled;
+}
+
+std::uint64_t make_node_id() {
+  static std::atomic<std::uint64_t> next_id = 1;
+  if(!is_enabled())
+    return 0;
+  return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+void instant(const char *name, category cat, std::uint64_t node,
+             const char *arg_name, std::uint64_t arg) {
+  if(is_enabled())
+    record(name, cat, node, now(), instant_duration, arg_name, arg);
+}
+
+scope::scope(const char *name, category cat, std::uint64_t node)
+    : _name{name}, _arg_name{nullptr}, _arg{0}, _node{node}, _begin{0},
+      _cat{cat}, _enabled{is_enabled()} {
+  if(_enabled)
+    _begin = now();
+}
+
+scope::scope(const char *name, category cat, const dag_node *node)
+    : scope{name, cat, node ? node->get_trace_id() : 0} {}
+
+scope::~scope() {
+  if(_enabled)
+    record(_name, _cat, _node, _begin, now() - _begin, _arg_name, _arg);
+}
+
+void scope::set_node(const dag_node* node) {
+  _node = node ? node->get_trace_id() : 0;
+}
+
+node_context::node_context(const dag_node *node)
+    : node_context{node ? node->get_trace_id() : 0} {}
+
+node_context::node_context(std::uint64_t node)
+    : _previous{0}, _enabled{is_enabled()} {
+  if(_enabled) {
+    _previous = current_node;
+    current_node = node;
+  }
+}
+
+node_context::~node_context() {
+  if(_enabled)
+    current_node = _previous;
+}
+
+void write_trace_file() {
+  if(is_enabled())
+    trace_recorder::get().write(
+        application::get_settings().get<setting::trace_file>());
+}
+
+}
+}
+}
@@ -22,6 +22,7 @@
 #include "hipSYCL/runtime/device_id.hpp"
 #include "hipSYCL/runtime/error.hpp"
 #include "hipSYCL/runtime/event.hpp"
+#include "hipSYCL/runtime/generic/object_pool.hpp"
 #include "hipSYCL/runtime/hints.hpp"
 #include "hipSYCL/runtime/inorder_queue.hpp"
 #include "hipSYCL/runtime/ze/ze_code_object.hpp"
@@ -215,11 +216,11 @@ std::shared_ptr<dag_node_event> ze_queue::create_event() {
     return nullptr;
   }
 
-  return std::make_shared<ze_node_event>(evt, pool);
+  return make_pooled_shared<ze_node_event>(evt, pool);
 }
 
 std::shared_ptr<dag_node_event> ze_queue::create_queue_completion_event() {
-  return std::make_shared<queue_completion_event<ze_event_handle_t, ze_node_event>>(
+  return make_pooled_shared<queue_completion_event<ze_event_handle_t, ze_node_event>>(
       this);
 }
 
@@ -0,0 +1,90 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+
+// Measures the page table operations that the scheduler issues for each
+// buffer access (intersections_with and entire_range_filled) on large
+// 3D page tables, for each range_store representation.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <hipSYCL/runtime/data.hpp>
+
+using namespace hipsycl;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+
+const char* get_name(rt::range_store::representation r) {
+  return r == rt::range_store::representation::dense ? "dense" : "bitmap";
+}
+
+template<class F>
+double measure_us(int num_iterations, F&& f) {
+  auto start = clock_type::now();
+  for(int i = 0; i < num_iterations; ++i)
+    f();
+  auto end = clock_type::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() /
+         num_iterations;
+}
+
+void run(rt::range<3> size, rt::range_store::representation representation,
+         int num_iterations) {
+  rt::range_store pt{size, representation};
+  rt::range_store::rect full_range{rt::id<3>{0, 0, 0}, size};
+
+  // Typical state after a kernel has written a subrange on another device:
+  // Most of the table is valid, with an outdated block in the middle.
+  pt.add(full_range);
+  rt::range_store::rect outdated{
+      rt::id<3>{size[0] / 4, size[1] / 4, size[2] / 4},
+      rt::range<3>{size[0] / 2, size[1] / 2, size[2] / 2}};
+  pt.remove(outdated);
+
+  std::vector<rt::range_store::rect> rects;
+  double intersection_time = measure_us(num_iterations, [&]() {
+    pt.intersections_with(full_range, rt::range_store::data_state::empty,
+                          rects);
+  });
+  std::size_t num_rects = rects.size();
+
+  double filled_time = measure_us(num_iterations, [&]() {
+    // Checks the entire valid region, which is the worst case
+    volatile bool filled = pt.entire_range_filled(rt::range_store::rect{
+        rt::id<3>{0, 0, 0}, rt::range<3>{size[0] / 4, size[1], size[2]}});
+    (void)filled;
+  });
+
+  std::cout << size[0] << "x" << size[1] << "x" << size[2] << " "
+            << get_name(representation)
+            << ": intersections_with " << intersection_time << " us ("
+            << num_rects << " rects), entire_range_filled " << filled_time
+            << " us" << std::endl;
+}
+
+}
+
+int main(int argc, char **argv) {
+  int num_iterations = 10;
+  if(argc > 1)
+    num_iterations = std::atoi(argv[1]);
+
+  for(rt::range<3> size : {rt::range<3>{16, 16, 16}, rt::range<3>{64, 64, 64},
+                           rt::range<3>{128, 128, 128},
+                           rt::range<3>{16, 256, 1024}}) {
+    for(auto r : {rt::range_store::representation::dense,
+                  rt::range_store::representation::bitmap})
+      run(size, r, num_iterations);
+  }
+}
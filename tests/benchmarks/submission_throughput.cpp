@@ -0,0 +1,80 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+
+// Measures how many empty kernels per second can be submitted and executed,
+// with one or more threads submitting to their own queue. This is
+// dominated by the runtime overhead per submission, e.g. DAG node,
+// operation and event creation.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <sycl/sycl.hpp>
+
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+
+void measure_throughput(const sycl::device &dev, int num_submitters,
+                        int kernels_per_submitter, bool in_order) {
+  std::vector<sycl::queue> queues;
+  for(int i = 0; i < num_submitters; ++i) {
+    if(in_order)
+      queues.emplace_back(dev, sycl::property::queue::in_order{});
+    else
+      queues.emplace_back(dev);
+  }
+
+  // Warm up, e.g. to trigger JIT compilation
+  for(auto& q : queues)
+    q.single_task([](){});
+  for(auto& q : queues)
+    q.wait();
+
+  auto start = clock_type::now();
+  std::vector<std::thread> submitters;
+  for(int i = 0; i < num_submitters; ++i) {
+    submitters.emplace_back([&, i]() {
+      for(int k = 0; k < kernels_per_submitter; ++k)
+        queues[i].single_task([](){});
+      queues[i].wait();
+    });
+  }
+  for(auto& t : submitters)
+    t.join();
+  auto end = clock_type::now();
+
+  double seconds = std::chrono::duration<double>(end - start).count();
+  double total = static_cast<double>(num_submitters) * kernels_per_submitter;
+  std::cout << (in_order ? "in-order" : "out-of-order") << " queues, "
+            << num_submitters << " submitting thread(s): "
+            << total / seconds << " kernels/s" << std::endl;
+}
+
+}
+
+int main(int argc, char **argv) {
+  int num_kernels = 100000;
+  if(argc > 1)
+    num_kernels = std::atoi(argv[1]);
+
+  sycl::device dev;
+  std::cout << "Device: " << dev.get_info<sycl::info::device::name>()
+            << std::endl;
+
+  for(bool in_order : {true, false})
+    for(int num_submitters : {1, 2, 4})
+      measure_throughput(dev, num_submitters, num_kernels / num_submitters,
+                         in_order);
+}
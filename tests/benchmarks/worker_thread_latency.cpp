@@ -0,0 +1,115 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+
+// Measures the latency between submitting an operation to
+// rt::worker_thread and the start of its execution, as well as the
+// throughput for many small operations.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <hipSYCL/runtime/generic/async_worker.hpp>
+
+using namespace hipsycl;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+
+double to_ns(clock_type::duration d) {
+  return std::chrono::duration<double, std::nano>(d).count();
+}
+
+void print_latency_statistics(const char *name, std::vector<double> &latencies) {
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&](double p) {
+    return latencies[static_cast<std::size_t>(p * (latencies.size() - 1))];
+  };
+  std::cout << name << ": median " << percentile(0.5) << " ns, p90 "
+            << percentile(0.9) << " ns, p99 " << percentile(0.99)
+            << " ns, max " << latencies.back() << " ns" << std::endl;
+}
+
+// Submit one operation at a time and wait for it, optionally with a pause in
+// between so that the worker becomes idle.
+void measure_latency(const char *name, int num_samples,
+                     std::chrono::microseconds pause) {
+  rt::worker_thread worker;
+  std::vector<double> latencies;
+  latencies.reserve(num_samples);
+
+  for(int i = 0; i < num_samples; ++i) {
+    std::atomic<bool> has_started = false;
+    clock_type::time_point start_time;
+    auto submission_time = clock_type::now();
+    worker([&]() {
+      start_time = clock_type::now();
+      has_started.store(true, std::memory_order_release);
+    });
+    while(!has_started.load(std::memory_order_acquire))
+      ;
+    latencies.push_back(to_ns(start_time - submission_time));
+    worker.wait();
+
+    if(pause.count() > 0)
+      std::this_thread::sleep_for(pause);
+  }
+  print_latency_statistics(name, latencies);
+}
+
+void measure_throughput(int num_producers, int ops_per_producer) {
+  rt::worker_thread worker;
+  std::atomic<std::size_t> counter = 0;
+
+  auto start = clock_type::now();
+  std::vector<std::thread> producers;
+  for(int p = 0; p < num_producers; ++p) {
+    producers.emplace_back([&]() {
+      for (int i = 0; i < ops_per_producer; ++i)
+        worker([&]() { counter.fetch_add(1, std::memory_order_relaxed); });
+    });
+  }
+  for(auto& t : producers)
+    t.join();
+  worker.wait();
+  auto end = clock_type::now();
+
+  std::size_t total = static_cast<std::size_t>(num_producers) * ops_per_producer;
+  if(counter.load() != total)
+    std::cout << "Error: Executed " << counter.load() << " operations, expected "
+              << total << std::endl;
+
+  std::cout << "throughput with " << num_producers
+            << " producer(s): " << to_ns(end - start) / total << " ns/op"
+            << std::endl;
+}
+
+}
+
+int main(int argc, char **argv) {
+  int num_samples = 10000;
+  if(argc > 1)
+    num_samples = std::atoi(argv[1]);
+
+  measure_latency("back-to-back latency", num_samples,
+                  std::chrono::microseconds{0});
+  measure_latency("latency after 20us idle", num_samples / 10,
+                  std::chrono::microseconds{20});
+  measure_latency("latency after 1ms idle", num_samples / 100,
+                  std::chrono::microseconds{1000});
+
+  for(int num_producers : {1, 2, 4})
+    measure_throughput(num_producers, 100 * num_samples / num_producers);
+}
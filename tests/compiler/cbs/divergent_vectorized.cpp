@@ -0,0 +1,59 @@
+// RUN: %acpp %s -o %t --acpp-targets=omp --acpp-use-accelerated-cpu -O
+// RUN: %t | FileCheck %s
+// RUN: %acpp %s -o %t --acpp-targets=generic -O
+// RUN: ACPP_VISIBILITY_MASK=omp; %t | FileCheck %s
+
+#include <iostream>
+#include <numeric>
+
+#include <CL/sycl.hpp>
+
+// Divergent control flow, a gather and a division in a masked block
+// within a wi-loop whose trip count is not a multiple of the vector width.
+int main()
+{
+  constexpr size_t local_size = 100;
+  constexpr size_t global_size = 200;
+
+  cl::sycl::queue queue;
+  std::vector<int> host_buf(global_size);
+  std::iota(host_buf.begin(), host_buf.end(), 0);
+
+  {
+    cl::sycl::buffer<int, 1> buf{host_buf.data(), host_buf.size()};
+
+    queue.submit([&](cl::sycl::handler &cgh) {
+      using namespace cl::sycl::access;
+      auto acc = buf.get_access<mode::read_write>(cgh);
+      auto scratch = cl::sycl::accessor<int, 1, mode::read_write, target::local>{local_size, cgh};
+
+      cgh.parallel_for<class divergent_vectorized>(
+        cl::sycl::nd_range<1>{global_size, local_size},
+        [=](cl::sycl::nd_item<1> item) noexcept {
+          const int lid = static_cast<int>(item.get_local_id(0));
+
+          scratch[lid] = acc[item.get_global_id()];
+          item.barrier();
+
+          int v = scratch[lid];
+          if(lid % 3 == 0)
+            v = scratch[(lid * 7) % local_size] / (lid + 1);
+          else if(lid % 3 == 1)
+            v = v * 2;
+          acc[item.get_global_id()] = v;
+        });
+    });
+  }
+  // CHECK: 0
+  // CHECK: 2
+  // CHECK: 2
+  // CHECK: 5
+  // CHECK: 0
+  // CHECK: 100
+  // CHECK: 30
+  // CHECK: 1
+  for(size_t i : {0, 1, 2, 3, 99, 100, 103, 199})
+    std::cout << host_buf[i] << "\n";
+  // CHECK: 19968
+  std::cout << std::accumulate(host_buf.begin(), host_buf.end(), 0) << "\n";
+}
@@ -243,4 +243,34 @@ BOOST_AUTO_TEST_CASE(multi_threaded) {
 }
 
 
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(pstl_small_objects)
+
+using hipsycl::stdpar::small_size_classes;
+
+BOOST_AUTO_TEST_CASE(size_class_round_trip) {
+  for(int c = 0; c < small_size_classes::num_classes; ++c) {
+    std::size_t size = small_size_classes::get_size(c);
+    // Small objects are carved back-to-back from slabs, so all class sizes
+    // must preserve the alignment of malloc()
+    BOOST_CHECK(size % 16 == 0);
+    BOOST_CHECK(size <= small_size_classes::max_size);
+    BOOST_CHECK(small_size_classes::get_class(size) == c);
+    if(c > 0)
+      BOOST_CHECK(small_size_classes::get_size(c - 1) < size);
+  }
+  BOOST_CHECK(small_size_classes::get_size(small_size_classes::num_classes -
+                                           1) == small_size_classes::max_size);
+
+  for(std::size_t size = 1; size <= small_size_classes::max_size; ++size) {
+    int c = small_size_classes::get_class(size);
+    BOOST_REQUIRE(c >= 0 && c < small_size_classes::num_classes);
+    // Each size must map to the smallest class that can hold it
+    BOOST_CHECK(small_size_classes::get_size(c) >= size);
+    if(c > 0)
+      BOOST_CHECK(small_size_classes::get_size(c - 1) < size);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
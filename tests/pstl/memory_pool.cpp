@@ -0,0 +1,256 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <boost/test/tools/old/interface.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/test/unit_test_suite.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+
+#include "pstl_test_suite.hpp"
+
+#ifndef __ACPP_STDPAR_ASSUME_SYSTEM_USM__
+
+BOOST_AUTO_TEST_SUITE(pstl_memory_pool)
+
+using pool_t = hipsycl::stdpar::memory_pool;
+
+constexpr std::size_t mb = 1024 * 1024;
+
+BOOST_AUTO_TEST_CASE(small_objects) {
+  pool_t pool{256 * mb};
+
+  constexpr std::size_t num_objects = 1000;
+  std::vector<void*> objects;
+  std::unordered_set<void*> unique_objects;
+  for(std::size_t i = 0; i < num_objects; ++i) {
+    void* ptr = pool.claim(24);
+    BOOST_REQUIRE(ptr);
+    BOOST_CHECK(reinterpret_cast<uint64_t>(ptr) % 16 == 0);
+    BOOST_CHECK(pool.is_from_pool(ptr));
+    objects.push_back(ptr);
+    unique_objects.insert(ptr);
+  }
+  BOOST_CHECK(unique_objects.size() == num_objects);
+
+  auto stats = pool.get_statistics();
+  BOOST_CHECK(stats.num_arenas == 1);
+  BOOST_CHECK(stats.slab_bytes > 0);
+  BOOST_CHECK(stats.claimed_bytes == stats.slab_bytes);
+  BOOST_CHECK(stats.num_fallback_allocations == 0);
+
+  for(void* ptr : objects)
+    pool.release(ptr, 24);
+
+  // Released objects are reused without claiming new slabs
+  for(std::size_t i = 0; i < num_objects; ++i) {
+    void* ptr = pool.claim(24);
+    BOOST_CHECK(unique_objects.find(ptr) != unique_objects.end());
+    objects[i] = ptr;
+  }
+  BOOST_CHECK(pool.get_statistics().slab_bytes == stats.slab_bytes);
+
+  for(void* ptr : objects)
+    pool.release(ptr, 24);
+}
+
+BOOST_AUTO_TEST_CASE(small_objects_across_threads) {
+  pool_t pool{256 * mb};
+  constexpr int num_threads = 4;
+  constexpr std::size_t num_objects = 20000;
+
+  std::vector<std::vector<void*>> objects(num_threads);
+  std::vector<std::thread> threads;
+  for(int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&, i]() {
+      for(std::size_t j = 0; j < num_objects; ++j)
+        objects[i].push_back(pool.claim(100));
+    });
+  }
+  for(auto& t : threads)
+    t.join();
+
+  std::unordered_set<void*> unique_objects;
+  for(const auto& thread_objects : objects)
+    for(void* ptr : thread_objects) {
+      BOOST_CHECK(ptr);
+      unique_objects.insert(ptr);
+    }
+  BOOST_CHECK(unique_objects.size() == num_threads * num_objects);
+
+  // Release the objects from other threads than the ones that claimed them,
+  // which moves surplus objects to the global lists.
+  threads.clear();
+  for(int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&, i]() {
+      for(void* ptr : objects[(i + 1) % num_threads])
+        pool.release(ptr, 100);
+    });
+  }
+  for(auto& t : threads)
+    t.join();
+
+  // All released objects have been returned to the global lists by now,
+  // so they can be claimed again without allocating new slabs.
+  std::size_t slab_bytes = pool.get_statistics().slab_bytes;
+  for(std::size_t j = 0; j < num_threads * num_objects; ++j)
+    BOOST_CHECK(pool.claim(100));
+  BOOST_CHECK(pool.get_statistics().slab_bytes == slab_bytes);
+}
+
+BOOST_AUTO_TEST_CASE(pools_do_not_share_thread_caches) {
+  pool_t pool_a{256 * mb};
+  pool_t pool_b{256 * mb};
+  constexpr std::size_t num_objects = 100;
+
+  // Fill the thread cache of this thread for pool_a
+  std::vector<void*> objects;
+  for(std::size_t i = 0; i < num_objects; ++i)
+    objects.push_back(pool_a.claim(48));
+  for(void* ptr : objects)
+    pool_a.release(ptr, 48);
+
+  for(std::size_t i = 0; i < num_objects; ++i) {
+    void* ptr = pool_b.claim(48);
+    BOOST_REQUIRE(ptr);
+    BOOST_CHECK(pool_b.is_from_pool(ptr));
+    BOOST_CHECK(!pool_a.is_from_pool(ptr));
+    objects[i] = ptr;
+  }
+  for(void* ptr : objects)
+    pool_b.release(ptr, 48);
+
+  for(std::size_t i = 0; i < num_objects; ++i) {
+    void* ptr = pool_a.claim(48);
+    BOOST_CHECK(pool_a.is_from_pool(ptr));
+    objects[i] = ptr;
+  }
+  for(void* ptr : objects)
+    pool_a.release(ptr, 48);
+}
+
+BOOST_AUTO_TEST_CASE(pool_destroyed_before_thread_exits) {
+  constexpr std::size_t num_objects = 100;
+  std::atomic<bool> pool_destroyed = false;
+  std::atomic<bool> objects_cached = false;
+  auto pool = std::make_unique<pool_t>(256 * mb);
+
+  // A thread whose cache still holds objects of the pool
+  // when the pool is destroyed
+  std::thread worker{[&]() {
+    std::vector<void*> objects;
+    for(std::size_t i = 0; i < num_objects; ++i)
+      objects.push_back(pool->claim(32));
+    for(void* ptr : objects)
+      pool->release(ptr, 32);
+    objects_cached = true;
+    while(!pool_destroyed)
+      std::this_thread::yield();
+  }};
+
+  while(!objects_cached)
+    std::this_thread::yield();
+  // Also leave objects in the cache of this thread
+  pool->release(pool->claim(32), 32);
+  pool.reset();
+  pool_destroyed = true;
+  worker.join();
+
+  // A new pool must not hand out cached objects of the previous one,
+  // even if it is created at the same address.
+  for(int i = 0; i < 2; ++i) {
+    pool = std::make_unique<pool_t>(256 * mb);
+    for(std::size_t j = 0; j < num_objects; ++j) {
+      void* ptr = pool->claim(32);
+      BOOST_REQUIRE(ptr);
+      BOOST_CHECK(pool->is_from_pool(ptr));
+    }
+    pool.reset();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(arena_growth) {
+  constexpr std::size_t max_size = 512 * mb;
+  pool_t pool{max_size};
+
+  constexpr std::size_t block_size = 16 * mb;
+  std::vector<void*> blocks;
+  // Claim more than fits into the initial arena
+  for(int i = 0; i < 12; ++i) {
+    void* ptr = pool.claim(block_size);
+    BOOST_REQUIRE(ptr);
+    BOOST_CHECK(pool.is_from_pool(ptr));
+    blocks.push_back(ptr);
+  }
+
+  auto stats = pool.get_statistics();
+  BOOST_CHECK(stats.num_arenas > 1);
+  BOOST_CHECK(stats.reserved_bytes <= max_size);
+  BOOST_CHECK(stats.claimed_bytes >= blocks.size() * block_size);
+  BOOST_CHECK(stats.requested_bytes == blocks.size() * block_size);
+  BOOST_CHECK(stats.num_fallback_allocations == 0);
+
+  for(void* ptr : blocks)
+    pool.release(ptr, block_size);
+
+  stats = pool.get_statistics();
+  BOOST_CHECK(stats.claimed_bytes == 0);
+  BOOST_CHECK(stats.requested_bytes == 0);
+
+  // Freed space is reused instead of adding arenas
+  std::size_t num_arenas = stats.num_arenas;
+  for(int i = 0; i < 12; ++i)
+    blocks[i] = pool.claim(block_size);
+  BOOST_CHECK(pool.get_statistics().num_arenas == num_arenas);
+  for(void* ptr : blocks)
+    pool.release(ptr, block_size);
+}
+
+BOOST_AUTO_TEST_CASE(fallback_counting) {
+  constexpr std::size_t max_size = 256 * mb;
+  pool_t pool{max_size};
+
+  // Allocations of at least half the pool size are never served by the pool
+  void* ptr = pool.claim(max_size / 2);
+  BOOST_CHECK(!ptr);
+
+  auto stats = pool.get_statistics();
+  BOOST_CHECK(stats.num_fallback_allocations == 1);
+  BOOST_CHECK(stats.fallback_bytes == max_size / 2);
+
+  // Exhaust the pool
+  std::vector<void*> blocks;
+  std::size_t block_size = 32 * mb;
+  while(void* block = pool.claim(block_size))
+    blocks.push_back(block);
+
+  stats = pool.get_statistics();
+  BOOST_CHECK(stats.reserved_bytes <= max_size);
+  BOOST_CHECK(stats.num_fallback_allocations == 2);
+  BOOST_CHECK(stats.fallback_bytes == max_size / 2 + block_size);
+
+  for(void* block : blocks)
+    pool.release(block, block_size);
+
+  pool_t disabled_pool{0};
+  BOOST_CHECK(!disabled_pool.claim(64));
+  BOOST_CHECK(disabled_pool.get_statistics().num_fallback_allocations == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
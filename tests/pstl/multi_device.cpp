@@ -0,0 +1,189 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <algorithm>
+#include <execution>
+#include <numeric>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "pstl_test_suite.hpp"
+
+// These tests only split operations across devices if the multi-device
+// dispatch is enabled, e.g. by running them with ACPP_STDPAR_MULTI_DEVICE=1
+// and ACPP_RT_OMP_SUB_DEVICES=2. Otherwise, they run on a single device.
+BOOST_FIXTURE_TEST_SUITE(pstl_multi_device, enable_unified_shared_memory)
+
+// Large enough to be split into multiple partitions
+constexpr std::size_t problem_size = 1 << 20;
+// The dispatch only splits operations once it has measured the throughput
+// of the devices, so run each operation a couple of times.
+constexpr int num_iterations = 4;
+
+std::vector<long long> make_data(std::size_t size) {
+  std::vector<long long> data(size);
+  for(std::size_t i = 0; i < size; ++i)
+    data[i] = static_cast<long long>(i % 1000);
+  return data;
+}
+
+template<class Policy>
+void test_for_each(Policy&& pol) {
+  std::vector<long long> data = make_data(problem_size);
+  for(int it = 0; it < num_iterations; ++it)
+    std::for_each(pol, data.begin(), data.end(), [=](auto &x) { x += 3; });
+  for(std::size_t i = 0; i < data.size(); ++i)
+    BOOST_REQUIRE(data[i] == static_cast<long long>(i % 1000) +
+                                 3 * num_iterations);
+
+  std::for_each_n(pol, data.begin(), data.size() / 2,
+                  [=](auto &x) { x = -x; });
+  for(std::size_t i = 0; i < data.size(); ++i) {
+    long long expected = static_cast<long long>(i % 1000) + 3 * num_iterations;
+    BOOST_REQUIRE(data[i] == (i < data.size() / 2 ? -expected : expected));
+  }
+}
+
+template<class Policy>
+void test_transform(Policy&& pol) {
+  std::vector<long long> input = make_data(problem_size);
+  std::vector<long long> output(problem_size);
+  for(int it = 0; it < num_iterations; ++it) {
+    std::transform(pol, input.begin(), input.end(), output.begin(),
+                   [=](auto x) { return x * 2 + it; });
+    for(std::size_t i = 0; i < output.size(); ++i)
+      BOOST_REQUIRE(output[i] == input[i] * 2 + it);
+  }
+
+  std::transform(pol, input.begin(), input.end(), output.begin(),
+                 output.begin(), [](auto x, auto y) { return x + y; });
+  for(std::size_t i = 0; i < output.size(); ++i)
+    BOOST_REQUIRE(output[i] == input[i] * 3 + num_iterations - 1);
+}
+
+template<class Policy>
+void test_reduce(Policy&& pol) {
+  std::vector<long long> data = make_data(problem_size);
+  for(int it = 0; it < num_iterations; ++it) {
+    // Modify the data first, so that the reduction depends on
+    // outstanding operations
+    std::for_each(pol, data.begin(), data.end(), [=](auto &x) { x += 1; });
+    // The initial value must only be applied once
+    long long reference = std::reduce(data.begin(), data.end(), 42ll);
+    BOOST_CHECK(std::reduce(pol, data.begin(), data.end(), 42ll) ==
+                reference);
+
+    long long reference_max =
+        std::reduce(data.begin(), data.end(), -1ll,
+                    [](auto a, auto b) { return std::max(a, b); });
+    BOOST_CHECK(std::reduce(pol, data.begin(), data.end(), -1ll,
+                            [](auto a, auto b) { return std::max(a, b); }) ==
+                reference_max);
+
+    long long reference_sq = std::transform_reduce(
+        data.begin(), data.end(), 0ll, std::plus<>{},
+        [](auto x) { return x * x; });
+    BOOST_CHECK(std::transform_reduce(pol, data.begin(), data.end(), 0ll,
+                                      std::plus<>{},
+                                      [](auto x) { return x * x; }) ==
+                reference_sq);
+
+    long long reference_dot =
+        std::transform_reduce(data.begin(), data.end(), data.begin(), 7ll);
+    BOOST_CHECK(std::transform_reduce(pol, data.begin(), data.end(),
+                                      data.begin(), 7ll) == reference_dot);
+  }
+}
+
+template<class Policy>
+void test_inclusive_scan(Policy&& pol) {
+  std::vector<long long> data = make_data(problem_size);
+  std::vector<long long> reference(problem_size);
+  std::vector<long long> output(problem_size);
+  for(int it = 0; it < num_iterations; ++it) {
+    std::inclusive_scan(data.begin(), data.end(), reference.begin());
+    std::inclusive_scan(pol, data.begin(), data.end(), output.begin());
+    BOOST_CHECK(output == reference);
+
+    // The initial value must only be applied to the first partition
+    std::inclusive_scan(data.begin(), data.end(), reference.begin(),
+                        std::plus<>{}, 10ll);
+    std::inclusive_scan(pol, data.begin(), data.end(), output.begin(),
+                        std::plus<>{}, 10ll);
+    BOOST_CHECK(output == reference);
+  }
+}
+
+template<class Policy>
+void test_transform_inclusive_scan(Policy&& pol) {
+  std::vector<long long> data = make_data(problem_size);
+  std::vector<long long> reference(problem_size);
+  std::vector<long long> output(problem_size);
+  auto square = [](auto x) { return x * x; };
+  for(int it = 0; it < num_iterations; ++it) {
+    std::transform_inclusive_scan(data.begin(), data.end(), reference.begin(),
+                                  std::plus<>{}, square);
+    std::transform_inclusive_scan(pol, data.begin(), data.end(),
+                                  output.begin(), std::plus<>{}, square);
+    BOOST_CHECK(output == reference);
+
+    std::transform_inclusive_scan(data.begin(), data.end(), reference.begin(),
+                                  std::plus<>{}, square, 10ll);
+    std::transform_inclusive_scan(pol, data.begin(), data.end(),
+                                  output.begin(), std::plus<>{}, square, 10ll);
+    BOOST_CHECK(output == reference);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(par_unseq_for_each) {
+  test_for_each(std::execution::par_unseq);
+}
+
+BOOST_AUTO_TEST_CASE(par_unseq_transform) {
+  test_transform(std::execution::par_unseq);
+}
+
+BOOST_AUTO_TEST_CASE(par_unseq_reduce) {
+  test_reduce(std::execution::par_unseq);
+}
+
+BOOST_AUTO_TEST_CASE(par_unseq_inclusive_scan) {
+  test_inclusive_scan(std::execution::par_unseq);
+}
+
+BOOST_AUTO_TEST_CASE(par_unseq_transform_inclusive_scan) {
+  test_transform_inclusive_scan(std::execution::par_unseq);
+}
+
+
+
+BOOST_AUTO_TEST_CASE(par_for_each) {
+  test_for_each(std::execution::par);
+}
+
+BOOST_AUTO_TEST_CASE(par_transform) {
+  test_transform(std::execution::par);
+}
+
+BOOST_AUTO_TEST_CASE(par_reduce) {
+  test_reduce(std::execution::par);
+}
+
+BOOST_AUTO_TEST_CASE(par_inclusive_scan) {
+  test_inclusive_scan(std::execution::par);
+}
+
+BOOST_AUTO_TEST_CASE(par_transform_inclusive_scan) {
+  test_transform_inclusive_scan(std::execution::par);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
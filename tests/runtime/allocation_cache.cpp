@@ -0,0 +1,123 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "runtime_test_suite.hpp"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <hipSYCL/algorithms/util/allocation_cache.hpp>
+
+using namespace hipsycl;
+
+namespace {
+
+rt::device_id get_host_device() {
+  return rt::device_id{rt::backend_descriptor{rt::hardware_platform::cpu,
+                                              rt::api_platform::omp},
+                       0};
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(allocation_cache)
+BOOST_AUTO_TEST_CASE(allocations_are_reused_within_size_class) {
+  algorithms::util::allocation_cache cache{
+      algorithms::util::allocation_type::host, 0};
+
+  void* first_ptr = nullptr;
+  {
+    algorithms::util::allocation_group group{&cache, get_host_device()};
+    first_ptr = group.obtain<float>(1000);
+    BOOST_REQUIRE(first_ptr);
+    BOOST_CHECK(cache.get_statistics().bytes_in_use == 4096);
+  }
+  auto stats = cache.get_statistics();
+  BOOST_CHECK(stats.num_misses == 1);
+  BOOST_CHECK(stats.bytes_held == 4096);
+  BOOST_CHECK(stats.bytes_in_use == 0);
+
+  {
+    // Same size class (4 KiB)
+    algorithms::util::allocation_group group{&cache, get_host_device()};
+    BOOST_CHECK(group.obtain<char>(3000) == first_ptr);
+    // Different size class
+    BOOST_CHECK(group.obtain<char>(5000) != first_ptr);
+    BOOST_CHECK(reinterpret_cast<std::uintptr_t>(group.obtain<double>(1)) %
+                    alignof(double) == 0);
+  }
+  stats = cache.get_statistics();
+  BOOST_CHECK(stats.num_hits == 1);
+  BOOST_CHECK(stats.num_misses == 3);
+
+  cache.purge();
+  stats = cache.get_statistics();
+  BOOST_CHECK(stats.bytes_held == 0);
+  BOOST_CHECK(stats.num_trimmed == 3);
+}
+
+BOOST_AUTO_TEST_CASE(large_allocations_use_fine_size_classes) {
+  algorithms::util::allocation_cache cache{
+      algorithms::util::allocation_type::host, 0};
+
+  const std::size_t mib = 1024 * 1024;
+  void* first_ptr = nullptr;
+  {
+    algorithms::util::allocation_group group{&cache, get_host_device()};
+    // Rounded up to 1.25 MiB instead of 2 MiB
+    first_ptr = group.obtain<char>(mib + 1);
+    BOOST_REQUIRE(first_ptr);
+    BOOST_CHECK(cache.get_statistics().bytes_in_use == mib + mib / 4);
+  }
+  {
+    algorithms::util::allocation_group group{&cache, get_host_device()};
+    // Same size class
+    BOOST_CHECK(group.obtain<char>(mib + mib / 8) == first_ptr);
+    // Next size class (1.5 MiB)
+    BOOST_CHECK(group.obtain<char>(mib + mib / 4 + 1) != first_ptr);
+    BOOST_CHECK(cache.get_statistics().bytes_in_use ==
+                mib + mib / 4 + mib + mib / 2);
+  }
+  // Power of two sizes map to the same size class as before
+  {
+    algorithms::util::allocation_group group{&cache, get_host_device()};
+    group.obtain<char>(2 * mib);
+    BOOST_CHECK(cache.get_statistics().bytes_in_use == 2 * mib);
+  }
+  cache.purge();
+  BOOST_CHECK(cache.get_statistics().bytes_held == 0);
+}
+
+BOOST_AUTO_TEST_CASE(unused_allocations_are_trimmed_to_high_water_mark) {
+  const std::size_t max_held_bytes = 64 * 1024;
+  algorithms::util::allocation_cache cache{
+      algorithms::util::allocation_type::host, max_held_bytes};
+
+  std::vector<std::thread> threads;
+  for(int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t]() {
+      for(int i = 0; i < 100; ++i) {
+        algorithms::util::allocation_group group{&cache, get_host_device()};
+        group.obtain<char>(1024 << ((t + i) % 6));
+        group.obtain<char>(100);
+      }
+    });
+  }
+  for(auto& t : threads)
+    t.join();
+
+  auto stats = cache.get_statistics();
+  BOOST_CHECK(stats.bytes_held <= max_held_bytes);
+  BOOST_CHECK(stats.bytes_in_use == 0);
+  BOOST_CHECK(stats.num_hits + stats.num_misses == 800);
+  BOOST_CHECK(stats.num_hits > 0);
+}
+BOOST_AUTO_TEST_SUITE_END()
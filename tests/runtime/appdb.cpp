@@ -0,0 +1,141 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "runtime_test_suite.hpp"
+
+#include <filesystem>
+#include <string>
+#include <unistd.h>
+#include <hipSYCL/common/appdb.hpp>
+
+using namespace hipsycl;
+
+BOOST_AUTO_TEST_SUITE(appdb)
+BOOST_AUTO_TEST_CASE(concurrent_writers_are_merged) {
+  std::string path = (std::filesystem::temp_directory_path() /
+                      ("acpp-appdb-test-" + std::to_string(::getpid()) + ".db"))
+                         .string();
+  std::filesystem::remove(path);
+
+  rt::kernel_configuration::id_type kernel_id{1, 2};
+  rt::kernel_configuration::id_type binary_a{3, 4};
+  rt::kernel_configuration::id_type binary_b{5, 6};
+
+  auto register_invocations = [&](common::db::appdb &db, uint64_t value,
+                                  int num_invocations) {
+    db.read_write_access([&](common::db::appdb_data &data) {
+      auto &entry = data.kernels[kernel_id];
+      entry.kernel_args.resize(1);
+      auto &statistics = entry.kernel_args[0].common_values[0];
+      statistics.value = value;
+      for(int i = 0; i < num_invocations; ++i) {
+        ++entry.num_registered_invocations;
+        ++statistics.count;
+        statistics.last_used = entry.num_registered_invocations;
+      }
+    });
+  };
+
+  {
+    // Simulates two processes that load the same db state
+    common::db::appdb first{path};
+    common::db::appdb second{path};
+
+    register_invocations(first, 42, 10);
+    first.read_write_access([&](common::db::appdb_data &data) {
+      data.binaries[binary_a].jit_cache_filename = "a";
+    });
+    first.flush();
+    // Incremental flush: Must not count the same invocations twice
+    register_invocations(first, 42, 5);
+    first.flush();
+
+    register_invocations(second, 42, 7);
+    second.read_write_access([&](common::db::appdb_data &data) {
+      data.binaries[binary_b].jit_cache_filename = "b";
+    });
+  }
+
+  common::db::appdb result{path};
+  result.read_access([&](const common::db::appdb_data &data) {
+    BOOST_CHECK(data.content_version == 2);
+    BOOST_CHECK(data.binaries.count(binary_a) == 1);
+    BOOST_CHECK(data.binaries.count(binary_b) == 1);
+
+    auto kernel = data.kernels.find(kernel_id);
+    BOOST_REQUIRE(kernel != data.kernels.end());
+    BOOST_CHECK(kernel->second.num_registered_invocations == 22);
+
+    const auto &values = kernel->second.kernel_args[0].common_values;
+    uint64_t count = 0;
+    for(const auto &v : values)
+      if(v.value == 42)
+        count += v.count;
+    BOOST_CHECK(count == 22);
+  });
+
+  std::filesystem::remove(path);
+  std::filesystem::remove(path + ".lock");
+}
+BOOST_AUTO_TEST_CASE(concurrent_stdpar_samples_are_merged) {
+  std::string path =
+      (std::filesystem::temp_directory_path() /
+       ("acpp-appdb-stdpar-test-" + std::to_string(::getpid()) + ".db"))
+          .string();
+  std::filesystem::remove(path);
+
+  const uint64_t op_hash = 1234;
+  const uint64_t bucket = 1024;
+
+  auto add_samples = [&](common::db::appdb &db, int num_samples,
+                         uint64_t runtime) {
+    db.read_write_access([&](common::db::appdb_data &data) {
+      auto &sample =
+          data.stdpar_datasets["test"].ops[op_hash].offload_samples[bucket];
+      for(int i = 0; i < num_samples; ++i) {
+        sample.total_problem_size += bucket;
+        sample.total_runtime += runtime;
+        ++sample.num_samples;
+      }
+    });
+  };
+
+  {
+    common::db::appdb first{path};
+    common::db::appdb second{path};
+
+    add_samples(first, 3, 100);
+    first.flush();
+    add_samples(first, 1, 100);
+    first.flush();
+
+    add_samples(second, 2, 400);
+  }
+
+  common::db::appdb result{path};
+  result.read_access([&](const common::db::appdb_data &data) {
+    auto dataset = data.stdpar_datasets.find("test");
+    BOOST_REQUIRE(dataset != data.stdpar_datasets.end());
+    auto op = dataset->second.ops.find(op_hash);
+    BOOST_REQUIRE(op != dataset->second.ops.end());
+    BOOST_CHECK(op->second.host_samples.empty());
+
+    auto sample = op->second.offload_samples.find(bucket);
+    BOOST_REQUIRE(sample != op->second.offload_samples.end());
+    BOOST_CHECK(sample->second.num_samples == 6);
+    BOOST_CHECK(sample->second.total_problem_size == 6 * bucket);
+    BOOST_CHECK(sample->second.total_runtime == 4 * 100 + 2 * 400);
+  });
+
+  std::filesystem::remove(path);
+  std::filesystem::remove(path + ".lock");
+}
+BOOST_AUTO_TEST_SUITE_END()
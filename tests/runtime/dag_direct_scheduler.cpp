@@ -0,0 +1,306 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "runtime_test_suite.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <hipSYCL/glue/kernel_launcher_data.hpp>
+#include <hipSYCL/runtime/application.hpp>
+#include <hipSYCL/runtime/backend.hpp>
+#include <hipSYCL/runtime/dag_direct_scheduler.hpp>
+#include <hipSYCL/runtime/dag_manager.hpp>
+#include <hipSYCL/runtime/kernel_launcher.hpp>
+#include <hipSYCL/runtime/runtime.hpp>
+#include <hipSYCL/runtime/settings.hpp>
+
+using namespace hipsycl;
+
+namespace {
+
+rt::backend_descriptor host_backend{rt::hardware_platform::cpu,
+                                    rt::api_platform::omp};
+
+rt::device_id make_device(int id) {
+  return rt::device_id{host_backend, id};
+}
+
+rt::update_region make_region(rt::id<3> offset, rt::range<3> size,
+                              std::vector<rt::device_id> sources) {
+  rt::update_region region;
+  region.rect = std::make_pair(offset, size);
+  for(const auto& source : sources)
+    region.sources.push_back(source);
+  return region;
+}
+
+std::vector<rt::update_region>
+sorted_by_offset(std::vector<rt::update_region> regions) {
+  std::sort(regions.begin(), regions.end(),
+            [](const rt::update_region &a, const rt::update_region &b) {
+              for(int i = 0; i < 3; ++i)
+                if(a.rect.first[i] != b.rect.first[i])
+                  return a.rect.first[i] < b.rect.first[i];
+              return false;
+            });
+  return regions;
+}
+
+// Completes once released, to hold back operations that depend on it
+class gate_event : public rt::dag_node_event {
+public:
+  bool is_complete() const override { return _is_released; }
+
+  void wait() override {
+    while(!_is_released)
+      std::this_thread::sleep_for(std::chrono::milliseconds{1});
+  }
+
+  void release() { _is_released = true; }
+private:
+  std::atomic<bool> _is_released = false;
+};
+
+template<rt::setting S>
+class scoped_setting {
+public:
+  using value_type = typename rt::setting_trait<S>::type;
+
+  scoped_setting(const value_type& v)
+  : _old_value{rt::application::get_settings().get<S>()} {
+    rt::application::get_settings().set<S>(v);
+  }
+
+  ~scoped_setting() {
+    rt::application::get_settings().set<S>(_old_value);
+  }
+private:
+  value_type _old_value;
+};
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(dag_direct_scheduler, reset_device_fixture)
+
+BOOST_AUTO_TEST_CASE(coalesce_adjacent_regions) {
+  rt::device_id dev = make_device(0);
+
+  // Out-of-order pages of a 1D buffer
+  std::vector<rt::update_region> regions{
+      make_region({0, 0, 512}, {1, 1, 256}, {dev}),
+      make_region({0, 0, 0}, {1, 1, 256}, {dev}),
+      make_region({0, 0, 256}, {1, 1, 256}, {dev})};
+  rt::coalesce_regions(regions);
+  BOOST_REQUIRE(regions.size() == 1);
+  BOOST_CHECK(regions[0].rect.first == (rt::id<3>{0, 0, 0}));
+  BOOST_CHECK(regions[0].rect.second == (rt::range<3>{1, 1, 768}));
+  BOOST_REQUIRE(regions[0].sources.size() == 1);
+  BOOST_CHECK(regions[0].sources[0] == dev);
+
+  // 2x2 pages of a 2D buffer are first merged into rows, then the rows
+  // into a single region.
+  regions = {make_region({0, 0, 0}, {1, 16, 16}, {dev}),
+             make_region({0, 0, 16}, {1, 16, 16}, {dev}),
+             make_region({0, 16, 0}, {1, 16, 16}, {dev}),
+             make_region({0, 16, 16}, {1, 16, 16}, {dev})};
+  rt::coalesce_regions(regions);
+  BOOST_REQUIRE(regions.size() == 1);
+  BOOST_CHECK(regions[0].rect.first == (rt::id<3>{0, 0, 0}));
+  BOOST_CHECK(regions[0].rect.second == (rt::range<3>{1, 32, 32}));
+}
+
+BOOST_AUTO_TEST_CASE(coalesce_non_adjacent_regions) {
+  rt::device_id dev = make_device(0);
+
+  // Gap between the regions
+  std::vector<rt::update_region> regions{
+      make_region({0, 0, 0}, {1, 1, 256}, {dev}),
+      make_region({0, 0, 512}, {1, 1, 256}, {dev})};
+  rt::coalesce_regions(regions);
+  BOOST_CHECK(regions.size() == 2);
+
+  // Adjacent in the slow dimension, but with different extents in the
+  // fast dimension
+  regions = {make_region({0, 0, 0}, {1, 16, 32}, {dev}),
+             make_region({0, 16, 0}, {1, 16, 16}, {dev})};
+  rt::coalesce_regions(regions);
+  BOOST_CHECK(regions.size() == 2);
+
+  // Same extent, but shifted in the fast dimension
+  regions = {make_region({0, 0, 0}, {1, 16, 16}, {dev}),
+             make_region({0, 16, 16}, {1, 16, 16}, {dev})};
+  rt::coalesce_regions(regions);
+  BOOST_CHECK(regions.size() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(coalesce_mixed_source_regions) {
+  rt::device_id dev0 = make_device(0);
+  rt::device_id dev1 = make_device(1);
+  rt::device_id dev2 = make_device(2);
+
+  // Adjacent regions that are only valid on different devices
+  // must not be merged.
+  std::vector<rt::update_region> regions{
+      make_region({0, 0, 0}, {1, 1, 256}, {dev0}),
+      make_region({0, 0, 256}, {1, 1, 256}, {dev1}),
+      make_region({0, 0, 512}, {1, 1, 256}, {dev0}),
+      make_region({0, 0, 768}, {1, 1, 256}, {dev1})};
+  rt::coalesce_regions(regions);
+  BOOST_CHECK(regions.size() == 4);
+
+  // Regions sharing some sources are merged, and the merged region
+  // only keeps the common sources.
+  regions = {make_region({0, 0, 0}, {1, 1, 256}, {dev0, dev1}),
+             make_region({0, 0, 256}, {1, 1, 256}, {dev1, dev2}),
+             make_region({0, 0, 512}, {1, 1, 256}, {dev2})};
+  rt::coalesce_regions(regions);
+  regions = sorted_by_offset(regions);
+  BOOST_REQUIRE(regions.size() == 2);
+  BOOST_CHECK(regions[0].rect.first == (rt::id<3>{0, 0, 0}));
+  BOOST_CHECK(regions[0].rect.second == (rt::range<3>{1, 1, 512}));
+  BOOST_REQUIRE(regions[0].sources.size() == 1);
+  BOOST_CHECK(regions[0].sources[0] == dev1);
+  BOOST_CHECK(regions[1].rect.first == (rt::id<3>{0, 0, 512}));
+  BOOST_CHECK(regions[1].rect.second == (rt::range<3>{1, 1, 256}));
+  BOOST_REQUIRE(regions[1].sources.size() == 1);
+  BOOST_CHECK(regions[1].sources[0] == dev2);
+}
+
+BOOST_AUTO_TEST_CASE(split_regions) {
+  std::vector<rt::range_store::rect> chunks;
+  rt::range_store::rect region =
+      std::make_pair(rt::id<3>{0, 0, 100}, rt::range<3>{1, 1, 10});
+  rt::split_region(region, 3, chunks);
+  BOOST_REQUIRE(chunks.size() == 3);
+  std::size_t expected_offset = 100;
+  for(const auto& chunk : chunks) {
+    BOOST_CHECK(chunk.first[2] == expected_offset);
+    BOOST_CHECK(chunk.second[2] >= 3 && chunk.second[2] <= 4);
+    expected_offset += chunk.second[2];
+  }
+  BOOST_CHECK(expected_offset == 110);
+
+  // There are never more chunks than elements, and always at least one
+  chunks.clear();
+  rt::split_region(region, 100, chunks);
+  BOOST_CHECK(chunks.size() == 10);
+  chunks.clear();
+  rt::split_region(region, 0, chunks);
+  BOOST_REQUIRE(chunks.size() == 1);
+  BOOST_CHECK(chunks[0] == region);
+
+  // Multi-dimensional regions are split along the slowest dimension
+  // with more than one element, so that the chunks remain contiguous.
+  chunks.clear();
+  region = std::make_pair(rt::id<3>{0, 4, 0}, rt::range<3>{1, 8, 64});
+  rt::split_region(region, 4, chunks);
+  BOOST_REQUIRE(chunks.size() == 4);
+  for(std::size_t i = 0; i < chunks.size(); ++i) {
+    BOOST_CHECK(chunks[i].first == (rt::id<3>{0, 4 + 2 * i, 0}));
+    BOOST_CHECK(chunks[i].second == (rt::range<3>{1, 2, 64}));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(chunked_transfers) {
+  rt::runtime_keep_alive_token rt;
+  rt::device_id host_device = make_device(0);
+  // Imaginary devices that are never submitted to. Since CPU devices can
+  // transfer data between each other with plain memcpy, they act as update
+  // sources that are distinct from host_device.
+  rt::device_id source0 = make_device(1234);
+  rt::device_id source1 = make_device(1235);
+
+  // Chunks are assigned to sources based on the built-in estimates
+  scoped_setting<rt::setting::memcpy_calibration> no_calibration{false};
+
+  const std::size_t num_elements = 4096;
+  const std::size_t chunk_size = num_elements * sizeof(int) / 8;
+  scoped_setting<rt::setting::memcpy_chunk_size> small_chunks{chunk_size};
+
+  std::vector<int> memory0(num_elements);
+  std::vector<int> memory1(num_elements);
+  for(std::size_t i = 0; i < num_elements; ++i) {
+    memory0[i] = static_cast<int>(i);
+    memory1[i] = -static_cast<int>(i);
+  }
+
+  rt::backend_allocator *allocator =
+      rt.get()->backends().get(rt::backend_id::omp)->get_allocator(host_device);
+  auto data = std::make_shared<rt::buffer_data_region>(
+      rt::range<3>{1, 1, num_elements}, sizeof(int),
+      rt::range<3>{1, 1, num_elements / 2});
+  // The first half is only valid on source0, the second half on source1
+  data->add_nonempty_allocation(source0, memory0.data(), allocator, false);
+  data->add_empty_allocation(source1, memory1.data(), allocator, false);
+  data->mark_range_current(source1, rt::id<3>{0, 0, num_elements / 2},
+                           rt::range<3>{1, 1, num_elements / 2});
+
+  rt::execution_hints hints;
+  hints.set_hint(rt::hints::bind_to_device{host_device});
+
+  // Transfer nodes are only referenced weakly once they have completed,
+  // so keep them from completing until they have been counted.
+  // The gate is bound to a device of another backend, so that executors
+  // synchronize with it by waiting for its event.
+  rt::device_id gate_device{
+      rt::backend_descriptor{rt::hardware_platform::ocl, rt::api_platform::ocl},
+      0};
+  rt::execution_hints gate_hints;
+  gate_hints.set_hint(rt::hints::bind_to_device{gate_device});
+
+  auto gate = std::make_shared<gate_event>();
+  auto gate_node = rt::make_pooled_shared<rt::dag_node>(
+      gate_hints, rt::node_list_t{},
+      rt::make_operation<rt::kernel_operation>(
+          "gate",
+          rt::kernel_launcher{
+              glue::kernel_launcher_data{},
+              common::auto_small_vector<
+                  std::unique_ptr<rt::backend_kernel_launcher>>{}},
+          rt::requirements_list{rt.get()}),
+      rt.get());
+  gate_node->assign_to_device(gate_device);
+  gate_node->mark_submitted(gate);
+
+  rt::dag_node_ptr node;
+  {
+    rt::dag_build_guard build{rt.get()->dag()};
+    auto req = rt::make_operation<rt::buffer_memory_requirement>(
+        data, rt::id<3>{0, 0, 0}, data->get_num_elements(),
+        sycl::access::mode::read, sycl::access::target::device);
+    rt::requirements_list reqs{rt.get()};
+    reqs.add_node_requirement(gate_node);
+    node = build.builder()->add_explicit_mem_requirement(std::move(req), reqs,
+                                                         hints);
+  }
+  rt.get()->dag().flush_sync();
+
+  // Each half is transferred from its own source in multiple chunks,
+  // which are submitted as separate nodes.
+  BOOST_CHECK(node->get_requirements().size() == 8);
+  gate->release();
+  node->wait();
+
+  auto *req = static_cast<rt::buffer_memory_requirement *>(node->get_operation());
+  BOOST_REQUIRE(req->has_device_ptr());
+  int *result = static_cast<int *>(req->get_device_ptr());
+  for(std::size_t i = 0; i < num_elements; ++i) {
+    int expected = (i < num_elements / 2) ? static_cast<int>(i)
+                                          : -static_cast<int>(i);
+    BOOST_REQUIRE(result[i] == expected);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,107 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "runtime_test_suite.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <hipSYCL/runtime/dag_submitted_ops.hpp>
+
+using namespace hipsycl;
+
+namespace {
+
+class test_event : public rt::dag_node_event {
+public:
+  bool is_complete() const override { return _is_complete; }
+
+  void wait() override {
+    while(!_is_complete)
+      std::this_thread::yield();
+  }
+
+  void complete() { _is_complete = true; }
+private:
+  std::atomic<bool> _is_complete = false;
+};
+
+rt::dag_node_ptr make_submitted_node(std::size_t node_group,
+                                     std::shared_ptr<test_event> evt) {
+  rt::execution_hints hints;
+  hints.set_hint(rt::hints::node_group{node_group});
+  auto node =
+      std::make_shared<rt::dag_node>(hints, rt::node_list_t{}, nullptr, nullptr);
+  node->mark_submitted(evt);
+  return node;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(dag_submitted_ops)
+BOOST_AUTO_TEST_CASE(completed_nodes_are_retired_on_submission) {
+  rt::dag_submitted_ops ops;
+
+  std::vector<std::shared_ptr<test_event>> events;
+  for(int i = 0; i < 3; ++i) {
+    events.push_back(std::make_shared<test_event>());
+    ops.update_with_submission(make_submitted_node(1, events.back()));
+  }
+  BOOST_CHECK(ops.get_num_nodes() == 3);
+
+  events[0]->complete();
+  events[1]->complete();
+  auto evt = std::make_shared<test_event>();
+  ops.update_with_submission(make_submitted_node(1, evt));
+  BOOST_CHECK(ops.get_num_nodes() == 2);
+  BOOST_CHECK(ops.get_group(1).size() == 2);
+
+  events[2]->complete();
+  evt->complete();
+  ops.wait_for_all();
+  BOOST_CHECK(ops.get_num_nodes() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(waiting_for_group_ignores_other_groups) {
+  rt::dag_submitted_ops ops;
+
+  auto pending_evt = std::make_shared<test_event>();
+  auto pending_node = make_submitted_node(1, pending_evt);
+  ops.update_with_submission(pending_node);
+
+  // Complete out of submission order: The newest node does not depend on
+  // the older one, which therefore needs to be waited on separately.
+  auto older_evt = std::make_shared<test_event>();
+  auto newer_evt = std::make_shared<test_event>();
+  ops.update_with_submission(make_submitted_node(2, older_evt));
+  ops.update_with_submission(make_submitted_node(2, newer_evt));
+  newer_evt->complete();
+
+  std::thread completer{[&](){
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    older_evt->complete();
+  }};
+  ops.wait_for_group(2);
+  completer.join();
+
+  BOOST_CHECK(older_evt->is_complete());
+  BOOST_CHECK(ops.get_group(2).empty());
+  BOOST_CHECK(ops.get_num_nodes() == 1);
+  BOOST_CHECK(ops.contains_node(pending_node));
+
+  pending_evt->complete();
+  ops.async_wait_and_unregister();
+  ops.wait_for_group(1);
+  BOOST_CHECK(!ops.contains_node(pending_node));
+  BOOST_CHECK(ops.get_num_nodes() == 0);
+}
+BOOST_AUTO_TEST_SUITE_END()
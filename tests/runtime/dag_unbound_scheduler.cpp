@@ -0,0 +1,91 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "hipSYCL/glue/kernel_launcher_data.hpp"
+#include "hipSYCL/runtime/application.hpp"
+#include "hipSYCL/runtime/kernel_launcher.hpp"
+#include "runtime_test_suite.hpp"
+
+#include <memory>
+#include <vector>
+#include <hipSYCL/runtime/backend.hpp>
+#include <hipSYCL/runtime/dag_builder.hpp>
+#include <hipSYCL/runtime/dag_unbound_scheduler.hpp>
+#include <hipSYCL/runtime/runtime.hpp>
+
+using namespace hipsycl;
+
+namespace {
+
+rt::dag_node_ptr make_kernel_node(rt::runtime *rt,
+                                  std::shared_ptr<rt::buffer_data_region> data,
+                                  sycl::access::mode mode) {
+  rt::dag_builder builder{rt};
+  auto reqs = rt::requirements_list{rt};
+  reqs.add_requirement<rt::buffer_memory_requirement>(
+      data, rt::id<3>{0, 0, 0}, data->get_num_elements(), mode,
+      sycl::access::target::device);
+
+  auto kernel_op = rt::make_operation<rt::kernel_operation>(
+      "test_kernel",
+      rt::kernel_launcher{glue::kernel_launcher_data{},
+                          common::auto_small_vector<
+                              std::unique_ptr<rt::backend_kernel_launcher>>{}},
+      reqs);
+  return builder.add_command_group(std::move(kernel_op), reqs);
+}
+
+void cancel(rt::dag_node_ptr node) {
+  for(auto weak_req : node->get_requirements())
+    if(auto req = weak_req.lock())
+      req->cancel();
+  node->cancel();
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(dag_unbound_scheduler, reset_device_fixture)
+BOOST_AUTO_TEST_CASE(placement_follows_data_and_backlog) {
+  rt::runtime_keep_alive_token rt;
+  rt::backend_descriptor host_backend{rt::hardware_platform::cpu,
+                                      rt::api_platform::omp};
+  rt::device_id host_device{host_backend, 0};
+  // Imaginary device that is never submitted to
+  rt::device_id other_device{host_backend, 1234};
+  std::vector<rt::device_id> devices{host_device, other_device};
+
+  rt::backend_allocator *allocator =
+      rt.get()->backends().get(rt::backend_id::omp)->get_allocator(host_device);
+
+  const std::size_t num_elements = 1024 * 1024;
+  std::vector<float> memory(num_elements);
+  auto data = std::make_shared<rt::buffer_data_region>(
+      rt::range<3>{1, 1, num_elements}, sizeof(float),
+      rt::range<3>{1, 1, num_elements});
+  data->add_nonempty_allocation(other_device, memory.data(), allocator, false);
+
+  rt::dag_unbound_scheduler scheduler{rt.get()};
+
+  // Data is only valid on other_device
+  rt::dag_node_ptr reading_node =
+      make_kernel_node(rt.get(), data, sycl::access::mode::read);
+  BOOST_CHECK(scheduler.select_device(reading_node, devices) == other_device);
+
+  // No data needs to be transferred, but other_device already has work
+  rt::dag_node_ptr discarding_node =
+      make_kernel_node(rt.get(), data, sycl::access::mode::discard_write);
+  BOOST_CHECK(scheduler.select_device(discarding_node, devices) ==
+              host_device);
+
+  cancel(reading_node);
+  cancel(discarding_node);
+}
+BOOST_AUTO_TEST_SUITE_END()
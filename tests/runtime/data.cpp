@@ -12,13 +12,38 @@
 #include "runtime_test_suite.hpp"
 
 #include <boost/test/tools/old/interface.hpp>
+#include <random>
 #include <vector>
 #include <memory>
 #include <hipSYCL/runtime/data.hpp>
 #include <hipSYCL/runtime/util.hpp>
+#include <CL/sycl.hpp>
 
 using namespace hipsycl;
 
+namespace {
+
+std::vector<sycl::device> get_cpu_devices() {
+  std::vector<sycl::device> result;
+  for(const auto& dev : sycl::device::get_devices())
+    if(dev.is_cpu())
+      result.push_back(dev);
+  return result;
+}
+
+struct if_three_cpu_devices_available {
+  boost::test_tools::assertion_result
+  operator()(boost::unit_test::test_unit_id) {
+    boost::test_tools::assertion_result ans(get_cpu_devices().size() >= 3);
+    if(!ans)
+      ans.message() << "at least three CPU devices are required, e.g. with "
+                       "ACPP_RT_OMP_SUB_DEVICES=3.";
+    return ans;
+  }
+};
+
+}
+
 BOOST_FIXTURE_TEST_SUITE(data, reset_device_fixture)
 BOOST_AUTO_TEST_CASE(page_table) {
   rt::range_store::rect full_range{rt::id<3>{0, 0, 0},
@@ -47,13 +72,15 @@ BOOST_AUTO_TEST_CASE(page_table) {
     }
   };
 
+  for (auto representation : {rt::range_store::representation::dense,
+                              rt::range_store::representation::bitmap})
   for (auto config : configurations) {
 
     auto full_range = config.page_table_size;
     auto fill_subrange = config.filled_subrange;
     auto intersection_subrange = config.intersection_subrange;
 
-    rt::range_store pt(full_range.second);
+    rt::range_store pt(full_range.second, representation);
 
     BOOST_CHECK(
         pt.entire_range_equals(full_range, rt::range_store::data_state::empty));
@@ -79,4 +106,102 @@ BOOST_AUTO_TEST_CASE(page_table) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(page_table_representations_are_equivalent) {
+  // z extent is not a multiple of the bitmap word size
+  rt::range<3> size{5, 7, 150};
+  rt::range_store dense{size, rt::range_store::representation::dense};
+  rt::range_store bitmap{size, rt::range_store::representation::bitmap};
+
+  std::mt19937 gen{1234};
+  auto random_rect = [&]() {
+    rt::id<3> begin;
+    rt::range<3> extent;
+    for(int i = 0; i < 3; ++i) {
+      begin[i] = std::uniform_int_distribution<std::size_t>{0, size[i] - 1}(gen);
+      extent[i] = std::uniform_int_distribution<std::size_t>{
+          1, size[i] - begin[i]}(gen);
+    }
+    return rt::range_store::rect{begin, extent};
+  };
+
+  for(int i = 0; i < 200; ++i) {
+    auto r = random_rect();
+    if(i % 3 == 2) {
+      dense.remove(r);
+      bitmap.remove(r);
+    } else {
+      dense.add(r);
+      bitmap.add(r);
+    }
+
+    auto query = random_rect();
+    for(auto state : {rt::range_store::data_state::empty,
+                      rt::range_store::data_state::available}) {
+      BOOST_CHECK(dense.entire_range_equals(query, state) ==
+                  bitmap.entire_range_equals(query, state));
+
+      // The rects returned by both representations may differ, but they must
+      // cover exactly the same pages without overlapping.
+      std::vector<rt::range_store::rect> rects;
+      bitmap.intersections_with(query, state, rects);
+      rt::range_store covered{size};
+      std::size_t num_covered_pages = 0;
+      for(const auto& rect : rects) {
+        BOOST_CHECK(covered.entire_range_empty(rect));
+        BOOST_CHECK(dense.entire_range_equals(rect, state));
+        covered.add(rect);
+        num_covered_pages += rect.second.size();
+      }
+      dense.intersections_with(query, state, rects);
+      std::size_t num_expected_pages = 0;
+      for(const auto& rect : rects) {
+        BOOST_CHECK(covered.entire_range_filled(rect));
+        num_expected_pages += rect.second.size();
+      }
+      BOOST_CHECK(num_covered_pages == num_expected_pages);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(update_from_different_sources,
+                     *boost::unit_test::precondition(
+                         if_three_cpu_devices_available{})) {
+  std::vector<sycl::device> devices = get_cpu_devices();
+  sycl::queue writer0{devices[0]};
+  sycl::queue writer1{devices[1]};
+  sycl::queue reader{devices[2]};
+
+  // Adjacent pages that are only valid on different devices must not be
+  // merged into a single transfer.
+  const std::size_t page_size = 1024;
+  const std::size_t num_pages = 4;
+  sycl::buffer<int> buff{
+      sycl::range{page_size * num_pages},
+      sycl::property::buffer::AdaptiveCpp_page_size<1>{sycl::range{page_size}}};
+  sycl::buffer<int> result{sycl::range{page_size * num_pages}};
+
+  for(std::size_t page = 0; page < num_pages; ++page) {
+    sycl::queue& q = (page % 2 == 0) ? writer0 : writer1;
+    q.submit([&](sycl::handler& cgh) {
+      sycl::accessor<int, 1, sycl::access_mode::discard_write> acc{
+          buff, cgh, sycl::range{page_size}, sycl::id{page * page_size}};
+      cgh.parallel_for(sycl::range{page_size}, [=](sycl::id<1> idx) {
+        acc[idx] = static_cast<int>(idx[0] + acc.get_offset()[0]);
+      });
+    });
+  }
+  writer0.wait();
+  writer1.wait();
+
+  reader.submit([&](sycl::handler& cgh) {
+    sycl::accessor<int, 1, sycl::access_mode::read> in{buff, cgh};
+    sycl::accessor<int, 1, sycl::access_mode::discard_write> out{result, cgh};
+    cgh.parallel_for(in.get_range(),
+                     [=](sycl::id<1> idx) { out[idx] = in[idx] + 1; });
+  });
+
+  sycl::host_accessor<int> hacc{result};
+  for(std::size_t i = 0; i < page_size * num_pages; ++i)
+    BOOST_REQUIRE(hacc[i] == static_cast<int>(i) + 1);
+}
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,16 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+
+// Shared library image for the dylib_loader tests. It is built once per
+// image, with a different symbol name and value each time.
+extern "C" int ACPP_TEST_IMAGE_SYMBOL() {
+  return ACPP_TEST_IMAGE_VALUE;
+}
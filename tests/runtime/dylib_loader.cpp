@@ -0,0 +1,85 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "runtime_test_suite.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <hipSYCL/runtime/dylib_loader.hpp>
+
+using namespace hipsycl;
+
+namespace {
+
+std::string read_image(const std::string& filename) {
+  std::ifstream file{filename, std::ios::binary};
+  std::stringstream sstr;
+  sstr << file.rdbuf();
+  return sstr.str();
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(dylib_loader)
+
+BOOST_AUTO_TEST_CASE(load_multiple_libraries_from_memory) {
+  std::string image_a = read_image(ACPP_RT_TEST_IMAGE_A);
+  std::string image_b = read_image(ACPP_RT_TEST_IMAGE_B);
+  BOOST_REQUIRE(!image_a.empty());
+  BOOST_REQUIRE(!image_b.empty());
+
+  int fd_a = -1;
+  void* handle_a =
+      rt::detail::load_library_from_memory(image_a, "rt_tests", fd_a);
+  if(!handle_a) {
+    BOOST_TEST_MESSAGE("Loading libraries from memory is unsupported");
+    return;
+  }
+  int fd_b = -1;
+  void* handle_b =
+      rt::detail::load_library_from_memory(image_b, "rt_tests", fd_b);
+  BOOST_REQUIRE(handle_b);
+  BOOST_CHECK(handle_a != handle_b);
+
+  using image_function = int();
+  auto* get_a = reinterpret_cast<image_function*>(
+      rt::detail::get_symbol_from_library(handle_a, "acpp_test_image_a",
+                                          "rt_tests"));
+  auto* get_b = reinterpret_cast<image_function*>(
+      rt::detail::get_symbol_from_library(handle_b, "acpp_test_image_b",
+                                          "rt_tests"));
+  BOOST_REQUIRE(get_a);
+  BOOST_REQUIRE(get_b);
+  BOOST_CHECK(get_a() == 1);
+  BOOST_CHECK(get_b() == 2);
+
+  rt::detail::close_library(handle_b, "rt_tests");
+  rt::detail::close_library_image(fd_b);
+
+  // Unloading one library must not affect the other one, and the next image
+  // must not be confused with the unloaded one.
+  int fd_c = -1;
+  void* handle_c =
+      rt::detail::load_library_from_memory(image_b, "rt_tests", fd_c);
+  BOOST_REQUIRE(handle_c);
+  BOOST_CHECK(handle_c != handle_a);
+  BOOST_CHECK(get_a() == 1);
+  BOOST_CHECK(rt::detail::get_symbol_from_library(handle_c, "acpp_test_image_b",
+                                                  "rt_tests"));
+
+  rt::detail::close_library(handle_c, "rt_tests");
+  rt::detail::close_library_image(fd_c);
+  rt::detail::close_library(handle_a, "rt_tests");
+  rt::detail::close_library_image(fd_a);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,109 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "runtime_test_suite.hpp"
+
+#include <string>
+#include <string_view>
+#include <hipSYCL/common/hcf_container.hpp>
+#include <hipSYCL/runtime/kernel_cache.hpp>
+
+using namespace hipsycl;
+
+namespace {
+
+std::string make_test_hcf(rt::hcf_object_id id) {
+  common::hcf_container hcf;
+  hcf.root_node()->set("object-id", std::to_string(id));
+
+  auto* images = hcf.root_node()->add_subnode("images");
+  auto* image = images->add_subnode("test-image");
+  image->set("format", "llvm-ir.global");
+  image->set("variant", "global-module");
+  hcf.attach_binary_content(image, "image-content");
+
+  auto* kernels = hcf.root_node()->add_subnode("kernels");
+  auto* kernel = kernels->add_subnode("test-kernel");
+  kernel->set_as_list("image-providers", {"test-image"});
+  auto* param = kernel->add_subnode("parameters")->add_subnode("0");
+  param->set("byte-size", "8");
+  param->set("byte-offset", "0");
+  param->set("original-index", "0");
+  param->set("type", "pointer");
+  // Nested node with the same name as its parent
+  param->add_subnode("0")->set("key", "value");
+
+  return hcf.serialize();
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(hcf_cache)
+BOOST_AUTO_TEST_CASE(container_references_binary_appendix) {
+  std::string data = make_test_hcf(1);
+  common::hcf_container hcf{data,
+                            common::hcf_container::reference_binary_appendix};
+
+  auto* image = hcf.root_node()->get_subnode("images")->get_subnode("test-image");
+  BOOST_REQUIRE(image);
+  std::string_view attachment;
+  BOOST_REQUIRE(hcf.get_binary_attachment(image, attachment));
+  BOOST_CHECK(attachment == "image-content");
+  BOOST_CHECK(attachment.data() >= data.data() &&
+              attachment.data() < data.data() + data.size());
+
+  auto* nested = hcf.root_node()
+                     ->get_subnode("kernels")
+                     ->get_subnode("test-kernel")
+                     ->get_subnode("parameters")
+                     ->get_subnode("0");
+  BOOST_REQUIRE(nested);
+  BOOST_CHECK(*nested->get_value("type") == "pointer");
+  BOOST_REQUIRE(nested->get_subnode("0"));
+  BOOST_CHECK(*nested->get_subnode("0")->get_value("key") == "value");
+
+  BOOST_CHECK(hcf.serialize() == data);
+  BOOST_CHECK(common::hcf_container::peek_root_value(data, "object-id") == "1");
+}
+
+BOOST_AUTO_TEST_CASE(lazy_registration) {
+  const rt::hcf_object_id id = 0x7e57c0de;
+  std::string data = make_test_hcf(id);
+
+  BOOST_CHECK(rt::hcf_cache::get().register_hcf_data(data) == id);
+
+  const rt::hcf_kernel_info* kernel_info =
+      rt::hcf_cache::get().get_kernel_info(id, std::string_view{"test-kernel"});
+  BOOST_REQUIRE(kernel_info);
+  BOOST_CHECK(kernel_info->get_num_parameters() == 1);
+  BOOST_CHECK(kernel_info->get_argument_type(0) ==
+              rt::hcf_kernel_info::pointer);
+  BOOST_CHECK(!rt::hcf_cache::get().get_kernel_info(
+      id, std::string_view{"missing-kernel"}));
+
+  const rt::hcf_image_info* image_info =
+      rt::hcf_cache::get().get_image_info(id, "test-image");
+  BOOST_REQUIRE(image_info);
+  BOOST_CHECK(image_info->get_contained_kernels().size() == 1);
+
+  const common::hcf_container* hcf = rt::hcf_cache::get().get_hcf(id);
+  BOOST_REQUIRE(hcf);
+  std::string_view attachment;
+  BOOST_REQUIRE(hcf->get_binary_attachment(
+      hcf->root_node()->get_subnode("images")->get_subnode("test-image"),
+      attachment));
+  BOOST_CHECK(attachment.data() >= data.data() &&
+              attachment.data() < data.data() + data.size());
+
+  rt::hcf_cache::get().unregister_hcf_object(id);
+  BOOST_CHECK(!rt::hcf_cache::get().get_hcf(id));
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,265 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "runtime_test_suite.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <hipSYCL/common/jit_cache_archive.hpp>
+#include <hipSYCL/runtime/application.hpp>
+#include <hipSYCL/runtime/kernel_cache.hpp>
+#include <hipSYCL/runtime/settings.hpp>
+
+using namespace hipsycl;
+
+namespace {
+
+struct temporary_directory {
+  temporary_directory() {
+    path = std::filesystem::temp_directory_path() /
+           ("acpp-jit-cache-test-" + std::to_string(::getpid()));
+    std::filesystem::remove_all(path);
+    std::filesystem::create_directories(path);
+  }
+
+  ~temporary_directory() {
+    std::error_code ec;
+    std::filesystem::remove_all(path, ec);
+  }
+
+  std::filesystem::path path;
+};
+
+rt::kernel_cache::code_object_id get_unique_test_id(uint64_t i) {
+  return rt::kernel_cache::code_object_id{
+      0xacc0de000000ull + static_cast<uint64_t>(::getpid()), i};
+}
+
+class test_code_object : public rt::code_object {
+public:
+  test_code_object(std::string_view binary)
+  : _binary{binary} {}
+
+  rt::code_object_state state() const override {
+    return rt::code_object_state::executable;
+  }
+  rt::code_format format() const override {
+    return rt::code_format::native_isa;
+  }
+  rt::backend_id managing_backend() const override {
+    return rt::backend_id::omp;
+  }
+  rt::hcf_object_id hcf_source() const override { return 0; }
+  std::string target_arch() const override { return "test"; }
+  rt::compilation_flow source_compilation_flow() const override {
+    return rt::compilation_flow::sscp;
+  }
+  std::vector<std::string> supported_backend_kernel_names() const override {
+    return {};
+  }
+  bool contains(const std::string &) const override { return false; }
+
+  const std::string& get_binary() const { return _binary; }
+private:
+  std::string _binary;
+};
+
+}
+
+BOOST_AUTO_TEST_SUITE(jit_cache)
+BOOST_AUTO_TEST_CASE(archive_store_lookup) {
+  using common::filesystem::jit_cache_archive;
+  temporary_directory dir;
+
+  jit_cache_archive::id_type id_a{1, 2};
+  jit_cache_archive::id_type id_b{3, 4};
+  std::string binary_a(1000, 'a');
+  std::string binary_b = "binary b";
+
+  {
+    jit_cache_archive archive{dir.path.string(), 0};
+    common::filesystem::archived_binary result;
+    BOOST_CHECK(!archive.lookup(id_a, result));
+
+    BOOST_CHECK(archive.store(id_a, binary_a));
+    BOOST_CHECK(archive.store(id_b, binary_b));
+    BOOST_CHECK(archive.lookup(id_a, result));
+    BOOST_CHECK(result.data() == binary_a);
+    BOOST_CHECK(archive.get_num_entries() == 2);
+  }
+  {
+    // Binaries must be visible to a new instance, e.g. in another process
+    jit_cache_archive archive{dir.path.string(), 0};
+    common::filesystem::archived_binary result;
+    BOOST_CHECK(archive.lookup(id_b, result));
+    BOOST_CHECK(result.data() == binary_b);
+    BOOST_CHECK(archive.lookup(id_a, result));
+    BOOST_CHECK(result.data() == binary_a);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(archive_eviction) {
+  using common::filesystem::jit_cache_archive;
+  temporary_directory dir;
+
+  const std::size_t binary_size = 4096;
+  const std::size_t max_size = 4 * binary_size;
+  {
+    jit_cache_archive archive{dir.path.string(), max_size};
+    for(uint64_t i = 0; i < 16; ++i)
+      BOOST_CHECK(archive.store(jit_cache_archive::id_type{i, i},
+                                std::string(binary_size, 'x')));
+    archive.flush();
+    BOOST_CHECK(archive.get_stored_bytes() <= max_size);
+    BOOST_CHECK(archive.get_num_entries() > 0);
+  }
+  {
+    jit_cache_archive archive{dir.path.string(), max_size};
+    BOOST_CHECK(archive.get_stored_bytes() <= max_size);
+    BOOST_CHECK(archive.get_num_entries() > 0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(archive_lookup_does_not_rewrite_index) {
+  using common::filesystem::jit_cache_archive;
+  temporary_directory dir;
+  auto index_path = dir.path / "jit-cache.idx";
+
+  jit_cache_archive::id_type id{5, 6};
+  {
+    jit_cache_archive archive{dir.path.string(), 0};
+    BOOST_CHECK(archive.store(id, "binary"));
+    archive.flush();
+  }
+  BOOST_REQUIRE(std::filesystem::exists(index_path));
+  auto index_write_time = std::filesystem::last_write_time(index_path);
+  std::filesystem::last_write_time(
+      index_path, index_write_time - std::chrono::hours{1});
+  index_write_time = std::filesystem::last_write_time(index_path);
+  {
+    // Cache hits of recently used entries must not cause index writes
+    jit_cache_archive archive{dir.path.string(), 0};
+    common::filesystem::archived_binary result;
+    for(int i = 0; i < 3; ++i)
+      BOOST_CHECK(archive.lookup(id, result));
+    archive.flush();
+  }
+  BOOST_CHECK(std::filesystem::last_write_time(index_path) ==
+              index_write_time);
+}
+
+BOOST_AUTO_TEST_CASE(kernel_cache_throwing_jit_compiler) {
+  auto cache = rt::kernel_cache::get();
+  auto id_of_code_object = get_unique_test_id(0);
+  auto id_of_binary = get_unique_test_id(1);
+
+  auto construct = [](std::string_view) -> const rt::code_object * {
+    return nullptr;
+  };
+  std::atomic<int> num_compilations = 0;
+
+  std::thread compiling_thread{[&]() {
+    auto throwing_compile = [&](std::string &) -> bool {
+      ++num_compilations;
+      std::this_thread::sleep_for(std::chrono::milliseconds{100});
+      throw std::runtime_error{"JIT compiler failure"};
+    };
+    BOOST_CHECK_THROW(
+        cache->get_or_construct_jit_code_object(
+            id_of_code_object, id_of_binary, throwing_compile, construct),
+        std::runtime_error);
+  }};
+
+  std::this_thread::sleep_for(std::chrono::milliseconds{20});
+  // Either waits on the in-flight compilation, or retries after the
+  // failed one has been cleaned up. In no case may this block forever.
+  auto failing_compile = [&](std::string &) -> bool {
+    ++num_compilations;
+    return false;
+  };
+  BOOST_CHECK(cache->get_or_construct_jit_code_object(
+                  id_of_code_object, id_of_binary, failing_compile,
+                  construct) == nullptr);
+  compiling_thread.join();
+
+  // The in-flight entry must have been removed, so that the compilation is
+  // retried.
+  int compilations_before_retry = num_compilations;
+  BOOST_CHECK(cache->get_or_construct_jit_code_object(
+                  id_of_code_object, id_of_binary, failing_compile,
+                  construct) == nullptr);
+  BOOST_CHECK(num_compilations == compilations_before_retry + 1);
+}
+
+BOOST_AUTO_TEST_CASE(kernel_cache_background_compilation_fallback) {
+  auto cache = rt::kernel_cache::get();
+  auto id_of_specialized = get_unique_test_id(2);
+  auto id_of_fallback = get_unique_test_id(3);
+
+  // Keep the test binaries out of the persistent cache
+  auto& settings = rt::application::get_settings();
+  const bool old_no_cache_population =
+      settings.get<rt::setting::no_jit_cache_population>();
+  settings.set<rt::setting::no_jit_cache_population>(true);
+
+  auto construct = [](std::string_view binary) -> const rt::code_object * {
+    return new test_code_object{binary};
+  };
+  auto get_binary = [](const rt::code_object* obj) {
+    return static_cast<const test_code_object *>(obj)->get_binary();
+  };
+
+  std::atomic<bool> release_compilation = false;
+  std::atomic<int> num_compilations = 0;
+  // Takes as long as the test needs, so that launches are guaranteed
+  // to happen while the compilation is in progress.
+  auto slow_compile = [&](std::string &out) -> bool {
+    ++num_compilations;
+    while(!release_compilation)
+      std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    out = "specialized";
+    return true;
+  };
+  auto fallback_compile = [](std::string &out) -> bool {
+    out = "fallback";
+    return true;
+  };
+
+  // Same pattern as kernel launches with background compilation: If the
+  // specialized code object is not available, use the fallback.
+  auto launch = [&]() {
+    const rt::code_object *obj = cache->get_or_schedule_jit_code_object(
+        id_of_specialized, id_of_specialized, slow_compile, construct);
+    if(!obj)
+      obj = cache->get_or_construct_jit_code_object(
+          id_of_fallback, id_of_fallback, fallback_compile, construct);
+    BOOST_REQUIRE(obj);
+    return get_binary(obj);
+  };
+
+  for(int i = 0; i < 3; ++i)
+    BOOST_CHECK(launch() == "fallback");
+
+  release_compilation = true;
+  cache->wait_for_background_compilations();
+  BOOST_CHECK(launch() == "specialized");
+  BOOST_CHECK(launch() == "specialized");
+  // Repeated launches must not schedule the compilation again
+  BOOST_CHECK(num_compilations == 1);
+
+  settings.set<rt::setting::no_jit_cache_population>(old_no_cache_population);
+}
+BOOST_AUTO_TEST_SUITE_END()
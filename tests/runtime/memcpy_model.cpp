@@ -0,0 +1,59 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "runtime_test_suite.hpp"
+
+#include <vector>
+#include <hipSYCL/runtime/hw_model/memcpy.hpp>
+
+using namespace hipsycl;
+
+BOOST_AUTO_TEST_SUITE(memcpy_model)
+BOOST_AUTO_TEST_CASE(source_selection_depends_on_transfer_size) {
+  rt::backend_descriptor backend{rt::hardware_platform::cuda,
+                                 rt::api_platform::cuda};
+  rt::device_id target{backend, 0};
+  rt::device_id low_latency_source{backend, 1};
+  rt::device_id high_bandwidth_source{backend, 2};
+
+  rt::memcpy_model model{nullptr};
+  model.set_link_parameters(low_latency_source, target,
+                            rt::memcpy_link_parameters{1000.0, 1.0});
+  model.set_link_parameters(high_bandwidth_source, target,
+                            rt::memcpy_link_parameters{10000.0, 100.0});
+
+  auto make_location = [](rt::device_id dev) {
+    return rt::memory_location{dev, nullptr, rt::id<3>{0, 0, 0},
+                               rt::range<3>{1, 1, 1 << 30}, 1};
+  };
+  std::vector<rt::memory_location> candidates{
+      make_location(low_latency_source), make_location(high_bandwidth_source)};
+  rt::memory_location dest = make_location(target);
+
+  BOOST_CHECK(model.choose_source(candidates, dest, rt::range<3>{1, 1, 128})
+                  .get_device() == low_latency_source);
+  BOOST_CHECK(model.choose_source(candidates, dest, rt::range<3>{1, 1, 1 << 20})
+                  .get_device() == high_bandwidth_source);
+
+  // Small transfers are not worth splitting
+  auto shares = model.split_sources(candidates, dest, rt::range<3>{1, 1, 128});
+  BOOST_REQUIRE(shares.size() == 1);
+  BOOST_CHECK(shares[0].source.get_device() == low_latency_source);
+  BOOST_CHECK(shares[0].fraction == 1.0);
+
+  model.set_link_parameters(low_latency_source, target,
+                            rt::memcpy_link_parameters{1000.0, 100.0});
+  shares = model.split_sources(candidates, dest, rt::range<3>{1, 1, 1 << 24});
+  BOOST_REQUIRE(shares.size() == 2);
+  BOOST_CHECK_CLOSE(shares[0].fraction + shares[1].fraction, 1.0, 1e-6);
+  BOOST_CHECK_CLOSE(shares[0].fraction, 0.5, 1e-6);
+}
+BOOST_AUTO_TEST_SUITE_END()
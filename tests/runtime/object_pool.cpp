@@ -0,0 +1,169 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "runtime_test_suite.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <set>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include <hipSYCL/common/intrusive_free_list.hpp>
+#include <hipSYCL/runtime/generic/object_pool.hpp>
+
+using namespace hipsycl;
+
+BOOST_AUTO_TEST_SUITE(object_pool)
+BOOST_AUTO_TEST_CASE(objects_are_aligned_and_disjoint) {
+  std::vector<std::pair<void*, std::size_t>> objects;
+  for(std::size_t size : {1, 8, 64, 65, 200, 1024, 4096}) {
+    for(int i = 0; i < 100; ++i) {
+      void* ptr = rt::object_pool::allocate(size);
+      BOOST_REQUIRE(ptr);
+      BOOST_CHECK(reinterpret_cast<std::uintptr_t>(ptr) %
+                      rt::object_pool::alignment == 0);
+      std::memset(ptr, i, size);
+      objects.emplace_back(ptr, size);
+    }
+  }
+
+  std::set<void*> unique_ptrs;
+  for(const auto& obj : objects)
+    unique_ptrs.insert(obj.first);
+  BOOST_CHECK(unique_ptrs.size() == objects.size());
+
+  for(const auto& obj : objects)
+    rt::object_pool::deallocate(obj.first, obj.second);
+}
+
+BOOST_AUTO_TEST_CASE(objects_are_reused) {
+  void* ptr = rt::object_pool::allocate(100);
+  rt::object_pool::deallocate(ptr, 100);
+  void* reused = rt::object_pool::allocate(128);
+  BOOST_CHECK(reused == ptr);
+  rt::object_pool::deallocate(reused, 128);
+}
+
+BOOST_AUTO_TEST_CASE(cross_thread_deallocation) {
+  // Objects are allocated in one thread and freed in another,
+  // like DAG nodes that are retired by a different thread.
+  constexpr int num_objects = 10000;
+  for(int iteration = 0; iteration < 3; ++iteration) {
+    std::vector<std::shared_ptr<std::vector<int>>> objects;
+    std::thread producer{[&]() {
+      for(int i = 0; i < num_objects; ++i)
+        objects.push_back(
+            rt::make_pooled_shared<std::vector<int>>(std::vector<int>{i}));
+    }};
+    producer.join();
+
+    std::thread consumer{[&]() {
+      for(int i = 0; i < num_objects; ++i)
+        BOOST_REQUIRE((*objects[i])[0] == i);
+      objects.clear();
+    }};
+    consumer.join();
+  }
+}
+
+struct pooled_base : public rt::pooled_object {
+  virtual ~pooled_base() = default;
+};
+
+struct pooled_small_object : public pooled_base {
+  char data[100];
+};
+
+struct alignas(256) pooled_overaligned_object : public pooled_base {
+  char data[100];
+};
+
+BOOST_AUTO_TEST_CASE(pooled_objects_are_aligned) {
+  std::vector<std::unique_ptr<pooled_base>> objects;
+  for(int i = 0; i < 100; ++i) {
+    auto small = std::make_unique<pooled_small_object>();
+    BOOST_CHECK(reinterpret_cast<std::uintptr_t>(small.get()) %
+                    rt::object_pool::alignment == 0);
+    objects.push_back(std::move(small));
+
+    auto overaligned = std::make_unique<pooled_overaligned_object>();
+    BOOST_CHECK(reinterpret_cast<std::uintptr_t>(overaligned.get()) %
+                    alignof(pooled_overaligned_object) == 0);
+    objects.push_back(std::move(overaligned));
+  }
+  // Deleted through the base class, which must select
+  // the matching deallocation function.
+  objects.clear();
+}
+
+struct alignas(16) test_object {
+  char data[16];
+};
+
+BOOST_AUTO_TEST_CASE(free_list_split_splice) {
+  constexpr std::size_t num_objects = 10;
+  std::array<test_object, num_objects> objects;
+
+  common::intrusive_free_list list;
+  for(auto& obj : objects)
+    list.push(&obj);
+  BOOST_CHECK(list.size() == num_objects);
+
+  common::intrusive_free_list front = list.split(4);
+  BOOST_CHECK(front.size() == 4);
+  BOOST_CHECK(list.size() == num_objects - 4);
+  // Objects are taken from the front, i.e. the most recently pushed ones
+  for(std::size_t i = 0; i < 4; ++i)
+    BOOST_CHECK(front.pop() == &objects[num_objects - 1 - i]);
+  BOOST_CHECK(front.size() == 0);
+  BOOST_CHECK(front.pop() == nullptr);
+
+  for(std::size_t i = 0; i < 4; ++i)
+    front.push(&objects[num_objects - 4 + i]);
+
+  common::intrusive_free_list rest = list.split(100);
+  BOOST_CHECK(rest.size() == num_objects - 4);
+  BOOST_CHECK(list.size() == 0);
+  BOOST_CHECK(list.pop() == nullptr);
+
+  // An emptied list must still be usable as a splice target
+  list.splice(rest);
+  list.splice(front);
+  BOOST_CHECK(list.size() == num_objects);
+  BOOST_CHECK(rest.size() == 0);
+  BOOST_CHECK(front.size() == 0);
+
+  common::intrusive_free_list empty;
+  list.splice(empty);
+  BOOST_CHECK(list.size() == num_objects);
+
+  std::unordered_set<void*> popped;
+  while(void* ptr = list.pop())
+    popped.insert(ptr);
+  BOOST_CHECK(popped.size() == num_objects);
+  for(auto& obj : objects)
+    BOOST_CHECK(popped.find(&obj) != popped.end());
+
+  // The tail must have been reset, otherwise splicing would link into
+  // objects that are no longer part of the list.
+  list.push(&objects[0]);
+  common::intrusive_free_list other;
+  other.push(&objects[1]);
+  list.splice(other);
+  BOOST_CHECK(list.size() == 2);
+  BOOST_CHECK(list.pop() == &objects[1]);
+  BOOST_CHECK(list.pop() == &objects[0]);
+  BOOST_CHECK(list.pop() == nullptr);
+}
+BOOST_AUTO_TEST_SUITE_END()
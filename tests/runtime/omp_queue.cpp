@@ -0,0 +1,101 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "runtime_test_suite.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <CL/sycl.hpp>
+
+using namespace hipsycl;
+
+namespace {
+
+std::vector<sycl::device> get_cpu_devices() {
+  std::vector<sycl::device> result;
+  for(const auto& dev : sycl::device::get_devices())
+    if(dev.is_cpu())
+      result.push_back(dev);
+  return result;
+}
+
+struct if_two_cpu_devices_available {
+  boost::test_tools::assertion_result
+  operator()(boost::unit_test::test_unit_id) {
+    boost::test_tools::assertion_result ans(get_cpu_devices().size() >= 2);
+    if(!ans)
+      ans.message() << "at least two CPU devices are required, e.g. with "
+                       "ACPP_RT_OMP_SUB_DEVICES=2.";
+    return ans;
+  }
+};
+
+bool wait_with_timeout(sycl::event evt, std::chrono::seconds timeout) {
+  auto start = std::chrono::steady_clock::now();
+  while(evt.get_info<sycl::info::event::command_execution_status>() !=
+        sycl::info::event_command_status::complete) {
+    if(std::chrono::steady_clock::now() - start > timeout)
+      return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+  }
+  return true;
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(omp_queue, reset_device_fixture)
+
+BOOST_AUTO_TEST_CASE(cross_queue_dependencies_with_coarse_grained_events,
+                     *boost::unit_test::precondition(
+                         if_two_cpu_devices_available{})) {
+  std::vector<sycl::device> devices = get_cpu_devices();
+  sycl::property_list props{
+      sycl::property::queue::in_order{},
+      sycl::property::queue::AdaptiveCpp_coarse_grained_events{}};
+  sycl::queue q0{devices[0], props};
+  sycl::queue q1{devices[1], props};
+
+  std::atomic<bool> release_first = false;
+  std::atomic<bool>* release_first_ptr = &release_first;
+  std::atomic<int> num_executed = 0;
+  std::atomic<int>* num_executed_ptr = &num_executed;
+
+  // Keep q0 busy until the operations that depend on each other across
+  // the queues have been submitted.
+  sycl::event first = q0.single_task([=]() {
+    while(!release_first_ptr->load())
+      ;
+    ++(*num_executed_ptr);
+  });
+  sycl::event second = q1.submit([&](sycl::handler& cgh) {
+    cgh.depends_on(first);
+    cgh.single_task([=]() { ++(*num_executed_ptr); });
+  });
+  // If second waited for all of q0 instead of only for the operations up
+  // to first, it would wait for this operation, which in turn waits for
+  // second.
+  sycl::event third = q0.submit([&](sycl::handler& cgh) {
+    cgh.depends_on(second);
+    cgh.single_task([=]() { ++(*num_executed_ptr); });
+  });
+
+  // Submit to the backend queues before first can complete
+  rt::runtime_keep_alive_token rt;
+  rt.get()->dag().flush_sync();
+
+  release_first = true;
+  BOOST_REQUIRE(wait_with_timeout(third, std::chrono::seconds{60}));
+  BOOST_CHECK(num_executed == 3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,171 @@
+/*
+ * This file is part of AdaptiveCpp, an implementation of SYCL and C++ standard
+ * parallelism for CPUs and GPUs.
+ *
+ * Copyright The AdaptiveCpp Contributors
+ *
+ * AdaptiveCpp is released under the BSD 2-Clause "Simplified" License.
+ * See file LICENSE in the project root for full license details.
+ */
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "runtime_test_suite.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <hipSYCL/runtime/generic/work_stealing_executor.hpp>
+
+using namespace hipsycl;
+
+BOOST_AUTO_TEST_SUITE(work_stealing_executor)
+BOOST_AUTO_TEST_CASE(parallel_for_covers_range) {
+  rt::work_stealing_executor executor{4};
+
+  for(std::size_t grain_size : {0, 1, 7, 1000}) {
+    const std::size_t num_items = 10007;
+    std::vector<std::atomic<int>> visits(num_items);
+    for(auto& v : visits)
+      v = 0;
+
+    executor.parallel_for(num_items, grain_size,
+                          [&](std::size_t begin, std::size_t end) {
+                            BOOST_REQUIRE(begin < end);
+                            BOOST_REQUIRE(end <= num_items);
+                            if(grain_size > 0)
+                              BOOST_REQUIRE(end - begin <= grain_size);
+                            for(std::size_t i = begin; i < end; ++i)
+                              ++visits[i];
+                          });
+    for(const auto& v : visits)
+      BOOST_REQUIRE(v.load() == 1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_parallel_for) {
+  rt::work_stealing_executor executor{3};
+
+  const std::size_t num_items = 5000;
+  std::vector<std::thread> submitters;
+  std::vector<std::size_t> sums(4, 0);
+  for(std::size_t t = 0; t < sums.size(); ++t) {
+    submitters.emplace_back([&, t]() {
+      for(int iteration = 0; iteration < 20; ++iteration) {
+        std::atomic<std::size_t> sum = 0;
+        executor.parallel_for(num_items, 0,
+                              [&](std::size_t begin, std::size_t end) {
+                                for(std::size_t i = begin; i < end; ++i)
+                                  sum += i;
+                              });
+        sums[t] = sum.load();
+      }
+    });
+  }
+  for(auto& t : submitters)
+    t.join();
+
+  for(auto s : sums)
+    BOOST_CHECK(s == num_items * (num_items - 1) / 2);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_parallel_for_make_progress_together) {
+  rt::work_stealing_executor executor{4};
+
+  struct job_state {
+    std::thread::id caller;
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    bool has_overlapped = false;
+  };
+  job_state jobs[2];
+  std::atomic<int> num_started_jobs = 0;
+
+  auto submit = [&](job_state& state) {
+    state.caller = std::this_thread::get_id();
+    bool has_started = false;
+    executor.parallel_for(2000, 1, [&](std::size_t, std::size_t) {
+      {
+        std::lock_guard<std::mutex> lock{state.mutex};
+        state.threads.insert(std::this_thread::get_id());
+        if(!has_started) {
+          has_started = true;
+          ++num_started_jobs;
+        }
+      }
+      // Both jobs must be running at the same time. This would time out
+      // if the executor processed one parallel_for after the other.
+      auto deadline =
+          std::chrono::steady_clock::now() + std::chrono::seconds{10};
+      while(num_started_jobs.load() < 2 &&
+            std::chrono::steady_clock::now() < deadline)
+        std::this_thread::yield();
+      if(num_started_jobs.load() == 2) {
+        std::lock_guard<std::mutex> lock{state.mutex};
+        state.has_overlapped = true;
+      }
+      std::this_thread::sleep_for(std::chrono::microseconds{100});
+    });
+  };
+
+  std::thread first{[&]() { submit(jobs[0]); }};
+  std::thread second{[&]() { submit(jobs[1]); }};
+  first.join();
+  second.join();
+
+  std::set<std::thread::id> pool_threads[2];
+  for(int i = 0; i < 2; ++i) {
+    BOOST_CHECK(jobs[i].has_overlapped);
+    for(auto id : jobs[i].threads)
+      if(id != jobs[0].caller && id != jobs[1].caller)
+        pool_threads[i].insert(id);
+  }
+  // The pool threads are partitioned among the concurrent jobs
+  BOOST_CHECK(!pool_threads[0].empty());
+  BOOST_CHECK(!pool_threads[1].empty());
+}
+
+BOOST_AUTO_TEST_CASE(parallel_for_static_uses_initial_distribution) {
+  rt::work_stealing_executor executor{4};
+
+  std::mutex mutex;
+  std::vector<std::pair<std::size_t, std::size_t>> ranges;
+  std::set<std::thread::id> threads;
+  executor.parallel_for_static(103, [&](std::size_t begin, std::size_t end) {
+    std::lock_guard<std::mutex> lock{mutex};
+    ranges.emplace_back(begin, end);
+    threads.insert(std::this_thread::get_id());
+  });
+
+  std::sort(ranges.begin(), ranges.end());
+  BOOST_REQUIRE(ranges.size() == 4);
+  BOOST_CHECK(threads.size() == 4);
+  for(std::size_t i = 0; i < ranges.size(); ++i) {
+    BOOST_CHECK(ranges[i].first == 103 * i / 4);
+    BOOST_CHECK(ranges[i].second == 103 * (i + 1) / 4);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(parallel_for_on_numa_node_covers_range) {
+  rt::work_stealing_executor executor{4};
+
+  // Without workers on the requested node, all workers participate
+  const std::size_t num_items = 1000;
+  std::vector<std::atomic<int>> visits(num_items);
+  for(auto& v : visits)
+    v = 0;
+  executor.parallel_for(
+      num_items, 0,
+      [&](std::size_t begin, std::size_t end) {
+        for(std::size_t i = begin; i < end; ++i)
+          ++visits[i];
+      },
+      0);
+  for(const auto& v : visits)
+    BOOST_REQUIRE(v.load() == 1);
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -1222,6 +1222,105 @@ BOOST_AUTO_TEST_CASE(sycl_specialized) {
   sycl::free(data, q);
 }
 #endif
+#ifdef ACPP_EXT_COMMAND_GRAPH
+BOOST_AUTO_TEST_CASE(command_graph) {
+  namespace sycl = hipsycl::sycl;
+
+  auto test = [](sycl::queue& q) {
+    constexpr std::size_t size = 1024;
+    int* data = sycl::malloc_shared<int>(size, q);
+    q.fill(data, 0, size).wait();
+
+    sycl::AdaptiveCpp_command_graph graph;
+    q.AdaptiveCpp_begin_recording(graph);
+    BOOST_CHECK(q.AdaptiveCpp_is_recording());
+
+    auto e1 = q.parallel_for(sycl::range{size}, [=](sycl::id<1> idx){
+      data[idx] += 1;
+    });
+    q.parallel_for(sycl::range{size}, e1, [=](sycl::id<1> idx){
+      data[idx] *= 2;
+    });
+    q.AdaptiveCpp_end_recording();
+
+    BOOST_CHECK(!q.AdaptiveCpp_is_recording());
+    BOOST_CHECK(graph.size() >= 2);
+    // Nothing must have been executed while recording
+    for(std::size_t i = 0; i < size; ++i)
+      BOOST_CHECK(data[i] == 0);
+
+    int expected = 0;
+    for(int replay = 0; replay < 3; ++replay) {
+      q.AdaptiveCpp_replay(graph);
+      expected = (expected + 1) * 2;
+    }
+    q.wait();
+    for(std::size_t i = 0; i < size; ++i)
+      BOOST_CHECK(data[i] == expected);
+
+    // Update the argument of the first kernel
+    int increment = 5;
+    q.AdaptiveCpp_update_recorded_operation(graph, 0, [&](sycl::handler& cgh){
+      cgh.parallel_for(sycl::range{size}, [=](sycl::id<1> idx){
+        data[idx] += increment;
+      });
+    });
+    q.AdaptiveCpp_replay(graph).wait();
+    expected = (expected + increment) * 2;
+    for(std::size_t i = 0; i < size; ++i)
+      BOOST_CHECK(data[i] == expected);
+
+    sycl::free(data, q);
+  };
+
+  sycl::queue out_of_order_q;
+  sycl::queue in_order_q{sycl::property::queue::in_order{}};
+  test(out_of_order_q);
+  test(in_order_q);
+
+  // Independent operations: The event returned by the replay must
+  // complete after all of them, without recording additional operations.
+  {
+    constexpr std::size_t size = 1024;
+    int* a = sycl::malloc_shared<int>(size, out_of_order_q);
+    int* b = sycl::malloc_shared<int>(size, out_of_order_q);
+    out_of_order_q.fill(a, 0, size);
+    out_of_order_q.fill(b, 0, size);
+    out_of_order_q.wait();
+
+    sycl::AdaptiveCpp_command_graph graph;
+    out_of_order_q.AdaptiveCpp_begin_recording(graph);
+    out_of_order_q.parallel_for(sycl::range{size}, [=](sycl::id<1> idx){
+      a[idx] += 1;
+    });
+    out_of_order_q.parallel_for(sycl::range{size}, [=](sycl::id<1> idx){
+      b[idx] += 2;
+    });
+    out_of_order_q.AdaptiveCpp_end_recording();
+    BOOST_CHECK(graph.size() == 2);
+
+    for(int replay = 1; replay <= 3; ++replay) {
+      out_of_order_q.AdaptiveCpp_replay(graph).wait();
+      for(std::size_t i = 0; i < size; ++i) {
+        BOOST_CHECK(a[i] == replay);
+        BOOST_CHECK(b[i] == 2 * replay);
+      }
+    }
+    sycl::free(a, out_of_order_q);
+    sycl::free(b, out_of_order_q);
+  }
+
+  sycl::queue q;
+  sycl::AdaptiveCpp_command_graph graph;
+  sycl::buffer<int> buff{sycl::range{1}};
+  q.AdaptiveCpp_begin_recording(graph);
+  BOOST_CHECK_THROW(q.submit([&](sycl::handler &cgh) {
+    sycl::accessor<int> acc{buff, cgh};
+    cgh.single_task([=]() { acc[0] = 1; });
+  }), sycl::exception);
+  q.AdaptiveCpp_end_recording();
+}
+#endif
 #ifdef SYCL_KHR_DEFAULT_CONTEXT
 BOOST_AUTO_TEST_CASE(khr_default_context) {
   using namespace cl;
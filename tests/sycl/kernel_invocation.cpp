@@ -10,6 +10,9 @@
 // SPDX-License-Identifier: BSD-2-Clause
 
 #include "sycl_test_suite.hpp"
+#include "hipSYCL/runtime/application.hpp"
+#include "hipSYCL/runtime/kernel_cache.hpp"
+#include "hipSYCL/runtime/settings.hpp"
 
 BOOST_FIXTURE_TEST_SUITE(kernel_invocation_tests, reset_device_fixture)
 
@@ -168,5 +171,47 @@ BOOST_AUTO_TEST_CASE(hierarchical_private_memory) {
 #endif // ACPP_LIBKERNEL_CUDA_NVCXX
 #endif // __ACPP_ENABLE_LLVM_SSCP_TARGET__
 
+BOOST_AUTO_TEST_CASE(jit_background_compilation_fallback) {
+  // For JIT-compiled kernels with ACPP_JIT_BACKGROUND_COMPILATION=1 and
+  // ACPP_ADAPTIVITY_LEVEL >= 1, the first launches run a fallback variant
+  // while the specialized variant is compiled in the background. Results
+  // must be the same before and after the switch to the specialized variant.
+  // Enable this independently of the environment; kernels that are not
+  // JIT-compiled are not affected.
+  namespace rt = hipsycl::rt;
+  auto& settings = rt::application::get_settings();
+  const bool old_background_compilation =
+      settings.get<rt::setting::jit_background_compilation>();
+  const int old_adaptivity_level =
+      settings.get<rt::setting::adaptivity_level>();
+  settings.set<rt::setting::jit_background_compilation>(true);
+  settings.set<rt::setting::adaptivity_level>(
+      std::max(old_adaptivity_level, 1));
+
+  constexpr std::size_t size = 1024;
+  cl::sycl::queue q;
+  int* data = cl::sycl::malloc_shared<int>(size, q);
+
+  auto run = [&](int round) {
+    q.parallel_for<class jit_background_compilation_fallback>(
+        cl::sycl::range<1>{size},
+        [=](cl::sycl::id<1> idx) { data[idx] = idx[0] + round; });
+    q.wait();
+    for(std::size_t i = 0; i < size; ++i)
+      BOOST_REQUIRE(data[i] == static_cast<int>(i) + round);
+  };
+
+  for(int round = 0; round < 4; ++round)
+    run(round);
+  hipsycl::rt::kernel_cache::get()->wait_for_background_compilations();
+  for(int round = 4; round < 8; ++round)
+    run(round);
+
+  cl::sycl::free(data, q);
+  settings.set<rt::setting::jit_background_compilation>(
+      old_background_compilation);
+  settings.set<rt::setting::adaptivity_level>(old_adaptivity_level);
+}
+
 BOOST_AUTO_TEST_SUITE_END() // NOTE: Make sure not to add anything below this
                             // line
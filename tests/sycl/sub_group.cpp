@@ -13,6 +13,35 @@
 #include "hipSYCL/sycl/info/device.hpp"
 #include "sycl_test_suite.hpp"
 
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// On the host, sub-groups consist of a single work item unless a larger size
+// is requested with ACPP_RT_OMP_SUB_GROUP_SIZE for SSCP kernels, e.g.
+// ACPP_RT_OMP_SUB_GROUP_SIZE=8.
+struct if_wide_sub_groups_available {
+  boost::test_tools::assertion_result
+  operator()(boost::unit_test::test_unit_id) {
+    auto sizes = cl::sycl::queue{}.get_device()
+                     .get_info<cl::sycl::info::device::sub_group_sizes>();
+    boost::test_tools::assertion_result ans(
+        std::any_of(sizes.begin(), sizes.end(),
+                    [](std::size_t size) { return size > 1; }));
+    if(!ans)
+      ans.message() << "sub-groups larger than a single work item are required";
+    return ans;
+  }
+};
+
+// Not a multiple of common sub-group sizes, so that the last sub-group
+// of each work group is smaller than the others.
+constexpr std::size_t wide_sg_local_size = 100;
+constexpr std::size_t wide_sg_num_groups = 10;
+
+}
+
 BOOST_FIXTURE_TEST_SUITE(sub_group_tests, reset_device_fixture)
 
 
@@ -128,5 +157,160 @@ BOOST_AUTO_TEST_CASE(sub_group) {
 }
 
 
+BOOST_AUTO_TEST_CASE(wide_sub_group_shuffle,
+                     *boost::unit_test::precondition(
+                         if_wide_sub_groups_available{})) {
+  namespace s = cl::sycl;
+  s::queue q;
+  const std::size_t size = wide_sg_local_size * wide_sg_num_groups;
+  std::vector<int> selected(size);
+  std::vector<int> shifted(size);
+  std::vector<int> sg_sizes(size);
+  std::vector<int> lanes(size);
+  {
+    s::buffer<int> selected_buff{selected.data(), size};
+    s::buffer<int> shifted_buff{shifted.data(), size};
+    s::buffer<int> sizes_buff{sg_sizes.data(), size};
+    s::buffer<int> lanes_buff{lanes.data(), size};
+
+    q.submit([&](s::handler &cgh) {
+      s::accessor selected_acc{selected_buff, cgh, s::write_only};
+      s::accessor shifted_acc{shifted_buff, cgh, s::write_only};
+      s::accessor sizes_acc{sizes_buff, cgh, s::write_only};
+      s::accessor lanes_acc{lanes_buff, cgh, s::write_only};
+
+      cgh.parallel_for<class wide_sub_group_shuffle_kernel>(
+          s::nd_range<1>{size, wide_sg_local_size}, [=](s::nd_item<1> idx) {
+            s::sub_group sg = idx.get_sub_group();
+            int x = static_cast<int>(idx.get_global_linear_id());
+            int sg_size = sg.get_local_linear_range();
+            int lane = sg.get_local_linear_id();
+
+            selected_acc[idx.get_global_id()] = s::select_from_group(
+                sg, x, s::id<1>{static_cast<std::size_t>((lane + 1) % sg_size)});
+            shifted_acc[idx.get_global_id()] = s::shift_group_left(sg, x, 1);
+            sizes_acc[idx.get_global_id()] = sg_size;
+            lanes_acc[idx.get_global_id()] = lane;
+          });
+    });
+  }
+
+  for(std::size_t i = 0; i < size; ++i) {
+    BOOST_TEST_INFO("i: " << i);
+    int first = static_cast<int>(i) - lanes[i];
+    BOOST_CHECK_EQUAL(selected[i], first + (lanes[i] + 1) % sg_sizes[i]);
+    // The result of lanes that would read beyond the sub-group is unspecified
+    if(lanes[i] + 1 < sg_sizes[i])
+      BOOST_CHECK_EQUAL(shifted[i], static_cast<int>(i) + 1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(wide_sub_group_reduce,
+                     *boost::unit_test::precondition(
+                         if_wide_sub_groups_available{})) {
+  namespace s = cl::sycl;
+  s::queue q;
+  const std::size_t size = wide_sg_local_size * wide_sg_num_groups;
+  std::vector<int> sums(size);
+  std::vector<int> maxima(size);
+  std::vector<int> scans(size);
+  std::vector<int> sg_sizes(size);
+  std::vector<int> lanes(size);
+  {
+    s::buffer<int> sums_buff{sums.data(), size};
+    s::buffer<int> maxima_buff{maxima.data(), size};
+    s::buffer<int> scans_buff{scans.data(), size};
+    s::buffer<int> sizes_buff{sg_sizes.data(), size};
+    s::buffer<int> lanes_buff{lanes.data(), size};
+
+    q.submit([&](s::handler &cgh) {
+      s::accessor sums_acc{sums_buff, cgh, s::write_only};
+      s::accessor maxima_acc{maxima_buff, cgh, s::write_only};
+      s::accessor scans_acc{scans_buff, cgh, s::write_only};
+      s::accessor sizes_acc{sizes_buff, cgh, s::write_only};
+      s::accessor lanes_acc{lanes_buff, cgh, s::write_only};
+
+      cgh.parallel_for<class wide_sub_group_reduce_kernel>(
+          s::nd_range<1>{size, wide_sg_local_size}, [=](s::nd_item<1> idx) {
+            s::sub_group sg = idx.get_sub_group();
+            int x = static_cast<int>(idx.get_global_linear_id());
+
+            sums_acc[idx.get_global_id()] =
+                s::reduce_over_group(sg, x, s::plus<int>());
+            maxima_acc[idx.get_global_id()] =
+                s::reduce_over_group(sg, x, s::maximum<int>());
+            scans_acc[idx.get_global_id()] =
+                s::inclusive_scan_over_group(sg, x, s::plus<int>());
+            sizes_acc[idx.get_global_id()] = sg.get_local_linear_range();
+            lanes_acc[idx.get_global_id()] = sg.get_local_linear_id();
+          });
+    });
+  }
+
+  for(std::size_t i = 0; i < size; ++i) {
+    BOOST_TEST_INFO("i: " << i);
+    int first = static_cast<int>(i) - lanes[i];
+    int sum = 0;
+    for(int j = first; j < first + sg_sizes[i]; ++j)
+      sum += j;
+    int scan = 0;
+    for(int j = first; j <= static_cast<int>(i); ++j)
+      scan += j;
+    BOOST_CHECK_EQUAL(sums[i], sum);
+    BOOST_CHECK_EQUAL(maxima[i], first + sg_sizes[i] - 1);
+    BOOST_CHECK_EQUAL(scans[i], scan);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(wide_sub_group_barrier,
+                     *boost::unit_test::precondition(
+                         if_wide_sub_groups_available{})) {
+  namespace s = cl::sycl;
+  s::queue q;
+  const std::size_t size = wide_sg_local_size * wide_sg_num_groups;
+  std::vector<int> results(size);
+  std::vector<int> sg_sizes(size);
+  std::vector<int> lanes(size);
+  {
+    s::buffer<int> results_buff{results.data(), size};
+    s::buffer<int> sizes_buff{sg_sizes.data(), size};
+    s::buffer<int> lanes_buff{lanes.data(), size};
+
+    q.submit([&](s::handler &cgh) {
+      s::accessor results_acc{results_buff, cgh, s::write_only};
+      s::accessor sizes_acc{sizes_buff, cgh, s::write_only};
+      s::accessor lanes_acc{lanes_buff, cgh, s::write_only};
+      s::local_accessor<int, 1> scratch{s::range<1>{wide_sg_local_size}, cgh};
+
+      cgh.parallel_for<class wide_sub_group_barrier_kernel>(
+          s::nd_range<1>{size, wide_sg_local_size}, [=](s::nd_item<1> idx) {
+            s::sub_group sg = idx.get_sub_group();
+            std::size_t lid = idx.get_local_linear_id();
+            int sg_size = sg.get_local_linear_range();
+            int lane = sg.get_local_linear_id();
+
+            scratch[lid] = static_cast<int>(idx.get_global_linear_id());
+            s::group_barrier(sg);
+            // Read the value that the next work item of the sub-group wrote
+            // before the barrier
+            std::size_t neighbor = lid - lane + (lane + 1) % sg_size;
+            int value = scratch[neighbor];
+            s::group_barrier(sg);
+            // Overwrite it only once all work items of the sub-group have read
+            scratch[lid] = -1;
+
+            results_acc[idx.get_global_id()] = value;
+            sizes_acc[idx.get_global_id()] = sg_size;
+            lanes_acc[idx.get_global_id()] = lane;
+          });
+    });
+  }
+
+  for(std::size_t i = 0; i < size; ++i) {
+    BOOST_TEST_INFO("i: " << i);
+    int first = static_cast<int>(i) - lanes[i];
+    BOOST_CHECK_EQUAL(results[i], first + (lanes[i] + 1) % sg_sizes[i]);
+  }
+}
 
 BOOST_AUTO_TEST_SUITE_END()